@@ -10,9 +10,37 @@
         "native/memory.cc",
         "native/process.cc",
         "native/module.cc",
+        "native/registry.cc",
         "native/pattern.cc",
-        "native/functions.cc",
-        "native/debugger.cc"
+        "native/signature.cc",
+        "native/multipattern.cc",
+        "native/threadpool.cc",
+        "native/readplan.cc",
+        "native/layout.cc",
+        "native/columns.cc",
+        "native/pagecache.cc",
+        "native/regionmap.cc",
+        "native/valuescan.cc",
+        "native/pointerscan.cc",
+        "native/snapshot.cc",
+        "native/watcher.cc",
+        "native/debugpump.cc"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "sources": [
+            "native/platform_win.cc",
+            "native/functions.cc",
+            "native/debugger.cc"
+          ]
+        }],
+        ["OS=='linux'", {
+          "sources": [
+            "native/platform_linux.cc"
+          ],
+          "cflags_cc": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
       ],
       'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ]
     }
@@ -0,0 +1,34 @@
+// @ts-ignore
+import { openProcess, closeHandle, readMemory, DataTypes } from 'memoryprocess';
+
+// Reads the same value over and over from this very process, first passing the data
+// type by name and then by id, to show what looking the name up costs on every call
+const ITERATIONS = 1_000_000;
+
+const processObject = openProcess(process.pid);
+
+// the first bytes of the main module are always mapped and readable
+const address = processObject.modBaseAddr;
+
+function bench(label: string, read: () => unknown) {
+  // warm up so both variants run optimized code
+  for (let i = 0; i < ITERATIONS / 10; i++) {
+    read();
+  }
+
+  const start = performance.now();
+
+  for (let i = 0; i < ITERATIONS; i++) {
+    read();
+  }
+
+  const elapsed = performance.now() - start;
+  console.log(`${label.padEnd(24)} ${(elapsed * 1e6 / ITERATIONS).toFixed(1)} ns/call`);
+}
+
+bench("readMemory('vec4')", () => readMemory(processObject.handle, address, 'vec4'));
+bench('readMemory(DataTypes.vec4)', () => readMemory(processObject.handle, address, DataTypes.vec4));
+bench("readMemory('uint32')", () => readMemory(processObject.handle, address, 'uint32'));
+bench('readMemory(DataTypes.uint32)', () => readMemory(processObject.handle, address, DataTypes.uint32));
+
+closeHandle(processObject.handle);
@@ -0,0 +1,28 @@
+// @ts-ignore
+import { openProcess, closeHandle, savePointerMap, scanPointerMap, filterPointerChains, readPointerChains } from 'memoryprocess';
+
+const PROCESS_NAME = "DarkSoulsRemastered.exe";
+
+const processObject = openProcess(PROCESS_NAME);
+
+// The address of the souls value found this session, run again after every restart of the game
+const soulsAddress = Number(process.argv[2]);
+
+if (process.argv[3] === 'first') {
+  // the first session maps every pointer once, any number of addresses can then be scanned for offline
+  const pointers = savePointerMap(processObject.handle, 'session.map', { pointerSize: 4 });
+  const stats = scanPointerMap('session.map', soulsAddress, 'souls.ptrs', { maxDepth: 4, maxOffset: 0x400 });
+
+  console.log(`${pointers} pointers mapped, ${stats.chains} candidate chains`);
+} else {
+  // every later session only follows the chains still left, then keeps the ones leading to the value
+  const stats = filterPointerChains(processObject.handle, 'souls.ptrs', soulsAddress, 'souls.next.ptrs');
+
+  console.log(`${stats.kept} of ${stats.chains} chains survived the restart`);
+
+  for (const chain of readPointerChains('souls.next.ptrs', 10)) {
+    console.log(`${chain.module} + ${chain.offsets.map(offset => `0x${offset.toString(16)}`).join(' -> ')}`);
+  }
+}
+
+closeHandle(processObject.handle);
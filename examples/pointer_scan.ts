@@ -0,0 +1,45 @@
+// @ts-ignore
+import { openProcess, closeHandle, findModule, readMemory, scanPointers, readPointerChains, compileReadPlan, executeReadPlan } from 'memoryprocess';
+
+const PROCESS_NAME = "DarkSoulsRemastered.exe";
+
+const processObject = openProcess(PROCESS_NAME);
+
+// The address of the souls value found this session, e.g. with a value scan. The chains leading to it
+// replace the offsets hard coded in read_game_memory.ts once a patch moves them.
+const soulsAddress = Number(process.argv[2]);
+
+const stats = scanPointers(processObject.handle, soulsAddress, 'souls.ptrs', {
+  pointerSize: 4,
+  maxDepth: 4,
+  maxOffset: 0x400,
+});
+
+console.log(`${stats.pointers} pointers mapped, ${stats.chains} chains written${stats.truncated ? ' (truncated)' : ''}`);
+
+// chains start in a module, resolved against this session's base address
+const found = readPointerChains('souls.ptrs', 1000);
+const chains = found.map(chain => ({
+  base: findModule(chain.module, processObject.th32ProcessID).modBaseAddr,
+  offsets: chain.offsets,
+  type: "int",
+}));
+
+const plan = compileReadPlan(chains, 4);
+const buffer = new ArrayBuffer(plan.byteLength);
+const view = new DataView(buffer);
+
+executeReadPlan(processObject.handle, plan, buffer);
+
+const souls = readMemory(processObject.handle, soulsAddress, "int");
+
+// the first chains still leading to the value
+for (let i = 0, shown = 0; i < chains.length && shown < 10; i++) {
+  if (view.getUint8(plan.statusOffset + i) === 1 && view.getInt32(plan.offsets[i], true) === souls) {
+    const offsets = found[i].offsets.map(offset => `0x${offset.toString(16)}`).join(' -> ');
+    console.log(`${found[i].module} + ${offsets}`);
+    shown++;
+  }
+}
+
+closeHandle(processObject.handle);
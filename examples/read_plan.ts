@@ -0,0 +1,29 @@
+// @ts-ignore
+import { openProcess, closeHandle, compileReadPlan, executeReadPlan } from 'memoryprocess';
+
+const PROCESS_NAME = "DarkSoulsRemastered.exe";
+
+const processObject = openProcess(PROCESS_NAME);
+
+// Same pointer chain as read_game_memory.ts (BaseAddress + 0x1D278F0 -> + 0x10 -> + 0x94),
+// compiled once and followed entirely in native code on every execution
+const plan = compileReadPlan([
+  { base: processObject.modBaseAddr, offsets: [0x1D278F0, 0x10, 0x94], type: "int" },
+], 4);
+
+// Allocated once, every execution writes into it
+const buffer = new ArrayBuffer(plan.byteLength);
+const view = new DataView(buffer);
+
+const timer = setInterval(() => {
+  executeReadPlan(processObject.handle, plan, buffer);
+
+  if (view.getUint8(plan.statusOffset) === 1) {
+    console.log(`Current Player Souls: ${view.getInt32(plan.offsets[0], true)}`);
+  }
+}, 1000 / 60);
+
+setTimeout(() => {
+  clearInterval(timer);
+  closeHandle(processObject.handle);
+}, 10000);
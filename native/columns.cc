@@ -0,0 +1,170 @@
+#include <cstring>
+#include <vector>
+#include "columns.h"
+#include "pagecache.h"
+#include "platform.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define COLUMNS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// SSE2 is part of every x64 target, 32-bit builds only use it when enabled
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define COLUMNS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(COLUMNS_X86) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+  // structs read last, reused so polling doesn't allocate
+  thread_local std::vector<unsigned char> scratch;
+
+  void gatherScalar(const unsigned char* source, size_t count, size_t stride, size_t size, unsigned char* target) {
+    for (size_t i = 0; i < count; i++) {
+      memcpy(target + i * size, source + i * stride, size);
+    }
+  }
+
+#ifdef COLUMNS_SSE2
+  // Vectors are copied 16 bytes at a time. A Vector3 store spills 4 bytes into the
+  // next slot, which the next store overwrites, so the last one is copied exactly.
+  void gatherVectors(const unsigned char* source, size_t count, size_t stride, size_t size, unsigned char* target) {
+    if (count == 0) {
+      return;
+    }
+
+    size_t i = 0;
+
+    for (; i + 1 < count; i++) {
+      __m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * stride));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i * size), vector);
+    }
+
+    memcpy(target + i * size, source + i * stride, size);
+  }
+#endif
+
+#ifdef COLUMNS_X86
+  // Eight 4 byte fields are gathered by a single instruction
+  TARGET_AVX2
+  void gather32AVX2(const unsigned char* source, size_t count, size_t stride, unsigned char* target) {
+    const int step = (int) stride;
+    const __m256i indexes = _mm256_setr_epi32(0, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256i values = _mm256_i32gather_epi32(reinterpret_cast<const int*>(source + i * stride), indexes, 1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i * 4), values);
+    }
+
+    gatherScalar(source + i * stride, count - i, stride, 4, target + i * 4);
+  }
+
+  bool supportsAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7) {
+      return false;
+    }
+
+    // AVX2 also requires the OS to save the YMM registers (OSXSAVE + XCR0)
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+      return false;
+    }
+
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+      return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+#endif
+
+  void gather(const unsigned char* source, size_t count, size_t stride, size_t size, unsigned char* target) {
+#ifdef COLUMNS_X86
+    static const bool avx2 = supportsAVX2();
+
+    // the gather takes 32-bit offsets, strides too large for them are copied one by one
+    if (size == 4 && avx2 && stride <= 0x7fffffff / 8) {
+      gather32AVX2(source, count, stride, target);
+      return;
+    }
+#endif
+
+#ifdef COLUMNS_SSE2
+    // the 16 byte loads stay inside the structs read as long as they don't overlap
+    if ((size == 12 || size == 16) && stride >= size) {
+      gatherVectors(source, count, stride, size, target);
+      return;
+    }
+#endif
+
+    gatherScalar(source, count, stride, size, target);
+  }
+}
+
+size_t columns::read(HANDLE handle, uintptr_t address, size_t count, size_t stride, const std::vector<Column>& columns) {
+  if (count == 0 || columns.empty()) {
+    return 0;
+  }
+
+  // only the bytes between the first and the last field asked for are read
+  size_t first = columns[0].offset;
+  size_t last = 0;
+
+  for (const Column& column : columns) {
+    first = column.offset < first ? column.offset : first;
+    last = column.offset + column.size > last ? column.offset + column.size : last;
+  }
+
+  size_t span = (count - 1) * stride + (last - first);
+  scratch.resize(span);
+
+  size_t read = count;
+
+  // structs packed closely enough are read at once, the gaps between them along
+  if (span > count * (last - first) * 2 || !pagecache::read(handle, address + first, scratch.data(), span)) {
+    std::vector<platform::Read> reads(count);
+
+    for (size_t i = 0; i < count; i++) {
+      reads[i] = { address + i * stride + first, scratch.data() + i * stride, last - first };
+    }
+
+    std::vector<bool> success;
+    platform::readMemory(handle, reads, &success);
+
+    read = 0;
+
+    for (size_t i = 0; i < count; i++) {
+      if (success[i]) {
+        read++;
+      } else {
+        memset(scratch.data() + i * stride, 0, last - first);
+      }
+    }
+  }
+
+  for (const Column& column : columns) {
+    gather(scratch.data() + column.offset - first, count, stride, column.size, column.target);
+  }
+
+  return read;
+}
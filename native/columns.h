@@ -0,0 +1,28 @@
+#pragma once
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "platform.h"
+
+// Columnar reads of arrays of structs. The array is read at once and the fields
+// asked for are scattered into tightly packed columns owned by the caller, so
+// polling thousands of entities a frame doesn't allocate anything.
+namespace columns {
+  struct Column {
+    // offset of the field in every struct
+    size_t offset;
+    // bytes of the field, 1, 2, 4 or 8 for numbers, 12 for a Vector3 and 16 for a Vector4
+    size_t size;
+    // `count * size` bytes, the field of struct n is written `n * size` bytes in
+    unsigned char* target;
+  };
+
+  // Reads `count` structs `stride` bytes apart and fills every column. Fields of
+  // structs that couldn't be read are zeroed. Returns the number of structs read.
+  size_t read(HANDLE handle, uintptr_t address, size_t count, size_t stride, const std::vector<Column>& columns);
+}
+
+#endif
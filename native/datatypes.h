@@ -0,0 +1,94 @@
+#pragma once
+#ifndef DATATYPES_H
+#define DATATYPES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Every data type `readMemory` and `writeMemory` handle, along with its size
+// (0 when it isn't fixed). A type's id is its position in the list.
+#define DATA_TYPES(X) \
+  X(INT8, 1) \
+  X(UINT8, 1) \
+  X(INT16, 2) \
+  X(UINT16, 2) \
+  X(INT32, 4) \
+  X(UINT32, 4) \
+  X(INT64, 8) \
+  X(UINT64, 8) \
+  X(FLOAT, sizeof(float)) \
+  X(DOUBLE, sizeof(double)) \
+  X(PTR, sizeof(intptr_t)) \
+  X(UPTR, sizeof(uintptr_t)) \
+  X(BOOL, sizeof(bool)) \
+  X(STRING, 0) \
+  X(WSTRING, 0) \
+  X(VECTOR3, 3 * sizeof(float)) \
+  X(VECTOR4, 4 * sizeof(float))
+
+// Names JavaScript passes for every type
+#define DATA_TYPE_NAMES(X) \
+  X("int8", INT8) X("byte", INT8) X("char", INT8) \
+  X("uint8", UINT8) X("ubyte", UINT8) X("uchar", UINT8) \
+  X("int16", INT16) X("short", INT16) \
+  X("uint16", UINT16) X("ushort", UINT16) X("word", UINT16) \
+  X("int32", INT32) X("int", INT32) X("long", INT32) \
+  X("uint32", UINT32) X("uint", UINT32) X("ulong", UINT32) X("dword", UINT32) \
+  X("int64", INT64) \
+  X("uint64", UINT64) \
+  X("float", FLOAT) \
+  X("double", DOUBLE) \
+  X("ptr", PTR) X("pointer", PTR) \
+  X("uptr", UPTR) X("upointer", UPTR) \
+  X("bool", BOOL) X("boolean", BOOL) \
+  X("string", STRING) X("str", STRING) \
+  X("wstring", WSTRING) X("wstr", WSTRING) \
+  X("vector3", VECTOR3) X("vec3", VECTOR3) \
+  X("vector4", VECTOR4) X("vec4", VECTOR4)
+
+// Numeric ids of the data types. JavaScript gets them as `DataTypes` and can pass
+// them in place of the names, which skips looking the name up on every call.
+namespace datatype {
+  enum Id : uint32_t {
+#define DATA_TYPE_ID(name, size) T_##name,
+    DATA_TYPES(DATA_TYPE_ID)
+#undef DATA_TYPE_ID
+    T_COUNT
+  };
+
+  constexpr size_t sizes[] = {
+#define DATA_TYPE_SIZE(name, size) size,
+    DATA_TYPES(DATA_TYPE_SIZE)
+#undef DATA_TYPE_SIZE
+  };
+
+  constexpr size_t getSize(Id id) {
+    return id < T_COUNT ? sizes[id] : 0;
+  }
+
+  inline const std::unordered_map<std::string, Id>& getNames() {
+    static const std::unordered_map<std::string, Id> names = {
+#define DATA_TYPE_NAME(name, id) { name, T_##id },
+      DATA_TYPE_NAMES(DATA_TYPE_NAME)
+#undef DATA_TYPE_NAME
+    };
+
+    return names;
+  }
+
+  // Id of a type name, false when there is none
+  inline bool fromName(const std::string& name, Id* id) {
+    auto found = getNames().find(name);
+
+    if (found == getNames().end()) {
+      return false;
+    }
+
+    *id = found->second;
+    return true;
+  }
+}
+
+#endif
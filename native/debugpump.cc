@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <chrono>
+#include "debugpump.h"
+
+namespace {
+  // longest a command waits for the pump to be done waiting for an event
+  const DWORD WAIT_SLICE = 5;
+}
+
+debugpump::Pump::Pump(std::function<void()> notify) : notify(notify), stopping(false), notified(false) {
+  std::fill(policies, policies + 5, HANDLED);
+  policies[0] = UNHANDLED;
+
+  thread = std::thread(&Pump::run, this);
+}
+
+debugpump::Pump::~Pump() {
+  stop();
+}
+
+bool debugpump::Pump::attach(DWORD processId, bool killOnExit) {
+  return execute([this, processId, killOnExit]() {
+    if (!platform::debugAttach(processId, killOnExit)) {
+      return false;
+    }
+
+    processes.insert(processId);
+    return true;
+  });
+}
+
+bool debugpump::Pump::detach(DWORD processId) {
+  return execute([this, processId]() {
+    release(processId);
+    processes.erase(processId);
+    return platform::debugDetach(processId);
+  });
+}
+
+bool debugpump::Pump::setBreakpoint(DWORD processId, uintptr_t address, int hardwareRegister, int trigger, int size) {
+  return execute([=]() {
+    return platform::setHardwareBreakpoint(processId, address, hardwareRegister, trigger, size);
+  });
+}
+
+bool debugpump::Pump::removeBreakpoint(DWORD processId, int hardwareRegister) {
+  return execute([=]() {
+    return platform::removeHardwareBreakpoint(processId, hardwareRegister);
+  });
+}
+
+void debugpump::Pump::setPolicy(int hardwareRegister, Policy policy) {
+  std::lock_guard<std::mutex> lock(mutex);
+  policies[hardwareRegister + 1] = policy;
+}
+
+bool debugpump::Pump::resume(DWORD processId, DWORD threadId, bool handled) {
+  return execute([this, processId, threadId, handled]() {
+    auto stop = std::find_if(held.begin(), held.end(), [&](const platform::DebugStop& stop) {
+      return stop.processId == processId && stop.threadId == threadId;
+    });
+
+    if (stop == held.end()) {
+      return false;
+    }
+
+    bool success = platform::debugContinue(*stop, handled);
+    held.erase(stop);
+    return success;
+  });
+}
+
+void debugpump::Pump::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  wake.notify_all();
+
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+bool debugpump::Pump::take(std::vector<platform::DebugStop>* stops) {
+  std::lock_guard<std::mutex> lock(mutex);
+  notified = false;
+
+  stops->swap(pending);
+  pending.clear();
+
+  return !stops->empty();
+}
+
+bool debugpump::Pump::execute(std::function<bool()> command) {
+  std::packaged_task<bool()> task(command);
+  std::future<bool> result = task.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (stopping) {
+      return false;
+    }
+
+    commands.push_back(std::move(task));
+  }
+
+  wake.notify_all();
+  return result.get();
+}
+
+void debugpump::Pump::run() {
+  std::deque<std::packaged_task<bool()>> queued;
+
+  for (;;) {
+    bool exiting;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      // with nothing attached there are only commands to wait for
+      wake.wait(lock, [this]() { return stopping || !commands.empty() || !processes.empty(); });
+
+      queued.swap(commands);
+      exiting = stopping;
+    }
+
+    for (auto& command : queued) {
+      command();
+    }
+
+    queued.clear();
+
+    if (exiting) {
+      break;
+    }
+
+    if (processes.empty()) {
+      continue;
+    }
+
+#ifdef _WIN32
+    // Windows has no next event for a debugger that hasn't continued the last one
+    if (!held.empty()) {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait_for(lock, std::chrono::milliseconds(WAIT_SLICE), [this]() { return stopping || !commands.empty(); });
+      continue;
+    }
+#endif
+
+    platform::DebugStop stop;
+
+    if (platform::debugWait(WAIT_SLICE, &stop)) {
+      dispatch(stop);
+    }
+  }
+
+  // commands queued as the pump was stopping still get their answer
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.swap(commands);
+  }
+
+  for (auto& command : queued) {
+    command();
+  }
+
+  for (DWORD processId : std::vector<DWORD>(processes.begin(), processes.end())) {
+    release(processId);
+    platform::debugDetach(processId);
+  }
+
+  processes.clear();
+}
+
+void debugpump::Pump::dispatch(const platform::DebugStop& stop) {
+  if (stop.exited) {
+    processes.erase(stop.processId);
+    held.erase(std::remove_if(held.begin(), held.end(), [&](const platform::DebugStop& other) {
+      return other.processId == stop.processId;
+    }), held.end());
+    return;
+  }
+
+  if (stop.initial) {
+    platform::debugContinue(stop, true);
+    return;
+  }
+
+  int hardwareRegister = stop.hardwareRegister >= 0 && stop.hardwareRegister < 4 ? stop.hardwareRegister : -1;
+  Policy policy;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = policies[hardwareRegister + 1];
+  }
+
+  // a hit sampled on Linux didn't stop the thread, there is nothing to hold or continue
+  if (!stop.sampled && policy == HOLD) {
+    held.push_back(stop);
+  } else if (!stop.sampled) {
+    platform::debugContinue(stop, policy == HANDLED);
+  }
+
+  bool waking;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(stop);
+
+    waking = !notified;
+    notified = true;
+  }
+
+  if (waking) {
+    notify();
+  }
+}
+
+void debugpump::Pump::release(DWORD processId) {
+  for (auto stop = held.begin(); stop != held.end();) {
+    if (stop->processId != processId) {
+      stop++;
+      continue;
+    }
+
+    platform::debugContinue(*stop, stop->hardwareRegister != -1);
+    stop = held.erase(stop);
+  }
+}
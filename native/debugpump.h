@@ -0,0 +1,85 @@
+#pragma once
+#ifndef DEBUGPUMP_H
+#define DEBUGPUMP_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "platform.h"
+
+// Debug event pump. Debugging is tied to the thread that attached, so a thread of its own
+// attaches, waits for events and continues them, and everything else asks it to. A stop is
+// continued right away the way the policy of its debug register says, so a breakpoint hit
+// often costs the process a round trip between two native threads instead of a trip through
+// the JavaScript event loop. Stops pile up until the consumer takes them, like the watcher's
+// changes.
+namespace debugpump {
+  enum Policy {
+    // continued as handled, the process doesn't see the exception or signal
+    HANDLED = 0,
+    // passed on to the process
+    UNHANDLED = 1,
+    // left stopped until `resume`
+    HOLD = 2,
+  };
+
+  class Pump {
+  public:
+    // Starts the thread. `notify` is called from it when stops are waiting to be taken and
+    // none were waiting before.
+    Pump(std::function<void()> notify);
+    ~Pump();
+
+    // All run on the pump thread, the caller waits for them
+    bool attach(DWORD processId, bool killOnExit);
+    bool detach(DWORD processId);
+    bool setBreakpoint(DWORD processId, uintptr_t address, int hardwareRegister, int trigger, int size);
+    bool removeBreakpoint(DWORD processId, int hardwareRegister);
+
+    // Policy of the stops of a debug register, -1 for the stops that aren't hardware
+    // breakpoints. Registers are continued as handled by default, other stops passed on.
+    // Breakpoint hits sampled on Linux never stopped the thread, they are only reported.
+    void setPolicy(int hardwareRegister, Policy policy);
+
+    // Continues a stop held by the HOLD policy, false when the thread isn't held
+    bool resume(DWORD processId, DWORD threadId, bool handled);
+
+    // Continues what is held, detaches from every process and waits for the thread,
+    // `notify` is never called afterwards
+    void stop();
+
+    // Takes the stops waiting, false when there are none
+    bool take(std::vector<platform::DebugStop>* stops);
+
+  private:
+    void run();
+    bool execute(std::function<bool()> command);
+    void dispatch(const platform::DebugStop& stop);
+    // continues the stops held of a process, breakpoints as handled and anything else passed on
+    void release(DWORD processId);
+
+    std::function<void()> notify;
+
+    // only touched by the pump thread
+    std::unordered_set<DWORD> processes;
+    std::vector<platform::DebugStop> held;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::deque<std::packaged_task<bool()>> commands;
+    // indexed by register + 1
+    Policy policies[5];
+    std::vector<platform::DebugStop> pending;
+    bool notified;
+
+    std::thread thread;
+  };
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <TlHelp32.h>
 #include <vector>
 #include <string>
+#include "memory.h"
 
 struct Call {
   int returnValue;
@@ -31,7 +32,6 @@ namespace functions {
   };
 
   LPVOID reserveString(HANDLE hProcess, const char* value, SIZE_T size);
-  char readChar(HANDLE hProcess, DWORD64 address);
 
   template <class returnDataType>
   Call call(HANDLE pHandle, std::vector<Arg> args, Type returnType, DWORD64 address, const char** errorMessage) {
@@ -174,30 +174,8 @@ namespace functions {
       // So we read the current returnValuePointer address to get the actual address of the string
       ReadProcessMemory(pHandle, (LPVOID)returnValuePointer, &returnValuePointer, sizeof(int), NULL);
 
-      std::vector<char> chars;
-      int offset = 0x0;
-      while (true) {
-        char c = functions::readChar(pHandle, (DWORD64)returnValuePointer + offset);
-        chars.push_back(c);
-
-        // break at 1 million chars
-        if (offset == (sizeof(char) * 1000000)) {
-          chars.clear();
-          break;
-        }
-
-        // break at terminator (end of string)
-        if (c == '\0') {
-          break;
-        }
-
-        // go to next char
-        offset += sizeof(char);
-      }
-
-      std::string str(chars.begin(), chars.end());
-      // TODO: pass str as LPVOID and cast back to string
-      data.returnString = str;
+      memory reader;
+      reader.readString(pHandle, (DWORD64)returnValuePointer, &data.returnString, 1000000);
     }
 
     VirtualFreeEx(pHandle, pShellcode, 0, MEM_RELEASE);
@@ -0,0 +1,214 @@
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "layout.h"
+#include "pagecache.h"
+#include "platform.h"
+
+namespace {
+  std::mutex registryMutex;
+  std::vector<std::shared_ptr<const layout::Layout>> registry;
+
+  // Follows the pointer fields of the structs of `image`, for a layout stored `base` bytes into them.
+  // Returns false when the structs pointed to by a field would span more than `MAX_SIZE`.
+  bool follow(HANDLE handle, const layout::Layout& structLayout, size_t base, const layout::Layout& root, layout::Image* image) {
+    size_t count = image->present.size();
+
+    for (const layout::Field& field : structLayout.fields) {
+      const layout::Layout* target = field.target;
+
+      if (target == nullptr) {
+        continue;
+      }
+
+      if (field.type == layout::T_STRUCT) {
+        if (!follow(handle, *target, base + field.offset, root, image)) {
+          return false;
+        }
+
+        continue;
+      }
+
+      // every level holds one struct per struct of the read, each as large as its layout
+      if (count > layout::MAX_SIZE / target->size) {
+        return false;
+      }
+
+      layout::Image& child = image->children[{ base + field.offset, &field }];
+      child.stride = target->size;
+      child.bytes.assign(count * target->size, 0);
+      child.present.assign(count, false);
+
+      std::vector<platform::Read> reads;
+      std::vector<size_t> indexes;
+
+      for (size_t i = 0; i < count; i++) {
+        if (!image->present[i]) {
+          continue;
+        }
+
+        uintptr_t pointer = layout::getPointer(root, image->bytes.data() + i * image->stride + base + field.offset);
+
+        if (pointer != 0) {
+          reads.push_back({ pointer, child.bytes.data() + i * target->size, target->size });
+          indexes.push_back(i);
+        }
+      }
+
+      if (!reads.empty()) {
+        std::vector<bool> success;
+        platform::readMemory(handle, reads, &success);
+
+        for (size_t i = 0; i < indexes.size(); i++) {
+          child.present[indexes[i]] = success[i];
+        }
+      }
+
+      // images are made for every pointer field, even when nothing is read, so decoding always finds them
+      if (!follow(handle, *target, 0, *target, &child)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+size_t layout::getTypeSize(Type type, size_t pointerSize) {
+  switch (type) {
+    case T_INT8: case T_UINT8: case T_BOOL: return 1;
+    case T_INT16: case T_UINT16: return 2;
+    case T_INT32: case T_UINT32: case T_FLOAT: return 4;
+    case T_INT64: case T_UINT64: case T_DOUBLE: return 8;
+    case T_POINTER: return pointerSize;
+    case T_VECTOR3: return 3 * sizeof(float);
+    case T_VECTOR4: return 4 * sizeof(float);
+    default: return 0;
+  }
+}
+
+int layout::add(const Layout& structLayout, const char** errorMessage) {
+  if (structLayout.pointerSize != 4 && structLayout.pointerSize != 8) {
+    *errorMessage = "pointer size must be 4 or 8";
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  std::shared_ptr<Layout> stored = std::make_shared<Layout>(structLayout);
+  size_t end = 0;
+
+  for (Field& field : stored->fields) {
+    size_t size = getTypeSize(field.type, stored->pointerSize);
+
+    if (field.layout >= (int) registry.size()) {
+      *errorMessage = "fields can only refer to layouts registered before";
+      return -1;
+    }
+
+    field.target = nullptr;
+
+    if (field.type == T_STRUCT) {
+      if (field.layout < 0) {
+        *errorMessage = "struct fields need a layout";
+        return -1;
+      }
+
+      field.target = registry[field.layout].get();
+      size = field.target->size;
+    } else if (field.type == T_POINTER) {
+      field.target = field.layout < 0 ? nullptr : registry[field.layout].get();
+    } else if (field.type == T_STRING) {
+      if (field.length == 0) {
+        *errorMessage = "string fields need a length";
+        return -1;
+      }
+
+      field.layout = -1;
+      size = field.length;
+    } else {
+      // only pointers and nested structs refer to other layouts
+      field.layout = -1;
+    }
+
+    if (field.offset > MAX_SIZE || size > MAX_SIZE - field.offset) {
+      *errorMessage = "fields must end within the first GiB of the struct";
+      return -1;
+    }
+
+    end = field.offset + size > end ? field.offset + size : end;
+  }
+
+  stored->size = stored->size > end ? stored->size : end;
+
+  if (stored->size > MAX_SIZE) {
+    *errorMessage = "layouts can't be larger than 1 GiB";
+    return -1;
+  }
+
+  if (stored->size == 0) {
+    *errorMessage = "layouts need at least one field";
+    return -1;
+  }
+
+  registry.push_back(stored);
+  return (int) registry.size() - 1;
+}
+
+std::shared_ptr<const layout::Layout> layout::get(int id) {
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  if (id < 0 || id >= (int) registry.size()) {
+    return nullptr;
+  }
+
+  return registry[id];
+}
+
+bool layout::read(HANDLE handle, const Layout& structLayout, uintptr_t address, size_t count, size_t stride, Image* image, const char** errorMessage) {
+  image->stride = stride;
+  image->bytes.assign(count == 0 ? 0 : (count - 1) * stride + structLayout.size, 0);
+  image->present.assign(count, false);
+  image->children.clear();
+
+  // structs packed closely enough are read at once, the gaps between them along
+  bool read = count != 0 && image->bytes.size() <= count * structLayout.size * 2 && pagecache::read(handle, address, image->bytes.data(), image->bytes.size());
+
+  if (read) {
+    image->present.assign(count, true);
+  } else {
+    std::vector<platform::Read> reads(count);
+
+    for (size_t i = 0; i < count; i++) {
+      reads[i] = { address + i * stride, image->bytes.data() + i * stride, structLayout.size };
+    }
+
+    std::vector<bool> success;
+    platform::readMemory(handle, reads, &success);
+
+    for (size_t i = 0; i < count; i++) {
+      image->present[i] = success[i];
+      read = read || success[i];
+    }
+  }
+
+  if (!follow(handle, structLayout, 0, structLayout, image)) {
+    image->children.clear();
+    *errorMessage = "the structs pointed to can't span more than 1 GiB";
+    return false;
+  }
+
+  return read;
+}
+
+uintptr_t layout::getPointer(const Layout& structLayout, const unsigned char* data) {
+  if (structLayout.pointerSize == 4) {
+    uint32_t pointer;
+    memcpy(&pointer, data, sizeof(pointer));
+    return pointer;
+  }
+
+  uint64_t pointer;
+  memcpy(&pointer, data, sizeof(pointer));
+  return (uintptr_t) pointer;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "platform.h"
+
+// Struct layouts registered once and decoded in bulk. Reading structs copies the
+// bytes of every element with as few reads as possible, then follows the pointer
+// fields pointing to other structs, the structs pointed to by a field read in one batch.
+namespace layout {
+  enum Type {
+    T_INT8,
+    T_UINT8,
+    T_INT16,
+    T_UINT16,
+    T_INT32,
+    T_UINT32,
+    T_INT64,
+    T_UINT64,
+    T_FLOAT,
+    T_DOUBLE,
+    T_BOOL,
+    T_POINTER,
+    T_VECTOR3,
+    T_VECTOR4,
+    // NUL terminated string stored in the struct, `length` bytes at most
+    T_STRING,
+    // struct stored in the struct
+    T_STRUCT
+  };
+
+  struct Layout;
+
+  struct Field {
+    std::string name;
+    size_t offset;
+    Type type;
+    size_t length;
+    // layout of a T_STRUCT field, or of the struct a T_POINTER field points to, -1 for none
+    int layout;
+    // that layout, resolved when the layout is added
+    const Layout* target;
+  };
+
+  struct Layout {
+    std::vector<Field> fields;
+    // bytes read for every struct
+    size_t size;
+    // 4 or 8, the size of the pointers stored in the target process
+    size_t pointerSize;
+  };
+
+  // Bytes of `count` structs, `stride` bytes apart, along with the structs their
+  // pointer fields point to
+  struct Image {
+    std::vector<unsigned char> bytes;
+    size_t stride;
+    // structs that could be read, pointed structs are missing for null pointers
+    std::vector<bool> present;
+    // structs pointed to by the pointer fields, by offset of the field in the struct.
+    // Fields of nested structs are found at the offset of the nested struct plus their own.
+    std::map<std::pair<size_t, const Field*>, Image> children;
+  };
+
+  // Most bytes a layout, or the structs of a single read, can span
+  const size_t MAX_SIZE = (size_t) 1 << 30;
+
+  // Size of the fixed size types, 0 for strings and structs
+  size_t getTypeSize(Type type, size_t pointerSize);
+
+  // Validates and stores a layout, returns its id or -1. Layouts can only refer to
+  // layouts registered before them, so layouts never form a cycle.
+  int add(const Layout& layout, const char** errorMessage);
+
+  // Layout registered with `id`, nullptr when there is none
+  std::shared_ptr<const Layout> get(int id);
+
+  // Reads `count` structs starting at `address`. Returns false when none could be read, or with
+  // `errorMessage` set when the structs a pointer field points to would span more than `MAX_SIZE`.
+  bool read(HANDLE handle, const Layout& layout, uintptr_t address, size_t count, size_t stride, Image* image, const char** errorMessage);
+
+  // Value of the pointer stored at `data`
+  uintptr_t getPointer(const Layout& layout, const unsigned char* data);
+}
+
+#endif
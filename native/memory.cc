@@ -1,20 +1,124 @@
-#include <windows.h>
-#include <TlHelp32.h>
+#include <cstring>
 #include <vector>
 #include "memory.h"
+#include "platform.h"
+#include "regionmap.h"
 
-memory::memory() {}
-memory::~memory() {}
+// SSE2 is part of every x64 target, 32-bit builds only use it when enabled
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MEMORY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+  const uintptr_t PAGE = 0x1000;
+  const size_t FIRST_STRING_READ = 64;
+  const size_t LAST_STRING_READ = 0x10000;
+
+  // Index of the first NUL character, `count` when there is none
+  size_t findTerminator(const char* characters, size_t count) {
+    const void* found = memchr(characters, '\0', count);
+    return found == nullptr ? count : (const char*) found - characters;
+  }
+
+  size_t findTerminator(const char16_t* characters, size_t count) {
+    size_t i = 0;
+
+#ifdef MEMORY_SSE2
+    const __m128i zero = _mm_setzero_si128();
 
-std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess) {
-  std::vector<MEMORY_BASIC_INFORMATION> regions;
+    for (; i + 8 <= count; i += 8) {
+      __m128i block = _mm_loadu_si128((const __m128i*) (characters + i));
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(block, zero));
 
-  MEMORY_BASIC_INFORMATION region;
-  DWORD64 address;
+      if (mask != 0) {
+        // each matching character sets two bits of the mask
+        for (int bit = 0; bit < 16; bit += 2) {
+          if (mask & (1 << bit)) {
+            return i + bit / 2;
+          }
+        }
+      }
+    }
+#endif
 
-  for (address = 0; VirtualQueryEx(hProcess, (LPVOID)address, &region, sizeof(region)) == sizeof(region); address += region.RegionSize) {
-    regions.push_back(region);
+    for (; i < count; i++) {
+      if (characters[i] == 0) {
+        return i;
+      }
+    }
+
+    return count;
   }
 
-  return regions;
-}
\ No newline at end of file
+  // Reads straight into the string, searching each read for the terminator as it comes in
+  template <class Char>
+  BOOL readTerminated(memory& reader, HANDLE hProcess, DWORD64 address, std::basic_string<Char>* pString, size_t maxLength) {
+    size_t length = 0;
+    size_t chunk = FIRST_STRING_READ;
+    // set once a read spanning pages failed, the rest is read a page at a time up to the unreadable one
+    bool pageByPage = false;
+
+    pString->clear();
+
+    while (length < maxLength) {
+      uintptr_t current = (uintptr_t) address + length * sizeof(Char);
+      uintptr_t end = current + chunk;
+
+      // reads stop at the last page boundary they cross, the pages before an unreadable one are
+      // read again one at a time, so a string ending just before an unreadable page still reads
+      uintptr_t boundary = end & ~(PAGE - 1);
+      if (boundary > current) {
+        end = boundary;
+      }
+
+      uintptr_t nextPage = (current & ~(PAGE - 1)) + PAGE;
+      if (pageByPage && end > nextPage) {
+        end = nextPage;
+      }
+
+      size_t count = (end - current) / sizeof(Char);
+      count = count == 0 ? 1 : count;
+      count = count < maxLength - length ? count : maxLength - length;
+
+      pString->resize(length + count);
+
+      if (!reader.readBuffer(hProcess, current, count * sizeof(Char), (const char*) &(*pString)[length])) {
+        if (!pageByPage && current + count * sizeof(Char) > nextPage) {
+          pageByPage = true;
+          continue;
+        }
+
+        pString->clear();
+        return FALSE;
+      }
+
+      size_t terminator = findTerminator(pString->data() + length, count);
+
+      if (terminator != count) {
+        pString->resize(length + terminator);
+        return TRUE;
+      }
+
+      length += count;
+      chunk = chunk * 2 < LAST_STRING_READ ? chunk * 2 : LAST_STRING_READ;
+    }
+
+    return TRUE;
+  }
+}
+
+memory::memory() {}
+memory::~memory() {}
+
+std::vector<MEMORY_BASIC_INFORMATION> memory::getRegions(HANDLE hProcess, std::vector<std::string>* names) {
+  return regionmap::getRegions(hProcess, names);
+}
+
+BOOL memory::readString(HANDLE hProcess, DWORD64 address, std::string* pString, size_t maxLength) {
+  return readTerminated(*this, hProcess, address, pString, maxLength);
+}
+
+BOOL memory::readString(HANDLE hProcess, DWORD64 address, std::u16string* pString, size_t maxLength) {
+  return readTerminated(*this, hProcess, address, pString, maxLength);
+}
@@ -1,73 +1,54 @@
 #pragma once
 #ifndef MEMORY_H
 #define MEMORY_H
-#define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-#include <TlHelp32.h>
+#include <cstdlib>
+#include <type_traits>
 #include <vector>
 #include <string>
+#include "platform.h"
+#include "pagecache.h"
 
 class memory {
 public:
+  static const size_t MAX_STRING_LENGTH = 0x100000;
+
   memory();
   ~memory();
-  std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE hProcess);
+  std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE hProcess, std::vector<std::string>* names = nullptr);
 
   template <class dataType>
   dataType readMemory(HANDLE hProcess, DWORD64 address) {
     dataType cRead;
-    ReadProcessMemory(hProcess, (LPVOID)address, &cRead, sizeof(dataType), NULL);
+    pagecache::read(hProcess, address, &cRead, sizeof(dataType));
     return cRead;
   }
 
   BOOL readBuffer(HANDLE hProcess, DWORD64 address, SIZE_T size, const char* dstBuffer) {
-    return ReadProcessMemory(hProcess, (LPVOID)address, (LPVOID)dstBuffer, size, NULL);
+    return pagecache::read(hProcess, address, (void*)dstBuffer, size);
+  }
+
+  // Reads every range with as few system calls as possible, bypassing the page cache
+  void readBuffers(HANDLE hProcess, const std::vector<platform::Read>& reads, std::vector<bool>* success) {
+    platform::readMemory(hProcess, reads, success);
   }
 
   char readChar(HANDLE hProcess, DWORD64 address) {
     char value;
-    ReadProcessMemory(hProcess, (LPVOID)address, &value, sizeof(char), NULL);
+    pagecache::read(hProcess, address, &value, sizeof(char));
     return value;
 	}
 
-  BOOL readString(HANDLE hProcess, DWORD64 address, std::string* pString) {
-    int length = 0;
-    int BATCH_SIZE = 256;
-    char* data = (char*) malloc(sizeof(char) * BATCH_SIZE);
-    while (length <= BATCH_SIZE * 4096) {
-      BOOL success = readBuffer(hProcess, address + length, BATCH_SIZE, data);
-
-      if (success == 0) {
-        free(data);
-        break;
-      }
-
-      for (const char* ptr = data; ptr - data < BATCH_SIZE; ++ptr) {
-        if (*ptr == '\0') {
-          length += ptr - data + 1;
-
-          char* buffer = (char*) malloc(length);
-          readBuffer(hProcess, address, length, buffer);
-
-          *pString = std::string(buffer);
-
-          free(data);
-          free(buffer);
-
-          return TRUE;
-        }
-      }
-
-      length += BATCH_SIZE;
-    }
-
-    return FALSE;
-  }
+  // Reads a NUL terminated string, UTF-8/ANSI or UTF-16, with reads growing from 64 bytes to
+  // 64 KiB that never cross into the next page once they reach it. Strings longer than
+  // `maxLength` characters are cut, unreadable memory before the terminator fails the read.
+  BOOL readString(HANDLE hProcess, DWORD64 address, std::string* pString, size_t maxLength = MAX_STRING_LENGTH);
+  BOOL readString(HANDLE hProcess, DWORD64 address, std::u16string* pString, size_t maxLength = MAX_STRING_LENGTH);
 
   template <class dataType>
   void writeMemory(HANDLE hProcess, DWORD64 address, dataType value) {
-    WriteProcessMemory(hProcess, (LPVOID)address, &value, sizeof(dataType), NULL);
+    platform::writeMemory(hProcess, address, &value, sizeof(dataType));
+    pagecache::invalidate(hProcess, address, sizeof(dataType));
   }
 
   template <class dataType>
@@ -80,7 +61,8 @@ public:
       buffer = &value; 
     }
 
-	  WriteProcessMemory(hProcess, (LPVOID)address, buffer, size, NULL);
+	  platform::writeMemory(hProcess, address, buffer, size);
+    pagecache::invalidate(hProcess, address, size);
   }
 
   // Write String, Method 1: Utf8Value is converted to string, get pointer and length from string
@@ -91,7 +73,8 @@ public:
 
   // Write String, Method 2: get pointer and length from Utf8Value directly
   void writeMemory(HANDLE hProcess, DWORD64 address, char* value, SIZE_T size) {
-    WriteProcessMemory(hProcess, (LPVOID)address, value, size, NULL);
+    platform::writeMemory(hProcess, address, value, size);
+    pagecache::invalidate(hProcess, address, size);
   }
 };
 #endif
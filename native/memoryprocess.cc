@@ -1,18 +1,39 @@
-#include <windows.h>
-#include <psapi.h>
 #include <napi.h>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include "platform.h"
 #include "module.h"
 #include "process.h"
+#include "registry.h"
 #include "memoryprocess.h"
 #include "memory.h"
+#include "datatypes.h"
 #include "pattern.h"
+#include "signature.h"
+#include "threadpool.h"
+#include "readplan.h"
+#include "layout.h"
+#include "columns.h"
+#include "pagecache.h"
+#include "regionmap.h"
+#include "valuescan.h"
+#include "pointerscan.h"
+#include "snapshot.h"
+#include "watcher.h"
+#include "debugpump.h"
+#include "worker.h"
+
+#ifdef _WIN32
 #include "functions.h"
 #include "dll.h"
 #include "debugger.h"
 
-#pragma comment(lib, "psapi.lib")
 #pragma comment(lib, "onecore.lib")
+#endif
 
 
 process Process;
@@ -29,6 +50,28 @@ struct Vector4 {
   float w, x, y, z;
 };
 
+static_assert(sizeof(Vector3) == datatype::getSize(datatype::T_VECTOR3), "Vector3 doesn't match its data type");
+static_assert(sizeof(Vector4) == datatype::getSize(datatype::T_VECTOR4), "Vector4 doesn't match its data type");
+
+// Data type passed as an id from `DataTypes` or as a name, T_COUNT when it isn't one
+datatype::Id getDataType(Napi::Value value) {
+  datatype::Id type = datatype::T_COUNT;
+
+  if (value.IsNumber()) {
+    uint32_t id = value.As<Napi::Number>().Uint32Value();
+    type = id < datatype::T_COUNT ? (datatype::Id) id : datatype::T_COUNT;
+  } else if (value.IsString()) {
+    datatype::fromName(value.As<Napi::String>().Utf8Value(), &type);
+  }
+
+  return type;
+}
+
+// Size of a fixed size data type passed as an id or a name, 0 for any other type
+size_t getDataTypeSize(Napi::Value value) {
+  return datatype::getSize(getDataType(value));
+}
+
 Napi::Value openProcess(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
@@ -107,7 +150,13 @@ Napi::Value openProcess(const Napi::CallbackInfo& args) {
 
 Napi::Value closeHandle(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
-  BOOL success = CloseHandle((HANDLE)args[0].As<Napi::Number>().Int64Value());
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  // handle values get reused, a later process must not see this one's pages
+  pagecache::disable(handle);
+  regionmap::invalidate(handle);
+
+  bool success = platform::closeProcess(handle);
   return Napi::Boolean::New(env, success);
 }
 
@@ -298,8 +347,8 @@ Napi::Value readMemory(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsString()) {
-    Napi::Error::New(env, "first and second argument must be a number, third argument must be a string").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsString() && !args[2].IsNumber()) {
+    Napi::Error::New(env, "first and second argument must be a number, third argument must be a string or a data type id").ThrowAsJavaScriptException();
     return env.Null();
   }
 
@@ -308,13 +357,12 @@ Napi::Value readMemory(const Napi::CallbackInfo& args) {
     return env.Null();
   }
 
-  std::string dataTypeArg(args[2].As<Napi::String>().Utf8Value());
-  const char* dataType = dataTypeArg.c_str();
-
   // Define the error message that will be set if no data type is recognised
   const char* errorMessage = "";
   Napi::Value retVal = env.Null();
 
+  datatype::Id type = getDataType(args[2]);
+
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
 
   DWORD64 address;
@@ -325,111 +373,229 @@ Napi::Value readMemory(const Napi::CallbackInfo& args) {
     address = args[1].As<Napi::Number>().Int64Value();
   }
 
-  if (!strcmp(dataType, "int8") || !strcmp(dataType, "byte") || !strcmp(dataType, "char")) {
+  switch (type) {
+    case datatype::T_INT8: {
+      int8_t result = Memory.readMemory<int8_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
+
+    case datatype::T_UINT8: {
+      uint8_t result = Memory.readMemory<uint8_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-    int8_t result = Memory.readMemory<int8_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_INT16: {
+      int16_t result = Memory.readMemory<int16_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-  } else if (!strcmp(dataType, "uint8") || !strcmp(dataType, "ubyte") || !strcmp(dataType, "uchar")) {
+    case datatype::T_UINT16: {
+      uint16_t result = Memory.readMemory<uint16_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-    uint8_t result = Memory.readMemory<uint8_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_INT32: {
+      int32_t result = Memory.readMemory<int32_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-  } else if (!strcmp(dataType, "int16") || !strcmp(dataType, "short")) {
+    case datatype::T_UINT32: {
+      uint32_t result = Memory.readMemory<uint32_t>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-    int16_t result = Memory.readMemory<int16_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_INT64: {
+      int64_t result = Memory.readMemory<int64_t>(handle, address);
+      retVal = Napi::Value::From(env, Napi::BigInt::New(env, result));
+      break;
+    }
 
-  } else if (!strcmp(dataType, "uint16") || !strcmp(dataType, "ushort") || !strcmp(dataType, "word")) {
+    case datatype::T_UINT64: {
+      uint64_t result = Memory.readMemory<uint64_t>(handle, address);
+      retVal = Napi::Value::From(env, Napi::BigInt::New(env, result));
+      break;
+    }
 
-    uint16_t result = Memory.readMemory<uint16_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_FLOAT: {
+      float result = Memory.readMemory<float>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-  } else if (!strcmp(dataType, "int32") || !strcmp(dataType, "int") || !strcmp(dataType, "long")) {
+    case datatype::T_DOUBLE: {
+      double result = Memory.readMemory<double>(handle, address);
+      retVal = Napi::Value::From(env, result);
+      break;
+    }
 
-    int32_t result = Memory.readMemory<int32_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_PTR: {
+      intptr_t result = Memory.readMemory<intptr_t>(handle, address);
 
-  } else if (!strcmp(dataType, "uint32") || !strcmp(dataType, "uint") || !strcmp(dataType, "ulong") || !strcmp(dataType, "dword")) {
+      if (sizeof(intptr_t) == 8) {
+        retVal = Napi::Value::From(env, Napi::BigInt::New(env, (int64_t) result));
+      } else {
+        retVal = Napi::Value::From(env, result);
+      }
+      break;
+    }
 
-    uint32_t result = Memory.readMemory<uint32_t>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_UPTR: {
+      uintptr_t result = Memory.readMemory<uintptr_t>(handle, address);
 
-  } else if (!strcmp(dataType, "int64")) {
+      if (sizeof(uintptr_t) == 8) {
+        retVal = Napi::Value::From(env, Napi::BigInt::New(env, (uint64_t) result));
+      } else {
+        retVal = Napi::Value::From(env, result);
+      }
+      break;
+    }
 
-    int64_t result = Memory.readMemory<int64_t>(handle, address);
-    retVal = Napi::Value::From(env, Napi::BigInt::New(env, result));
+    case datatype::T_BOOL: {
+      bool result = Memory.readMemory<bool>(handle, address);
+      retVal = Napi::Boolean::New(env, result);
+      break;
+    }
 
-  } else if (!strcmp(dataType, "uint64")) {
+    case datatype::T_STRING: {
+      std::string str;
+      if (!Memory.readString(handle, address, &str)) {
+        errorMessage = "unable to read string";
+      } else {
+        retVal = Napi::String::New(env, str);
+      }
+      break;
+    }
 
-    uint64_t result = Memory.readMemory<uint64_t>(handle, address);
-    retVal = Napi::Value::From(env, Napi::BigInt::New(env, result));
+    case datatype::T_WSTRING: {
+      std::u16string str;
+      if (!Memory.readString(handle, address, &str)) {
+        errorMessage = "unable to read string";
+      } else {
+        retVal = Napi::String::New(env, str);
+      }
+      break;
+    }
 
-  } else if (!strcmp(dataType, "float")) {
+    case datatype::T_VECTOR3: {
+      Vector3 result = Memory.readMemory<Vector3>(handle, address);
+      Napi::Object moduleInfo = Napi::Object::New(env);
+      moduleInfo.Set(Napi::String::New(env, "x"), Napi::Value::From(env, result.x));
+      moduleInfo.Set(Napi::String::New(env, "y"), Napi::Value::From(env, result.y));
+      moduleInfo.Set(Napi::String::New(env, "z"), Napi::Value::From(env, result.z));
+      retVal = moduleInfo;
+      break;
+    }
 
-    float result = Memory.readMemory<float>(handle, address);
-    retVal = Napi::Value::From(env, result);
+    case datatype::T_VECTOR4: {
+      Vector4 result = Memory.readMemory<Vector4>(handle, address);
+      Napi::Object moduleInfo = Napi::Object::New(env);
+      moduleInfo.Set(Napi::String::New(env, "w"), Napi::Value::From(env, result.w));
+      moduleInfo.Set(Napi::String::New(env, "x"), Napi::Value::From(env, result.x));
+      moduleInfo.Set(Napi::String::New(env, "y"), Napi::Value::From(env, result.y));
+      moduleInfo.Set(Napi::String::New(env, "z"), Napi::Value::From(env, result.z));
+      retVal = moduleInfo;
+      break;
+    }
 
-  } else if (!strcmp(dataType, "double")) {
+    default:
+      errorMessage = "unexpected data type";
+      break;
+  }
 
-    double result = Memory.readMemory<double>(handle, address);
-    retVal = Napi::Value::From(env, result);
+  if (strcmp(errorMessage, "") && args.Length() != 4) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  } else if (!strcmp(dataType, "ptr") || !strcmp(dataType, "pointer")) {
+  if (args.Length() == 4) {
+    Napi::Function callback = args[3].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), retVal });
+    return env.Null();
+  } else {
+    return retVal;
+  }
+}
 
-    intptr_t result = Memory.readMemory<intptr_t>(handle, address);
+Napi::Value readString(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-    if (sizeof(intptr_t) == 8) {
-      retVal = Napi::Value::From(env, Napi::BigInt::New(env, (int64_t) result));
-    } else {
-      retVal = Napi::Value::From(env, result);
-    }
+  if (args.Length() < 2 || args.Length() > 4) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with options, or 4 arguments if a callback is being used").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  } else if (!strcmp(dataType, "uptr") || !strcmp(dataType, "upointer")) {
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt())) {
+    Napi::Error::New(env, "first argument must be a number, second argument must be a number or a BigInt").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    uintptr_t result = Memory.readMemory<uintptr_t>(handle, address);
+  if (args.Length() >= 3 && !args[2].IsObject() && !args[2].IsUndefined() && !args[2].IsNull()) {
+    Napi::Error::New(env, "third argument must be an object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    if (sizeof(uintptr_t) == 8) {
-      retVal = Napi::Value::From(env, Napi::BigInt::New(env, (uint64_t) result));
-    } else {
-      retVal = Napi::Value::From(env, result);
-    }
+  if (args.Length() == 4 && !args[3].IsFunction()) {
+    Napi::Error::New(env, "fourth argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
 
-  } else if (!strcmp(dataType, "bool") || !strcmp(dataType, "boolean")) {
+  DWORD64 address;
+  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
 
-    bool result = Memory.readMemory<bool>(handle, address);
-    retVal = Napi::Boolean::New(env, result);
+  size_t maxLength = memory::MAX_STRING_LENGTH;
+  bool utf16 = false;
 
-  } else if (!strcmp(dataType, "string") || !strcmp(dataType, "str")) {
+  if (args.Length() >= 3 && args[2].IsObject()) {
+    Napi::Object options = args[2].As<Napi::Object>();
+    Napi::Value length = options.Get("maxLength");
+    Napi::Value encoding = options.Get("encoding");
 
-    std::string str;
-    if (!Memory.readString(handle, address, &str)) {
-      errorMessage = "unable to read string";
-    } else {
-      retVal = Napi::String::New(env, str);
+    if (length.IsNumber()) {
+      maxLength = (size_t) length.As<Napi::Number>().Int64Value();
     }
 
-  } else if (!strcmp(dataType, "vector3") || !strcmp(dataType, "vec3")) {
+    if (encoding.IsString()) {
+      std::string name(encoding.As<Napi::String>().Utf8Value());
 
-    Vector3 result = Memory.readMemory<Vector3>(handle, address);
-    Napi::Object moduleInfo = Napi::Object::New(env);
-    moduleInfo.Set(Napi::String::New(env, "x"), Napi::Value::From(env, result.x));
-    moduleInfo.Set(Napi::String::New(env, "y"), Napi::Value::From(env, result.y));
-    moduleInfo.Set(Napi::String::New(env, "z"), Napi::Value::From(env, result.z));
-    retVal = moduleInfo;
-
-  } else if (!strcmp(dataType, "vector4") || !strcmp(dataType, "vec4")) {
+      if (name == "utf16" || name == "utf16le" || name == "ucs2") {
+        utf16 = true;
+      } else if (name != "utf8" && name != "ascii") {
+        Napi::Error::New(env, "encoding must be 'utf8' or 'utf16'").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+  }
 
-    Vector4 result = Memory.readMemory<Vector4>(handle, address);
-    Napi::Object moduleInfo = Napi::Object::New(env);
-    moduleInfo.Set(Napi::String::New(env, "w"), Napi::Value::From(env, result.w));
-    moduleInfo.Set(Napi::String::New(env, "x"), Napi::Value::From(env, result.x));
-    moduleInfo.Set(Napi::String::New(env, "y"), Napi::Value::From(env, result.y));
-    moduleInfo.Set(Napi::String::New(env, "z"), Napi::Value::From(env, result.z));
-    retVal = moduleInfo;
+  const char* errorMessage = "";
+  Napi::Value retVal = env.Null();
 
+  if (utf16) {
+    std::u16string str;
+    if (!Memory.readString(handle, address, &str, maxLength)) {
+      errorMessage = "unable to read string";
+    } else {
+      retVal = Napi::String::New(env, str);
+    }
   } else {
-    errorMessage = "unexpected data type";
+    std::string str;
+    if (!Memory.readString(handle, address, &str, maxLength)) {
+      errorMessage = "unable to read string";
+    } else {
+      retVal = Napi::String::New(env, str);
+    }
   }
 
   if (strcmp(errorMessage, "") && args.Length() != 4) {
@@ -446,6 +612,9 @@ Napi::Value readMemory(const Napi::CallbackInfo& args) {
   }
 }
 
+// Fresh reads at least this large are backed by memory outside of the JavaScript heap
+static const SIZE_T EXTERNAL_BUFFER_SIZE = 0x100000;
+
 Napi::Value readBuffer(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
@@ -476,20 +645,28 @@ Napi::Value readBuffer(const Napi::CallbackInfo& args) {
 
   SIZE_T size = args[2].As<Napi::Number>().Int64Value();
 
-  // To fix the memory leak problem that was happening here, we need to release the
-  // temporary buffer we create after we're done creating a Napi::Buffer from it.
-  // Napi::Buffer::New doesn't free the memory, so it has be done manually
-  // but it can segfault when the memory is freed before being accessed.
-  // The solution is to use Napi::Buffer::Copy, and then we can manually free it.
-  //
-  // see: https://github.com/nodejs/node/issues/40936
-  // see: https://sagivo.com/2015/09/30/Go-Native-Calling-C-From-NodeJS.html
-  char* data = (char*) malloc(sizeof(char) * size);
-  Memory.readBuffer(handle, address, size, data);
-
-  Napi::Buffer<char> buffer = Napi::Buffer<char>::Copy(env, data, size);
-  free(data);
-  
+  // Read straight into the memory backing the returned buffer, no temporary copy is made.
+  // Large reads are backed by memory allocated outside of the JavaScript heap, which is
+  // handed over to the buffer and freed when it is garbage collected.
+  Napi::Buffer<char> buffer;
+
+  if (size >= EXTERNAL_BUFFER_SIZE) {
+    char* data = (char*) malloc(size);
+
+    if (data == nullptr) {
+      Napi::Error::New(env, "unable to allocate the buffer").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    Memory.readBuffer(handle, address, size, data);
+    buffer = Napi::Buffer<char>::New(env, data, size, [](Napi::Env, char* data) {
+      free(data);
+    });
+  } else {
+    buffer = Napi::Buffer<char>::New(env, size);
+    Memory.readBuffer(handle, address, size, buffer.Data());
+  }
+
   if (args.Length() == 4) {
     Napi::Function callback = args[3].As<Napi::Function>();
     callback.Call(env.Global(), { Napi::String::New(env, ""), buffer });
@@ -499,1077 +676,4124 @@ Napi::Value readBuffer(const Napi::CallbackInfo& args) {
   }
 }
 
-Napi::Value writeMemory(const Napi::CallbackInfo& args) {
+// Resolves the memory behind an ArrayBuffer, a Buffer, a typed array or a DataView
+bool getBytes(Napi::Value value, unsigned char** data, size_t* length) {
+  if (value.IsArrayBuffer()) {
+    *data = (unsigned char*) value.As<Napi::ArrayBuffer>().Data();
+    *length = value.As<Napi::ArrayBuffer>().ByteLength();
+    return true;
+  }
+
+  if (value.IsTypedArray()) {
+    Napi::TypedArray array = value.As<Napi::TypedArray>();
+    *data = (unsigned char*) array.ArrayBuffer().Data() + array.ByteOffset();
+    *length = array.ByteLength();
+    return true;
+  }
+
+  if (value.IsDataView()) {
+    Napi::DataView view = value.As<Napi::DataView>();
+    *data = (unsigned char*) view.ArrayBuffer().Data() + view.ByteOffset();
+    *length = view.ByteLength();
+    return true;
+  }
+
+  return false;
+}
+
+Napi::Value readBufferInto(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 4) {
-    Napi::Error::New(env, "requires 4 arguments").ThrowAsJavaScriptException();
+  if (args.Length() < 3 || args.Length() > 6) {
+    Napi::Error::New(env, "requires 3 to 5 arguments, 6 with callback").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[3].IsString()) {
-    Napi::Error::New(env, "first and second argument must be a number, third argument must be a string").ThrowAsJavaScriptException();
+  bool hasCallback = args[args.Length() - 1].IsFunction();
+  size_t count = hasCallback ? args.Length() - 1 : args.Length();
+
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt())) {
+    Napi::Error::New(env, "first and second arguments must be a number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  std::string dataTypeArg(args[3].As<Napi::String>().Utf8Value());
-  const char* dataType = dataTypeArg.c_str();
+  if ((count > 3 && !args[3].IsNumber()) || (count > 4 && !args[4].IsNumber())) {
+    Napi::Error::New(env, "offset and length arguments must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
 
   DWORD64 address;
-  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+  if (args[1].IsBigInt()) {
     bool lossless;
     address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
   } else {
     address = args[1].As<Napi::Number>().Int64Value();
   }
 
-  if (!strcmp(dataType, "int8") || !strcmp(dataType, "byte") || !strcmp(dataType, "char")) {
+  unsigned char* target;
+  size_t targetLength;
 
-    Memory.writeMemory<int8_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+  if (!getBytes(args[2], &target, &targetLength)) {
+    Napi::Error::New(env, "third argument must be an ArrayBuffer, a Buffer or a typed array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  } else if (!strcmp(dataType, "uint8") || !strcmp(dataType, "ubyte") || !strcmp(dataType, "uchar")) {
+  // by default the read fills the target from `offset` to its end
+  size_t offset = count > 3 ? (size_t) args[3].As<Napi::Number>().Int64Value() : 0;
+  size_t length = count > 4 ? (size_t) args[4].As<Napi::Number>().Int64Value() : (offset < targetLength ? targetLength - offset : 0);
 
-    Memory.writeMemory<uint8_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+  if (offset > targetLength || length > targetLength - offset) {
+    Napi::Error::New(env, "offset and length must lie inside the target").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  } else if (!strcmp(dataType, "int16") || !strcmp(dataType, "short")) {
+  const char* errorMessage = "";
 
-    Memory.writeMemory<int16_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+  if (length != 0 && !Memory.readBuffer(handle, address, length, (const char*) (target + offset))) {
+    errorMessage = "unable to read memory";
+  }
 
-  } else if (!strcmp(dataType, "uint16") || !strcmp(dataType, "ushort") || !strcmp(dataType, "word")) {
+  if (hasCallback) {
+    Napi::Function callback = args[args.Length() - 1].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Boolean::New(env, !strcmp(errorMessage, "")) });
+    return env.Null();
+  } else {
+    return Napi::Boolean::New(env, !strcmp(errorMessage, ""));
+  }
+}
 
-    Memory.writeMemory<uint16_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+Napi::Value readMemoryBatch(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-  } else if (!strcmp(dataType, "int32") || !strcmp(dataType, "int") || !strcmp(dataType, "long")) {
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, or 3 arguments if a callback is being used").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    Memory.writeMemory<int32_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+  if (!args[0].IsNumber() || !args[1].IsArray()) {
+    Napi::Error::New(env, "first argument must be a number, second argument must be an array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  } else if (!strcmp(dataType, "uint32") || !strcmp(dataType, "uint") || !strcmp(dataType, "ulong") || !strcmp(dataType, "dword")) {
+  if (args.Length() == 3 && !args[2].IsFunction()) {
+    Napi::Error::New(env, "third argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    Memory.writeMemory<uint32_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  Napi::Array requests = args[1].As<Napi::Array>();
 
-  } else if (!strcmp(dataType, "int64")) {
+  Napi::String addressKey = Napi::String::New(env, "address");
+  Napi::String typeKey = Napi::String::New(env, "type");
 
-    if (args[2].As<Napi::BigInt>().IsBigInt()) {
-      bool lossless;
-      Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::BigInt>().Int64Value(&lossless));
-    } else {
-      Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::Number>().Int64Value());
-    }
+  // values are packed in request order, each aligned to its own size (vectors to their components)
+  std::vector<platform::Read> reads(requests.Length());
+  std::vector<size_t> offsets(requests.Length());
+  size_t size = 0;
 
-  } else if (!strcmp(dataType, "uint64")) {
+  for (uint32_t i = 0; i < requests.Length(); i++) {
+    Napi::Value requestArg = requests.Get(i);
 
-    if (args[2].As<Napi::BigInt>().IsBigInt()) {
-      bool lossless;
-      Memory.writeMemory<int64_t>(handle, address,  args[2].As<Napi::BigInt>().Uint64Value(&lossless));
-    } else {
-      Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::Number>().Int64Value());
+    if (!requestArg.IsObject()) {
+      Napi::Error::New(env, "requests must be objects of { address: number | bigint, type: string | number }").ThrowAsJavaScriptException();
+      return env.Null();
     }
 
-  } else if (!strcmp(dataType, "float")) {
-
-    Memory.writeMemory<float>(handle, address, args[2].As<Napi::Number>().FloatValue());
+    Napi::Object request = requestArg.As<Napi::Object>();
+    Napi::Value addressArg = request.Get(addressKey);
 
-  } else if (!strcmp(dataType, "double")) {
-
-    Memory.writeMemory<double>(handle, address, args[2].As<Napi::Number>().DoubleValue());
-
-  } else if (!strcmp(dataType, "ptr") || !strcmp(dataType, "pointer")) {
-
-    Napi::BigInt valueBigInt = args[2].As<Napi::BigInt>();
-
-    if (sizeof(intptr_t) == 8 && !valueBigInt.IsBigInt()) {
-      std::string error = "Writing 'ptr' or 'pointer' on 64 bit target build requires you to supply a BigInt.";
-      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    if (!addressArg.IsNumber() && !addressArg.IsBigInt()) {
+      Napi::Error::New(env, "requests must be objects of { address: number | bigint, type: string | number }").ThrowAsJavaScriptException();
       return env.Null();
     }
 
-    if (valueBigInt.IsBigInt()) {
+    DWORD64 address;
+    if (addressArg.IsBigInt()) {
       bool lossless;
-      Memory.writeMemory<intptr_t>(handle, address, valueBigInt.Int64Value(&lossless));
+      address = addressArg.As<Napi::BigInt>().Uint64Value(&lossless);
     } else {
-      Memory.writeMemory<intptr_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+      address = addressArg.As<Napi::Number>().Int64Value();
     }
 
-  } else if (!strcmp(dataType, "uptr") || !strcmp(dataType, "upointer")) {
+    size_t dataTypeSize = getDataTypeSize(request.Get(typeKey));
 
-    Napi::BigInt valueBigInt = args[2].As<Napi::BigInt>();
-
-    if (sizeof(uintptr_t) == 8 && !valueBigInt.IsBigInt()) {
-      std::string error = "Writing 'ptr' or 'pointer' on 64 bit target build requires you to supply a BigInt.";
-      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    if (dataTypeSize == 0) {
+      Napi::Error::New(env, "unexpected data type, only fixed size types can be read in a batch").ThrowAsJavaScriptException();
       return env.Null();
     }
 
-    if (valueBigInt.IsBigInt()) {
-      bool lossless;
-      Memory.writeMemory<uintptr_t>(handle, address, valueBigInt.Uint64Value(&lossless));
-    } else {
-      Memory.writeMemory<uintptr_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
-    }
-
-  } else if (!strcmp(dataType, "bool") || !strcmp(dataType, "boolean")) {
-
-    Memory.writeMemory<bool>(handle, address, args[2].As<Napi::Boolean>().Value());
-
-  } else if (!strcmp(dataType, "string") || !strcmp(dataType, "str")) {
-
-    std::string valueParam(args[2].As<Napi::String>().Utf8Value());
-    valueParam.append("", 1);
+    size_t alignment = dataTypeSize > sizeof(double) ? sizeof(float) : dataTypeSize;
+    size = (size + alignment - 1) / alignment * alignment;
 
-    // Write String, Method 1
-    //Memory.writeMemory<std::string>(handle, address, std::string(*valueParam));
+    reads[i] = { (uintptr_t) address, nullptr, dataTypeSize };
+    offsets[i] = size;
+    size += dataTypeSize;
+  }
 
-    // Write String, Method 2
-    Memory.writeMemory(handle, address, (char*) valueParam.data(), valueParam.size());
+  // a status byte per request follows the values, like the status bytes of read plans
+  size_t statusOffset = size;
+  size += reads.size();
 
-  } else if (!strcmp(dataType, "vector3") || !strcmp(dataType, "vec3")) {
+  Napi::Buffer<char> buffer = Napi::Buffer<char>::New(env, size);
+  memset(buffer.Data(), 0, size);
 
-    Napi::Object value = args[2].As<Napi::Object>();
-    Vector3 vector = {
-      value.Get(Napi::String::New(env, "x")).As<Napi::Number>().FloatValue(),
-      value.Get(Napi::String::New(env, "y")).As<Napi::Number>().FloatValue(),
-      value.Get(Napi::String::New(env, "z")).As<Napi::Number>().FloatValue()
-    };
-    Memory.writeMemory<Vector3>(handle, address, vector);
+  // the layout is handed along so it doesn't have to be worked out again in JavaScript
+  Napi::Uint32Array offsetsArray = Napi::Uint32Array::New(env, reads.size());
 
-  } else if (!strcmp(dataType, "vector4") || !strcmp(dataType, "vec4")) {
+  for (std::vector<platform::Read>::size_type i = 0; i != reads.size(); i++) {
+    reads[i].buffer = buffer.Data() + offsets[i];
+    offsetsArray[i] = (uint32_t) offsets[i];
+  }
 
-    Napi::Object value = args[2].As<Napi::Object>();
-    Vector4 vector = {
-      value.Get(Napi::String::New(env, "w")).As<Napi::Number>().FloatValue(),
-      value.Get(Napi::String::New(env, "x")).As<Napi::Number>().FloatValue(),
-      value.Get(Napi::String::New(env, "y")).As<Napi::Number>().FloatValue(),
-      value.Get(Napi::String::New(env, "z")).As<Napi::Number>().FloatValue()
-    };
-    Memory.writeMemory<Vector4>(handle, address, vector);
+  // values that couldn't be read are left zeroed, their status byte tells them from zeros
+  std::vector<bool> success;
+  Memory.readBuffers(handle, reads, &success);
 
-  } else {
-    Napi::Error::New(env, "unexpected data type").ThrowAsJavaScriptException();
+  for (std::vector<bool>::size_type i = 0; i != success.size() && i != reads.size(); i++) {
+    buffer.Data()[statusOffset + i] = success[i] ? 1 : 0;
   }
 
-  return env.Null();
-}
-
-Napi::Value writeBuffer(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+  buffer.Set(Napi::String::New(env, "offsets"), offsetsArray);
+  buffer.Set(Napi::String::New(env, "statusOffset"), Napi::Value::From(env, statusOffset));
 
-  if (args.Length() != 3) {
-    Napi::Error::New(env, "required 3 arguments").ThrowAsJavaScriptException();
+  if (args.Length() == 3) {
+    Napi::Function callback = args[2].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, ""), buffer });
     return env.Null();
+  } else {
+    return buffer;
   }
+}
 
-  if (!args[0].IsNumber() && !args[1].IsNumber()) {
-    Napi::Error::New(env, "first and second argument must be a number").ThrowAsJavaScriptException();
-    return env.Null();
+// Value of a fixed size data type stored at `data`
+Napi::Value toDataValue(Napi::Env env, datatype::Id type, const unsigned char* data) {
+  switch (type) {
+    case datatype::T_INT8: { int8_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_UINT8: { uint8_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_INT16: { int16_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_UINT16: { uint16_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_INT32: { int32_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_UINT32: { uint32_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_INT64: { int64_t value; memcpy(&value, data, sizeof(value)); return Napi::BigInt::New(env, value); }
+    case datatype::T_UINT64: { uint64_t value; memcpy(&value, data, sizeof(value)); return Napi::BigInt::New(env, value); }
+    case datatype::T_FLOAT: { float value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_DOUBLE: { double value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case datatype::T_BOOL: return Napi::Boolean::New(env, *data != 0);
+    case datatype::T_PTR: {
+      intptr_t value;
+      memcpy(&value, data, sizeof(value));
+      return sizeof(intptr_t) == 8 ? Napi::Value(Napi::BigInt::New(env, (int64_t) value)) : Napi::Value::From(env, value);
+    }
+    case datatype::T_UPTR: {
+      uintptr_t value;
+      memcpy(&value, data, sizeof(value));
+      return sizeof(uintptr_t) == 8 ? Napi::Value(Napi::BigInt::New(env, (uint64_t) value)) : Napi::Value::From(env, value);
+    }
+    case datatype::T_VECTOR3: {
+      Vector3 value;
+      memcpy(&value, data, sizeof(value));
+      Napi::Object vector = Napi::Object::New(env);
+      vector.Set(Napi::String::New(env, "x"), Napi::Value::From(env, value.x));
+      vector.Set(Napi::String::New(env, "y"), Napi::Value::From(env, value.y));
+      vector.Set(Napi::String::New(env, "z"), Napi::Value::From(env, value.z));
+      return vector;
+    }
+    case datatype::T_VECTOR4: {
+      Vector4 value;
+      memcpy(&value, data, sizeof(value));
+      Napi::Object vector = Napi::Object::New(env);
+      vector.Set(Napi::String::New(env, "w"), Napi::Value::From(env, value.w));
+      vector.Set(Napi::String::New(env, "x"), Napi::Value::From(env, value.x));
+      vector.Set(Napi::String::New(env, "y"), Napi::Value::From(env, value.y));
+      vector.Set(Napi::String::New(env, "z"), Napi::Value::From(env, value.z));
+      return vector;
+    }
+    default:
+      return env.Null();
   }
+}
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+// Tags externals created by `watch`
+static const napi_type_tag watchTypeTag = { 0xd3a81f5c06b7e294, 0x68c2e09b4f1a7d35 };
+
+// A watcher handed to JavaScript. The polling thread only queues a call to `callback`,
+// which takes every change waiting once it runs on the JavaScript thread.
+struct Watch {
+  std::unique_ptr<watcher::Watcher> watcher;
+  std::vector<datatype::Id> types;
+  Napi::ThreadSafeFunction callback;
+  // reused by every call so delivering doesn't allocate
+  watcher::Changes changes;
+  bool stopped = false;
+
+  void stop() {
+    if (stopped) {
+      return;
+    }
 
-  DWORD64 address;
-  if (args[1].As<Napi::BigInt>().IsBigInt()) {
-    bool lossless;
-    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
-  } else {
-    address = args[1].As<Napi::Number>().Int64Value();
+    stopped = true;
+    watcher->stop();
+    callback.Release();
   }
+};
 
-  SIZE_T length = args[2].As<Napi::Buffer<char>>().Length();
-  char* data = args[2].As<Napi::Buffer<char>>().Data();
-  Memory.writeMemory<char*>(handle, address, data, length);
-
-  return env.Null();
-}
-
-// Napi::Value findPattern(const Napi::CallbackInfo& args) {
-//   Napi::Env env = args.Env();
+// Calls the JavaScript callback of a watch with the indices of the values changed and their values
+void deliverChanges(Napi::Env env, Napi::Function callback, const std::weak_ptr<Watch>& weak) {
+  std::shared_ptr<Watch> watch = weak.lock();
 
-//   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-//   DWORD64 baseAddress = args[1].As<Napi::Number>().Int64Value();
-//   DWORD64 baseSize = args[2].As<Napi::Number>().Int64Value();
-//   std::string signature(args[3].As<Napi::String>().Utf8Value());
-//   short flags = args[4].As<Napi::Number>().Uint32Value();
-//   uint32_t patternOffset = args[5].As<Napi::Number>().Uint32Value();
+  if (env == nullptr || !watch || watch->stopped || !watch->watcher->take(&watch->changes)) {
+    return;
+  }
 
-//   // matching address
-//   uintptr_t address = 0;
-//   const char* errorMessage = "";
+  const watcher::Changes& changes = watch->changes;
+  Napi::Uint32Array indices = Napi::Uint32Array::New(env, changes.indices.size());
+  Napi::Array values = Napi::Array::New(env, changes.indices.size());
 
-//   // read memory region occupied by the module to pattern match inside
-//   std::vector<unsigned char> moduleBytes = std::vector<unsigned char>(baseSize);
-//   ReadProcessMemory(handle, (LPVOID)baseAddress, &moduleBytes[0], baseSize, nullptr);
-//   unsigned char* byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
+  memcpy(indices.Data(), changes.indices.data(), changes.indices.size() * sizeof(uint32_t));
 
-//   Pattern.findPattern(handle, baseAddress, byteBase, baseSize, signature.c_str(), flags, patternOffset, &address);
+  for (size_t i = 0, offset = 0; i < changes.indices.size(); i++) {
+    datatype::Id type = watch->types[changes.indices[i]];
 
-//   if (address == 0) {
-//     errorMessage = "unable to match pattern inside any modules or regions";
-//   }
+    values.Set(i, changes.readable[i] ? toDataValue(env, type, changes.values.data() + offset) : env.Null());
+    offset += datatype::getSize(type);
+  }
 
-//   if (args.Length() == 5) {
-//     Napi::Function callback = args[4].As<Napi::Function>();
-//     callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
-//     return env.Null();
-//   } else {
-//     return Napi::Value::From(env, address);
-//   }
-// }
+  callback.Call(env.Global(), { indices, values });
+}
 
-Napi::Value findPattern(const Napi::CallbackInfo& args) {
+Napi::Value watch(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 4 && args.Length() != 5) {
-    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 4) {
+    Napi::Error::New(env, "requires 4 arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsString() || !args[2].IsNumber() || !args[3].IsNumber()) {
-    Napi::Error::New(env, "expected: number, string, string, number").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || !args[1].IsArray() || !args[2].IsNumber() || !args[3].IsFunction()) {
+    Napi::Error::New(env, "expected: number, array, number, function").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 5 && !args[4].IsFunction()) {
-    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  Napi::Array requests = args[1].As<Napi::Array>();
+  uint32_t interval = args[2].As<Napi::Number>().Uint32Value();
+
+  if (interval == 0) {
+    Napi::Error::New(env, "the interval must be at least 1 millisecond").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  std::string pattern(args[1].As<Napi::String>().Utf8Value());
-  short flags = args[2].As<Napi::Number>().Uint32Value();
-  uint32_t patternOffset = args[3].As<Napi::Number>().Uint32Value();
+  Napi::String addressKey = Napi::String::New(env, "address");
+  Napi::String typeKey = Napi::String::New(env, "type");
 
-  // matching address
-  uintptr_t address = 0;
-  const char* errorMessage = "";
+  std::shared_ptr<Watch> watch = std::make_shared<Watch>();
+  std::vector<watcher::Entry> entries(requests.Length());
 
-  std::vector<MODULEENTRY32> modules = module::getModules(GetProcessId(handle), &errorMessage);
-  Pattern.search(handle, modules, 0, pattern.c_str(), flags, patternOffset, &address);
+  for (uint32_t i = 0; i < requests.Length(); i++) {
+    Napi::Value request = requests.Get(i);
 
-  // if no match found inside any modules, search memory regions
-  if (address == 0) {
-    std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
-    Pattern.search(handle, regions, 0, pattern.c_str(), flags, patternOffset, &address);
-  }
+    if (!request.IsObject()) {
+      Napi::Error::New(env, "watched values must be objects with an address and a type").ThrowAsJavaScriptException();
+      return env.Null();
+    }
 
-  if (address == 0) {
-    errorMessage = "unable to match pattern inside any modules or regions";
-  }
+    Napi::Value addressArg = request.As<Napi::Object>().Get(addressKey);
+    datatype::Id type = getDataType(request.As<Napi::Object>().Get(typeKey));
 
-  if (args.Length() == 5) {
-    Napi::Function callback = args[4].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
-    return env.Null();
-  } else {
-    return Napi::Value::From(env, address);
+    DWORD64 address;
+    if (addressArg.IsBigInt()) {
+      bool lossless;
+      address = addressArg.As<Napi::BigInt>().Uint64Value(&lossless);
+    } else {
+      address = addressArg.As<Napi::Number>().Int64Value();
+    }
+
+    if (datatype::getSize(type) == 0) {
+      Napi::Error::New(env, "unexpected data type, only fixed size types can be watched").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    entries[i] = { (uintptr_t) address, datatype::getSize(type) };
+    watch->types.push_back(type);
   }
+
+  Napi::ThreadSafeFunction callback = Napi::ThreadSafeFunction::New(env, args[3].As<Napi::Function>(), "watch", 0, 1);
+  std::weak_ptr<Watch> weak = watch;
+
+  watch->callback = callback;
+  watch->watcher.reset(new watcher::Watcher(handle, entries, interval, [callback, weak]() {
+    callback.NonBlockingCall([weak](Napi::Env env, Napi::Function function) {
+      deliverChanges(env, function, weak);
+    });
+  }));
+
+  std::shared_ptr<Watch>* data = new std::shared_ptr<Watch>(watch);
+  Napi::External<std::shared_ptr<Watch>> result = Napi::External<std::shared_ptr<Watch>>::New(env, data, [](Napi::Env, std::shared_ptr<Watch>* data) {
+    (*data)->stop();
+    delete data;
+  });
+  result.TypeTag(&watchTypeTag);
+
+  return result;
 }
 
-Napi::Value findPatternByModule(const Napi::CallbackInfo& args) {
+Napi::Value unwatch(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 5 && args.Length() != 6) {
-    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 1 || !args[0].IsExternal() || !args[0].As<Napi::External<std::shared_ptr<Watch>>>().CheckTypeTag(&watchTypeTag)) {
+    Napi::Error::New(env, "requires 1 argument, which must be a watch").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsString() || !args[2].IsString() || !args[3].IsNumber() || !args[4].IsNumber()) {
-    Napi::Error::New(env, "expected: number, string, string, number, number").ThrowAsJavaScriptException();
+  (*args[0].As<Napi::External<std::shared_ptr<Watch>>>().Data())->stop();
+  return env.Null();
+}
+
+// Tags externals created by `compileReadPlan`
+static const napi_type_tag readPlanTypeTag = { 0x2c8e61f4a9d05b37, 0xb41f7d20c6e9a853 };
+
+Napi::Value compileReadPlan(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    Napi::Error::New(env, "requires 1 argument, or 2 arguments with a pointer size").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 6 && !args[5].IsFunction()) {
-    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+  if (!args[0].IsArray() || (args.Length() == 2 && !args[1].IsNumber())) {
+    Napi::Error::New(env, "first argument must be an array, second argument must be a number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
-  std::string pattern(args[2].As<Napi::String>().Utf8Value());
-  short flags = args[3].As<Napi::Number>().Uint32Value();
-  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
+  Napi::Array chainsArg = args[0].As<Napi::Array>();
+  size_t pointerSize = args.Length() == 2 ? args[1].As<Napi::Number>().Uint32Value() : sizeof(uintptr_t);
 
-  // matching address
-  uintptr_t address = 0;
-  const char* errorMessage = "";
+  std::vector<readplan::Chain> chains(chainsArg.Length());
+
+  for (uint32_t i = 0; i < chainsArg.Length(); i++) {
+    Napi::Value chainValue = chainsArg.Get(i);
 
-  MODULEENTRY32 module = module::findModule(moduleName.c_str(), GetProcessId(handle), &errorMessage);
+    if (!chainValue.IsObject()) {
+      Napi::Error::New(env, "chains must be objects of { base: number, offsets: number[], type: string | number }").ThrowAsJavaScriptException();
+      return env.Null();
+    }
 
-  uintptr_t baseAddress = (uintptr_t) module.modBaseAddr;
-  DWORD baseSize = module.modBaseSize;
+    Napi::Object chainArg = chainValue.As<Napi::Object>();
+    Napi::Value base = chainArg.Get("base");
+    Napi::Value offsets = chainArg.Get("offsets");
+    Napi::Value type = chainArg.Get("type");
 
-  // read memory region occupied by the module to pattern match inside
-  std::vector<unsigned char> moduleBytes = std::vector<unsigned char>(baseSize);
-  ReadProcessMemory(handle, (LPVOID)baseAddress, &moduleBytes[0], baseSize, nullptr);
-  unsigned char* byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
+    if ((!base.IsNumber() && !base.IsBigInt()) || (!offsets.IsArray() && !offsets.IsUndefined()) || (!type.IsString() && !type.IsNumber())) {
+      Napi::Error::New(env, "chains must be objects of { base: number, offsets: number[], type: string | number }").ThrowAsJavaScriptException();
+      return env.Null();
+    }
 
-  Pattern.findPattern(handle, baseAddress, byteBase, baseSize, pattern.c_str(), flags, patternOffset, &address);
+    if (base.IsBigInt()) {
+      bool lossless;
+      chains[i].base = (uintptr_t) base.As<Napi::BigInt>().Uint64Value(&lossless);
+    } else {
+      chains[i].base = (uintptr_t) base.As<Napi::Number>().Int64Value();
+    }
 
-  if (address == 0) {
-    errorMessage = "unable to match pattern inside any modules or regions";
+    if (offsets.IsArray()) {
+      Napi::Array offsetsArray = offsets.As<Napi::Array>();
+
+      for (uint32_t j = 0; j < offsetsArray.Length(); j++) {
+        chains[i].offsets.push_back(offsetsArray.Get(j).As<Napi::Number>().Int64Value());
+      }
+    }
+
+    chains[i].size = getDataTypeSize(type);
   }
 
-  if (args.Length() == 6) {
-    Napi::Function callback = args[5].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
+  const char* errorMessage = "";
+  readplan::Plan* plan = new readplan::Plan();
+
+  if (!readplan::compile(chains, pointerSize, plan, &errorMessage)) {
+    delete plan;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
-  } else {
-    return Napi::Value::From(env, address);
   }
+
+  Napi::External<readplan::Plan> compiled = Napi::External<readplan::Plan>::New(env, plan, [](Napi::Env, readplan::Plan* data) {
+    delete data;
+  });
+  compiled.TypeTag(&readPlanTypeTag);
+
+  // the layout is handed over once so executing the plan doesn't have to create any value
+  Napi::Array offsets = Napi::Array::New(env, plan->offsets.size());
+
+  for (std::vector<size_t>::size_type i = 0; i != plan->offsets.size(); i++) {
+    offsets.Set(i, Napi::Value::From(env, plan->offsets[i]));
+  }
+
+  Napi::Object info = Napi::Object::New(env);
+  info.Set(Napi::String::New(env, "compiled"), compiled);
+  info.Set(Napi::String::New(env, "byteLength"), Napi::Value::From(env, plan->size));
+  info.Set(Napi::String::New(env, "offsets"), offsets);
+  info.Set(Napi::String::New(env, "statusOffset"), Napi::Value::From(env, plan->statusOffset));
+
+  return info;
 }
 
-Napi::Value findPatternByAddress(const Napi::CallbackInfo& args) {
+Napi::Value executeReadPlan(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 5 && args.Length() != 6) {
-    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 3) {
+    Napi::Error::New(env, "requires 3 arguments").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsNumber() || !args[2].IsString() || !args[3].IsNumber() || !args[4].IsNumber()) {
-    Napi::Error::New(env, "expected: number, number, string, number, number").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || !args[1].IsExternal() || !args[1].As<Napi::External<readplan::Plan>>().CheckTypeTag(&readPlanTypeTag)) {
+    Napi::Error::New(env, "first argument must be a number, second argument must be a compiled read plan").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 6 && !args[5].IsFunction()) {
-    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  readplan::Plan* plan = args[1].As<Napi::External<readplan::Plan>>().Data();
+
+  unsigned char* output;
+  size_t length;
+
+  if (!getBytes(args[2], &output, &length)) {
+    Napi::Error::New(env, "third argument must be an ArrayBuffer, a Buffer or a typed array").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-
-  DWORD64 baseAddress;
-  if (args[1].As<Napi::BigInt>().IsBigInt()) {
-    bool lossless;
-    baseAddress = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
-  } else {
-    baseAddress = args[1].As<Napi::Number>().Int64Value();
+  if (length < plan->size) {
+    Napi::Error::New(env, "target is smaller than the plan's byteLength").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  std::string pattern(args[2].As<Napi::String>().Utf8Value());
-  short flags = args[3].As<Napi::Number>().Uint32Value();
-  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
+  size_t read = readplan::execute(handle, *plan, output);
+  return Napi::Value::From(env, read);
+}
 
-  // matching address
-  uintptr_t address = 0;
-  const char* errorMessage = "";
+// Layout type of a data type name, the names being the ones `readMemory` takes plus "struct"
+bool getFieldType(const std::string& dataType, layout::Type* type) {
+  if (dataType == "struct") {
+    *type = layout::T_STRUCT;
+    return true;
+  }
+
+  datatype::Id id;
+
+  if (!datatype::fromName(dataType, &id)) {
+    return false;
+  }
+
+  switch (id) {
+    case datatype::T_INT8: *type = layout::T_INT8; return true;
+    case datatype::T_UINT8: *type = layout::T_UINT8; return true;
+    case datatype::T_INT16: *type = layout::T_INT16; return true;
+    case datatype::T_UINT16: *type = layout::T_UINT16; return true;
+    case datatype::T_INT32: *type = layout::T_INT32; return true;
+    case datatype::T_UINT32: *type = layout::T_UINT32; return true;
+    case datatype::T_INT64: *type = layout::T_INT64; return true;
+    case datatype::T_UINT64: *type = layout::T_UINT64; return true;
+    case datatype::T_FLOAT: *type = layout::T_FLOAT; return true;
+    case datatype::T_DOUBLE: *type = layout::T_DOUBLE; return true;
+    case datatype::T_BOOL: *type = layout::T_BOOL; return true;
+    case datatype::T_PTR: *type = layout::T_POINTER; return true;
+    case datatype::T_UPTR: *type = layout::T_POINTER; return true;
+    case datatype::T_VECTOR3: *type = layout::T_VECTOR3; return true;
+    case datatype::T_VECTOR4: *type = layout::T_VECTOR4; return true;
+    case datatype::T_STRING: *type = layout::T_STRING; return true;
+    // wide strings aren't stored in structs
+    default: return false;
+  }
+}
 
-  std::vector<MODULEENTRY32> modules = module::getModules(GetProcessId(handle), &errorMessage);
-  Pattern.search(handle, modules, baseAddress, pattern.c_str(), flags, patternOffset, &address);
+// Count and stride of an array of `size` byte items, a stride of 0 standing for `defaultStride`.
+// False when either is negative or the array spans more than a single read is allowed to copy.
+bool getArraySpan(const Napi::Value& countArg, const Napi::Value& strideArg, size_t defaultStride, size_t size, size_t* count, size_t* stride) {
+  int64_t countValue = countArg.As<Napi::Number>().Int64Value();
+  int64_t strideValue = strideArg.As<Napi::Number>().Int64Value();
 
-  if (address == 0) {
-    std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
-    Pattern.search(handle, regions, baseAddress, pattern.c_str(), flags, patternOffset, &address);
+  if (countValue < 0 || strideValue < 0 || (uint64_t) countValue > layout::MAX_SIZE || (uint64_t) strideValue > layout::MAX_SIZE) {
+    return false;
   }
 
-  if (address == 0) {
-    errorMessage = "unable to match pattern inside any modules or regions";
-  }
+  uint64_t step = strideValue == 0 ? defaultStride : (uint64_t) strideValue;
 
-  if (args.Length() == 6) {
-    Napi::Function callback = args[5].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
-    return env.Null();
-  } else {
-    return Napi::Value::From(env, address);
+  if (countValue > 0 && (uint64_t) (countValue - 1) * step + size > layout::MAX_SIZE) {
+    return false;
   }
+
+  *count = (size_t) countValue;
+  *stride = (size_t) step;
+  return true;
 }
 
-Napi::Value callFunction(const Napi::CallbackInfo& args) {
+// Property names of every registered layout, by layout id then field, created once
+// so decoding structs doesn't create a single string for them
+static std::vector<std::vector<Napi::Reference<Napi::String>>> structNames;
+
+Napi::Value registerStruct(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 4 && args.Length() != 5) {
-    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 1 && args.Length() != 2) {
+    Napi::Error::New(env, "requires 1 argument, 2 with options").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() && !args[1].IsObject() && !args[2].IsNumber() && !args[3].IsNumber()) {
-    Napi::Error::New(env, "invalid arguments").ThrowAsJavaScriptException();
+  if (!args[0].IsArray() || (args.Length() == 2 && !args[1].IsObject())) {
+    Napi::Error::New(env, "first argument must be an array, second argument must be an object").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // TODO: temp (?) solution to forcing variables onto the heap
-  // to ensure consistent addresses. copy everything to a vector, and use the
-  // vector's instances of the variables as the addresses being passed to `functions.call()`.
-  // Another solution: do `int x = new int(4)` and then use `&x` for the address
-  std::vector<LPVOID> heap;
-
-  std::vector<functions::Arg> parsedArgs;
-  Napi::Array arguments = args[1].As<Napi::Array>();
-  for (unsigned int i = 0; i < arguments.Length(); i++) {
-    Napi::Object argument = arguments.Get(i).As<Napi::Object>();
+  Napi::Array fieldsArg = args[0].As<Napi::Array>();
+  layout::Layout structLayout = { {}, 0, sizeof(uintptr_t) };
 
-    functions::Type type = (functions::Type) argument.Get(Napi::String::New(env, "type")).As<Napi::Number>().Uint32Value();
+  if (args.Length() == 2) {
+    Napi::Object options = args[1].As<Napi::Object>();
+    Napi::Value size = options.Get("size");
+    Napi::Value pointerSize = options.Get("pointerSize");
 
-    if (type == functions::Type::T_STRING) {
-      std::string stringValue = argument.Get(Napi::String::New(env, "value")).As<Napi::String>().Utf8Value();
-      parsedArgs.push_back({ type, &stringValue });
+    if (size.IsNumber() && size.As<Napi::Number>().Int64Value() < 0) {
+      Napi::Error::New(env, "the struct size can't be negative").ThrowAsJavaScriptException();
+      return env.Null();
     }
 
-    if (type == functions::Type::T_INT) {
-      int data = argument.Get(Napi::String::New(env, "value")).As<Napi::Number>().Int32Value();
-
-      // As we only pass the addresses of the variable to the `call` function and not a copy
-      // of the variable itself, we need to ensure that the variable stays alive and in a unique
-      // memory location until the `call` function has been executed. So manually allocate memory,
-      // track it, and then free it once the function has been called.
-      // TODO: find a better solution?
-      int* memory = (int*) malloc(sizeof(int));
-      *memory = data;
-      heap.push_back(memory);
+    if (size.IsNumber()) {
+      structLayout.size = (size_t) size.As<Napi::Number>().Int64Value();
+    }
 
-      parsedArgs.push_back({ type, memory });
+    if (pointerSize.IsNumber()) {
+      structLayout.pointerSize = pointerSize.As<Napi::Number>().Uint32Value();
     }
+  }
 
-    if (type == functions::Type::T_FLOAT) {
-      float data = argument.Get(Napi::String::New(env, "value")).As<Napi::Number>().FloatValue();
+  for (uint32_t i = 0; i < fieldsArg.Length(); i++) {
+    Napi::Object fieldArg = fieldsArg.Get(i).As<Napi::Object>();
+    Napi::Value name = fieldArg.Get("name");
+    Napi::Value offset = fieldArg.Get("offset");
+    Napi::Value type = fieldArg.Get("type");
+    Napi::Value length = fieldArg.Get("length");
+    Napi::Value id = fieldArg.Get("layout");
 
-      float* memory = (float*) malloc(sizeof(float));
-      *memory = data;
-      heap.push_back(memory);
+    layout::Field field = { "", 0, layout::T_INT8, 0, -1, nullptr };
 
-      parsedArgs.push_back({ type, memory });
+    if (!name.IsString() || !offset.IsNumber() || !type.IsString() || !getFieldType(type.As<Napi::String>().Utf8Value(), &field.type)) {
+      Napi::Error::New(env, "fields must be objects of { name: string, offset: number, type: string, length?: number, layout?: number }").ThrowAsJavaScriptException();
+      return env.Null();
     }
-  }
-
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  functions::Type returnType = (functions::Type) args[2].As<Napi::Number>().Uint32Value();
 
-  DWORD64 address;
-  if (args[3].As<Napi::BigInt>().IsBigInt()) {
-    bool lossless;
-    address = args[3].As<Napi::BigInt>().Uint64Value(&lossless);
-  } else {
-    address = args[3].As<Napi::Number>().Int64Value();
-  }
+    if (offset.As<Napi::Number>().Int64Value() < 0 || (length.IsNumber() && length.As<Napi::Number>().Int64Value() < 0)) {
+      Napi::Error::New(env, "field offsets and lengths can't be negative").ThrowAsJavaScriptException();
+      return env.Null();
+    }
 
-  const char* errorMessage = "";
-  Call data = functions::call<int>(handle, parsedArgs, returnType, address, &errorMessage);
+    field.name = name.As<Napi::String>().Utf8Value();
+    field.offset = (size_t) offset.As<Napi::Number>().Int64Value();
+    field.length = length.IsNumber() ? (size_t) length.As<Napi::Number>().Int64Value() : 0;
+    field.layout = id.IsNumber() ? id.As<Napi::Number>().Int32Value() : -1;
 
-  // Free all the memory we allocated
-  for (auto &memory : heap) {
-    free(memory);
+    structLayout.fields.push_back(field);
   }
 
-  heap.clear();
+  const char* errorMessage = "";
+  int id = layout::add(structLayout, &errorMessage);
 
-  if (strcmp(errorMessage, "") && args.Length() != 5) {
+  if (id < 0) {
     Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  Napi::Object info = Napi::Object::New(env);
-
-  Napi::String keyString = Napi::String::New(env, "returnValue");
+  std::vector<Napi::Reference<Napi::String>> names;
 
-  if (returnType == functions::Type::T_STRING) {
-    info.Set(keyString, Napi::String::New(env, data.returnString.c_str()));
+  for (const layout::Field& field : structLayout.fields) {
+    names.push_back(Napi::Persistent(Napi::String::New(env, field.name)));
+    names.back().SuppressDestruct();
   }
 
-  if (returnType == functions::Type::T_CHAR) {
-    info.Set(keyString, Napi::Value::From(env, (char) data.returnValue));
+  if (structNames.size() <= (size_t) id) {
+    structNames.resize(id + 1);
   }
 
-  if (returnType == functions::Type::T_BOOL) {
-    info.Set(keyString, Napi::Value::From(env, (bool) data.returnValue));
-  }
+  structNames[id] = std::move(names);
 
-  if (returnType == functions::Type::T_INT) {
-    info.Set(keyString, Napi::Value::From(env, (int) data.returnValue));
+  return Napi::Value::From(env, id);
+}
+
+// Value of a fixed size field stored at `data`
+Napi::Value toFieldValue(Napi::Env env, const layout::Field& field, size_t pointerSize, const unsigned char* data) {
+  switch (field.type) {
+    case layout::T_INT8: { int8_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_UINT8: { uint8_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_INT16: { int16_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_UINT16: { uint16_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_INT32: { int32_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_UINT32: { uint32_t value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_INT64: { int64_t value; memcpy(&value, data, sizeof(value)); return Napi::BigInt::New(env, value); }
+    case layout::T_UINT64: { uint64_t value; memcpy(&value, data, sizeof(value)); return Napi::BigInt::New(env, value); }
+    case layout::T_FLOAT: { float value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_DOUBLE: { double value; memcpy(&value, data, sizeof(value)); return Napi::Value::From(env, value); }
+    case layout::T_BOOL: return Napi::Boolean::New(env, *data != 0);
+    case layout::T_POINTER: {
+      if (pointerSize == 8) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return Napi::BigInt::New(env, value);
+      }
+
+      uint32_t value;
+      memcpy(&value, data, sizeof(value));
+      return Napi::Value::From(env, value);
+    }
+    case layout::T_VECTOR3: {
+      Vector3 value;
+      memcpy(&value, data, sizeof(value));
+      Napi::Object vector = Napi::Object::New(env);
+      vector.Set(Napi::String::New(env, "x"), Napi::Value::From(env, value.x));
+      vector.Set(Napi::String::New(env, "y"), Napi::Value::From(env, value.y));
+      vector.Set(Napi::String::New(env, "z"), Napi::Value::From(env, value.z));
+      return vector;
+    }
+    case layout::T_VECTOR4: {
+      Vector4 value;
+      memcpy(&value, data, sizeof(value));
+      Napi::Object vector = Napi::Object::New(env);
+      vector.Set(Napi::String::New(env, "w"), Napi::Value::From(env, value.w));
+      vector.Set(Napi::String::New(env, "x"), Napi::Value::From(env, value.x));
+      vector.Set(Napi::String::New(env, "y"), Napi::Value::From(env, value.y));
+      vector.Set(Napi::String::New(env, "z"), Napi::Value::From(env, value.z));
+      return vector;
+    }
+    case layout::T_STRING: {
+      const char* characters = (const char*) data;
+      size_t length = 0;
+
+      while (length < field.length && characters[length] != '\0') {
+        length++;
+      }
+
+      return Napi::String::New(env, characters, length);
+    }
+    default:
+      return env.Null();
   }
+}
 
-  if (returnType == functions::Type::T_FLOAT) {
-    float value = *(float *)&data.returnValue;
-    info.Set(keyString, Napi::Value::From(env, value));
+// Struct `index` of `image` as an object, for a layout stored `base` bytes into its structs
+Napi::Value toStructObject(Napi::Env env, int id, const layout::Layout& structLayout, size_t pointerSize, const layout::Image& image, size_t index, size_t base) {
+  const std::vector<Napi::Reference<Napi::String>>& names = structNames[id];
+  const unsigned char* data = image.bytes.data() + index * image.stride + base;
+  Napi::Object object = Napi::Object::New(env);
+
+  for (size_t i = 0; i < structLayout.fields.size(); i++) {
+    const layout::Field& field = structLayout.fields[i];
+    Napi::Value value;
+
+    if (field.type == layout::T_STRUCT) {
+      value = toStructObject(env, field.layout, *field.target, pointerSize, image, index, base + field.offset);
+    } else if (field.type == layout::T_POINTER && field.target != nullptr) {
+      const layout::Image& child = image.children.at({ base + field.offset, &field });
+
+      value = child.present[index]
+        ? toStructObject(env, field.layout, *field.target, field.target->pointerSize, child, index, 0)
+        : env.Null();
+    } else {
+      value = toFieldValue(env, field, pointerSize, data + field.offset);
+    }
+
+    object.Set(names[i].Value(), value);
   }
 
-  if (returnType == functions::Type::T_DOUBLE) {
-    double value = *(double *)&data.returnValue;
-    info.Set(keyString, Napi::Value::From(env, value));
+  return object;
+}
+
+// Column of a numeric field, `components` values per struct. Values of missing structs are left zeroed.
+template <class T>
+Napi::Value toColumn(Napi::Env env, const layout::Image& image, size_t offset, size_t components = 1) {
+  size_t count = image.present.size();
+  Napi::TypedArrayOf<T> column = Napi::TypedArrayOf<T>::New(env, count * components);
+  T* values = column.Data();
+
+  for (size_t i = 0; i < count; i++) {
+    if (image.present[i]) {
+      memcpy(values + i * components, image.bytes.data() + i * image.stride + offset, sizeof(T) * components);
+    }
   }
 
-  info.Set(Napi::String::New(env, "exitCode"), Napi::Value::From(env, data.exitCode));
+  return column;
+}
 
-  if (args.Length() == 5) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[2].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), info });
-    return env.Null();
-  } else {
-    // return JSON
-    return info;
+// Structs of `image` as an object of columns, one per field
+Napi::Object toStructColumns(Napi::Env env, int id, const layout::Layout& structLayout, size_t pointerSize, const layout::Image& image, size_t base) {
+  const std::vector<Napi::Reference<Napi::String>>& names = structNames[id];
+  Napi::Object columns = Napi::Object::New(env);
+
+  for (size_t i = 0; i < structLayout.fields.size(); i++) {
+    const layout::Field& field = structLayout.fields[i];
+    size_t offset = base + field.offset;
+    Napi::Value column;
+
+    switch (field.type) {
+      case layout::T_INT8: column = toColumn<int8_t>(env, image, offset); break;
+      case layout::T_UINT8: column = toColumn<uint8_t>(env, image, offset); break;
+      case layout::T_BOOL: column = toColumn<uint8_t>(env, image, offset); break;
+      case layout::T_INT16: column = toColumn<int16_t>(env, image, offset); break;
+      case layout::T_UINT16: column = toColumn<uint16_t>(env, image, offset); break;
+      case layout::T_INT32: column = toColumn<int32_t>(env, image, offset); break;
+      case layout::T_UINT32: column = toColumn<uint32_t>(env, image, offset); break;
+      case layout::T_INT64: column = toColumn<int64_t>(env, image, offset); break;
+      case layout::T_UINT64: column = toColumn<uint64_t>(env, image, offset); break;
+      case layout::T_FLOAT: column = toColumn<float>(env, image, offset); break;
+      case layout::T_DOUBLE: column = toColumn<double>(env, image, offset); break;
+      case layout::T_VECTOR3: column = toColumn<float>(env, image, offset, 3); break;
+      case layout::T_VECTOR4: column = toColumn<float>(env, image, offset, 4); break;
+      case layout::T_STRUCT:
+        column = toStructColumns(env, field.layout, *field.target, pointerSize, image, offset);
+        break;
+      case layout::T_POINTER:
+        if (field.target != nullptr) {
+          column = toStructColumns(env, field.layout, *field.target, field.target->pointerSize, image.children.at({ offset, &field }), 0);
+        } else if (pointerSize == 8) {
+          column = toColumn<uint64_t>(env, image, offset);
+        } else {
+          column = toColumn<uint32_t>(env, image, offset);
+        }
+        break;
+      case layout::T_STRING: {
+        Napi::Array strings = Napi::Array::New(env, image.present.size());
+
+        for (size_t j = 0; j < image.present.size(); j++) {
+          strings.Set(j, image.present[j] ? toFieldValue(env, field, pointerSize, image.bytes.data() + j * image.stride + offset) : env.Null());
+        }
+
+        column = strings;
+        break;
+      }
+    }
+
+    columns.Set(names[i].Value(), column);
   }
 
+  return columns;
 }
 
-Napi::Value virtualProtectEx(const Napi::CallbackInfo& args) {
+Napi::Value readStruct(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 4 && args.Length() != 5) {
-    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, or 4 arguments if a callback is being used").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsNumber()) {
-    Napi::Error::New(env, "All arguments should be numbers.").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsNumber()) {
+    Napi::Error::New(env, "first and third arguments must be a number, second argument must be a number or a BigInt").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 5 && !args[4].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+  if (args.Length() == 4 && !args[3].IsFunction()) {
+    Napi::Error::New(env, "fourth argument must be a function").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  DWORD result;
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
-  SIZE_T size = args[2].As<Napi::Number>().Int64Value();
-  DWORD protection = args[3].As<Napi::Number>().Uint32Value();
 
-  bool success = VirtualProtectEx(handle, (LPVOID) address, size, protection, &result);
+  DWORD64 address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  int id = args[2].As<Napi::Number>().Int32Value();
+  std::shared_ptr<const layout::Layout> structLayout = layout::get(id);
+
+  if (structLayout == nullptr) {
+    Napi::Error::New(env, "third argument must be a layout returned by registerStruct").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
   const char* errorMessage = "";
+  Napi::Value retVal = env.Null();
+  layout::Image image;
 
-  if (success == 0) {
-    errorMessage = "an error occurred calling VirtualProtectEx";
-    // errorMessage = GetLastErrorToString().c_str();
+  if (!layout::read(handle, *structLayout, (uintptr_t) address, 1, structLayout->size, &image, &errorMessage)) {
+    if (!strcmp(errorMessage, "")) {
+      errorMessage = "unable to read struct";
+    }
+  } else {
+    retVal = toStructObject(env, id, *structLayout, structLayout->pointerSize, image, 0, 0);
   }
 
-  // If there is an error and there is no callback, throw the error
-  if (strcmp(errorMessage, "") && args.Length() != 5) {
+  if (strcmp(errorMessage, "") && args.Length() != 4) {
     Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 5) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[5].As<Napi::Function>();
-    callback.Call(env.Global(), {
-      Napi::String::New(env, errorMessage),
-      Napi::Value::From(env, result)
-    });
+  if (args.Length() == 4) {
+    Napi::Function callback = args[3].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), retVal });
     return env.Null();
   } else {
-    return Napi::Value::From(env, result);
+    return retVal;
   }
 }
 
-Napi::Value getRegions(const Napi::CallbackInfo& args) {
+Napi::Value readStructArray(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 1 && args.Length() != 2) {
-    Napi::Error::New(env, "requires 1 argument, 2 with callback").ThrowAsJavaScriptException();
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with options").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber()) {
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsNumber() || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "second argument must be a number or a BigInt, the others must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6 && !args[5].IsObject() && !args[5].IsUndefined()) {
+    Napi::Error::New(env, "sixth argument must be an object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  DWORD64 address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  size_t count;
+  size_t stride;
+  int id = args[4].As<Napi::Number>().Int32Value();
+  std::shared_ptr<const layout::Layout> structLayout = layout::get(id);
+
+  if (structLayout == nullptr) {
+    Napi::Error::New(env, "fifth argument must be a layout returned by registerStruct").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // structs are packed one after the other when no stride is given
+  if (!getArraySpan(args[2], args[3], structLayout->size, structLayout->size, &count, &stride)) {
+    Napi::Error::New(env, "count and stride can't be negative, and the structs can't span more than 1 GiB").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool columnar = args.Length() == 6 && args[5].IsObject() && args[5].As<Napi::Object>().Get("columnar").ToBoolean().Value();
+
+  layout::Image image;
+  const char* errorMessage = "";
+
+  // structs that can't be read come back as null, only a read too large to hold fails
+  if (!layout::read(handle, *structLayout, (uintptr_t) address, count, stride, &image, &errorMessage) && strcmp(errorMessage, "")) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (columnar) {
+    return toStructColumns(env, id, *structLayout, structLayout->pointerSize, image, 0);
+  }
+
+  Napi::Array structs = Napi::Array::New(env, count);
+
+  for (size_t i = 0; i < count; i++) {
+    structs.Set(i, image.present[i] ? toStructObject(env, id, *structLayout, structLayout->pointerSize, image, i, 0) : env.Null());
+  }
+
+  return structs;
+}
+
+Napi::Value readColumns(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5) {
+    Napi::Error::New(env, "requires 5 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsNumber() || !args[3].IsNumber() || !args[4].IsArray()) {
+    Napi::Error::New(env, "second argument must be a number or a BigInt, fifth argument must be an array, the others must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  DWORD64 address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  size_t count;
+  size_t stride;
+  Napi::Array columnsArg = args[4].As<Napi::Array>();
+
+  if (!getArraySpan(args[2], args[3], 0, 0, &count, &stride)) {
+    Napi::Error::New(env, "count and stride can't be negative, and the structs can't span more than 1 GiB").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::String offsetKey = Napi::String::New(env, "offset");
+  Napi::String typeKey = Napi::String::New(env, "type");
+  Napi::String targetKey = Napi::String::New(env, "target");
+
+  std::vector<columns::Column> fields(columnsArg.Length());
+
+  for (uint32_t i = 0; i < columnsArg.Length(); i++) {
+    Napi::Value columnValue = columnsArg.Get(i);
+
+    if (!columnValue.IsObject()) {
+      Napi::Error::New(env, "columns must be objects of { offset: number, type: string | number, target: TypedArray }").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    Napi::Object columnArg = columnValue.As<Napi::Object>();
+    Napi::Value offset = columnArg.Get(offsetKey);
+    Napi::Value type = columnArg.Get(typeKey);
+
+    size_t length;
+
+    if (!offset.IsNumber() || (!type.IsString() && !type.IsNumber()) || !getBytes(columnArg.Get(targetKey), &fields[i].target, &length)) {
+      Napi::Error::New(env, "columns must be objects of { offset: number, type: string | number, target: TypedArray }").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    int64_t fieldOffset = offset.As<Napi::Number>().Int64Value();
+
+    if (fieldOffset < 0 || (uint64_t) fieldOffset > layout::MAX_SIZE) {
+      Napi::Error::New(env, "column offsets must be between 0 and 1 GiB").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    fields[i].offset = (size_t) fieldOffset;
+    fields[i].size = getDataTypeSize(type);
+
+    if (fields[i].size == 0) {
+      Napi::Error::New(env, "unexpected data type, only fixed size types can be read into columns").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    if ((uint64_t) length < (uint64_t) count * fields[i].size) {
+      Napi::Error::New(env, "column target is too small to hold a value per struct").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  size_t read = columns::read(handle, (uintptr_t) address, count, stride, fields);
+  return Napi::Value::From(env, read);
+}
+
+Napi::Value enablePageCache(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    Napi::Error::New(env, "requires 1 argument, 2 with options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (args.Length() == 2 && !args[1].IsObject())) {
+    Napi::Error::New(env, "first argument must be a number, second argument must be an object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  // 64 MiB of pages, writable pages aren't cached unless a ttl is given
+  pagecache::Options options = { 64 * 1024 * 1024, -1 };
+
+  if (args.Length() == 2) {
+    Napi::Object settings = args[1].As<Napi::Object>();
+    Napi::Value budget = settings.Get("budget");
+    Napi::Value ttl = settings.Get("ttl");
+
+    if (budget.IsNumber()) {
+      options.budget = (size_t) budget.As<Napi::Number>().Int64Value();
+    }
+
+    if (ttl.IsNumber()) {
+      options.ttl = ttl.As<Napi::Number>().Int64Value();
+    }
+  }
+
+  pagecache::enable(handle, options);
+  return env.Null();
+}
+
+Napi::Value disablePageCache(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  pagecache::disable((HANDLE)args[0].As<Napi::Number>().Int64Value());
+  return env.Null();
+}
+
+Napi::Value clearPageCache(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  pagecache::clear((HANDLE)args[0].As<Napi::Number>().Int64Value());
+  return env.Null();
+}
+
+Napi::Value getPageCacheStats(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  pagecache::Stats stats;
+
+  if (!pagecache::getStats((HANDLE)args[0].As<Napi::Number>().Int64Value(), &stats)) {
+    return env.Null();
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "hits"), Napi::Value::From(env, (double) stats.hits));
+  result.Set(Napi::String::New(env, "misses"), Napi::Value::From(env, (double) stats.misses));
+  result.Set(Napi::String::New(env, "evictions"), Napi::Value::From(env, (double) stats.evictions));
+  result.Set(Napi::String::New(env, "pages"), Napi::Value::From(env, stats.pages));
+  result.Set(Napi::String::New(env, "bytes"), Napi::Value::From(env, stats.bytes));
+
+  return result;
+}
+
+Napi::Value writeMemory(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4) {
+    Napi::Error::New(env, "requires 4 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[3].IsString() && !args[3].IsNumber()) {
+    Napi::Error::New(env, "first and second argument must be a number, fourth argument must be a string or a data type id").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  datatype::Id type = getDataType(args[3]);
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  DWORD64 address;
+  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  switch (type) {
+    case datatype::T_INT8: {
+      Memory.writeMemory<int8_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+      break;
+    }
+
+    case datatype::T_UINT8: {
+      Memory.writeMemory<uint8_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+      break;
+    }
+
+    case datatype::T_INT16: {
+      Memory.writeMemory<int16_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+      break;
+    }
+
+    case datatype::T_UINT16: {
+      Memory.writeMemory<uint16_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+      break;
+    }
+
+    case datatype::T_INT32: {
+      Memory.writeMemory<int32_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+      break;
+    }
+
+    case datatype::T_UINT32: {
+      Memory.writeMemory<uint32_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+      break;
+    }
+
+    case datatype::T_INT64: {
+      if (args[2].As<Napi::BigInt>().IsBigInt()) {
+        bool lossless;
+        Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::BigInt>().Int64Value(&lossless));
+      } else {
+        Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::Number>().Int64Value());
+      }
+      break;
+    }
+
+    case datatype::T_UINT64: {
+      if (args[2].As<Napi::BigInt>().IsBigInt()) {
+        bool lossless;
+        Memory.writeMemory<int64_t>(handle, address,  args[2].As<Napi::BigInt>().Uint64Value(&lossless));
+      } else {
+        Memory.writeMemory<int64_t>(handle, address, args[2].As<Napi::Number>().Int64Value());
+      }
+      break;
+    }
+
+    case datatype::T_FLOAT: {
+      Memory.writeMemory<float>(handle, address, args[2].As<Napi::Number>().FloatValue());
+      break;
+    }
+
+    case datatype::T_DOUBLE: {
+      Memory.writeMemory<double>(handle, address, args[2].As<Napi::Number>().DoubleValue());
+      break;
+    }
+
+    case datatype::T_PTR: {
+      Napi::BigInt valueBigInt = args[2].As<Napi::BigInt>();
+
+      if (sizeof(intptr_t) == 8 && !valueBigInt.IsBigInt()) {
+        std::string error = "Writing 'ptr' or 'pointer' on 64 bit target build requires you to supply a BigInt.";
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      if (valueBigInt.IsBigInt()) {
+        bool lossless;
+        Memory.writeMemory<intptr_t>(handle, address, valueBigInt.Int64Value(&lossless));
+      } else {
+        Memory.writeMemory<intptr_t>(handle, address, args[2].As<Napi::Number>().Int32Value());
+      }
+      break;
+    }
+
+    case datatype::T_UPTR: {
+      Napi::BigInt valueBigInt = args[2].As<Napi::BigInt>();
+
+      if (sizeof(uintptr_t) == 8 && !valueBigInt.IsBigInt()) {
+        std::string error = "Writing 'ptr' or 'pointer' on 64 bit target build requires you to supply a BigInt.";
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      if (valueBigInt.IsBigInt()) {
+        bool lossless;
+        Memory.writeMemory<uintptr_t>(handle, address, valueBigInt.Uint64Value(&lossless));
+      } else {
+        Memory.writeMemory<uintptr_t>(handle, address, args[2].As<Napi::Number>().Uint32Value());
+      }
+      break;
+    }
+
+    case datatype::T_BOOL: {
+      Memory.writeMemory<bool>(handle, address, args[2].As<Napi::Boolean>().Value());
+      break;
+    }
+
+    case datatype::T_STRING: {
+      std::string valueParam(args[2].As<Napi::String>().Utf8Value());
+      valueParam.append("", 1);
+
+      // Write String, Method 1
+      //Memory.writeMemory<std::string>(handle, address, std::string(*valueParam));
+
+      // Write String, Method 2
+      Memory.writeMemory(handle, address, (char*) valueParam.data(), valueParam.size());
+      break;
+    }
+
+    case datatype::T_WSTRING: {
+      std::u16string valueParam(args[2].As<Napi::String>().Utf16Value());
+      valueParam.append(1, u'\0');
+
+      Memory.writeMemory(handle, address, (char*) valueParam.data(), valueParam.size() * sizeof(char16_t));
+      break;
+    }
+
+    case datatype::T_VECTOR3: {
+      Napi::Object value = args[2].As<Napi::Object>();
+      Vector3 vector = {
+        value.Get(Napi::String::New(env, "x")).As<Napi::Number>().FloatValue(),
+        value.Get(Napi::String::New(env, "y")).As<Napi::Number>().FloatValue(),
+        value.Get(Napi::String::New(env, "z")).As<Napi::Number>().FloatValue()
+      };
+      Memory.writeMemory<Vector3>(handle, address, vector);
+      break;
+    }
+
+    case datatype::T_VECTOR4: {
+      Napi::Object value = args[2].As<Napi::Object>();
+      Vector4 vector = {
+        value.Get(Napi::String::New(env, "w")).As<Napi::Number>().FloatValue(),
+        value.Get(Napi::String::New(env, "x")).As<Napi::Number>().FloatValue(),
+        value.Get(Napi::String::New(env, "y")).As<Napi::Number>().FloatValue(),
+        value.Get(Napi::String::New(env, "z")).As<Napi::Number>().FloatValue()
+      };
+      Memory.writeMemory<Vector4>(handle, address, vector);
+      break;
+    }
+
+    default:
+      Napi::Error::New(env, "unexpected data type").ThrowAsJavaScriptException();
+      break;
+  }
+
+  return env.Null();
+}
+
+Napi::Value writeBuffer(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3) {
+    Napi::Error::New(env, "required 3 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() && !args[1].IsNumber()) {
+    Napi::Error::New(env, "first and second argument must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  DWORD64 address;
+  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  SIZE_T length = args[2].As<Napi::Buffer<char>>().Length();
+  char* data = args[2].As<Napi::Buffer<char>>().Data();
+  Memory.writeMemory<char*>(handle, address, data, length);
+
+  return env.Null();
+}
+
+// Tags externals created by `compilePattern` so other externals can't be mistaken for signatures
+static const napi_type_tag signatureTypeTag = { 0x5f1d3a0c8e2b4c71, 0x9a64f0e3b7d25c18 };
+
+// Resolves a signature argument that is either a string or a handle returned by `compilePattern`.
+// Strings are compiled into `storage`, compiled handles are used as they are.
+bool getSignature(Napi::Value value, signature::Signature* storage, const signature::Signature** result, const char** errorMessage) {
+  if (value.IsString()) {
+    std::string pattern(value.As<Napi::String>().Utf8Value());
+
+    if (!signature::compile(pattern.c_str(), storage, errorMessage)) {
+      return false;
+    }
+
+    *result = storage;
+    return true;
+  }
+
+  if (value.IsExternal() && value.As<Napi::External<signature::Signature>>().CheckTypeTag(&signatureTypeTag)) {
+    *result = value.As<Napi::External<signature::Signature>>().Data();
+    return true;
+  }
+
+  *errorMessage = "signature must be a string or a compiled pattern";
+  return false;
+}
+
+Napi::Value compilePattern(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsString()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string pattern(args[0].As<Napi::String>().Utf8Value());
+
+  const char* errorMessage = "";
+  signature::Signature* compiled = new signature::Signature();
+
+  if (!signature::compile(pattern.c_str(), compiled, &errorMessage)) {
+    delete compiled;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::External<signature::Signature> handle = Napi::External<signature::Signature>::New(env, compiled, [](Napi::Env, signature::Signature* data) {
+    delete data;
+  });
+  handle.TypeTag(&signatureTypeTag);
+
+  return handle;
+}
+
+// Searches the modules of a process first and, if none of them matched, every memory region.
+// A non-zero `searchAddress` limits the search to the module/region containing it.
+bool searchModulesAndRegions(HANDLE handle, DWORD64 searchAddress, const signature::Signature& pattern, short flags, uint32_t patternOffset, uintptr_t* address, const std::atomic<bool>* cancelled = nullptr) {
+  const char* errorMessage = "";
+
+  std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &errorMessage);
+  Pattern.search(handle, modules, searchAddress, pattern, flags, patternOffset, address, cancelled);
+
+  // if no match found inside any modules, search memory regions, only the
+  // one containing `searchAddress` when it is set
+  if (*address == 0) {
+    std::vector<MEMORY_BASIC_INFORMATION> regions;
+    MEMORY_BASIC_INFORMATION region;
+
+    if (searchAddress == 0) {
+      regions = Memory.getRegions(handle);
+    } else if (regionmap::find(handle, searchAddress, &region)) {
+      regions.push_back(region);
+    }
+
+    Pattern.search(handle, regions, searchAddress, pattern, flags, patternOffset, address, cancelled);
+  }
+
+  return *address != 0;
+}
+
+// Napi::Value findPattern(const Napi::CallbackInfo& args) {
+//   Napi::Env env = args.Env();
+
+//   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+//   DWORD64 baseAddress = args[1].As<Napi::Number>().Int64Value();
+//   DWORD64 baseSize = args[2].As<Napi::Number>().Int64Value();
+//   std::string signature(args[3].As<Napi::String>().Utf8Value());
+//   short flags = args[4].As<Napi::Number>().Uint32Value();
+//   uint32_t patternOffset = args[5].As<Napi::Number>().Uint32Value();
+
+//   // matching address
+//   uintptr_t address = 0;
+//   const char* errorMessage = "";
+
+//   // read memory region occupied by the module to pattern match inside
+//   std::vector<unsigned char> moduleBytes = std::vector<unsigned char>(baseSize);
+//   ReadProcessMemory(handle, (LPVOID)baseAddress, &moduleBytes[0], baseSize, nullptr);
+//   unsigned char* byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
+
+//   Pattern.findPattern(handle, baseAddress, byteBase, baseSize, signature.c_str(), flags, patternOffset, &address);
+
+//   if (address == 0) {
+//     errorMessage = "unable to match pattern inside any modules or regions";
+//   }
+
+//   if (args.Length() == 5) {
+//     Napi::Function callback = args[4].As<Napi::Function>();
+//     callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
+//     return env.Null();
+//   } else {
+//     return Napi::Value::From(env, address);
+//   }
+// }
+
+Napi::Value findPattern(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsString() && !args[1].IsExternal()) || !args[2].IsNumber() || !args[3].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string or compiled pattern, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 5 && !args[4].IsFunction()) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  short flags = args[2].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[3].As<Napi::Number>().Uint32Value();
+
+  // matching address
+  uintptr_t address = 0;
+  const char* errorMessage = "";
+
+  signature::Signature storage;
+  const signature::Signature* pattern;
+
+  if (!getSignature(args[1], &storage, &pattern, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!searchModulesAndRegions(handle, 0, *pattern, flags, patternOffset, &address)) {
+    errorMessage = "unable to match pattern inside any modules or regions";
+  }
+
+  if (args.Length() == 5) {
+    Napi::Function callback = args[4].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
+    return env.Null();
+  } else {
+    return Napi::Value::From(env, address);
+  }
+}
+
+Napi::Value findPatternByModule(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString() || (!args[2].IsString() && !args[2].IsExternal()) || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string, string or compiled pattern, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6 && !args[5].IsFunction()) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+  short flags = args[3].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
+
+  // matching address
+  uintptr_t address = 0;
+  const char* errorMessage = "";
+
+  signature::Signature storage;
+  const signature::Signature* pattern;
+
+  if (!getSignature(args[2], &storage, &pattern, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  MODULEENTRY32 module = module::findModule(moduleName.c_str(), platform::getProcessId(handle), &errorMessage);
+
+  // pattern match inside the memory occupied by the module
+  Pattern.search(handle, std::vector<MODULEENTRY32>{ module }, 0, *pattern, flags, patternOffset, &address);
+
+  if (address == 0) {
+    errorMessage = "unable to match pattern inside any modules or regions";
+  }
+
+  if (args.Length() == 6) {
+    Napi::Function callback = args[5].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
+    return env.Null();
+  } else {
+    return Napi::Value::From(env, address);
+  }
+}
+
+Napi::Value findPatternByAddress(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber() || (!args[2].IsString() && !args[2].IsExternal()) || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "expected: number, number, string or compiled pattern, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6 && !args[5].IsFunction()) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  DWORD64 baseAddress;
+  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    baseAddress = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    baseAddress = args[1].As<Napi::Number>().Int64Value();
+  }
+
+  short flags = args[3].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
+
+  // matching address
+  uintptr_t address = 0;
+  const char* errorMessage = "";
+
+  signature::Signature storage;
+  const signature::Signature* pattern;
+
+  if (!getSignature(args[2], &storage, &pattern, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!searchModulesAndRegions(handle, baseAddress, *pattern, flags, patternOffset, &address)) {
+    errorMessage = "unable to match pattern inside any modules or regions";
+  }
+
+  if (args.Length() == 6) {
+    Napi::Function callback = args[5].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Value::From(env, address) });
+    return env.Null();
+  } else {
+    return Napi::Value::From(env, address);
+  }
+}
+
+Napi::Value setScanThreads(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  threadpool::shared().setThreads(args[0].As<Napi::Number>().Uint32Value());
+  return Napi::Value::From(env, threadpool::shared().getThreads());
+}
+
+Napi::Value setProcessIndexMaxAge(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsNumber()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  registry::setMaxAge(args[0].As<Napi::Number>().Int64Value());
+  return Napi::Value::From(env, registry::getMaxAge());
+}
+
+Napi::Value findPatterns(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 4) {
+    Napi::Error::New(env, "requires 2 or 3 arguments, 4 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsArray() || (args.Length() > 2 && !args[2].IsBoolean() && !args[2].IsFunction())) {
+    Napi::Error::New(env, "expected: number, array, boolean").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 4 && (!args[2].IsBoolean() || !args[3].IsFunction())) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  Napi::Array signatures = args[1].As<Napi::Array>();
+  bool all = args.Length() > 2 && args[2].IsBoolean() && args[2].As<Napi::Boolean>().Value();
+  bool hasCallback = args[args.Length() - 1].IsFunction();
+
+  const char* errorMessage = "";
+
+  // signatures passed as strings are compiled into this storage, which
+  // can't reallocate while `requests` holds pointers into it
+  std::vector<signature::Signature> storage(signatures.Length());
+  std::vector<pattern::Request> requests;
+
+  for (uint32_t i = 0; i < signatures.Length(); i++) {
+    Napi::Value entry = signatures.Get(i);
+    pattern::Request request = { nullptr, pattern::ST_NORMAL, 0 };
+
+    // entries can either be a signature, or `{ pattern, flags, patternOffset }`
+    if (entry.IsObject() && !entry.IsExternal()) {
+      Napi::Object options = entry.As<Napi::Object>();
+      Napi::Value flags = options.Get("flags");
+      Napi::Value patternOffset = options.Get("patternOffset");
+
+      request.flags = flags.IsNumber() ? flags.As<Napi::Number>().Uint32Value() : pattern::ST_NORMAL;
+      request.patternOffset = patternOffset.IsNumber() ? patternOffset.As<Napi::Number>().Uint32Value() : 0;
+      entry = options.Get("pattern");
+    }
+
+    if (!getSignature(entry, &storage[i], &request.signature, &errorMessage)) {
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    requests.push_back(request);
+  }
+
+  std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &errorMessage);
+  std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
+
+  std::vector<std::vector<uintptr_t>> matches;
+  Pattern.searchMany(handle, modules, regions, requests, all, &matches);
+
+  // first match mode returns one address per signature (0 when not found),
+  // all matches mode returns an array of addresses per signature
+  Napi::Array results = Napi::Array::New(env, matches.size());
+
+  for (std::vector<std::vector<uintptr_t>>::size_type i = 0; i != matches.size(); i++) {
+    if (all) {
+      Napi::Array addresses = Napi::Array::New(env, matches[i].size());
+
+      for (std::vector<uintptr_t>::size_type j = 0; j != matches[i].size(); j++) {
+        addresses.Set(j, Napi::Value::From(env, matches[i][j]));
+      }
+
+      results.Set(i, addresses);
+    } else {
+      results.Set(i, Napi::Value::From(env, matches[i].empty() ? 0 : matches[i][0]));
+    }
+  }
+
+  if (hasCallback) {
+    Napi::Function callback = args[args.Length() - 1].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, ""), results });
+    return env.Null();
+  } else {
+    return results;
+  }
+}
+
+// Wraps addresses in a BigUint64Array that owns the vector's storage, so no copy is made
+Napi::Value toBigUint64Array(Napi::Env env, std::vector<uint64_t>&& addresses) {
+  size_t length = addresses.size();
+
+  if (length == 0) {
+    return Napi::BigUint64Array::New(env, 0);
+  }
+
+  std::vector<uint64_t>* storage = new std::vector<uint64_t>(std::move(addresses));
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, storage->data(), length * sizeof(uint64_t), [](Napi::Env, void*, std::vector<uint64_t>* data) {
+    delete data;
+  }, storage);
+
+  return Napi::BigUint64Array::New(env, length, buffer, 0);
+}
+
+Napi::Value findAllPatterns(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 4 || args.Length() > 6) {
+    Napi::Error::New(env, "requires 4 or 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsString() && !args[1].IsExternal()) || !args[2].IsNumber() || !args[3].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string or compiled pattern, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() > 4 && !args[4].IsNumber() && !args[4].IsFunction()) {
+    Napi::Error::New(env, "max results argument must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6 && (!args[4].IsNumber() || !args[5].IsFunction())) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  short flags = args[2].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[3].As<Napi::Number>().Uint32Value();
+  int64_t maxResults = args.Length() > 4 && args[4].IsNumber() ? args[4].As<Napi::Number>().Int64Value() : 0;
+  bool hasCallback = args[args.Length() - 1].IsFunction();
+
+  if (maxResults < 0) {
+    Napi::Error::New(env, "max results can't be negative").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const char* errorMessage = "";
+
+  signature::Signature storage;
+  const signature::Signature* pattern;
+
+  if (!getSignature(args[1], &storage, &pattern, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &errorMessage);
+  std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
+
+  std::vector<uint64_t> addresses;
+  size_t total = 0;
+
+  // with a callback, matches are handed over a batch at a time as the scan
+  // goes, returning false from the callback stops the scan
+  Pattern.searchAll(handle, modules, regions, *pattern, flags, patternOffset, maxResults, [&](std::vector<uintptr_t>& matches) {
+    total += matches.size();
+
+    if (!hasCallback) {
+      addresses.insert(addresses.end(), matches.begin(), matches.end());
+      return true;
+    }
+
+    Napi::Function callback = args[args.Length() - 1].As<Napi::Function>();
+    Napi::Value result = callback.Call(env.Global(), {
+      Napi::String::New(env, ""),
+      toBigUint64Array(env, std::vector<uint64_t>(matches.begin(), matches.end()))
+    });
+
+    return !env.IsExceptionPending() && !(result.IsBoolean() && !result.As<Napi::Boolean>().Value());
+  });
+
+  if (hasCallback) {
+    return Napi::Value::From(env, total);
+  } else {
+    return toBigUint64Array(env, std::move(addresses));
+  }
+}
+
+// Tags externals created by `firstScan` so other externals can't be mistaken for scans
+static const napi_type_tag valueScanTypeTag = { 0x91c7e4052bd83a6f, 0x3f08d6b2e57a1c94 };
+
+// Scanned type of a data type name, pointers scanned as integers of their size
+bool getScanType(const std::string& dataType, valuescan::Type* type) {
+  datatype::Id id;
+
+  if (!datatype::fromName(dataType, &id)) {
+    return false;
+  }
+
+  switch (id) {
+    case datatype::T_INT8: *type = valuescan::T_INT8; return true;
+    case datatype::T_UINT8: *type = valuescan::T_UINT8; return true;
+    case datatype::T_BOOL: *type = valuescan::T_UINT8; return true;
+    case datatype::T_INT16: *type = valuescan::T_INT16; return true;
+    case datatype::T_UINT16: *type = valuescan::T_UINT16; return true;
+    case datatype::T_INT32: *type = valuescan::T_INT32; return true;
+    case datatype::T_UINT32: *type = valuescan::T_UINT32; return true;
+    case datatype::T_INT64: *type = valuescan::T_INT64; return true;
+    case datatype::T_UINT64: *type = valuescan::T_UINT64; return true;
+    case datatype::T_FLOAT: *type = valuescan::T_FLOAT; return true;
+    case datatype::T_DOUBLE: *type = valuescan::T_DOUBLE; return true;
+    case datatype::T_PTR: *type = sizeof(intptr_t) == 8 ? valuescan::T_INT64 : valuescan::T_INT32; return true;
+    case datatype::T_UPTR: *type = sizeof(uintptr_t) == 8 ? valuescan::T_UINT64 : valuescan::T_UINT32; return true;
+    // strings and vectors aren't scanned for
+    default: return false;
+  }
+}
+
+// Stores a number or a bigint as the scanned type
+void encodeScanValue(Napi::Value value, valuescan::Type type, unsigned char* output) {
+  if (value.IsBigInt()) {
+    bool lossless;
+    uint64_t bits = type == valuescan::T_INT64 ? (uint64_t) value.As<Napi::BigInt>().Int64Value(&lossless) : value.As<Napi::BigInt>().Uint64Value(&lossless);
+
+    if (type == valuescan::T_INT64 || type == valuescan::T_UINT64) {
+      memcpy(output, &bits, sizeof(bits));
+      return;
+    }
+
+    valuescan::encode(type, (double) bits, output);
+    return;
+  }
+
+  valuescan::encode(type, value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : 0, output);
+}
+
+// Parses `{ compare, value, min, max }`, where `compare` is one of
+// exact, range, unknown, changed, unchanged, increased or decreased
+bool getScanCondition(Napi::Value value, valuescan::Type type, valuescan::Condition* condition, const char** errorMessage) {
+  static const std::unordered_map<std::string, valuescan::Compare> compares = {
+    { "exact", valuescan::C_EXACT }, { "range", valuescan::C_RANGE }, { "unknown", valuescan::C_UNKNOWN },
+    { "changed", valuescan::C_CHANGED }, { "unchanged", valuescan::C_UNCHANGED },
+    { "increased", valuescan::C_INCREASED }, { "decreased", valuescan::C_DECREASED },
+  };
+
+  if (!value.IsObject() || !value.As<Napi::Object>().Get("compare").IsString()) {
+    *errorMessage = "condition must be an object with a compare string";
+    return false;
+  }
+
+  Napi::Object options = value.As<Napi::Object>();
+  auto compare = compares.find(options.Get("compare").As<Napi::String>().Utf8Value());
+
+  if (compare == compares.end()) {
+    *errorMessage = "unknown compare, expected exact, range, unknown, changed, unchanged, increased or decreased";
+    return false;
+  }
+
+  condition->compare = compare->second;
+
+  if (condition->compare == valuescan::C_RANGE) {
+    encodeScanValue(options.Get("min"), type, condition->value);
+    encodeScanValue(options.Get("max"), type, condition->maximum);
+  } else {
+    encodeScanValue(options.Get("value"), type, condition->value);
+    encodeScanValue(options.Get("value"), type, condition->maximum);
+  }
+
+  return true;
+}
+
+Napi::Value firstScan(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, 4 with an alignment").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString() || !args[2].IsObject() || (args.Length() == 4 && !args[3].IsNumber())) {
+    Napi::Error::New(env, "expected: number, string, object, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  size_t alignment = args.Length() == 4 ? args[3].As<Napi::Number>().Uint32Value() : 0;
+
+  const char* errorMessage = "";
+  valuescan::Type type;
+  valuescan::Condition condition;
+
+  if (!getScanType(args[1].As<Napi::String>().Utf8Value(), &type)) {
+    Napi::Error::New(env, "data type can't be scanned for, expected an integer, float or double type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!getScanCondition(args[2], type, &condition, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  valuescan::Scan* scan = new valuescan::Scan();
+
+  if (!valuescan::first(handle, type, alignment, condition, scan, &errorMessage)) {
+    delete scan;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::External<valuescan::Scan> result = Napi::External<valuescan::Scan>::New(env, scan, [](Napi::Env, valuescan::Scan* data) {
+    delete data;
+  });
+  result.TypeTag(&valueScanTypeTag);
+
+  return result;
+}
+
+bool isScan(Napi::Value value) {
+  return value.IsExternal() && value.As<Napi::External<valuescan::Scan>>().CheckTypeTag(&valueScanTypeTag);
+}
+
+Napi::Value nextScan(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !isScan(args[0]) || !args[1].IsObject()) {
+    Napi::Error::New(env, "requires 2 arguments, a scan and a condition").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  valuescan::Scan* scan = args[0].As<Napi::External<valuescan::Scan>>().Data();
+
+  const char* errorMessage = "";
+  valuescan::Condition condition;
+
+  if (!getScanCondition(args[1], scan->type, &condition, &errorMessage) || !valuescan::next(*scan, condition, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, scan->count);
+}
+
+Napi::Value getScanCount(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !isScan(args[0])) {
+    Napi::Error::New(env, "requires 1 argument, which must be a scan").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, args[0].As<Napi::External<valuescan::Scan>>().Data()->count);
+}
+
+Napi::Value getScanResults(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if ((args.Length() != 1 && args.Length() != 2) || !isScan(args[0]) || (args.Length() == 2 && !args[1].IsNumber())) {
+    Napi::Error::New(env, "requires a scan, and optionally the maximum number of results").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t maxResults = args.Length() == 2 ? (size_t) args[1].As<Napi::Number>().Int64Value() : 0;
+
+  std::vector<uint64_t> addresses;
+  valuescan::results(*args[0].As<Napi::External<valuescan::Scan>>().Data(), maxResults, &addresses);
+
+  return toBigUint64Array(env, std::move(addresses));
+}
+
+// Parses `{ pointerSize, alignment, maxDepth, maxOffset, maxResults, maxMemory }`, every field being optional
+bool getPointerScanOptions(Napi::Value value, pointerscan::Options* options, const char** errorMessage) {
+  *options = { sizeof(uintptr_t), 0, 5, 0x1000, 1000000, (size_t) 1 << 30 };
+
+  if (!value.IsUndefined() && !value.IsNull()) {
+    if (!value.IsObject()) {
+      *errorMessage = "options must be an object";
+      return false;
+    }
+
+    Napi::Object object = value.As<Napi::Object>();
+    const char* names[] = { "pointerSize", "alignment", "maxDepth", "maxOffset", "maxResults", "maxMemory" };
+    size_t* fields[] = { &options->pointerSize, &options->alignment, &options->maxDepth, &options->maxOffset, &options->maxResults, &options->maxMemory };
+
+    for (size_t i = 0; i < 6; i++) {
+      Napi::Value field = object.Get(names[i]);
+
+      if (field.IsNumber()) {
+        *fields[i] = (size_t) field.As<Napi::Number>().Int64Value();
+      } else if (!field.IsUndefined()) {
+        *errorMessage = "options must be numbers";
+        return false;
+      }
+    }
+  }
+
+  // pointers are aligned to their own size unless told otherwise
+  if (options->alignment == 0) {
+    options->alignment = options->pointerSize;
+  }
+
+  return pointerscan::validate(*options, errorMessage);
+}
+
+Napi::Value toPointerScanStats(Napi::Env env, const pointerscan::Stats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "pointers"), Napi::Value::From(env, (double) stats.pointers));
+  result.Set(Napi::String::New(env, "chains"), Napi::Value::From(env, (double) stats.chains));
+  result.Set(Napi::String::New(env, "truncated"), Napi::Boolean::New(env, stats.truncated));
+  return result;
+}
+
+Napi::Value scanPointers(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, or 4 with options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsString()) {
+    Napi::Error::New(env, "expected: number, number or BigInt, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[2].As<Napi::String>().Utf8Value());
+
+  uintptr_t address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = (uintptr_t) args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = (uintptr_t) args[1].As<Napi::Number>().Int64Value();
+  }
+
+  const char* errorMessage = "";
+  pointerscan::Options options;
+  pointerscan::Map map;
+  pointerscan::Stats stats;
+
+  if (!getPointerScanOptions(args.Length() == 4 ? args[3] : env.Undefined(), &options, &errorMessage)
+    || !pointerscan::buildMap(handle, options, &map, &errorMessage)
+    || !pointerscan::scan(map, address, options, path.c_str(), &stats, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return toPointerScanStats(env, stats);
+}
+
+Napi::Value readPointerChains(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if ((args.Length() != 1 && args.Length() != 2) || !args[0].IsString() || (args.Length() == 2 && !args[1].IsNumber())) {
+    Napi::Error::New(env, "requires the path of a pointer scan, and optionally the maximum number of chains").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string path(args[0].As<Napi::String>().Utf8Value());
+  size_t maxResults = args.Length() == 2 ? (size_t) args[1].As<Napi::Number>().Int64Value() : 0;
+
+  const char* errorMessage = "";
+  std::vector<std::string> modules;
+  std::vector<pointerscan::Chain> chains;
+
+  if (!pointerscan::readChains(path.c_str(), maxResults, &modules, &chains, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // module names are shared by the chains starting in them
+  std::vector<Napi::String> names;
+
+  for (auto& module : modules) {
+    names.push_back(Napi::String::New(env, module));
+  }
+
+  Napi::Array result = Napi::Array::New(env, chains.size());
+
+  for (size_t i = 0; i < chains.size(); i++) {
+    Napi::Object chain = Napi::Object::New(env);
+    Napi::Array offsets = Napi::Array::New(env, chains[i].offsets.size());
+
+    for (size_t j = 0; j < chains[i].offsets.size(); j++) {
+      offsets.Set(j, Napi::Value::From(env, (double) chains[i].offsets[j]));
+    }
+
+    chain.Set(Napi::String::New(env, "module"), names[chains[i].module]);
+    chain.Set(Napi::String::New(env, "offsets"), offsets);
+    result.Set(i, chain);
+  }
+
+  return result;
+}
+
+Napi::Value toFilterStats(Napi::Env env, const pointerscan::FilterStats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "chains"), Napi::Value::From(env, (double) stats.chains));
+  result.Set(Napi::String::New(env, "kept"), Napi::Value::From(env, (double) stats.kept));
+  return result;
+}
+
+Napi::Value savePointerMap(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, or 3 with options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "expected: number, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+
+  const char* errorMessage = "";
+  pointerscan::Options options;
+  pointerscan::Map map;
+
+  if (!getPointerScanOptions(args.Length() == 3 ? args[2] : env.Undefined(), &options, &errorMessage)
+    || !pointerscan::buildMap(handle, options, &map, &errorMessage)
+    || !pointerscan::saveMap(map, path.c_str(), &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, (double) map.pointerCount);
+}
+
+Napi::Value scanPointerMap(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, or 4 with options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsString() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsString()) {
+    Napi::Error::New(env, "expected: string, number or BigInt, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string mapPath(args[0].As<Napi::String>().Utf8Value());
+  std::string path(args[2].As<Napi::String>().Utf8Value());
+
+  uintptr_t address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = (uintptr_t) args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = (uintptr_t) args[1].As<Napi::Number>().Int64Value();
+  }
+
+  const char* errorMessage = "";
+  pointerscan::Options options;
+  pointerscan::Map map;
+  pointerscan::Stats stats;
+
+  if (!getPointerScanOptions(args.Length() == 4 ? args[3] : env.Undefined(), &options, &errorMessage)
+    || !pointerscan::openMap(mapPath.c_str(), &map, &errorMessage)
+    || !pointerscan::scan(map, address, options, path.c_str(), &stats, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return toPointerScanStats(env, stats);
+}
+
+Napi::Value filterPointerChains(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4) {
+    Napi::Error::New(env, "requires 4 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString() || (!args[2].IsNumber() && !args[2].IsBigInt()) || !args[3].IsString()) {
+    Napi::Error::New(env, "expected: number, string, number or BigInt, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+  std::string output(args[3].As<Napi::String>().Utf8Value());
+
+  uintptr_t address;
+  if (args[2].IsBigInt()) {
+    bool lossless;
+    address = (uintptr_t) args[2].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = (uintptr_t) args[2].As<Napi::Number>().Int64Value();
+  }
+
+  const char* errorMessage = "";
+  pointerscan::FilterStats stats;
+
+  if (!pointerscan::filter(handle, path.c_str(), address, output.c_str(), &stats, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return toFilterStats(env, stats);
+}
+
+Napi::Value intersectPointerChains(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !args[0].IsArray() || !args[1].IsString()) {
+    Napi::Error::New(env, "requires an array of pointer scan paths and the path to write to").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array array = args[0].As<Napi::Array>();
+  std::vector<std::string> paths;
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value path = array.Get(i);
+
+    if (!path.IsString()) {
+      Napi::Error::New(env, "pointer scan paths must be strings").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    paths.push_back(path.As<Napi::String>().Utf8Value());
+  }
+
+  std::string output(args[1].As<Napi::String>().Utf8Value());
+  const char* errorMessage = "";
+  uint64_t chains;
+
+  if (!pointerscan::intersect(paths, output.c_str(), &chains, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, (double) chains);
+}
+
+// Parses `{ protection, type, start, end }`, every field being optional
+bool getSnapshotFilter(Napi::Value value, snapshot::Filter* filter, const char** errorMessage) {
+  *filter = { 0, 0, 0, 0 };
+
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+
+  if (!value.IsObject()) {
+    *errorMessage = "filter must be an object";
+    return false;
+  }
+
+  Napi::Object options = value.As<Napi::Object>();
+  Napi::Value fields[] = { options.Get("protection"), options.Get("type"), options.Get("start"), options.Get("end") };
+  uint64_t values[4] = { 0, 0, 0, 0 };
+
+  for (size_t i = 0; i < 4; i++) {
+    if (fields[i].IsBigInt()) {
+      bool lossless;
+      values[i] = fields[i].As<Napi::BigInt>().Uint64Value(&lossless);
+    } else if (fields[i].IsNumber()) {
+      values[i] = fields[i].As<Napi::Number>().Int64Value();
+    } else if (!fields[i].IsUndefined()) {
+      *errorMessage = "filter fields must be numbers";
+      return false;
+    }
+  }
+
+  *filter = { (DWORD) values[0], (DWORD) values[1], (uintptr_t) values[2], (uintptr_t) values[3] };
+  return true;
+}
+
+Napi::Value toDumpStats(Napi::Env env, const snapshot::Stats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "regions"), Napi::Value::From(env, stats.regions));
+  result.Set(Napi::String::New(env, "bytes"), Napi::Value::From(env, (double) stats.bytes));
+  result.Set(Napi::String::New(env, "unreadablePages"), Napi::Value::From(env, (double) stats.unreadable));
+  return result;
+}
+
+Napi::Value dumpProcess(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 4) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with a filter, 4 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "expected: number, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 4 && !args[3].IsFunction()) {
+    Napi::Error::New(env, "callback argument must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+
+  const char* errorMessage = "";
+  snapshot::Filter filter;
+  snapshot::Stats stats = { 0, 0, 0 };
+
+  if (!getSnapshotFilter(args.Length() > 2 ? args[2] : env.Undefined(), &filter, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool success = snapshot::dump(handle, path.c_str(), filter, &stats, &errorMessage);
+
+  if (args.Length() == 4) {
+    Napi::Function callback = args[3].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), success ? toDumpStats(env, stats) : env.Null() });
+    return env.Null();
+  }
+
+  if (!success) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return toDumpStats(env, stats);
+}
+
+Napi::Value openSnapshot(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if ((args.Length() != 1 && args.Length() != 2) || !args[0].IsString() || (args.Length() == 2 && !args[1].IsArray())) {
+    Napi::Error::New(env, "requires the path of the snapshot, and optionally an array of deltas").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string path(args[0].As<Napi::String>().Utf8Value());
+  std::vector<std::string> deltas;
+
+  if (args.Length() == 2) {
+    Napi::Array paths = args[1].As<Napi::Array>();
+
+    for (uint32_t i = 0; i < paths.Length(); i++) {
+      if (!paths.Get(i).IsString()) {
+        Napi::Error::New(env, "deltas must be paths").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+
+      deltas.push_back(paths.Get(i).As<Napi::String>().Utf8Value());
+    }
+  }
+
+  const char* errorMessage = "";
+  HANDLE handle = snapshot::open(path.c_str(), deltas, &errorMessage);
+
+  if (handle == NULL) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, (uintptr_t) handle);
+}
+
+// Tags externals created by `trackProcess` so other externals can't be mistaken for trackers
+static const napi_type_tag trackerTypeTag = { 0x5be1907c3a46d2f8, 0xa4730e6c19d85b21 };
+
+Napi::Value trackProcess(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with a filter").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "expected: number, string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+
+  const char* errorMessage = "";
+  snapshot::Filter filter;
+  snapshot::Stats stats;
+
+  if (!getSnapshotFilter(args.Length() == 3 ? args[2] : env.Undefined(), &filter, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  snapshot::Tracker* tracker = new snapshot::Tracker();
+
+  if (!snapshot::track(handle, path.c_str(), filter, tracker, &stats, &errorMessage)) {
+    delete tracker;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::External<snapshot::Tracker> external = Napi::External<snapshot::Tracker>::New(env, tracker, [](Napi::Env, snapshot::Tracker* data) {
+    delete data;
+  });
+  external.TypeTag(&trackerTypeTag);
+
+  Napi::Object result = toDumpStats(env, stats).As<Napi::Object>();
+  result.Set(Napi::String::New(env, "tracker"), external);
+  result.Set(Napi::String::New(env, "softDirty"), Napi::Boolean::New(env, tracker->softDirty));
+
+  return result;
+}
+
+Napi::Value captureDelta(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 || !args[0].IsExternal() || !args[0].As<Napi::External<snapshot::Tracker>>().CheckTypeTag(&trackerTypeTag) || !args[1].IsString()) {
+    Napi::Error::New(env, "requires 2 arguments, a tracker and the path of the delta").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  snapshot::Tracker* tracker = args[0].As<Napi::External<snapshot::Tracker>>().Data();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+
+  const char* errorMessage = "";
+  snapshot::DeltaStats stats;
+
+  if (!snapshot::capture(*tracker, path.c_str(), &stats, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "sequence"), Napi::Value::From(env, (double) tracker->sequence));
+  result.Set(Napi::String::New(env, "pagesScanned"), Napi::Value::From(env, (double) stats.pagesScanned));
+  result.Set(Napi::String::New(env, "pagesCopied"), Napi::Value::From(env, (double) stats.pagesCopied));
+  result.Set(Napi::String::New(env, "softDirty"), Napi::Boolean::New(env, stats.softDirty));
+
+  return result;
+}
+
+#ifdef _WIN32
+// Arguments of a remote call. `functions::call` is handed pointers to the values,
+// so they are kept in deques, whose elements never move as more are added.
+struct CallArguments {
+  std::vector<functions::Arg> args;
+  std::deque<std::string> strings;
+  std::deque<int> ints;
+  std::deque<float> floats;
+};
+
+void parseCallArguments(Napi::Env env, Napi::Array arguments, CallArguments* parsed) {
+  for (unsigned int i = 0; i < arguments.Length(); i++) {
+    Napi::Object argument = arguments.Get(i).As<Napi::Object>();
+
+    functions::Type type = (functions::Type) argument.Get(Napi::String::New(env, "type")).As<Napi::Number>().Uint32Value();
+
+    if (type == functions::Type::T_STRING) {
+      parsed->strings.push_back(argument.Get(Napi::String::New(env, "value")).As<Napi::String>().Utf8Value());
+      parsed->args.push_back({ type, &parsed->strings.back() });
+    }
+
+    if (type == functions::Type::T_INT) {
+      parsed->ints.push_back(argument.Get(Napi::String::New(env, "value")).As<Napi::Number>().Int32Value());
+      parsed->args.push_back({ type, &parsed->ints.back() });
+    }
+
+    if (type == functions::Type::T_FLOAT) {
+      parsed->floats.push_back(argument.Get(Napi::String::New(env, "value")).As<Napi::Number>().FloatValue());
+      parsed->args.push_back({ type, &parsed->floats.back() });
+    }
+  }
+}
+
+Napi::Object toCallResult(Napi::Env env, functions::Type returnType, const Call& data) {
+  Napi::Object info = Napi::Object::New(env);
+
+  Napi::String keyString = Napi::String::New(env, "returnValue");
+
+  if (returnType == functions::Type::T_STRING) {
+    info.Set(keyString, Napi::String::New(env, data.returnString.c_str()));
+  }
+
+  if (returnType == functions::Type::T_CHAR) {
+    info.Set(keyString, Napi::Value::From(env, (char) data.returnValue));
+  }
+
+  if (returnType == functions::Type::T_BOOL) {
+    info.Set(keyString, Napi::Value::From(env, (bool) data.returnValue));
+  }
+
+  if (returnType == functions::Type::T_INT) {
+    info.Set(keyString, Napi::Value::From(env, (int) data.returnValue));
+  }
+
+  if (returnType == functions::Type::T_FLOAT) {
+    float value = *(float *)&data.returnValue;
+    info.Set(keyString, Napi::Value::From(env, value));
+  }
+
+  if (returnType == functions::Type::T_DOUBLE) {
+    double value = *(double *)&data.returnValue;
+    info.Set(keyString, Napi::Value::From(env, value));
+  }
+
+  info.Set(Napi::String::New(env, "exitCode"), Napi::Value::From(env, data.exitCode));
+
+  return info;
+}
+
+Napi::Value callFunction(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() && !args[1].IsObject() && !args[2].IsNumber() && !args[3].IsNumber()) {
+    Napi::Error::New(env, "invalid arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  CallArguments parsedArgs;
+  parseCallArguments(env, args[1].As<Napi::Array>(), &parsedArgs);
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  functions::Type returnType = (functions::Type) args[2].As<Napi::Number>().Uint32Value();
+
+  DWORD64 address;
+  if (args[3].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    address = args[3].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[3].As<Napi::Number>().Int64Value();
+  }
+
+  const char* errorMessage = "";
+  Call data = functions::call<int>(handle, parsedArgs.args, returnType, address, &errorMessage);
+
+  if (strcmp(errorMessage, "") && args.Length() != 5) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object info = toCallResult(env, returnType, data);
+
+  if (args.Length() == 5) {
+    // Callback to let the user handle with the information
+    Napi::Function callback = args[2].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), info });
+    return env.Null();
+  } else {
+    // return JSON
+    return info;
+  }
+
+}
+
+Napi::Value virtualProtectEx(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, 5 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() && !args[1].IsNumber() && !args[2].IsNumber()) {
+    Napi::Error::New(env, "All arguments should be numbers.").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 5 && !args[4].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD result;
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  SIZE_T size = args[2].As<Napi::Number>().Int64Value();
+  DWORD protection = args[3].As<Napi::Number>().Uint32Value();
+
+  bool success = VirtualProtectEx(handle, (LPVOID) address, size, protection, &result);
+  regionmap::invalidate(handle);
+
+  const char* errorMessage = "";
+
+  if (success == 0) {
+    errorMessage = "an error occurred calling VirtualProtectEx";
+    // errorMessage = GetLastErrorToString().c_str();
+  }
+
+  // If there is an error and there is no callback, throw the error
+  if (strcmp(errorMessage, "") && args.Length() != 5) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 5) {
+    // Callback to let the user handle with the information
+    Napi::Function callback = args[5].As<Napi::Function>();
+    callback.Call(env.Global(), {
+      Napi::String::New(env, errorMessage),
+      Napi::Value::From(env, result)
+    });
+    return env.Null();
+  } else {
+    return Napi::Value::From(env, result);
+  }
+}
+
+#endif
+
+Napi::Array toRegionsArray(Napi::Env env, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const std::vector<std::string>& names) {
+  Napi::Array regionsArray = Napi::Array::New(env, regions.size());
+
+  for (std::vector<MEMORY_BASIC_INFORMATION>::size_type i = 0; i != regions.size(); i++) {
+    Napi::Object region = Napi::Object::New(env);
+
+    region.Set(Napi::String::New(env, "BaseAddress"), Napi::Value::From(env, (DWORD64) regions[i].BaseAddress));
+    region.Set(Napi::String::New(env, "AllocationBase"), Napi::Value::From(env, (DWORD64) regions[i].AllocationBase));
+    region.Set(Napi::String::New(env, "AllocationProtect"), Napi::Value::From(env, (DWORD) regions[i].AllocationProtect));
+    region.Set(Napi::String::New(env, "RegionSize"), Napi::Value::From(env, (SIZE_T) regions[i].RegionSize));
+    region.Set(Napi::String::New(env, "State"), Napi::Value::From(env, (DWORD) regions[i].State));
+    region.Set(Napi::String::New(env, "Protect"), Napi::Value::From(env, (DWORD) regions[i].Protect));
+    region.Set(Napi::String::New(env, "Type"), Napi::Value::From(env, (DWORD) regions[i].Type));
+
+    if (!names[i].empty()) {
+      region.Set(Napi::String::New(env, "szExeFile"), Napi::String::New(env, names[i]));
+    }
+
+    regionsArray.Set(i, region);
+  }
+
+  return regionsArray;
+}
+
+Napi::Value getRegions(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    Napi::Error::New(env, "requires 1 argument, 2 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber()) {
     Napi::Error::New(env, "invalid arguments: first argument must be a number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 2 && !args[1].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
-    return env.Null();
+  if (args.Length() == 2 && !args[1].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::vector<std::string> names;
+  std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle, &names);
+
+  Napi::Array regionsArray = toRegionsArray(env, regions, names);
+
+  if (args.Length() == 2) {
+    // Callback to let the user handle with the information
+    Napi::Function callback = args[1].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, ""), regionsArray });
+    return env.Null();
+  } else {
+    // return JSON
+    return regionsArray;
+  }
+}
+
+Napi::Value virtualQueryEx(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber()) {
+    Napi::Error::New(env, "first and second argument need to be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 3 && !args[2].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+
+  MEMORY_BASIC_INFORMATION information;
+  bool success = platform::queryRegion(handle, address, &information);
+
+  const char* errorMessage = "";
+
+  if (!success) {
+    errorMessage = "an error occurred calling VirtualQueryEx";
+    // errorMessage = GetLastErrorToString().c_str();
+  }
+
+  // If there is an error and there is no callback, throw the error
+  if (strcmp(errorMessage, "") && args.Length() != 3) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object region = Napi::Object::New(env);
+
+  region.Set(Napi::String::New(env, "BaseAddress"), Napi::Value::From(env, (DWORD64) information.BaseAddress));
+  region.Set(Napi::String::New(env, "AllocationBase"), Napi::Value::From(env, (DWORD64) information.AllocationBase));
+  region.Set(Napi::String::New(env, "AllocationProtect"), Napi::Value::From(env, (DWORD) information.AllocationProtect));
+  region.Set(Napi::String::New(env, "RegionSize"), Napi::Value::From(env, (SIZE_T) information.RegionSize));
+  region.Set(Napi::String::New(env, "State"), Napi::Value::From(env, (DWORD) information.State));
+  region.Set(Napi::String::New(env, "Protect"), Napi::Value::From(env, (DWORD) information.Protect));
+  region.Set(Napi::String::New(env, "Type"), Napi::Value::From(env, (DWORD) information.Type));
+
+  if (args.Length() == 3) {
+    // Callback to let the user handle with the information
+    Napi::Function callback = args[1].As<Napi::Function>();
+    callback.Call(env.Global(), { Napi::String::New(env, ""), region });
+    return env.Null();
+  } else {
+    // return JSON
+    return region;
+  }
+}
+
+// Tags externals created by `createDebugPump`
+static const napi_type_tag debugPumpTypeTag = { 0x5b07e3d9a4c2f186, 0x93fa6d18e05b2c47 };
+
+// A debug pump handed to JavaScript. Its thread only queues a call to `callback`, which
+// takes every stop waiting once it runs on the JavaScript thread.
+struct DebugPump {
+  std::unique_ptr<debugpump::Pump> pump;
+  Napi::ThreadSafeFunction callback;
+  // reused by every call so delivering doesn't allocate
+  std::vector<platform::DebugStop> stops;
+  bool stopped = false;
+
+  void stop() {
+    if (stopped) {
+      return;
+    }
+
+    stopped = true;
+    pump->stop();
+    callback.Release();
+  }
+};
+
+// Calls the JavaScript callback of a debug pump with the stops it went through
+void deliverDebugEvents(Napi::Env env, Napi::Function callback, const std::weak_ptr<DebugPump>& weak) {
+  std::shared_ptr<DebugPump> debugPump = weak.lock();
+
+  if (env == nullptr || !debugPump || debugPump->stopped || !debugPump->pump->take(&debugPump->stops)) {
+    return;
+  }
+
+  Napi::Array events = Napi::Array::New(env, debugPump->stops.size());
+
+  for (size_t i = 0; i < debugPump->stops.size(); i++) {
+    const platform::DebugStop& stop = debugPump->stops[i];
+    Napi::Object event = Napi::Object::New(env);
+
+    event.Set(Napi::String::New(env, "processId"), Napi::Value::From(env, (DWORD) stop.processId));
+    event.Set(Napi::String::New(env, "threadId"), Napi::Value::From(env, (DWORD) stop.threadId));
+    event.Set(Napi::String::New(env, "exceptionCode"), Napi::Value::From(env, (DWORD) stop.code));
+    event.Set(Napi::String::New(env, "exceptionFlags"), Napi::Value::From(env, (DWORD) stop.flags));
+    event.Set(Napi::String::New(env, "exceptionAddress"), Napi::Value::From(env, (DWORD64) stop.address));
+    event.Set(Napi::String::New(env, "hardwareRegister"), Napi::Value::From(env, stop.hardwareRegister));
+    events.Set(i, event);
+  }
+
+  callback.Call(env.Global(), { events });
+}
+
+// Gets the pump an entry point was given as its first argument, null after throwing
+DebugPump* getDebugPump(const Napi::CallbackInfo& args) {
+  if (args.Length() == 0 || !args[0].IsExternal() || !args[0].As<Napi::External<std::shared_ptr<DebugPump>>>().CheckTypeTag(&debugPumpTypeTag)) {
+    Napi::Error::New(args.Env(), "first argument needs to be a debug pump").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  DebugPump* debugPump = args[0].As<Napi::External<std::shared_ptr<DebugPump>>>().Data()->get();
+
+  if (debugPump->stopped) {
+    Napi::Error::New(args.Env(), "the debug pump is closed").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  return debugPump;
+}
+
+Napi::Value createDebugPump(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsFunction()) {
+    Napi::Error::New(env, "requires 1 argument, which must be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<DebugPump> debugPump = std::make_shared<DebugPump>();
+  Napi::ThreadSafeFunction callback = Napi::ThreadSafeFunction::New(env, args[0].As<Napi::Function>(), "debugPump", 0, 1);
+  std::weak_ptr<DebugPump> weak = debugPump;
+
+  debugPump->callback = callback;
+  debugPump->pump.reset(new debugpump::Pump([callback, weak]() {
+    callback.NonBlockingCall([weak](Napi::Env env, Napi::Function function) {
+      deliverDebugEvents(env, function, weak);
+    });
+  }));
+
+  std::shared_ptr<DebugPump>* data = new std::shared_ptr<DebugPump>(debugPump);
+  Napi::External<std::shared_ptr<DebugPump>> result = Napi::External<std::shared_ptr<DebugPump>>::New(env, data, [](Napi::Env, std::shared_ptr<DebugPump>* data) {
+    (*data)->stop();
+    delete data;
+  });
+  result.TypeTag(&debugPumpTypeTag);
+
+  return result;
+}
+
+Napi::Value debugPumpAttach(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 3 || !args[1].IsNumber() || !args[2].IsBoolean()) {
+    Napi::Error::New(env, "expected: debug pump, number, boolean").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[1].As<Napi::Number>().Uint32Value();
+  bool killOnExit = args[2].As<Napi::Boolean>().Value();
+
+  bool success = debugPump->pump->attach(processId, killOnExit);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value debugPumpDetach(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 2 || !args[1].IsNumber()) {
+    Napi::Error::New(env, "expected: debug pump, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool success = debugPump->pump->detach(args[1].As<Napi::Number>().Uint32Value());
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value debugPumpSetBreakpoint(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 6 || !args[1].IsNumber() || !(args[2].IsNumber() || args[2].IsBigInt()) || !args[3].IsNumber() || !args[4].IsNumber() || !args[5].IsNumber()) {
+    Napi::Error::New(env, "expected: debug pump, number, number or bigint, number, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[1].As<Napi::Number>().Uint32Value();
+
+  DWORD64 address;
+  if (args[2].IsBigInt()) {
+    bool lossless;
+    address = args[2].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[2].As<Napi::Number>().Int64Value();
+  }
+
+  int hardwareRegister = args[3].As<Napi::Number>().Int32Value();
+
+  if (hardwareRegister < 0 || hardwareRegister > 3) {
+    Napi::Error::New(env, "the register must be between 0 and 3").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Execute = 0x0
+  // Access = 0x3
+  // Write = 0x1
+  int trigger = args[4].As<Napi::Number>().Int32Value();
+  int size = args[5].As<Napi::Number>().Int32Value();
+
+  bool success = debugPump->pump->setBreakpoint(processId, (uintptr_t) address, hardwareRegister, trigger, size);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value debugPumpRemoveBreakpoint(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 3 || !args[1].IsNumber() || !args[2].IsNumber()) {
+    Napi::Error::New(env, "expected: debug pump, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[1].As<Napi::Number>().Uint32Value();
+  int hardwareRegister = args[2].As<Napi::Number>().Int32Value();
+
+  bool success = debugPump->pump->removeBreakpoint(processId, hardwareRegister);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value setDebugPolicy(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 3 || !args[1].IsNumber() || !args[2].IsNumber()) {
+    Napi::Error::New(env, "expected: debug pump, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int hardwareRegister = args[1].As<Napi::Number>().Int32Value();
+  uint32_t policy = args[2].As<Napi::Number>().Uint32Value();
+
+  if (hardwareRegister < -1 || hardwareRegister > 3) {
+    Napi::Error::New(env, "the register must be between 0 and 3, or -1 for other exceptions").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (policy > debugpump::HOLD) {
+    Napi::Error::New(env, "unexpected policy, expected 0 (handled), 1 (unhandled) or 2 (hold)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  debugPump->pump->setPolicy(hardwareRegister, (debugpump::Policy) policy);
+  return env.Null();
+}
+
+Napi::Value continueDebugEvent(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  DebugPump* debugPump = getDebugPump(args);
+
+  if (debugPump == nullptr) {
+    return env.Null();
+  }
+
+  if (args.Length() != 4 || !args[1].IsNumber() || !args[2].IsNumber() || !args[3].IsBoolean()) {
+    Napi::Error::New(env, "expected: debug pump, number, number, boolean").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[1].As<Napi::Number>().Uint32Value();
+  DWORD threadId = args[2].As<Napi::Number>().Uint32Value();
+  bool handled = args[3].As<Napi::Boolean>().Value();
+
+  bool success = debugPump->pump->resume(processId, threadId, handled);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value closeDebugPump(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsExternal() || !args[0].As<Napi::External<std::shared_ptr<DebugPump>>>().CheckTypeTag(&debugPumpTypeTag)) {
+    Napi::Error::New(env, "requires 1 argument, which must be a debug pump").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  (*args[0].As<Napi::External<std::shared_ptr<DebugPump>>>().Data())->stop();
+  return env.Null();
+}
+
+#ifdef _WIN32
+Napi::Value virtualAllocEx(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[2].IsNumber() || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "invalid arguments: arguments 0, 2, 3 and 4 need to be numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6 && !args[5].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  SIZE_T size = args[2].As<Napi::Number>().Int64Value();
+  DWORD allocationType = args[3].As<Napi::Number>().Uint32Value();
+  DWORD protection = args[4].As<Napi::Number>().Uint32Value();
+  LPVOID address;
+
+  // Means in the JavaScript space `null` was passed through.
+  if (args[1] == env.Null()) {
+    address = NULL;
+  } else {
+    address = (LPVOID) args[1].As<Napi::Number>().Int64Value();
+  }
+
+  LPVOID allocatedAddress = VirtualAllocEx(handle, address, size, allocationType, protection);
+  regionmap::invalidate(handle);
+
+  const char* errorMessage = "";
+
+  // If null, it means an error occurred
+  if (allocatedAddress == NULL) {
+    errorMessage = "an error occurred calling VirtualAllocEx";
+    // errorMessage = GetLastErrorToString().c_str();
+  }
+
+  // If there is an error and there is no callback, throw the error
+  if (strcmp(errorMessage, "") && args.Length() != 6) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 6) {
+    // Callback to let the user handle with the information
+    Napi::Function callback = args[5].As<Napi::Function>();
+    callback.Call(env.Global(), {
+      Napi::String::New(env, errorMessage),
+      Napi::Value::From(env, (intptr_t)allocatedAddress)
+    });
+    return env.Null();
+  } else {
+    return Napi::Value::From(env, (intptr_t)allocatedAddress);
+  }
+}
+
+Napi::Value attachDebugger(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2) {
+    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsBoolean()) {
+    Napi::Error::New(env, "first argument needs to be a number, second a boolean").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
+  bool killOnExit = args[1].As<Napi::Boolean>().Value();
+
+  bool success = debugger::attach(processId, killOnExit);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value detachDebugger(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
+
+  if (args.Length() != 1) {
+    Napi::Error::New(env, "requires only 1 argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber()) {
+    Napi::Error::New(env, "only argument needs to be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool success = debugger::detatch(processId);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value awaitDebugEvent(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2) {
+    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber()) {
+    Napi::Error::New(env, "both arguments need to be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int millisTimeout = args[1].As<Napi::Number>().Uint32Value();
+
+  DebugEvent debugEvent;
+  bool success = debugger::awaitDebugEvent(millisTimeout, &debugEvent);
+
+  Register hardwareRegister = static_cast<Register>(args[0].As<Napi::Number>().Uint32Value());
+
+  if (success && debugEvent.hardwareRegister == hardwareRegister) {
+    Napi::Object info = Napi::Object::New(env);
+
+    info.Set(Napi::String::New(env, "processId"), Napi::Value::From(env, (DWORD) debugEvent.processId));
+    info.Set(Napi::String::New(env, "threadId"), Napi::Value::From(env, (DWORD) debugEvent.threadId));
+    info.Set(Napi::String::New(env, "exceptionCode"), Napi::Value::From(env, (DWORD) debugEvent.exceptionCode));
+    info.Set(Napi::String::New(env, "exceptionFlags"), Napi::Value::From(env, (DWORD) debugEvent.exceptionFlags));
+    info.Set(Napi::String::New(env, "exceptionAddress"), Napi::Value::From(env, (DWORD64) debugEvent.exceptionAddress));
+    info.Set(Napi::String::New(env, "hardwareRegister"), Napi::Value::From(env, static_cast<int>(debugEvent.hardwareRegister)));
+
+    return info;
+  }
+
+  // If we aren't interested in passing this event back to the JS space,
+  // just silently handle it
+  if (success && debugEvent.hardwareRegister != hardwareRegister) {
+    debugger::handleDebugEvent(debugEvent.processId, debugEvent.threadId);
+  }
+
+  return env.Null();
+}
+
+Napi::Value handleDebugEvent(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2) {
+    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber()) {
+    Napi::Error::New(env, "both arguments need to be numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
+  DWORD threadId = args[1].As<Napi::Number>().Uint32Value();
+
+  bool success = debugger::handleDebugEvent(processId, threadId);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value setHardwareBreakpoint(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5) {
+    Napi::Error::New(env, "requires 5 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  for (unsigned int i = 0; i < args.Length(); i++) {
+    if (!args[i].IsNumber()) {
+      Napi::Error::New(env, "all arguments need to be numbers").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
+  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  Register hardwareRegister = static_cast<Register>(args[2].As<Napi::Number>().Uint32Value());
+
+  // Execute = 0x0
+  // Access = 0x3
+  // Writer = 0x1
+  int trigger = args[3].As<Napi::Number>().Uint32Value();
+
+  int length = args[4].As<Napi::Number>().Uint32Value();
+
+  bool success = debugger::setHardwareBreakpoint(processId, address, hardwareRegister, trigger, length);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value removeHardwareBreakpoint(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2) {
+    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsNumber()) {
+    Napi::Error::New(env, "both arguments need to be numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
+  Register hardwareRegister = static_cast<Register>(args[1].As<Napi::Number>().Uint32Value());
+
+  bool success = debugger::setHardwareBreakpoint(processId, 0, hardwareRegister, 0, 0);
+  return Napi::Boolean::New(env, success);
+}
+
+Napi::Value injectDll(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, or 3 with a callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "first argument needs to be a number, second argument needs to be a string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 3 && !args[2].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string dllPath(args[1].As<Napi::String>().Utf8Value());
+  Napi::Function callback = args[2].As<Napi::Function>();
+
+  const char* errorMessage = "";
+  DWORD moduleHandle = -1;
+  bool success = dll::inject(handle, dllPath, &errorMessage, &moduleHandle);
+  registry::invalidateModules(platform::getProcessId(handle));
+  regionmap::invalidate(handle);
+
+  if (strcmp(errorMessage, "") && args.Length() != 3) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // `moduleHandle` above is the return value of the `LoadLibrary` procedure,
+  // which we retrieve through `GetExitCode`. This value can become truncated
+  // in large address spaces such as 64 bit since `GetExitCode` just returns BOOL,
+  // so it's unreliable to use as the handle. Since the handle of a module is just a pointer
+  // to the address of the DLL mapped in the process' virtual address space, we can fetch
+  // this separately, so we won't return it to prevent it being passed to `unloadDll`
+  // and in some cases unexpectedly failing when it is truncated.
+
+  if (args.Length() == 3) {
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Boolean::New(env, success) });
+    return env.Null();
+  } else {
+    return Napi::Boolean::New(env, success);
+  }
+}
+
+Napi::Value unloadDll(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, or 3 with a callback").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber()) {
+    Napi::Error::New(env, "first argument needs to be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[1].IsNumber() && !args[1].IsString()) {
+    Napi::Error::New(env, "second argument needs to be a number or a string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (args.Length() == 3 && !args[2].IsFunction()) {
+    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  Napi::Function callback = args[2].As<Napi::Function>();
+
+  HMODULE moduleHandle;
+
+  // get module handle (module base address) directly
+  if (args[1].IsNumber()) {
+    moduleHandle = (HMODULE)args[1].As<Napi::Number>().Int64Value();
+  }
+
+  // find module handle from name of DLL
+  if (args[1].IsString()) {
+    std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+    const char* errorMessage = "";
+
+    MODULEENTRY32 module = module::findModule(moduleName.c_str(), platform::getProcessId(handle), &errorMessage);
+
+    if (strcmp(errorMessage, "")) {
+      if (args.Length() != 3) {
+        Napi::Error::New(env, "unable to find specified module").ThrowAsJavaScriptException();
+        return env.Null();
+      } else {
+        callback.Call(env.Global(), { Napi::String::New(env, errorMessage) });
+        return Napi::Boolean::New(env, false);
+      }
+    }
+
+    moduleHandle = (HMODULE) module.modBaseAddr;
+  }
+
+  const char* errorMessage = "";
+  bool success = dll::unload(handle, &errorMessage, moduleHandle);
+  registry::invalidateModules(platform::getProcessId(handle));
+  regionmap::invalidate(handle);
+
+  if (strcmp(errorMessage, "") && args.Length() != 3) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return Napi::Boolean::New(env, false);
+  }
+
+  if (args.Length() == 3) {
+    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Boolean::New(env, success) });
+    return env.Null();
+  } else {
+    return Napi::Boolean::New(env, success);
+  }
+}
+
+Napi::Value openFileMapping(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  std::string fileName(args[0].As<Napi::String>().Utf8Value());
+
+  HANDLE fileHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, fileName.c_str());
+
+  if (fileHandle == NULL) {
+    Napi::Error::New(env, Napi::String::New(env, "Error opening handle to file!")).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, (uintptr_t) fileHandle);
+}
+
+Napi::Value mapViewOfFile(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  HANDLE processHandle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  HANDLE fileHandle = (HANDLE)args[1].As<Napi::Number>().Int64Value();
+
+  uint64_t offset;
+  if (args[2].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    offset = args[2].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    offset = args[2].As<Napi::Number>().Int64Value();
+  }
+  
+  size_t viewSize;
+  if (args[3].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    viewSize = args[3].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    viewSize = args[3].As<Napi::Number>().Int64Value();
+  }
+
+  ULONG pageProtection = args[4].As<Napi::Number>().Int64Value();
+
+  LPVOID baseAddress = MapViewOfFile2(fileHandle, processHandle, offset, NULL, viewSize, 0, pageProtection);
+
+  if (baseAddress == NULL) {
+    Napi::Error::New(env, Napi::String::New(env, "Error mapping file to process!")).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Value::From(env, (uintptr_t) baseAddress);
+}
+
+// https://stackoverflow.com/a/17387176
+std::string GetLastErrorToString() {
+  DWORD errorMessageID = ::GetLastError();
+
+  // No error message, return empty string
+  if(errorMessageID == 0) {
+    return std::string();
+  }
+
+  LPSTR messageBuffer = nullptr;
+
+  size_t size = FormatMessageA(
+    FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+    NULL,
+    errorMessageID,
+    MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+    (LPSTR)&messageBuffer,
+    0,
+    NULL
+  );
+
+  std::string message(messageBuffer, size);
+
+  // Free the buffer
+  LocalFree(messageBuffer);
+  return message;
+}
+
+#else
+// Entry points built on Windows-only APIs (remote threads, debugging, file mappings)
+Napi::Value notSupported(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+  Napi::Error::New(env, "not supported on this platform").ThrowAsJavaScriptException();
+  return env.Null();
+}
+#endif
+
+// Tags externals created by `createCancellation` so other externals can't be mistaken for them
+static const napi_type_tag cancellationTypeTag = { 0x7e3b9d2a51c4f806, 0xc2a58e17f90b3d64 };
+
+// Creates the token the *Async functions take to be aborted, the JavaScript side
+// cancels it when the AbortSignal passed to them fires
+Napi::Value createCancellation(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  Cancellation* cancellation = new Cancellation(std::make_shared<std::atomic<bool>>(false));
+  Napi::External<Cancellation> token = Napi::External<Cancellation>::New(env, cancellation, [](Napi::Env, Cancellation* data) {
+    delete data;
+  });
+  token.TypeTag(&cancellationTypeTag);
+
+  return token;
+}
+
+Napi::Value cancel(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 1 || !args[0].IsExternal() || !args[0].As<Napi::External<Cancellation>>().CheckTypeTag(&cancellationTypeTag)) {
+    Napi::Error::New(env, "requires 1 argument, which must be a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  (*args[0].As<Napi::External<Cancellation>>().Data())->store(true);
+  return env.Null();
+}
+
+// Resolves the optional cancellation token passed as the last argument of an *Async function
+bool getCancellation(const Napi::CallbackInfo& args, size_t index, Cancellation* cancellation, const char** errorMessage) {
+  if (args.Length() <= index || args[index].IsUndefined() || args[index].IsNull()) {
+    return true;
   }
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
+  if (args[index].IsExternal() && args[index].As<Napi::External<Cancellation>>().CheckTypeTag(&cancellationTypeTag)) {
+    *cancellation = *args[index].As<Napi::External<Cancellation>>().Data();
+    return true;
+  }
 
-  Napi::Array regionsArray = Napi::Array::New(env, regions.size());
+  *errorMessage = "last argument must be a cancellation token";
+  return false;
+}
 
-  for (std::vector<MEMORY_BASIC_INFORMATION>::size_type i = 0; i != regions.size(); i++) {
-    Napi::Object region = Napi::Object::New(env);
+// Signature of an *Async function. Strings are compiled up front into storage owned by the
+// worker, compiled patterns are used in place and kept alive by the worker until it is done.
+struct AsyncSignature {
+  signature::Signature storage;
+  const signature::Signature* pattern;
+};
 
-    region.Set(Napi::String::New(env, "BaseAddress"), Napi::Value::From(env, (DWORD64) regions[i].BaseAddress));
-    region.Set(Napi::String::New(env, "AllocationBase"), Napi::Value::From(env, (DWORD64) regions[i].AllocationBase));
-    region.Set(Napi::String::New(env, "AllocationProtect"), Napi::Value::From(env, (DWORD) regions[i].AllocationProtect));
-    region.Set(Napi::String::New(env, "RegionSize"), Napi::Value::From(env, (SIZE_T) regions[i].RegionSize));
-    region.Set(Napi::String::New(env, "State"), Napi::Value::From(env, (DWORD) regions[i].State));
-    region.Set(Napi::String::New(env, "Protect"), Napi::Value::From(env, (DWORD) regions[i].Protect));
-    region.Set(Napi::String::New(env, "Type"), Napi::Value::From(env, (DWORD) regions[i].Type));
+bool getAsyncSignature(PromiseWorker* worker, Napi::Value value, AsyncSignature* signature, const char** errorMessage) {
+  if (!getSignature(value, &signature->storage, &signature->pattern, errorMessage)) {
+    return false;
+  }
 
-    char moduleName[MAX_PATH];
-    DWORD size = GetModuleFileNameExA(handle, (HINSTANCE)regions[i].AllocationBase, moduleName, MAX_PATH);
+  worker->keep(value);
+  return true;
+}
 
-    if (size != 0) {
-      region.Set(Napi::String::New(env, "szExeFile"), Napi::String::New(env, moduleName));
-    }
+Napi::Value findPatternAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-    regionsArray.Set(i, region);
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, 5 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  if (args.Length() == 2) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[1].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, ""), regionsArray });
+  if (!args[0].IsNumber() || (!args[1].IsString() && !args[1].IsExternal()) || !args[2].IsNumber() || !args[3].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string or compiled pattern, number, number").ThrowAsJavaScriptException();
     return env.Null();
-  } else {
-    // return JSON
-    return regionsArray;
   }
-}
 
-Napi::Value virtualQueryEx(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  short flags = args[2].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[3].As<Napi::Number>().Uint32Value();
 
-  if (args.Length() != 2 && args.Length() != 3) {
-    Napi::Error::New(env, "requires 2 arguments, 3 with callback").ThrowAsJavaScriptException();
+  const char* errorMessage = "";
+  Cancellation cancellation;
+
+  if (!getCancellation(args, 4, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsNumber()) {
-    Napi::Error::New(env, "first and second argument need to be a number").ThrowAsJavaScriptException();
+  std::shared_ptr<AsyncSignature> signature = std::make_shared<AsyncSignature>();
+  std::shared_ptr<uintptr_t> address = std::make_shared<uintptr_t>(0);
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    searchModulesAndRegions(handle, 0, *signature->pattern, flags, patternOffset, address.get(), cancellation.get());
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) {
+    return Napi::Value::From(env, *address);
+  });
+
+  if (!getAsyncSignature(worker, args[1], signature.get(), &errorMessage)) {
+    delete worker;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 3 && !args[2].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+  return worker->start();
+}
+
+Napi::Value findPatternByModuleAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
+  if (!args[0].IsNumber() || !args[1].IsString() || (!args[2].IsString() && !args[2].IsExternal()) || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string, string or compiled pattern, number, number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  MEMORY_BASIC_INFORMATION information;
-  SIZE_T result = VirtualQueryEx(handle, (LPVOID)address, &information, sizeof(information));
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string moduleName(args[1].As<Napi::String>().Utf8Value());
+  short flags = args[3].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
 
   const char* errorMessage = "";
+  Cancellation cancellation;
 
-  if (result == 0 || result != sizeof(information)) {
-    errorMessage = "an error occurred calling VirtualQueryEx";
-    // errorMessage = GetLastErrorToString().c_str();
-  }
-
-  // If there is an error and there is no callback, throw the error
-  if (strcmp(errorMessage, "") && args.Length() != 3) {
+  if (!getCancellation(args, 5, &cancellation, &errorMessage)) {
     Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  Napi::Object region = Napi::Object::New(env);
+  std::shared_ptr<AsyncSignature> signature = std::make_shared<AsyncSignature>();
+  std::shared_ptr<uintptr_t> address = std::make_shared<uintptr_t>(0);
 
-  region.Set(Napi::String::New(env, "BaseAddress"), Napi::Value::From(env, (DWORD64) information.BaseAddress));
-  region.Set(Napi::String::New(env, "AllocationBase"), Napi::Value::From(env, (DWORD64) information.AllocationBase));
-  region.Set(Napi::String::New(env, "AllocationProtect"), Napi::Value::From(env, (DWORD) information.AllocationProtect));
-  region.Set(Napi::String::New(env, "RegionSize"), Napi::Value::From(env, (SIZE_T) information.RegionSize));
-  region.Set(Napi::String::New(env, "State"), Napi::Value::From(env, (DWORD) information.State));
-  region.Set(Napi::String::New(env, "Protect"), Napi::Value::From(env, (DWORD) information.Protect));
-  region.Set(Napi::String::New(env, "Type"), Napi::Value::From(env, (DWORD) information.Type));
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    MODULEENTRY32 module = module::findModule(moduleName.c_str(), platform::getProcessId(handle), errorMessage);
 
-  if (args.Length() == 3) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[1].As<Napi::Function>();
-    callback.Call(env.Global(), { Napi::String::New(env, ""), region });
+    if (strcmp(*errorMessage, "")) {
+      return;
+    }
+
+    Pattern.search(handle, std::vector<MODULEENTRY32>{ module }, 0, *signature->pattern, flags, patternOffset, address.get(), cancellation.get());
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) {
+    return Napi::Value::From(env, *address);
+  });
+
+  if (!getAsyncSignature(worker, args[2], signature.get(), &errorMessage)) {
+    delete worker;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
-  } else {
-    // return JSON
-    return region;
   }
+
+  return worker->start();
 }
 
-Napi::Value virtualAllocEx(const Napi::CallbackInfo& args) {
+Napi::Value findPatternByAddressAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
   if (args.Length() != 5 && args.Length() != 6) {
-    Napi::Error::New(env, "requires 5 arguments, 6 with callback").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  if (!args[0].IsNumber() || !args[2].IsNumber() || !args[3].IsNumber() || !args[4].IsNumber()) {
-    Napi::Error::New(env, "invalid arguments: arguments 0, 2, 3 and 4 need to be numbers").ThrowAsJavaScriptException();
+    Napi::Error::New(env, "requires 5 arguments, 6 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 6 && !args[5].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || !args[1].IsNumber() || (!args[2].IsString() && !args[2].IsExternal()) || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "expected: number, number, string or compiled pattern, number, number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  SIZE_T size = args[2].As<Napi::Number>().Int64Value();
-  DWORD allocationType = args[3].As<Napi::Number>().Uint32Value();
-  DWORD protection = args[4].As<Napi::Number>().Uint32Value();
-  LPVOID address;
 
-  // Means in the JavaScript space `null` was passed through.
-  if (args[1] == env.Null()) {
-    address = NULL;
+  DWORD64 baseAddress;
+  if (args[1].As<Napi::BigInt>().IsBigInt()) {
+    bool lossless;
+    baseAddress = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
   } else {
-    address = (LPVOID) args[1].As<Napi::Number>().Int64Value();
+    baseAddress = args[1].As<Napi::Number>().Int64Value();
   }
 
-  LPVOID allocatedAddress = VirtualAllocEx(handle, address, size, allocationType, protection);
+  short flags = args[3].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[4].As<Napi::Number>().Uint32Value();
 
   const char* errorMessage = "";
+  Cancellation cancellation;
 
-  // If null, it means an error occurred
-  if (allocatedAddress == NULL) {
-    errorMessage = "an error occurred calling VirtualAllocEx";
-    // errorMessage = GetLastErrorToString().c_str();
-  }
-
-  // If there is an error and there is no callback, throw the error
-  if (strcmp(errorMessage, "") && args.Length() != 6) {
+  if (!getCancellation(args, 5, &cancellation, &errorMessage)) {
     Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 6) {
-    // Callback to let the user handle with the information
-    Napi::Function callback = args[5].As<Napi::Function>();
-    callback.Call(env.Global(), {
-      Napi::String::New(env, errorMessage),
-      Napi::Value::From(env, (intptr_t)allocatedAddress)
-    });
+  std::shared_ptr<AsyncSignature> signature = std::make_shared<AsyncSignature>();
+  std::shared_ptr<uintptr_t> address = std::make_shared<uintptr_t>(0);
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    searchModulesAndRegions(handle, baseAddress, *signature->pattern, flags, patternOffset, address.get(), cancellation.get());
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) {
+    return Napi::Value::From(env, *address);
+  });
+
+  if (!getAsyncSignature(worker, args[2], signature.get(), &errorMessage)) {
+    delete worker;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
-  } else {
-    return Napi::Value::From(env, (intptr_t)allocatedAddress);
   }
+
+  return worker->start();
 }
 
-Napi::Value attachDebugger(const Napi::CallbackInfo& args) {
+Napi::Value findPatternsAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 2) {
-    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, 4 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsBoolean()) {
-    Napi::Error::New(env, "first argument needs to be a number, second a boolean").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || !args[1].IsArray() || !args[2].IsBoolean()) {
+    Napi::Error::New(env, "expected: number, array, boolean").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
-  bool killOnExit = args[1].As<Napi::Boolean>().Value();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  Napi::Array signatures = args[1].As<Napi::Array>();
+  bool all = args[2].As<Napi::Boolean>().Value();
 
-  bool success = debugger::attach(processId, killOnExit);
-  return Napi::Boolean::New(env, success);
+  const char* errorMessage = "";
+  Cancellation cancellation;
+
+  if (!getCancellation(args, 3, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  struct State {
+    std::deque<AsyncSignature> signatures;
+    std::vector<pattern::Request> requests;
+    std::vector<std::vector<uintptr_t>> matches;
+  };
+
+  std::shared_ptr<State> state = std::make_shared<State>();
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    const char* modulesError = "";
+    std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &modulesError);
+    std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
+
+    Pattern.searchMany(handle, modules, regions, state->requests, all, &state->matches, cancellation.get());
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) {
+    Napi::Array results = Napi::Array::New(env, state->matches.size());
+
+    for (std::vector<std::vector<uintptr_t>>::size_type i = 0; i != state->matches.size(); i++) {
+      std::vector<uintptr_t>& matches = state->matches[i];
+
+      if (all) {
+        Napi::Array addresses = Napi::Array::New(env, matches.size());
+
+        for (std::vector<uintptr_t>::size_type j = 0; j != matches.size(); j++) {
+          addresses.Set(j, Napi::Value::From(env, matches[j]));
+        }
+
+        results.Set(i, addresses);
+      } else {
+        results.Set(i, Napi::Value::From(env, matches.empty() ? 0 : matches[0]));
+      }
+    }
+
+    return results;
+  });
+
+  for (uint32_t i = 0; i < signatures.Length(); i++) {
+    Napi::Value entry = signatures.Get(i);
+    pattern::Request request = { nullptr, pattern::ST_NORMAL, 0 };
+
+    // entries can either be a signature, or `{ pattern, flags, patternOffset }`
+    if (entry.IsObject() && !entry.IsExternal()) {
+      Napi::Object options = entry.As<Napi::Object>();
+      Napi::Value flags = options.Get("flags");
+      Napi::Value patternOffset = options.Get("patternOffset");
+
+      request.flags = flags.IsNumber() ? flags.As<Napi::Number>().Uint32Value() : pattern::ST_NORMAL;
+      request.patternOffset = patternOffset.IsNumber() ? patternOffset.As<Napi::Number>().Uint32Value() : 0;
+      entry = options.Get("pattern");
+    }
+
+    state->signatures.emplace_back();
+
+    if (!getAsyncSignature(worker, entry, &state->signatures.back(), &errorMessage)) {
+      delete worker;
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    request.signature = state->signatures.back().pattern;
+    state->requests.push_back(request);
+  }
+
+  return worker->start();
 }
 
-Napi::Value detachDebugger(const Napi::CallbackInfo& args) {
+Napi::Value findAllPatternsAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
-
-  if (args.Length() != 1) {
-    Napi::Error::New(env, "requires only 1 argument").ThrowAsJavaScriptException();
+  if (args.Length() != 5 && args.Length() != 6) {
+    Napi::Error::New(env, "requires 5 arguments, 6 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber()) {
-    Napi::Error::New(env, "only argument needs to be a number").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || (!args[1].IsString() && !args[1].IsExternal()) || !args[2].IsNumber() || !args[3].IsNumber() || !args[4].IsNumber()) {
+    Napi::Error::New(env, "expected: number, string or compiled pattern, number, number, number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  bool success = debugger::detatch(processId);
-  return Napi::Boolean::New(env, success);
-}
-
-Napi::Value awaitDebugEvent(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  short flags = args[2].As<Napi::Number>().Uint32Value();
+  uint32_t patternOffset = args[3].As<Napi::Number>().Uint32Value();
+  int64_t maxResults = args[4].As<Napi::Number>().Int64Value();
 
-  if (args.Length() != 2) {
-    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+  if (maxResults < 0) {
+    Napi::Error::New(env, "max results can't be negative").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsNumber()) {
-    Napi::Error::New(env, "both arguments need to be a number").ThrowAsJavaScriptException();
+  const char* errorMessage = "";
+  Cancellation cancellation;
+
+  if (!getCancellation(args, 5, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int millisTimeout = args[1].As<Napi::Number>().Uint32Value();
+  std::shared_ptr<AsyncSignature> signature = std::make_shared<AsyncSignature>();
+  std::shared_ptr<std::vector<uint64_t>> addresses = std::make_shared<std::vector<uint64_t>>();
 
-  DebugEvent debugEvent;
-  bool success = debugger::awaitDebugEvent(millisTimeout, &debugEvent);
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    const char* modulesError = "";
+    std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &modulesError);
+    std::vector<MEMORY_BASIC_INFORMATION> regions = Memory.getRegions(handle);
 
-  Register hardwareRegister = static_cast<Register>(args[0].As<Napi::Number>().Uint32Value());
+    Pattern.searchAll(handle, modules, regions, *signature->pattern, flags, patternOffset, maxResults, [&](std::vector<uintptr_t>& matches) {
+      addresses->insert(addresses->end(), matches.begin(), matches.end());
+      return true;
+    }, cancellation.get());
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) {
+    return toBigUint64Array(env, std::move(*addresses));
+  });
+
+  if (!getAsyncSignature(worker, args[1], signature.get(), &errorMessage)) {
+    delete worker;
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  if (success && debugEvent.hardwareRegister == hardwareRegister) {
-    Napi::Object info = Napi::Object::New(env);
+  return worker->start();
+}
 
-    info.Set(Napi::String::New(env, "processId"), Napi::Value::From(env, (DWORD) debugEvent.processId));
-    info.Set(Napi::String::New(env, "threadId"), Napi::Value::From(env, (DWORD) debugEvent.threadId));
-    info.Set(Napi::String::New(env, "exceptionCode"), Napi::Value::From(env, (DWORD) debugEvent.exceptionCode));
-    info.Set(Napi::String::New(env, "exceptionFlags"), Napi::Value::From(env, (DWORD) debugEvent.exceptionFlags));
-    info.Set(Napi::String::New(env, "exceptionAddress"), Napi::Value::From(env, (DWORD64) debugEvent.exceptionAddress));
-    info.Set(Napi::String::New(env, "hardwareRegister"), Napi::Value::From(env, static_cast<int>(debugEvent.hardwareRegister)));
+Napi::Value getRegionsAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-    return info;
+  if (args.Length() != 1 && args.Length() != 2) {
+    Napi::Error::New(env, "requires 1 argument, 2 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  // If we aren't interested in passing this event back to the JS space,
-  // just silently handle it
-  if (success && debugEvent.hardwareRegister != hardwareRegister) {
-    debugger::handleDebugEvent(debugEvent.processId, debugEvent.threadId);
+  if (!args[0].IsNumber()) {
+    Napi::Error::New(env, "invalid arguments: first argument must be a number").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return env.Null();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+
+  const char* errorMessage = "";
+  Cancellation cancellation;
+
+  if (!getCancellation(args, 1, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<std::vector<std::string>> names = std::make_shared<std::vector<std::string>>();
+  std::shared_ptr<std::vector<MEMORY_BASIC_INFORMATION>> regions = std::make_shared<std::vector<MEMORY_BASIC_INFORMATION>>();
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char**) {
+    *regions = Memory.getRegions(handle, names.get());
+  }, [=](Napi::Env env) {
+    return toRegionsArray(env, *regions, *names);
+  });
+
+  return worker->start();
 }
 
-Napi::Value handleDebugEvent(const Napi::CallbackInfo& args) {
+Napi::Value readBufferAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 2) {
-    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
+  if (args.Length() != 3 && args.Length() != 4) {
+    Napi::Error::New(env, "requires 3 arguments, 4 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber() || !args[1].IsNumber()) {
-    Napi::Error::New(env, "both arguments need to be numbers").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsNumber()) {
+    Napi::Error::New(env, "first, second and third arguments must be a number").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
-  DWORD threadId = args[1].As<Napi::Number>().Uint32Value();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
 
-  bool success = debugger::handleDebugEvent(processId, threadId);
-  return Napi::Boolean::New(env, success);
-}
+  DWORD64 address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = args[1].As<Napi::Number>().Int64Value();
+  }
 
-Napi::Value setHardwareBreakpoint(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+  int64_t requested = args[2].As<Napi::Number>().Int64Value();
 
-  if (args.Length() != 5) {
-    Napi::Error::New(env, "requires 5 arguments").ThrowAsJavaScriptException();
+  if (requested < 0) {
+    Napi::Error::New(env, "size can't be negative").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  for (unsigned int i = 0; i < args.Length(); i++) {
-    if (!args[i].IsNumber()) {
-      Napi::Error::New(env, "all arguments need to be numbers").ThrowAsJavaScriptException();
-      return env.Null();
-    }
+  SIZE_T size = (SIZE_T) requested;
+
+  const char* errorMessage = "";
+  Cancellation cancellation;
+
+  if (!getCancellation(args, 3, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
-  DWORD64 address = args[1].As<Napi::Number>().Int64Value();
-  Register hardwareRegister = static_cast<Register>(args[2].As<Napi::Number>().Uint32Value());
+  // allocated by the worker and handed over to the buffer, freed here when the promise is rejected
+  std::shared_ptr<char*> data(new char*(nullptr), [](char** data) {
+    free(*data);
+    delete data;
+  });
 
-  // Execute = 0x0
-  // Access = 0x3
-  // Writer = 0x1
-  int trigger = args[3].As<Napi::Number>().Uint32Value();
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    if (size == 0) {
+      return;
+    }
 
-  int length = args[4].As<Napi::Number>().Uint32Value();
+    *data = (char*) calloc(size, 1);
 
-  bool success = debugger::setHardwareBreakpoint(processId, address, hardwareRegister, trigger, length);
-  return Napi::Boolean::New(env, success);
-}
+    if (*data == nullptr) {
+      *errorMessage = "unable to allocate the buffer";
+      return;
+    }
 
-Napi::Value removeHardwareBreakpoint(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+    // read a chunk at a time so a large read can be aborted part way,
+    // chunks that can't be read are left zeroed
+    for (SIZE_T offset = 0; offset < size && !(cancellation && cancellation->load()); offset += pattern::CHUNK_SIZE) {
+      SIZE_T length = size - offset < pattern::CHUNK_SIZE ? size - offset : pattern::CHUNK_SIZE;
+      Memory.readBuffer(handle, address + offset, length, *data + offset);
+    }
 
-  if (args.Length() != 2) {
-    Napi::Error::New(env, "requires 2 arguments").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    reportAborted(cancellation, errorMessage);
+  }, [=](Napi::Env env) -> Napi::Value {
+    if (*data == nullptr) {
+      return Napi::Buffer<char>::New(env, 0);
+    }
 
-  if (!args[0].IsNumber() || !args[1].IsNumber()) {
-    Napi::Error::New(env, "both arguments need to be numbers").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    // hand the worker's memory over to the buffer instead of copying it
+    char* bytes = *data;
+    *data = nullptr;
 
-  DWORD processId = args[0].As<Napi::Number>().Uint32Value();
-  Register hardwareRegister = static_cast<Register>(args[1].As<Napi::Number>().Uint32Value());
+    return Napi::Buffer<char>::New(env, bytes, size, [](Napi::Env, char* bytes) {
+      free(bytes);
+    });
+  });
 
-  bool success = debugger::setHardwareBreakpoint(processId, 0, hardwareRegister, 0, 0);
-  return Napi::Boolean::New(env, success);
+  return worker->start();
 }
 
-Napi::Value injectDll(const Napi::CallbackInfo& args) {
+Napi::Value dumpProcessAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 2 && args.Length() != 3) {
-    Napi::Error::New(env, "requires 2 arguments, or 3 with a callback").ThrowAsJavaScriptException();
+  if (args.Length() < 2 || args.Length() > 4) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with a filter, 4 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   if (!args[0].IsNumber() || !args[1].IsString()) {
-    Napi::Error::New(env, "first argument needs to be a number, second argument needs to be a string").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  if (args.Length() == 3 && !args[2].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+    Napi::Error::New(env, "expected: number, string").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  std::string dllPath(args[1].As<Napi::String>().Utf8Value());
-  Napi::Function callback = args[2].As<Napi::Function>();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
 
   const char* errorMessage = "";
-  DWORD moduleHandle = -1;
-  bool success = dll::inject(handle, dllPath, &errorMessage, &moduleHandle);
+  snapshot::Filter filter;
+  Cancellation cancellation;
 
-  if (strcmp(errorMessage, "") && args.Length() != 3) {
+  if (!getSnapshotFilter(args.Length() > 2 ? args[2] : env.Undefined(), &filter, &errorMessage) || !getCancellation(args, 3, &cancellation, &errorMessage)) {
     Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // `moduleHandle` above is the return value of the `LoadLibrary` procedure,
-  // which we retrieve through `GetExitCode`. This value can become truncated
-  // in large address spaces such as 64 bit since `GetExitCode` just returns BOOL,
-  // so it's unreliable to use as the handle. Since the handle of a module is just a pointer
-  // to the address of the DLL mapped in the process' virtual address space, we can fetch
-  // this separately, so we won't return it to prevent it being passed to `unloadDll`
-  // and in some cases unexpectedly failing when it is truncated.
+  std::shared_ptr<snapshot::Stats> stats = std::make_shared<snapshot::Stats>();
 
-  if (args.Length() == 3) {
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Boolean::New(env, success) });
-    return env.Null();
-  } else {
-    return Napi::Boolean::New(env, success);
-  }
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    snapshot::dump(handle, path.c_str(), filter, stats.get(), errorMessage, cancellation.get());
+  }, [=](Napi::Env env) -> Napi::Value {
+    return toDumpStats(env, *stats);
+  });
+
+  return worker->start();
 }
 
-Napi::Value unloadDll(const Napi::CallbackInfo& args) {
+Napi::Value scanPointersAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  if (args.Length() != 2 && args.Length() != 3) {
-    Napi::Error::New(env, "requires 2 arguments, or 3 with a callback").ThrowAsJavaScriptException();
+  if (args.Length() < 3 || args.Length() > 5) {
+    Napi::Error::New(env, "requires 3 arguments, 4 with options, 5 with a cancellation token").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[0].IsNumber()) {
-    Napi::Error::New(env, "first argument needs to be a number").ThrowAsJavaScriptException();
+  if (!args[0].IsNumber() || (!args[1].IsNumber() && !args[1].IsBigInt()) || !args[2].IsString()) {
+    Napi::Error::New(env, "expected: number, number or BigInt, string").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!args[1].IsNumber() && !args[1].IsString()) {
-    Napi::Error::New(env, "second argument needs to be a number or a string").ThrowAsJavaScriptException();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[2].As<Napi::String>().Utf8Value());
+
+  uintptr_t address;
+  if (args[1].IsBigInt()) {
+    bool lossless;
+    address = (uintptr_t) args[1].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = (uintptr_t) args[1].As<Napi::Number>().Int64Value();
+  }
+
+  const char* errorMessage = "";
+  pointerscan::Options options;
+  Cancellation cancellation;
+
+  if (!getPointerScanOptions(args.Length() > 3 ? args[3] : env.Undefined(), &options, &errorMessage) || !getCancellation(args, 4, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (args.Length() == 3 && !args[2].IsFunction()) {
-    Napi::Error::New(env, "callback needs to be a function").ThrowAsJavaScriptException();
+  std::shared_ptr<pointerscan::Stats> stats = std::make_shared<pointerscan::Stats>();
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    pointerscan::Map map;
+
+    if (pointerscan::buildMap(handle, options, &map, errorMessage, cancellation.get())) {
+      pointerscan::scan(map, address, options, path.c_str(), stats.get(), errorMessage, cancellation.get());
+    }
+  }, [=](Napi::Env env) -> Napi::Value {
+    return toPointerScanStats(env, *stats);
+  });
+
+  return worker->start();
+}
+
+Napi::Value savePointerMapAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
+
+  if (args.Length() < 2 || args.Length() > 4) {
+    Napi::Error::New(env, "requires 2 arguments, 3 with options, 4 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "expected: number, string").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  Napi::Function callback = args[2].As<Napi::Function>();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
 
-  HMODULE moduleHandle;
+  const char* errorMessage = "";
+  pointerscan::Options options;
+  Cancellation cancellation;
 
-  // get module handle (module base address) directly
-  if (args[1].IsNumber()) {
-    moduleHandle = (HMODULE)args[1].As<Napi::Number>().Int64Value();
+  if (!getPointerScanOptions(args.Length() > 2 ? args[2] : env.Undefined(), &options, &errorMessage) || !getCancellation(args, 3, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  // find module handle from name of DLL
-  if (args[1].IsString()) {
-    std::string moduleName(args[1].As<Napi::String>().Utf8Value());
-    const char* errorMessage = "";
+  std::shared_ptr<size_t> pointers = std::make_shared<size_t>(0);
 
-    MODULEENTRY32 module = module::findModule(moduleName.c_str(), GetProcessId(handle), &errorMessage);
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    pointerscan::Map map;
 
-    if (strcmp(errorMessage, "")) {
-      if (args.Length() != 3) {
-        Napi::Error::New(env, "unable to find specified module").ThrowAsJavaScriptException();
-        return env.Null();
-      } else {
-        callback.Call(env.Global(), { Napi::String::New(env, errorMessage) });
-        return Napi::Boolean::New(env, false);
-      }
+    if (pointerscan::buildMap(handle, options, &map, errorMessage, cancellation.get()) && pointerscan::saveMap(map, path.c_str(), errorMessage)) {
+      *pointers = map.pointerCount;
     }
+  }, [=](Napi::Env env) -> Napi::Value {
+    return Napi::Value::From(env, (double) *pointers);
+  });
 
-    moduleHandle = (HMODULE) module.modBaseAddr;
-  }
+  return worker->start();
+}
 
-  const char* errorMessage = "";
-  bool success = dll::unload(handle, &errorMessage, moduleHandle);
+Napi::Value filterPointerChainsAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-  if (strcmp(errorMessage, "") && args.Length() != 3) {
-    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
-    return Napi::Boolean::New(env, false);
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, or 5 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  if (args.Length() == 3) {
-    callback.Call(env.Global(), { Napi::String::New(env, errorMessage), Napi::Boolean::New(env, success) });
+  if (!args[0].IsNumber() || !args[1].IsString() || (!args[2].IsNumber() && !args[2].IsBigInt()) || !args[3].IsString()) {
+    Napi::Error::New(env, "expected: number, string, number or BigInt, string").ThrowAsJavaScriptException();
     return env.Null();
-  } else {
-    return Napi::Boolean::New(env, success);
   }
-}
 
-Napi::Value openFileMapping(const Napi::CallbackInfo& args) {
-  Napi::Env env = args.Env();
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string path(args[1].As<Napi::String>().Utf8Value());
+  std::string output(args[3].As<Napi::String>().Utf8Value());
 
-  std::string fileName(args[0].As<Napi::String>().Utf8Value());
+  uintptr_t address;
+  if (args[2].IsBigInt()) {
+    bool lossless;
+    address = (uintptr_t) args[2].As<Napi::BigInt>().Uint64Value(&lossless);
+  } else {
+    address = (uintptr_t) args[2].As<Napi::Number>().Int64Value();
+  }
 
-  HANDLE fileHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, fileName.c_str());
+  const char* errorMessage = "";
+  Cancellation cancellation;
 
-  if (fileHandle == NULL) {
-    Napi::Error::New(env, Napi::String::New(env, "Error opening handle to file!")).ThrowAsJavaScriptException();
+  if (!getCancellation(args, 4, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Value::From(env, (uintptr_t) fileHandle);
+  std::shared_ptr<pointerscan::FilterStats> stats = std::make_shared<pointerscan::FilterStats>();
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    pointerscan::filter(handle, path.c_str(), address, output.c_str(), stats.get(), errorMessage, cancellation.get());
+  }, [=](Napi::Env env) -> Napi::Value {
+    return toFilterStats(env, *stats);
+  });
+
+  return worker->start();
 }
 
-Napi::Value mapViewOfFile(const Napi::CallbackInfo& args) {
+#ifdef _WIN32
+Napi::Value callFunctionAsync(const Napi::CallbackInfo& args) {
   Napi::Env env = args.Env();
 
-  HANDLE processHandle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
-  HANDLE fileHandle = (HANDLE)args[1].As<Napi::Number>().Int64Value();
+  if (args.Length() != 4 && args.Length() != 5) {
+    Napi::Error::New(env, "requires 4 arguments, 5 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  uint64_t offset;
-  if (args[2].As<Napi::BigInt>().IsBigInt()) {
-    bool lossless;
-    offset = args[2].As<Napi::BigInt>().Uint64Value(&lossless);
-  } else {
-    offset = args[2].As<Napi::Number>().Int64Value();
+  if (!args[0].IsNumber() || !args[1].IsArray() || !args[2].IsNumber() || (!args[3].IsNumber() && !args[3].IsBigInt())) {
+    Napi::Error::New(env, "invalid arguments").ThrowAsJavaScriptException();
+    return env.Null();
   }
-  
-  size_t viewSize;
-  if (args[3].As<Napi::BigInt>().IsBigInt()) {
+
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  functions::Type returnType = (functions::Type) args[2].As<Napi::Number>().Uint32Value();
+
+  DWORD64 address;
+  if (args[3].IsBigInt()) {
     bool lossless;
-    viewSize = args[3].As<Napi::BigInt>().Uint64Value(&lossless);
+    address = args[3].As<Napi::BigInt>().Uint64Value(&lossless);
   } else {
-    viewSize = args[3].As<Napi::Number>().Int64Value();
+    address = args[3].As<Napi::Number>().Int64Value();
   }
 
-  ULONG pageProtection = args[4].As<Napi::Number>().Int64Value();
-
-  LPVOID baseAddress = MapViewOfFile2(fileHandle, processHandle, offset, NULL, viewSize, 0, pageProtection);
+  const char* errorMessage = "";
+  Cancellation cancellation;
 
-  if (baseAddress == NULL) {
-    Napi::Error::New(env, Napi::String::New(env, "Error mapping file to process!")).ThrowAsJavaScriptException();
+  if (!getCancellation(args, 4, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Value::From(env, (uintptr_t) baseAddress);
+  // the remote thread can't be stopped once it runs, cancelling only helps before the worker starts
+  std::shared_ptr<CallArguments> parsedArgs = std::make_shared<CallArguments>();
+  parseCallArguments(env, args[1].As<Napi::Array>(), parsedArgs.get());
+
+  std::shared_ptr<Call> data = std::make_shared<Call>();
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    *data = functions::call<int>(handle, parsedArgs->args, returnType, address, errorMessage);
+  }, [=](Napi::Env env) {
+    return toCallResult(env, returnType, *data);
+  });
+
+  return worker->start();
 }
 
-// https://stackoverflow.com/a/17387176
-std::string GetLastErrorToString() {
-  DWORD errorMessageID = ::GetLastError();
+Napi::Value injectDllAsync(const Napi::CallbackInfo& args) {
+  Napi::Env env = args.Env();
 
-  // No error message, return empty string
-  if(errorMessageID == 0) {
-    return std::string();
+  if (args.Length() != 2 && args.Length() != 3) {
+    Napi::Error::New(env, "requires 2 arguments, or 3 with a cancellation token").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  LPSTR messageBuffer = nullptr;
+  if (!args[0].IsNumber() || !args[1].IsString()) {
+    Napi::Error::New(env, "first argument needs to be a number, second argument needs to be a string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  size_t size = FormatMessageA(
-    FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-    NULL,
-    errorMessageID,
-    MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-    (LPSTR)&messageBuffer,
-    0,
-    NULL
-  );
+  HANDLE handle = (HANDLE)args[0].As<Napi::Number>().Int64Value();
+  std::string dllPath(args[1].As<Napi::String>().Utf8Value());
 
-  std::string message(messageBuffer, size);
+  const char* errorMessage = "";
+  Cancellation cancellation;
 
-  // Free the buffer
-  LocalFree(messageBuffer);
-  return message;
+  if (!getCancellation(args, 2, &cancellation, &errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<bool> success = std::make_shared<bool>(false);
+
+  PromiseWorker* worker = new PromiseWorker(env, cancellation, [=](const char** errorMessage) {
+    DWORD moduleHandle = -1;
+    *success = dll::inject(handle, dllPath, errorMessage, &moduleHandle);
+    registry::invalidateModules(platform::getProcessId(handle));
+    regionmap::invalidate(handle);
+  }, [=](Napi::Env env) {
+    return Napi::Boolean::New(env, *success);
+  });
+
+  return worker->start();
 }
+#endif
 
 Napi::Object init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "openProcess"), Napi::Function::New(env, openProcess));
@@ -1578,17 +4802,74 @@ Napi::Object init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "getModules"), Napi::Function::New(env, getModules));
   exports.Set(Napi::String::New(env, "findModule"), Napi::Function::New(env, findModule));
   exports.Set(Napi::String::New(env, "readMemory"), Napi::Function::New(env, readMemory));
+  exports.Set(Napi::String::New(env, "readString"), Napi::Function::New(env, readString));
   exports.Set(Napi::String::New(env, "readBuffer"), Napi::Function::New(env, readBuffer));
+  exports.Set(Napi::String::New(env, "readBufferInto"), Napi::Function::New(env, readBufferInto));
+  exports.Set(Napi::String::New(env, "readMemoryBatch"), Napi::Function::New(env, readMemoryBatch));
+  exports.Set(Napi::String::New(env, "watch"), Napi::Function::New(env, watch));
+  exports.Set(Napi::String::New(env, "unwatch"), Napi::Function::New(env, unwatch));
+  exports.Set(Napi::String::New(env, "compileReadPlan"), Napi::Function::New(env, compileReadPlan));
+  exports.Set(Napi::String::New(env, "executeReadPlan"), Napi::Function::New(env, executeReadPlan));
+  exports.Set(Napi::String::New(env, "registerStruct"), Napi::Function::New(env, registerStruct));
+  exports.Set(Napi::String::New(env, "readStruct"), Napi::Function::New(env, readStruct));
+  exports.Set(Napi::String::New(env, "readStructArray"), Napi::Function::New(env, readStructArray));
+  exports.Set(Napi::String::New(env, "readColumns"), Napi::Function::New(env, readColumns));
+  exports.Set(Napi::String::New(env, "enablePageCache"), Napi::Function::New(env, enablePageCache));
+  exports.Set(Napi::String::New(env, "disablePageCache"), Napi::Function::New(env, disablePageCache));
+  exports.Set(Napi::String::New(env, "clearPageCache"), Napi::Function::New(env, clearPageCache));
+  exports.Set(Napi::String::New(env, "getPageCacheStats"), Napi::Function::New(env, getPageCacheStats));
   exports.Set(Napi::String::New(env, "writeMemory"), Napi::Function::New(env, writeMemory));
   exports.Set(Napi::String::New(env, "writeBuffer"), Napi::Function::New(env, writeBuffer));
+  exports.Set(Napi::String::New(env, "compilePattern"), Napi::Function::New(env, compilePattern));
   exports.Set(Napi::String::New(env, "findPattern"), Napi::Function::New(env, findPattern));
   exports.Set(Napi::String::New(env, "findPatternByModule"), Napi::Function::New(env, findPatternByModule));
   exports.Set(Napi::String::New(env, "findPatternByAddress"), Napi::Function::New(env, findPatternByAddress));
+  exports.Set(Napi::String::New(env, "findPatterns"), Napi::Function::New(env, findPatterns));
+  exports.Set(Napi::String::New(env, "findAllPatterns"), Napi::Function::New(env, findAllPatterns));
+  exports.Set(Napi::String::New(env, "setScanThreads"), Napi::Function::New(env, setScanThreads));
+  exports.Set(Napi::String::New(env, "setProcessIndexMaxAge"), Napi::Function::New(env, setProcessIndexMaxAge));
+  exports.Set(Napi::String::New(env, "firstScan"), Napi::Function::New(env, firstScan));
+  exports.Set(Napi::String::New(env, "nextScan"), Napi::Function::New(env, nextScan));
+  exports.Set(Napi::String::New(env, "getScanCount"), Napi::Function::New(env, getScanCount));
+  exports.Set(Napi::String::New(env, "getScanResults"), Napi::Function::New(env, getScanResults));
+  exports.Set(Napi::String::New(env, "scanPointers"), Napi::Function::New(env, scanPointers));
+  exports.Set(Napi::String::New(env, "readPointerChains"), Napi::Function::New(env, readPointerChains));
+  exports.Set(Napi::String::New(env, "savePointerMap"), Napi::Function::New(env, savePointerMap));
+  exports.Set(Napi::String::New(env, "scanPointerMap"), Napi::Function::New(env, scanPointerMap));
+  exports.Set(Napi::String::New(env, "filterPointerChains"), Napi::Function::New(env, filterPointerChains));
+  exports.Set(Napi::String::New(env, "intersectPointerChains"), Napi::Function::New(env, intersectPointerChains));
+  exports.Set(Napi::String::New(env, "dumpProcess"), Napi::Function::New(env, dumpProcess));
+  exports.Set(Napi::String::New(env, "openSnapshot"), Napi::Function::New(env, openSnapshot));
+  exports.Set(Napi::String::New(env, "trackProcess"), Napi::Function::New(env, trackProcess));
+  exports.Set(Napi::String::New(env, "captureDelta"), Napi::Function::New(env, captureDelta));
+  exports.Set(Napi::String::New(env, "getRegions"), Napi::Function::New(env, getRegions));
+  exports.Set(Napi::String::New(env, "virtualQueryEx"), Napi::Function::New(env, virtualQueryEx));
+  exports.Set(Napi::String::New(env, "createDebugPump"), Napi::Function::New(env, createDebugPump));
+  exports.Set(Napi::String::New(env, "debugPumpAttach"), Napi::Function::New(env, debugPumpAttach));
+  exports.Set(Napi::String::New(env, "debugPumpDetach"), Napi::Function::New(env, debugPumpDetach));
+  exports.Set(Napi::String::New(env, "debugPumpSetBreakpoint"), Napi::Function::New(env, debugPumpSetBreakpoint));
+  exports.Set(Napi::String::New(env, "debugPumpRemoveBreakpoint"), Napi::Function::New(env, debugPumpRemoveBreakpoint));
+  exports.Set(Napi::String::New(env, "setDebugPolicy"), Napi::Function::New(env, setDebugPolicy));
+  exports.Set(Napi::String::New(env, "continueDebugEvent"), Napi::Function::New(env, continueDebugEvent));
+  exports.Set(Napi::String::New(env, "closeDebugPump"), Napi::Function::New(env, closeDebugPump));
+  exports.Set(Napi::String::New(env, "createCancellation"), Napi::Function::New(env, createCancellation));
+  exports.Set(Napi::String::New(env, "cancel"), Napi::Function::New(env, cancel));
+  exports.Set(Napi::String::New(env, "findPatternAsync"), Napi::Function::New(env, findPatternAsync));
+  exports.Set(Napi::String::New(env, "findPatternByModuleAsync"), Napi::Function::New(env, findPatternByModuleAsync));
+  exports.Set(Napi::String::New(env, "findPatternByAddressAsync"), Napi::Function::New(env, findPatternByAddressAsync));
+  exports.Set(Napi::String::New(env, "findPatternsAsync"), Napi::Function::New(env, findPatternsAsync));
+  exports.Set(Napi::String::New(env, "findAllPatternsAsync"), Napi::Function::New(env, findAllPatternsAsync));
+  exports.Set(Napi::String::New(env, "getRegionsAsync"), Napi::Function::New(env, getRegionsAsync));
+  exports.Set(Napi::String::New(env, "readBufferAsync"), Napi::Function::New(env, readBufferAsync));
+  exports.Set(Napi::String::New(env, "dumpProcessAsync"), Napi::Function::New(env, dumpProcessAsync));
+  exports.Set(Napi::String::New(env, "scanPointersAsync"), Napi::Function::New(env, scanPointersAsync));
+  exports.Set(Napi::String::New(env, "savePointerMapAsync"), Napi::Function::New(env, savePointerMapAsync));
+  exports.Set(Napi::String::New(env, "filterPointerChainsAsync"), Napi::Function::New(env, filterPointerChainsAsync));
+#ifdef _WIN32
   exports.Set(Napi::String::New(env, "virtualProtectEx"), Napi::Function::New(env, virtualProtectEx));
   exports.Set(Napi::String::New(env, "callFunction"), Napi::Function::New(env, callFunction));
+  exports.Set(Napi::String::New(env, "callFunctionAsync"), Napi::Function::New(env, callFunctionAsync));
   exports.Set(Napi::String::New(env, "virtualAllocEx"), Napi::Function::New(env, virtualAllocEx));
-  exports.Set(Napi::String::New(env, "getRegions"), Napi::Function::New(env, getRegions));
-  exports.Set(Napi::String::New(env, "virtualQueryEx"), Napi::Function::New(env, virtualQueryEx));
   exports.Set(Napi::String::New(env, "attachDebugger"), Napi::Function::New(env, attachDebugger));
   exports.Set(Napi::String::New(env, "detachDebugger"), Napi::Function::New(env, detachDebugger));
   exports.Set(Napi::String::New(env, "awaitDebugEvent"), Napi::Function::New(env, awaitDebugEvent));
@@ -1596,9 +4877,30 @@ Napi::Object init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "setHardwareBreakpoint"), Napi::Function::New(env, setHardwareBreakpoint));
   exports.Set(Napi::String::New(env, "removeHardwareBreakpoint"), Napi::Function::New(env, removeHardwareBreakpoint));
   exports.Set(Napi::String::New(env, "injectDll"), Napi::Function::New(env, injectDll));
+  exports.Set(Napi::String::New(env, "injectDllAsync"), Napi::Function::New(env, injectDllAsync));
   exports.Set(Napi::String::New(env, "unloadDll"), Napi::Function::New(env, unloadDll));
   exports.Set(Napi::String::New(env, "openFileMapping"), Napi::Function::New(env, openFileMapping));
   exports.Set(Napi::String::New(env, "mapViewOfFile"), Napi::Function::New(env, mapViewOfFile));
+#else
+  const char* windowsOnly[] = {
+    "virtualProtectEx", "callFunction", "callFunctionAsync", "virtualAllocEx", "attachDebugger", "detachDebugger",
+    "awaitDebugEvent", "handleDebugEvent", "setHardwareBreakpoint", "removeHardwareBreakpoint", "injectDll",
+    "injectDllAsync", "unloadDll", "openFileMapping", "mapViewOfFile"
+  };
+
+  for (const char* name : windowsOnly) {
+    exports.Set(Napi::String::New(env, name), Napi::Function::New(env, notSupported, name));
+  }
+#endif
+
+  // ids of every data type name, hot paths can pass them instead of the name
+  Napi::Object dataTypes = Napi::Object::New(env);
+
+  for (const auto& name : datatype::getNames()) {
+    dataTypes.Set(name.first, Napi::Value::From(env, (uint32_t) name.second));
+  }
+
+  exports.Set(Napi::String::New(env, "DataTypes"), dataTypes);
   return exports;
 }
 
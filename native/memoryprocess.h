@@ -1,9 +1,8 @@
 #pragma once
 #ifndef MEMORYPROCESS_H
 #define MEMORYPROCESS_H
-#define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
+#include "platform.h"
 
 class memoryprocess {
 
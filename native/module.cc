@@ -1,8 +1,10 @@
-#include <windows.h>
-#include <TlHelp32.h>
+#include <cstring>
 #include <vector>
 #include "module.h"
+#include "platform.h"
 #include "process.h"
+#include "registry.h"
+#include "snapshot.h"
 #include "memoryprocess.h"
 
 DWORD64 module::getBaseAddress(const char* processName, DWORD processId) {
@@ -14,18 +16,19 @@ DWORD64 module::getBaseAddress(const char* processName, DWORD processId) {
 MODULEENTRY32 module::findModule(const char* moduleName, DWORD processId, const char** errorMessage) {
   MODULEENTRY32 module;
   bool found = false;
-
-  std::vector<MODULEENTRY32> moduleEntries = getModules(processId, errorMessage);
-
-  // Loop over every module
-  for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
-    // Check to see if this is the module we want.
-    if (!strcmp(moduleEntries[i].szModule, moduleName)) {
-      // module is returned and moduleEntry is used internally for reading/writing to memory
-      module = moduleEntries[i];
-      found = true;
-      break;
+  std::vector<MODULEENTRY32> moduleEntries;
+
+  if (snapshot::getModules(processId, &moduleEntries)) {
+    for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
+      if (!strcmp(moduleEntries[i].szModule, moduleName)) {
+        module = moduleEntries[i];
+        found = true;
+        break;
+      }
     }
+  } else {
+    // modules of live processes are looked up by name in the module index
+    found = registry::findModule(processId, moduleName, &module, errorMessage);
   }
 
   if (!found) {
@@ -36,58 +39,16 @@ MODULEENTRY32 module::findModule(const char* moduleName, DWORD processId, const
 } 
 
 std::vector<MODULEENTRY32> module::getModules(DWORD processId, const char** errorMessage) {
-  // Take a snapshot of all modules inside a given process.
-  HANDLE hModuleSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, processId);
-  MODULEENTRY32 mEntry;
-
-  if (hModuleSnapshot == INVALID_HANDLE_VALUE) {
-    *errorMessage = "method failed to take snapshot of the modules";
-  }
-
-  // Before use, set the structure size.
-  mEntry.dwSize = sizeof(mEntry);
-
-  // Exit if unable to find the first module.
-  if (!Module32First(hModuleSnapshot, &mEntry)) {
-    CloseHandle(hModuleSnapshot);
-    *errorMessage = "method failed to retrieve the first module";
-  }
-
   std::vector<MODULEENTRY32> modules;
 
-  // Loop through modules.
-  do {
-    // Add the module to the vector
-    modules.push_back(mEntry);
-  } while (Module32Next(hModuleSnapshot, &mEntry));
-
-  CloseHandle(hModuleSnapshot);
+  // snapshots keep the modules loaded when they were taken
+  if (snapshot::getModules(processId, &modules)) {
+    return modules;
+  }
 
-  return modules;
+  return registry::getModules(processId, errorMessage);
 }
 
 std::vector<THREADENTRY32> module::getThreads(DWORD processId, const char** errorMessage) {
-  HANDLE hThreadSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, processId);
-  THREADENTRY32 mEntry;
-
-  if (hThreadSnapshot == INVALID_HANDLE_VALUE) {
-    *errorMessage = "method failed to take snapshot of the threads";
-  }
-
-  mEntry.dwSize = sizeof(mEntry);
-
-  if(!Thread32First(hThreadSnapshot, &mEntry)) {
-    CloseHandle(hThreadSnapshot);
-    *errorMessage = "method failed to retrieve the first thread";
-  }
-
-  std::vector<THREADENTRY32> threads;
-
-  do {
-    threads.push_back(mEntry);
-  } while (Thread32Next(hThreadSnapshot, &mEntry));
-
-  CloseHandle(hThreadSnapshot);
-
-  return threads;
+  return platform::getThreads(processId, errorMessage);
 }
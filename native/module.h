@@ -1,11 +1,9 @@
 #pragma once
 #ifndef MODULE_H
 #define MODULE_H
-#define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-#include <TlHelp32.h>
 #include <vector>
+#include "platform.h"
 
 namespace module {
   DWORD64 getBaseAddress(const char* processName, DWORD processId);
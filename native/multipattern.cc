@@ -0,0 +1,93 @@
+#include <cstring>
+#include <vector>
+#include "multipattern.h"
+#include "signature.h"
+
+void multipattern::build(Matcher* matcher, const std::vector<const signature::Signature*>& signatures) {
+  matcher->signatures = signatures;
+  matcher->anchors.assign(signatures.size(), 0);
+  matcher->pairMap.assign(65536 / 64, 0);
+  matcher->pairStart.assign(65537, 0);
+  matcher->pairEntries.clear();
+  matcher->singleEntries.clear();
+  matcher->wildcards.clear();
+  memset(matcher->singleMap, 0, sizeof(matcher->singleMap));
+  memset(matcher->singleStart, 0, sizeof(matcher->singleStart));
+
+  // bucket each signature falls into, -1 when it isn't in a pair bucket
+  std::vector<int32_t> pairKeys(signatures.size(), -1);
+  std::vector<uint32_t> pairLoad(65536, 0);
+  std::vector<uint32_t> singleLoad(256, 0);
+
+  for (uint32_t index = 0; index < signatures.size(); index++) {
+    const signature::Signature* pattern = signatures[index];
+
+    if (!pattern->significant) {
+      matcher->wildcards.push_back(index);
+      continue;
+    }
+
+    // pick the pair of consecutive significant bytes that is least common,
+    // taking into account how many signatures already share that bucket
+    bool found = false;
+    int bestScore = 0;
+
+    for (size_t i = 0; i + 1 < pattern->bytes.size(); i++) {
+      if (pattern->mask[i] == 0x00 || pattern->mask[i + 1] == 0x00) {
+        continue;
+      }
+
+      uint32_t key = pattern->bytes[i] | (uint32_t) pattern->bytes[i + 1] << 8;
+      int score = signature::frequency(pattern->bytes[i]) + signature::frequency(pattern->bytes[i + 1]) + (int) pairLoad[key] * 8;
+
+      if (!found || score < bestScore) {
+        found = true;
+        bestScore = score;
+        matcher->anchors[index] = i;
+        pairKeys[index] = (int32_t) key;
+      }
+    }
+
+    if (found) {
+      pairLoad[pairKeys[index]]++;
+    } else {
+      matcher->anchors[index] = pattern->anchor;
+      singleLoad[pattern->bytes[pattern->anchor]]++;
+    }
+  }
+
+  // lay the buckets out contiguously (prefix sums of the bucket sizes)
+  for (uint32_t key = 0; key < 65536; key++) {
+    matcher->pairStart[key + 1] = matcher->pairStart[key] + pairLoad[key];
+
+    if (pairLoad[key] != 0) {
+      matcher->pairMap[key >> 6] |= (uint64_t) 1 << (key & 63);
+    }
+  }
+
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    matcher->singleStart[byte + 1] = matcher->singleStart[byte] + singleLoad[byte];
+    matcher->singleMap[byte] = singleLoad[byte] != 0;
+  }
+
+  matcher->pairEntries.resize(matcher->pairStart[65536]);
+  matcher->singleEntries.resize(matcher->singleStart[256]);
+
+  std::vector<uint32_t> pairFill(matcher->pairStart.begin(), matcher->pairStart.end() - 1);
+  std::vector<uint32_t> singleFill(matcher->singleStart, matcher->singleStart + 256);
+
+  for (uint32_t index = 0; index < signatures.size(); index++) {
+    const signature::Signature* pattern = signatures[index];
+
+    if (!pattern->significant) {
+      continue;
+    }
+
+    if (pairKeys[index] != -1) {
+      matcher->pairEntries[pairFill[pairKeys[index]]++] = index;
+    } else {
+      unsigned char byte = pattern->bytes[pattern->anchor];
+      matcher->singleEntries[singleFill[byte]++] = index;
+    }
+  }
+}
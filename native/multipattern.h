@@ -0,0 +1,88 @@
+#pragma once
+#ifndef MULTIPATTERN_H
+#define MULTIPATTERN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "signature.h"
+
+namespace multipattern {
+  // Matches many signatures in a single pass over a buffer.
+  // Every signature is filed in a bucket keyed by one or two of its rarest
+  // significant bytes (its anchor), so each byte of the buffer costs one
+  // bitmap lookup no matter how many signatures are being searched for.
+  struct Matcher {
+    std::vector<const signature::Signature*> signatures;
+    // distance from the start of each signature to its anchor
+    std::vector<size_t> anchors;
+
+    // signatures anchored on two consecutive bytes, keyed by `byte | next << 8`
+    std::vector<uint64_t> pairMap;
+    std::vector<uint32_t> pairStart;
+    std::vector<uint32_t> pairEntries;
+
+    // signatures with no two consecutive significant bytes, keyed by a single byte
+    bool singleMap[256];
+    uint32_t singleStart[257];
+    std::vector<uint32_t> singleEntries;
+
+    // signatures made only of wildcards, they match at every offset
+    std::vector<uint32_t> wildcards;
+  };
+
+  void build(Matcher* matcher, const std::vector<const signature::Signature*>& signatures);
+
+  // Scans [begin, end) once. `onMatch(index, offset)` is called for every match
+  // in increasing offset order per signature, and returns whether the signature
+  // should keep being reported. `active[index]` disables signatures up front.
+  template <class Callback>
+  void scan(const Matcher& matcher, const unsigned char* begin, const unsigned char* end, std::vector<bool>& active, Callback onMatch) {
+    size_t size = end - begin;
+
+    for (uint32_t index : matcher.wildcards) {
+      size_t length = matcher.signatures[index]->bytes.size();
+
+      for (size_t offset = 0; active[index] && offset + length <= size; offset++) {
+        active[index] = onMatch(index, offset);
+      }
+    }
+
+    auto check = [&](uint32_t index, size_t position) {
+      if (!active[index] || position < matcher.anchors[index]) {
+        return;
+      }
+
+      size_t offset = position - matcher.anchors[index];
+      const signature::Signature* pattern = matcher.signatures[index];
+
+      if (offset + pattern->bytes.size() > size || !signature::compare(begin + offset, *pattern)) {
+        return;
+      }
+
+      active[index] = onMatch(index, offset);
+    };
+
+    for (size_t position = 0; position < size; position++) {
+      unsigned char byte = begin[position];
+
+      if (matcher.singleMap[byte]) {
+        for (uint32_t i = matcher.singleStart[byte]; i < matcher.singleStart[byte + 1]; i++) {
+          check(matcher.singleEntries[i], position);
+        }
+      }
+
+      if (position + 1 < size) {
+        uint32_t key = byte | (uint32_t) begin[position + 1] << 8;
+
+        if (matcher.pairMap[key >> 6] & ((uint64_t) 1 << (key & 63))) {
+          for (uint32_t i = matcher.pairStart[key]; i < matcher.pairStart[key + 1]; i++) {
+            check(matcher.pairEntries[i], position);
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,272 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "pagecache.h"
+#include "platform.h"
+
+namespace {
+  struct Page {
+    uintptr_t address;
+    // read-only or executable, valid until evicted
+    bool permanent;
+    uint64_t generation;
+    std::chrono::steady_clock::time_point fetched;
+    unsigned char bytes[pagecache::PAGE];
+  };
+
+  struct Cache {
+    std::mutex mutex;
+    pagecache::Options options;
+    pagecache::Stats stats;
+    // bumped by `clear`, writable pages of an older generation are stale
+    uint64_t generation;
+    // most recently used first
+    std::list<Page> pages;
+    std::unordered_map<uintptr_t, std::list<Page>::iterator> index;
+  };
+
+  // caches are shared so one being disabled while another thread reads through it stays alive
+  std::mutex cachesMutex;
+  std::unordered_map<HANDLE, std::shared_ptr<Cache>> caches;
+
+  // lets reads skip the lookup entirely while no cache is enabled
+  std::atomic<size_t> enabled(0);
+
+  std::shared_ptr<Cache> find(HANDLE handle) {
+    if (enabled.load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cachesMutex);
+
+    auto cache = caches.find(handle);
+    return cache == caches.end() ? nullptr : cache->second;
+  }
+
+  bool isValid(const Cache& cache, const Page& page, std::chrono::steady_clock::time_point now) {
+    if (page.permanent) {
+      return true;
+    }
+
+    if (cache.options.ttl < 0 || page.generation != cache.generation) {
+      return false;
+    }
+
+    return cache.options.ttl == 0 || now - page.fetched < std::chrono::milliseconds(cache.options.ttl);
+  }
+
+  // Looks a page up and marks it as the most recently used one, nullptr when missing or stale
+  Page* lookup(Cache& cache, uintptr_t address, std::chrono::steady_clock::time_point now) {
+    auto found = cache.index.find(address);
+
+    if (found == cache.index.end() || !isValid(cache, *found->second, now)) {
+      return nullptr;
+    }
+
+    cache.pages.splice(cache.pages.begin(), cache.pages, found->second);
+    return &*found->second;
+  }
+
+  void insert(Cache& cache, uintptr_t address, const unsigned char* bytes, bool permanent, std::chrono::steady_clock::time_point now) {
+    auto found = cache.index.find(address);
+
+    if (found != cache.index.end()) {
+      cache.pages.splice(cache.pages.begin(), cache.pages, found->second);
+    } else {
+      cache.pages.emplace_front();
+      cache.index[address] = cache.pages.begin();
+      cache.stats.bytes += pagecache::PAGE;
+    }
+
+    Page& page = cache.pages.front();
+    page.address = address;
+    page.permanent = permanent;
+    page.generation = cache.generation;
+    page.fetched = now;
+    memcpy(page.bytes, bytes, pagecache::PAGE);
+  }
+
+  void erase(Cache& cache, std::list<Page>::iterator page) {
+    cache.index.erase(page->address);
+    cache.pages.erase(page);
+    cache.stats.bytes -= pagecache::PAGE;
+  }
+
+  void evict(Cache& cache) {
+    while (cache.stats.bytes > cache.options.budget && !cache.pages.empty()) {
+      erase(cache, std::prev(cache.pages.end()));
+      cache.stats.evictions++;
+    }
+  }
+
+  // Copies the part of the page at `page` that overlaps [address, address + size)
+  void copy(uintptr_t page, const unsigned char* bytes, uintptr_t address, size_t size, unsigned char* buffer) {
+    uintptr_t begin = page > address ? page : address;
+    uintptr_t end = page + pagecache::PAGE < address + size ? page + pagecache::PAGE : address + size;
+
+    memcpy(buffer + (begin - address), bytes + (begin - page), end - begin);
+  }
+}
+
+void pagecache::enable(HANDLE handle, const Options& options) {
+  std::lock_guard<std::mutex> lock(cachesMutex);
+  std::shared_ptr<Cache>& cache = caches[handle];
+
+  if (!cache) {
+    cache = std::make_shared<Cache>();
+    cache->stats = { 0, 0, 0, 0, 0 };
+    cache->generation = 0;
+    enabled++;
+  }
+
+  std::lock_guard<std::mutex> guard(cache->mutex);
+  cache->options = options;
+  evict(*cache);
+}
+
+void pagecache::disable(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(cachesMutex);
+
+  if (caches.erase(handle) != 0) {
+    enabled--;
+  }
+}
+
+void pagecache::clear(HANDLE handle) {
+  std::shared_ptr<Cache> cache = find(handle);
+
+  if (!cache) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->generation++;
+
+  for (auto page = cache->pages.begin(); page != cache->pages.end();) {
+    auto next = std::next(page);
+
+    if (!page->permanent) {
+      erase(*cache, page);
+    }
+
+    page = next;
+  }
+}
+
+void pagecache::invalidate(HANDLE handle, uintptr_t address, size_t size) {
+  std::shared_ptr<Cache> cache = find(handle);
+
+  if (!cache || size == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+
+  for (uintptr_t page = address & ~(PAGE - 1); page < address + size; page += PAGE) {
+    auto found = cache->index.find(page);
+
+    if (found != cache->index.end()) {
+      erase(*cache, found->second);
+    }
+  }
+}
+
+bool pagecache::getStats(HANDLE handle, Stats* stats) {
+  std::shared_ptr<Cache> cache = find(handle);
+
+  if (!cache) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  *stats = cache->stats;
+  stats->pages = cache->index.size();
+
+  return true;
+}
+
+bool pagecache::read(HANDLE handle, uintptr_t address, void* buffer, size_t size) {
+  std::shared_ptr<Cache> cache = find(handle);
+
+  if (!cache || size == 0) {
+    return platform::readMemory(handle, address, buffer, size);
+  }
+
+  std::unique_lock<std::mutex> lock(cache->mutex);
+
+  // a range this large would only push everything else out of the cache
+  if (size > cache->options.budget / 2) {
+    lock.unlock();
+    return platform::readMemory(handle, address, buffer, size);
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  unsigned char* output = (unsigned char*) buffer;
+  uintptr_t end = address + size;
+
+  // pages missing from the cache are fetched with one read per run, kept per thread so misses don't allocate
+  thread_local std::vector<unsigned char> fetched;
+
+  for (uintptr_t page = address & ~(PAGE - 1); page < end;) {
+    Page* cached = lookup(*cache, page, now);
+
+    if (cached != nullptr) {
+      copy(page, cached->bytes, address, size, output);
+      cache->stats.hits++;
+      page += PAGE;
+      continue;
+    }
+
+    uintptr_t runEnd = page + PAGE;
+    while (runEnd < end && lookup(*cache, runEnd, now) == nullptr) {
+      runEnd += PAGE;
+    }
+
+    size_t count = (runEnd - page) / PAGE;
+    cache->stats.misses += count;
+
+    // the kernel is called without the lock held, so threads scanning other pages aren't held up
+    lock.unlock();
+
+    // asked live rather than from the region map, which can be a second old and misses
+    // remaps that keep the size of the address space, a page cached for good has to be
+    // read-only right now
+    MEMORY_BASIC_INFORMATION region = {};
+    bool known = platform::queryRegion(handle, page, &region);
+
+    fetched.resize(runEnd - page);
+    bool success = platform::readMemory(handle, page, fetched.data(), fetched.size());
+
+    lock.lock();
+
+    if (!success) {
+      return false;
+    }
+
+    // only pages of the queried region are known to share its protection
+    uintptr_t regionEnd = known ? (uintptr_t) region.BaseAddress + region.RegionSize : page;
+    bool permanent = known && (region.Protect & (PAGE_READONLY | PAGE_EXECUTE | PAGE_EXECUTE_READ)) != 0 && !(region.Protect & PAGE_GUARD);
+    bool cacheable = known && region.State == MEM_COMMIT && (permanent || cache->options.ttl >= 0);
+
+    for (size_t i = 0; i < count; i++) {
+      uintptr_t current = page + i * PAGE;
+      const unsigned char* bytes = fetched.data() + i * PAGE;
+
+      copy(current, bytes, address, size, output);
+
+      if (cacheable && current + PAGE <= regionEnd) {
+        insert(*cache, current, bytes, permanent, now);
+      }
+    }
+
+    page = runEnd;
+  }
+
+  evict(*cache);
+  return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "platform.h"
+
+// Opt-in cache of a process's memory, kept per handle and 4 KiB page.
+// Read-only and executable pages stay cached until they are evicted,
+// writable pages only when `Options::ttl` allows it. Pages are evicted
+// least recently used first once the cache grows past its byte budget.
+namespace pagecache {
+  static const size_t PAGE = 0x1000;
+
+  struct Options {
+    // bytes of pages kept at most
+    size_t budget;
+    // milliseconds writable pages stay valid, 0 to keep them until `clear`,
+    // negative to never cache them
+    int64_t ttl;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t pages;
+    size_t bytes;
+  };
+
+  void enable(HANDLE handle, const Options& options);
+  void disable(HANDLE handle);
+
+  // Drops every writable page, read-only and executable pages are kept
+  void clear(HANDLE handle);
+
+  // Drops the pages overlapping a range, called after writing to it
+  void invalidate(HANDLE handle, uintptr_t address, size_t size);
+
+  bool getStats(HANDLE handle, Stats* stats);
+
+  // Reads through the cache when it is enabled for `handle`, straight from the process otherwise.
+  // Fails unless the whole range could be read, like `platform::readMemory`.
+  bool read(HANDLE handle, uintptr_t address, void* buffer, size_t size);
+}
+
+#endif
@@ -1,102 +1,382 @@
-#include <windows.h>
-#include <TlHelp32.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include "pattern.h"
+#include "platform.h"
+#include "pagecache.h"
+#include "snapshot.h"
+#include "signature.h"
+#include "multipattern.h"
+#include "threadpool.h"
 #include "memoryprocess.h"
 #include "process.h"
 #include "memory.h"
 
-#define INRANGE(x,a,b) (x >= a && x <= b) 
-#define getBits( x ) (INRANGE(x,'0','9') ? (x - '0') : ((x&(~0x20)) - 'A' + 0xa))
-#define getByte( x ) (getBits(x[0]) << 4 | getBits(x[1]))
-
 pattern::pattern() {}
 pattern::~pattern() {}
 
+namespace {
+  // Free and reserved regions (the free tail of the address space among them) and pages that
+  // can't be read would only be split into chunks whose reads all fail
+  bool isScannable(const MEMORY_BASIC_INFORMATION& region) {
+    return region.State == MEM_COMMIT && region.Protect != 0 && (region.Protect & (PAGE_NOACCESS | PAGE_GUARD)) == 0;
+  }
+}
+
 bool pattern::search(HANDLE handle, std::vector<MEMORY_BASIC_INFORMATION> regions, DWORD64 searchAddress, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress) {
+  signature::Signature signature;
+  const char* errorMessage = "";
+
+  if (!signature::compile(pattern, &signature, &errorMessage)) {
+    return false;
+  }
+
+  return search(handle, regions, searchAddress, signature, flags, patternOffset, pAddress);
+}
+
+bool pattern::search(HANDLE handle, std::vector<MEMORY_BASIC_INFORMATION> regions, DWORD64 searchAddress, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled) {
+  std::vector<Range> ranges;
+
   for (std::vector<MEMORY_BASIC_INFORMATION>::size_type i = 0; i != regions.size(); i++) {
     uintptr_t baseAddress = (uintptr_t) regions[i].BaseAddress;
-    DWORD baseSize = regions[i].RegionSize;
+    SIZE_T baseSize = regions[i].RegionSize;
+
+    if (!isScannable(regions[i])) {
+      continue;
+    }
 
     // if `searchAddress` has been set, only pattern match if the address lies inside of this region
     if (searchAddress != 0 && (searchAddress < baseAddress || searchAddress > (baseAddress + baseSize))) {
       continue;
     }
 
-    // read memory region to pattern match inside
-    std::vector<unsigned char> regionBytes = std::vector<unsigned char>(baseSize);
-    ReadProcessMemory(handle, (LPVOID)baseAddress, &regionBytes[0], baseSize, nullptr);
-    unsigned char* byteBase = const_cast<unsigned char*>(&regionBytes.at(0));
-
-    if (findPattern(handle, baseAddress, byteBase, baseSize, pattern, flags, patternOffset, pAddress)) {
-      return true;
-    }
+    ranges.push_back({ baseAddress, baseSize });
   }
 
-  return false;
+  return searchRanges(handle, ranges, signature, flags, patternOffset, pAddress, cancelled);
 }
 
 bool pattern::search(HANDLE handle, std::vector<MODULEENTRY32> modules, DWORD64 searchAddress, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress) {
+  signature::Signature signature;
+  const char* errorMessage = "";
+
+  if (!signature::compile(pattern, &signature, &errorMessage)) {
+    return false;
+  }
+
+  return search(handle, modules, searchAddress, signature, flags, patternOffset, pAddress);
+}
+
+bool pattern::search(HANDLE handle, std::vector<MODULEENTRY32> modules, DWORD64 searchAddress, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled) {
+  std::vector<Range> ranges;
+
   for (std::vector<MODULEENTRY32>::size_type i = 0; i != modules.size(); i++) {
     uintptr_t baseAddress = (uintptr_t) modules[i].modBaseAddr;
-    DWORD baseSize = modules[i].modBaseSize;
+    SIZE_T baseSize = modules[i].modBaseSize;
 
     // if `searchAddress` has been set, only pattern match if the address lies inside of this module
     if (searchAddress != 0 && (searchAddress < baseAddress || searchAddress > (baseAddress + baseSize))) {
       continue;
     }
 
-    // read memory region occupied by the module to pattern match inside
-    std::vector<unsigned char> moduleBytes = std::vector<unsigned char>(baseSize);
-    ReadProcessMemory(handle, (LPVOID)baseAddress, &moduleBytes[0], baseSize, nullptr);
-    unsigned char* byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
+    ranges.push_back({ baseAddress, baseSize });
+  }
+
+  return searchRanges(handle, ranges, signature, flags, patternOffset, pAddress, cancelled);
+}
+
+namespace {
+  // Part of a range scanned by a single task. Matches have to start inside
+  // [baseAddress, baseAddress + size), the chunk is read with `overlap` extra
+  // bytes so matches crossing into the next chunk are still found.
+  struct Chunk {
+    uintptr_t memoryBase;
+    uintptr_t baseAddress;
+    SIZE_T size;
+    SIZE_T overlap;
+  };
+
+  std::vector<Chunk> split(const std::vector<pattern::Range>& ranges, SIZE_T patternLength) {
+    std::vector<Chunk> chunks;
+    SIZE_T overlap = patternLength > 0 ? patternLength - 1 : 0;
 
-    if (findPattern(handle, baseAddress, byteBase, baseSize, pattern, flags, patternOffset, pAddress)) {
-      return true;
+    for (auto& range : ranges) {
+      for (SIZE_T offset = 0; offset < range.baseSize; offset += pattern::CHUNK_SIZE) {
+        SIZE_T size = range.baseSize - offset < pattern::CHUNK_SIZE ? range.baseSize - offset : pattern::CHUNK_SIZE;
+        SIZE_T remaining = range.baseSize - offset - size;
+
+        chunks.push_back({ range.baseAddress, range.baseAddress + offset, size, remaining < overlap ? remaining : overlap });
+      }
     }
+
+    return chunks;
   }
 
-  return false;
-}
+  // Same order as `findPattern`: modules first, then every region that isn't part of a module
+  std::vector<pattern::Range> collect(const std::vector<MODULEENTRY32>& modules, const std::vector<MEMORY_BASIC_INFORMATION>& regions) {
+    std::vector<pattern::Range> ranges;
 
-/* based off Y3t1y3t's implementation */
-bool pattern::findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* byteBase, DWORD memorySize, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress) {
-  // uintptr_t moduleBase = (uintptr_t)module.hModule;
-  auto maxOffset = memorySize - 0x1000;
+    for (auto& module : modules) {
+      ranges.push_back({ (uintptr_t) module.modBaseAddr, module.modBaseSize });
+    }
 
-  for (uintptr_t offset = 0; offset < maxOffset; ++offset) {
-    if (compareBytes(byteBase + offset, pattern)) {
-      uintptr_t address = memoryBase + offset + patternOffset;
+    for (auto& region : regions) {
+      uintptr_t baseAddress = (uintptr_t) region.BaseAddress;
+      SIZE_T baseSize = region.RegionSize;
+      bool scanned = false;
 
-      if (flags & ST_READ) {
-        ReadProcessMemory(handle, LPCVOID(address), &address, sizeof(uintptr_t), nullptr);
+      if (!isScannable(region)) {
+        continue;
       }
 
-      if (flags & ST_SUBTRACT) {
-        address -= memoryBase;
+      for (auto& module : modules) {
+        uintptr_t moduleBase = (uintptr_t) module.modBaseAddr;
+
+        if (baseAddress >= moduleBase && baseAddress + baseSize <= moduleBase + module.modBaseSize) {
+          scanned = true;
+          break;
+        }
       }
 
-      *pAddress = address;
+      if (!scanned) {
+        ranges.push_back({ baseAddress, baseSize });
+      }
+    }
+
+    return ranges;
+  }
+
+  bool isCancelled(const std::atomic<bool>* cancelled) {
+    return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+  }
+
+  // Reads a chunk into a buffer owned by the scanning thread, so buffers are only
+  // allocated once per thread instead of once per region. Snapshots are scanned
+  // in place, the thread keeps the last one it viewed mapped.
+  const unsigned char* readChunk(HANDLE handle, const Chunk& chunk) {
+    thread_local std::shared_ptr<const void> mapping;
+    const unsigned char* view = snapshot::view(handle, chunk.baseAddress, chunk.size + chunk.overlap, &mapping);
+
+    if (view != nullptr) {
+      return view;
+    }
+
+    thread_local std::vector<unsigned char> bytes;
+    bytes.resize(chunk.size + chunk.overlap);
 
-      return true;
+    if (!pagecache::read(handle, chunk.baseAddress, bytes.data(), bytes.size())) {
+      return nullptr;
     }
+
+    return bytes.data();
   }
+}
 
-  return false;
-};
+bool pattern::searchRanges(HANDLE handle, const std::vector<Range>& ranges, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled) {
+  std::vector<Chunk> chunks = split(ranges, signature.bytes.size());
 
-bool pattern::compareBytes(const unsigned char* bytes, const char* pattern) {
-  for (; *pattern; *pattern != ' ' ? ++bytes : bytes, ++pattern) {
-    if (*pattern == ' ' || *pattern == '?') {
-      continue;
+  // lowest chunk that matched, chunks after it don't need to be scanned anymore
+  std::atomic<size_t> best(chunks.size());
+  std::vector<uintptr_t> addresses(chunks.size());
+
+  threadpool::shared().run(chunks.size(), [&](size_t index) {
+    if (index > best.load() || isCancelled(cancelled)) {
+      return;
     }
-		
-    if (*bytes != getByte(pattern)) {
-      return false;
+
+    const Chunk& chunk = chunks[index];
+    const unsigned char* bytes = readChunk(handle, chunk);
+
+    if (bytes == nullptr) {
+      return;
     }
-    
-    ++pattern;
+
+    const unsigned char* match = signature::find(bytes, bytes + chunk.size + chunk.overlap, signature);
+
+    if (match == nullptr || (SIZE_T) (match - bytes) >= chunk.size) {
+      return;
+    }
+
+    uintptr_t offset = chunk.baseAddress - chunk.memoryBase + (match - bytes);
+    addresses[index] = resolve(handle, chunk.memoryBase, offset, flags, patternOffset);
+
+    size_t current = best.load();
+    while (index < current && !best.compare_exchange_weak(current, index));
+  });
+
+  if (best.load() == chunks.size()) {
+    return false;
+  }
+
+  *pAddress = addresses[best.load()];
+  return true;
+}
+
+bool pattern::findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* byteBase, SIZE_T memorySize, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress) {
+  signature::Signature signature;
+  const char* errorMessage = "";
+
+  if (!signature::compile(pattern, &signature, &errorMessage)) {
+    return false;
+  }
+
+  return findPattern(handle, memoryBase, byteBase, memorySize, signature, flags, patternOffset, pAddress);
+}
+
+bool pattern::findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* byteBase, SIZE_T memorySize, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress) {
+  const unsigned char* match = signature::find(byteBase, byteBase + memorySize, signature);
+
+  if (match == nullptr) {
+    return false;
   }
-  
+
+  *pAddress = resolve(handle, memoryBase, match - byteBase, flags, patternOffset);
+
   return true;
-}
\ No newline at end of file
+}
+
+void pattern::searchMany(HANDLE handle, const std::vector<MODULEENTRY32>& modules, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const std::vector<Request>& requests, bool all, std::vector<std::vector<uintptr_t>>* matches, const std::atomic<bool>* cancelled) {
+  std::vector<const signature::Signature*> signatures;
+  SIZE_T longest = 0;
+
+  for (auto& request : requests) {
+    signatures.push_back(request.signature);
+    longest = request.signature->bytes.size() > longest ? request.signature->bytes.size() : longest;
+  }
+
+  multipattern::Matcher matcher;
+  multipattern::build(&matcher, signatures);
+
+  std::vector<Chunk> chunks = split(collect(modules, regions), longest);
+
+  // matches of every chunk as (signature index, address), merged in chunk order afterwards
+  std::vector<std::vector<std::pair<uint32_t, uintptr_t>>> found(chunks.size());
+
+  // lowest chunk each signature matched in, only used when looking for the first match
+  std::unique_ptr<std::atomic<size_t>[]> best(new std::atomic<size_t>[requests.size()]);
+  for (size_t i = 0; i < requests.size(); i++) {
+    best[i].store(chunks.size());
+  }
+
+  threadpool::shared().run(chunks.size(), [&](size_t index) {
+    std::vector<bool> active(requests.size(), true);
+    bool anyActive = all;
+
+    if (!all) {
+      for (size_t i = 0; i < requests.size(); i++) {
+        active[i] = best[i].load() > index;
+        anyActive = anyActive || active[i];
+      }
+    }
+
+    if (!anyActive || isCancelled(cancelled)) {
+      return;
+    }
+
+    const Chunk& chunk = chunks[index];
+    const unsigned char* bytes = readChunk(handle, chunk);
+
+    if (bytes == nullptr) {
+      return;
+    }
+
+    multipattern::scan(matcher, bytes, bytes + chunk.size + chunk.overlap, active, [&](uint32_t i, size_t offset) {
+      // matches starting in the overlap belong to the next chunk
+      if (offset >= chunk.size) {
+        return false;
+      }
+
+      const Request& request = requests[i];
+      found[index].push_back({ i, resolve(handle, chunk.memoryBase, chunk.baseAddress - chunk.memoryBase + offset, request.flags, request.patternOffset) });
+
+      if (!all) {
+        size_t current = best[i].load();
+        while (index < current && !best[i].compare_exchange_weak(current, index));
+      }
+
+      return all;
+    });
+  });
+
+  matches->assign(requests.size(), std::vector<uintptr_t>());
+
+  for (auto& chunkMatches : found) {
+    for (auto& match : chunkMatches) {
+      if (all || (*matches)[match.first].empty()) {
+        (*matches)[match.first].push_back(match.second);
+      }
+    }
+  }
+}
+
+void pattern::searchAll(HANDLE handle, const std::vector<MODULEENTRY32>& modules, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const signature::Signature& signature, short flags, uint32_t patternOffset, size_t maxResults, const std::function<bool(std::vector<uintptr_t>&)>& onMatches, const std::atomic<bool>* cancelled) {
+  std::vector<Chunk> chunks = split(collect(modules, regions), signature.bytes.size());
+
+  // chunks are scanned a window at a time so matches can be handed over in
+  // address order while the rest of the memory hasn't been read yet
+  size_t window = threadpool::shared().getThreads() * 4;
+  std::vector<std::vector<uintptr_t>> found(window);
+  size_t total = 0;
+
+  for (size_t first = 0; first < chunks.size() && !isCancelled(cancelled); first += window) {
+    size_t count = chunks.size() - first < window ? chunks.size() - first : window;
+    size_t remaining = maxResults == 0 ? SIZE_MAX : maxResults - total;
+
+    threadpool::shared().run(count, [&](size_t index) {
+      const Chunk& chunk = chunks[first + index];
+      std::vector<uintptr_t>& addresses = found[index];
+      addresses.clear();
+
+      if (isCancelled(cancelled)) {
+        return;
+      }
+
+      const unsigned char* bytes = readChunk(handle, chunk);
+
+      if (bytes == nullptr) {
+        return;
+      }
+
+      const unsigned char* end = bytes + chunk.size + chunk.overlap;
+      const unsigned char* match = signature::find(bytes, end, signature);
+
+      // no chunk can contribute more than what is left of `maxResults`
+      while (match != nullptr && (SIZE_T) (match - bytes) < chunk.size && addresses.size() < remaining) {
+        addresses.push_back(resolve(handle, chunk.memoryBase, chunk.baseAddress - chunk.memoryBase + (match - bytes), flags, patternOffset));
+        match = signature::find(match + 1, end, signature);
+      }
+    });
+
+    std::vector<uintptr_t> matches;
+
+    for (size_t i = 0; i < count && matches.size() < remaining; i++) {
+      size_t take = found[i].size() < remaining - matches.size() ? found[i].size() : remaining - matches.size();
+      matches.insert(matches.end(), found[i].begin(), found[i].begin() + take);
+    }
+
+    total += matches.size();
+
+    if (!matches.empty() && !onMatches(matches)) {
+      return;
+    }
+
+    if (maxResults != 0 && total >= maxResults) {
+      return;
+    }
+  }
+}
+
+uintptr_t pattern::resolve(HANDLE handle, uintptr_t memoryBase, uintptr_t offset, short flags, uint32_t patternOffset) {
+  uintptr_t address = memoryBase + offset + patternOffset;
+
+  if (flags & ST_READ) {
+    pagecache::read(handle, address, &address, sizeof(uintptr_t));
+  }
+
+  if (flags & ST_SUBTRACT) {
+    address -= memoryBase;
+  }
+
+  return address;
+}
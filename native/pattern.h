@@ -1,11 +1,12 @@
 #pragma once
 #ifndef PATTERN_H
 #define PATTERN_H
-#define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-#include <TlHelp32.h>
+#include <atomic>
+#include <functional>
 #include <vector>
+#include "platform.h"
+#include "signature.h"
 
 class pattern {
 public:
@@ -22,10 +23,34 @@ public:
     ST_SUBTRACT = 0x2
   };
 
+  // A signature searched for by `searchMany`, with its own flags and offset
+  struct Request {
+    const signature::Signature* signature;
+    short flags;
+    uint32_t patternOffset;
+  };
+
+  // Memory range to scan, a module or a region
+  struct Range {
+    uintptr_t baseAddress;
+    SIZE_T baseSize;
+  };
+
+  // Ranges are split into chunks of this size so they can be scanned in parallel
+  static const SIZE_T CHUNK_SIZE = 0x100000;
+
+  // Scans taking a `cancelled` flag stop reading chunks once it is set and report what they found so far
+
   bool search(HANDLE handle, std::vector<MEMORY_BASIC_INFORMATION> regions, DWORD64 searchAddress, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress);
+  bool search(HANDLE handle, std::vector<MEMORY_BASIC_INFORMATION> regions, DWORD64 searchAddress, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled = nullptr);
   bool search(HANDLE handle, std::vector<MODULEENTRY32> modules, DWORD64 searchAddress, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress);
-  bool findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* module, DWORD memorySize, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress);
-  bool compareBytes(const unsigned char* bytes, const char* pattern);
+  bool search(HANDLE handle, std::vector<MODULEENTRY32> modules, DWORD64 searchAddress, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled = nullptr);
+  bool searchRanges(HANDLE handle, const std::vector<Range>& ranges, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress, const std::atomic<bool>* cancelled = nullptr);
+  void searchMany(HANDLE handle, const std::vector<MODULEENTRY32>& modules, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const std::vector<Request>& requests, bool all, std::vector<std::vector<uintptr_t>>* matches, const std::atomic<bool>* cancelled = nullptr);
+  void searchAll(HANDLE handle, const std::vector<MODULEENTRY32>& modules, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const signature::Signature& signature, short flags, uint32_t patternOffset, size_t maxResults, const std::function<bool(std::vector<uintptr_t>&)>& onMatches, const std::atomic<bool>* cancelled = nullptr);
+  bool findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* module, SIZE_T memorySize, const char* pattern, short flags, uint32_t patternOffset, uintptr_t* pAddress);
+  bool findPattern(HANDLE handle, uintptr_t memoryBase, unsigned char* module, SIZE_T memorySize, const signature::Signature& signature, short flags, uint32_t patternOffset, uintptr_t* pAddress);
+  uintptr_t resolve(HANDLE handle, uintptr_t memoryBase, uintptr_t offset, short flags, uint32_t patternOffset);
 };
 
 #endif
@@ -0,0 +1,199 @@
+#pragma once
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <TlHelp32.h>
+#else
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+// The addon is written against the Win32 types below, other platforms get
+// the same layout so the memory/process/module layer can share its code
+
+typedef void* HANDLE;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef void* HMODULE;
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uint64_t DWORD64;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef size_t SIZE_T;
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_PATH PATH_MAX
+#define MAX_MODULE_NAME32 255
+
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_FREE 0x10000
+#define MEM_PRIVATE 0x20000
+#define MEM_MAPPED 0x40000
+#define MEM_IMAGE 0x1000000
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE 0x10
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+
+struct MEMORY_BASIC_INFORMATION {
+  PVOID BaseAddress;
+  PVOID AllocationBase;
+  DWORD AllocationProtect;
+  SIZE_T RegionSize;
+  DWORD State;
+  DWORD Protect;
+  DWORD Type;
+};
+
+struct PROCESSENTRY32 {
+  DWORD dwSize;
+  DWORD cntUsage;
+  DWORD th32ProcessID;
+  uintptr_t th32DefaultHeapID;
+  DWORD th32ModuleID;
+  DWORD cntThreads;
+  DWORD th32ParentProcessID;
+  LONG pcPriClassBase;
+  DWORD dwFlags;
+  char szExeFile[MAX_PATH];
+};
+
+struct MODULEENTRY32 {
+  DWORD dwSize;
+  DWORD th32ModuleID;
+  DWORD th32ProcessID;
+  DWORD GlblcntUsage;
+  DWORD ProccntUsage;
+  BYTE* modBaseAddr;
+  DWORD modBaseSize;
+  HMODULE hModule;
+  char szModule[MAX_MODULE_NAME32 + 1];
+  char szExePath[MAX_PATH];
+};
+
+struct THREADENTRY32 {
+  DWORD dwSize;
+  DWORD cntUsage;
+  DWORD th32ThreadID;
+  DWORD th32OwnerProcessID;
+  LONG tpBasePri;
+  LONG tpDeltaPri;
+  DWORD dwFlags;
+};
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Operating system specific part of the memory/process/module layer,
+// implemented by platform_win.cc and platform_linux.cc.
+// On Linux a process handle is the process id itself.
+namespace platform {
+  HANDLE openProcess(DWORD processId);
+  bool closeProcess(HANDLE handle);
+  DWORD getProcessId(HANDLE handle);
+
+  // Both fail unless the whole range could be read/written
+  bool readMemory(HANDLE handle, uintptr_t address, void* buffer, size_t size);
+  bool writeMemory(HANDLE handle, uintptr_t address, const void* buffer, size_t size);
+
+  // A range read as part of a batch
+  struct Read {
+    uintptr_t address;
+    void* buffer;
+    size_t size;
+  };
+
+  // Reads many ranges with as few system calls as possible,
+  // `success[i]` tells whether `reads[i]` was read in full
+  void readMemory(HANDLE handle, const std::vector<Read>& reads, std::vector<bool>* success);
+
+  // `names` receives the file backing each region, empty for anonymous memory
+  std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE handle, std::vector<std::string>* names = nullptr);
+  bool queryRegion(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region);
+
+  // Value that changes when regions are allocated or freed, so lists of regions can be kept
+  // until it does. Protection changes don't always change it. False when it can't be read.
+  bool getRegionsVersion(HANDLE handle, uint64_t* version);
+
+  // Tracks which pages of a process get written, with soft-dirty bits on Linux.
+  // `resetDirtyPages` starts over, `getDirtyPages` tells for each 4 KiB page of a range
+  // whether it was written since. Both fail where the kernel can't track writes.
+  bool resetDirtyPages(HANDLE handle);
+  bool getDirtyPages(HANDLE handle, uintptr_t address, size_t pages, std::vector<bool>* dirty);
+
+  // Stops every thread of a process so its memory holds still, false when it can't be stopped
+  // or doesn't stop in time. `resume` is set when `resumeProcess` has to be called afterwards,
+  // whether or not the process stopped, and isn't for a process that was stopped already.
+  bool suspendProcess(HANDLE handle, bool* resume);
+  void resumeProcess(HANDLE handle);
+
+  std::vector<PROCESSENTRY32> getProcesses(const char** errorMessage);
+  // Entry of a single process, false when it doesn't exist (anymore)
+  bool getProcess(DWORD processId, PROCESSENTRY32* process);
+
+  // Processes started or replaced by exec since the last call, and processes that exited,
+  // as told by the kernel (the proc connector on Linux). An exited process can still be
+  // read for a while, so it's only in `exited`. Returns false when the platform can't tell,
+  // listings then have to be compared. `overflow` is set when changes were lost.
+  bool getProcessChanges(std::vector<DWORD>* processIds, std::vector<DWORD>* exited, bool* overflow);
+
+  std::vector<MODULEENTRY32> getModules(DWORD processId, const char** errorMessage);
+  std::vector<THREADENTRY32> getThreads(DWORD processId, const char** errorMessage);
+
+  // A thread of a debugged process stopped by an exception, a signal on Linux
+  struct DebugStop {
+    DWORD processId;
+    DWORD threadId;
+    // exception code and flags, the signal and its si_code on Linux
+    DWORD code;
+    DWORD flags;
+    uintptr_t address;
+    // debug register that triggered, -1 when the stop isn't a hardware breakpoint
+    int hardwareRegister;
+    // the breakpoint Windows raises when attaching, to be continued as handled
+    bool initial;
+    // the process exited, nothing is stopped and nothing is to be continued
+    bool exited;
+    // a breakpoint hit recorded without stopping the thread, nothing is to be continued
+    bool sampled;
+  };
+
+  // Debugging. Both Windows and ptrace tie a debugged process to the thread that attached
+  // to it, every call for a process has to come from that thread. `debugWait` handles the
+  // events that aren't stops itself, a stop leaves the thread stopped until `debugContinue`,
+  // `handled` false passing the exception or signal on to the process. A process exiting is
+  // reported once, as a stop marked `exited`.
+  bool debugAttach(DWORD processId, bool killOnExit);
+  bool debugDetach(DWORD processId);
+  bool debugWait(DWORD timeout, DebugStop* stop);
+  bool debugContinue(const DebugStop& stop, bool handled);
+
+  // Hardware breakpoint in debug register `hardwareRegister` (0 to 3) of every thread of a
+  // process attached to. `trigger` is 0 to break on execution, 1 on writes and 3 on accesses,
+  // `size` in bytes. On Linux a breakpoint is a perf event per thread, opened again for every
+  // thread the process starts, that writes its hits to a ring buffer without stopping the
+  // thread; `debugWait` reports them as stops marked `sampled`.
+  bool setHardwareBreakpoint(DWORD processId, uintptr_t address, int hardwareRegister, int trigger, int size);
+  bool removeHardwareBreakpoint(DWORD processId, int hardwareRegister);
+}
+
+#endif
@@ -0,0 +1,1351 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/hw_breakpoint.h>
+#include <linux/netlink.h>
+#include <linux/perf_event.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "platform.h"
+#include "snapshot.h"
+
+namespace {
+  // A line of /proc/<pid>/maps
+  struct Mapping {
+    uintptr_t begin;
+    uintptr_t end;
+    char perms[5];
+    std::string path;
+  };
+
+  // Fields of /proc/<pid>/stat the process and thread entries are built from
+  struct Stat {
+    std::string comm;
+    char state;
+    DWORD parentId;
+    LONG priority;
+    DWORD threads;
+    unsigned long long startTime;
+    unsigned long virtualSize;
+  };
+
+  pid_t toPid(HANDLE handle) {
+    return (pid_t)(uintptr_t)handle;
+  }
+
+  bool isNumber(const char* name) {
+    if (*name == '\0') {
+      return false;
+    }
+
+    for (; *name != '\0'; name++) {
+      if (*name < '0' || *name > '9') {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool readMaps(pid_t pid, std::vector<Mapping>* mappings) {
+    std::string path = "/proc/" + std::to_string(pid) + "/maps";
+    FILE* file = fopen(path.c_str(), "r");
+
+    if (file == nullptr) {
+      return false;
+    }
+
+    char* line = nullptr;
+    size_t capacity = 0;
+
+    while (getline(&line, &capacity, file) != -1) {
+      Mapping mapping;
+      unsigned long begin, end;
+      int pathStart = 0;
+
+      // start-end perms offset dev inode [path]
+      if (sscanf(line, "%lx-%lx %4s %*x %*x:%*x %*u %n", &begin, &end, mapping.perms, &pathStart) < 3) {
+        continue;
+      }
+
+      mapping.begin = begin;
+      mapping.end = end;
+
+      if (pathStart > 0) {
+        mapping.path = line + pathStart;
+
+        while (!mapping.path.empty() && (mapping.path.back() == '\n' || mapping.path.back() == ' ')) {
+          mapping.path.pop_back();
+        }
+      }
+
+      mappings->push_back(mapping);
+    }
+
+    free(line);
+    fclose(file);
+    return true;
+  }
+
+  bool readStat(const std::string& path, Stat* stat) {
+    FILE* file = fopen(path.c_str(), "r");
+
+    if (file == nullptr) {
+      return false;
+    }
+
+    char buffer[1024];
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[length] = '\0';
+
+    // the command name is in parentheses and can itself contain spaces and parentheses
+    char* open = strchr(buffer, '(');
+    char* close = strrchr(buffer, ')');
+
+    if (open == nullptr || close == nullptr || close < open) {
+      return false;
+    }
+
+    stat->comm = std::string(open + 1, close - open - 1);
+
+    char state = 0;
+    int parentId = 0;
+    long priority = 0;
+    long threads = 0;
+    unsigned long long startTime = 0;
+    unsigned long virtualSize = 0;
+
+    // state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime cutime cstime priority nice num_threads
+    // itrealvalue starttime vsize
+    if (sscanf(close + 1, " %c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %ld %*d %ld %*d %llu %lu", &state, &parentId, &priority, &threads, &startTime, &virtualSize) != 6) {
+      return false;
+    }
+
+    stat->state = state;
+    stat->parentId = parentId;
+    stat->priority = priority;
+    stat->threads = threads;
+    stat->startTime = startTime;
+    stat->virtualSize = virtualSize;
+    return true;
+  }
+
+  const char* baseName(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+  }
+
+  // Process entry of /proc/<id>, false when the process is gone
+  bool readProcess(const char* id, PROCESSENTRY32* process) {
+    std::string path = std::string("/proc/") + id;
+    Stat stat;
+
+    if (!readStat(path + "/stat", &stat)) {
+      return false;
+    }
+
+    *process = {};
+    process->dwSize = sizeof(*process);
+    process->th32ProcessID = (DWORD)atoi(id);
+    process->cntThreads = stat.threads;
+    process->th32ParentProcessID = stat.parentId;
+    process->pcPriClassBase = stat.priority;
+
+    // `comm` is truncated to 15 characters, the executable's name isn't
+    // but can only be read for processes we are allowed to inspect
+    std::string name = stat.comm;
+    char executable[MAX_PATH];
+    ssize_t length = readlink((path + "/exe").c_str(), executable, sizeof(executable) - 1);
+
+    if (length > 0) {
+      std::string target(executable, length);
+      const char* deleted = " (deleted)";
+
+      if (target.size() > strlen(deleted) && target.compare(target.size() - strlen(deleted), std::string::npos, deleted) == 0) {
+        target.resize(target.size() - strlen(deleted));
+      }
+
+      name = baseName(target);
+    }
+
+    strncpy(process->szExeFile, name.c_str(), sizeof(process->szExeFile) - 1);
+    return true;
+  }
+
+  // Socket of the proc connector, -1 until it is opened and -2 when it can't be
+  // (it needs CAP_NET_ADMIN and the initial network namespace)
+  int connector = -1;
+  std::mutex connectorMutex;
+
+  int openConnector() {
+    int socketFd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+
+    if (socketFd < 0) {
+      return -2;
+    }
+
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+
+    alignas(nlmsghdr) char request[NLMSG_SPACE(sizeof(cn_msg) + sizeof(int))] = {};
+    nlmsghdr* header = (nlmsghdr*) request;
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(int));
+    header->nlmsg_type = NLMSG_DONE;
+
+    cn_msg* message = (cn_msg*) NLMSG_DATA(header);
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(int);
+
+    int operation = PROC_CN_MCAST_LISTEN;
+    memcpy(message->data, &operation, sizeof(operation));
+
+    if (bind(socketFd, (sockaddr*) &address, sizeof(address)) != 0 || send(socketFd, request, header->nlmsg_len, 0) < 0) {
+      close(socketFd);
+      return -2;
+    }
+
+    return socketFd;
+  }
+
+  DWORD toProtection(const char* perms) {
+    bool read = perms[0] == 'r';
+    bool write = perms[1] == 'w';
+    bool execute = perms[2] == 'x';
+
+    if (execute) {
+      return write ? PAGE_EXECUTE_READWRITE : read ? PAGE_EXECUTE_READ : PAGE_EXECUTE;
+    }
+
+    return write ? PAGE_READWRITE : read ? PAGE_READONLY : PAGE_NOACCESS;
+  }
+
+  // /proc/<pid>/mem is only used when process_vm_readv/writev can't be, it is kept
+  // open until the handle is closed since opening it costs more than a read
+  std::mutex memoryFilesMutex;
+  std::unordered_map<pid_t, int> memoryFiles;
+
+  int memoryFile(pid_t pid) {
+    std::lock_guard<std::mutex> lock(memoryFilesMutex);
+
+    auto cached = memoryFiles.find(pid);
+    if (cached != memoryFiles.end()) {
+      return cached->second;
+    }
+
+    std::string path = "/proc/" + std::to_string(pid) + "/mem";
+    int file = open(path.c_str(), O_RDWR | O_CLOEXEC);
+
+    if (file == -1) {
+      file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    if (file != -1) {
+      memoryFiles[pid] = file;
+    }
+
+    return file;
+  }
+
+  const uint64_t PAGEMAP_SOFT_DIRTY = 1ULL << 55;
+
+  bool isSoftDirty(uint64_t entry) {
+    return (entry & PAGEMAP_SOFT_DIRTY) != 0;
+  }
+
+  // Writing 4 to clear_refs clears the soft-dirty bit of every page of a process
+  bool clearSoftDirty(pid_t pid) {
+    std::string path = "/proc/" + std::to_string(pid) + "/clear_refs";
+    int file = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+
+    if (file == -1) {
+      return false;
+    }
+
+    bool success = write(file, "4", 1) == 1;
+    close(file);
+
+    return success;
+  }
+
+  // Kernels built without CONFIG_MEM_SOFT_DIRTY accept clear_refs but never set the bit,
+  // which would look like nothing ever changes. Clear this process's bits, write to a page
+  // and check that the write shows up.
+  bool supportsSoftDirty() {
+    static const bool supported = [] {
+      size_t size = (size_t)sysconf(_SC_PAGESIZE);
+      void* page = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (page == MAP_FAILED) {
+        return false;
+      }
+
+      bool result = false;
+      *(volatile char*)page = 1;
+
+      if (clearSoftDirty(getpid())) {
+        *(volatile char*)page = 2;
+
+        int file = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+        uint64_t entry = 0;
+
+        if (file != -1) {
+          result = pread(file, &entry, sizeof(entry), (off_t)((uintptr_t)page / size * sizeof(entry))) == sizeof(entry) && isSoftDirty(entry);
+          close(file);
+        }
+      }
+
+      munmap(page, size);
+      return result;
+    }();
+
+    return supported;
+  }
+}
+
+HANDLE platform::openProcess(DWORD processId) {
+  // there is nothing to open, the process only has to exist
+  if (processId == 0 || (kill((pid_t)processId, 0) != 0 && errno != EPERM)) {
+    return NULL;
+  }
+
+  return (HANDLE)(uintptr_t)processId;
+}
+
+bool platform::closeProcess(HANDLE handle) {
+  if (snapshot::close(handle)) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(memoryFilesMutex);
+
+  auto cached = memoryFiles.find(toPid(handle));
+  if (cached != memoryFiles.end()) {
+    close(cached->second);
+    memoryFiles.erase(cached);
+  }
+
+  return true;
+}
+
+DWORD platform::getProcessId(HANDLE handle) {
+  if (snapshot::isSnapshot(handle)) {
+    return (DWORD)(uintptr_t)handle;
+  }
+
+  return (DWORD)toPid(handle);
+}
+
+bool platform::readMemory(HANDLE handle, uintptr_t address, void* buffer, size_t size) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::readMemory(handle, address, buffer, size);
+  }
+
+  struct iovec local = { buffer, size };
+  struct iovec remote = { (void*)address, size };
+
+  ssize_t read = process_vm_readv(toPid(handle), &local, 1, &remote, 1, 0);
+
+  if (read == (ssize_t)size) {
+    return true;
+  }
+
+  // unmapped or unreadable memory fails here the same way it does through /proc/<pid>/mem
+  if (read != -1 || (errno != ENOSYS && errno != EPERM)) {
+    return false;
+  }
+
+  int file = memoryFile(toPid(handle));
+
+  for (size_t done = 0; done < size;) {
+    ssize_t count = pread(file, (char*)buffer + done, size - done, (off_t)(address + done));
+
+    if (count <= 0) {
+      return false;
+    }
+
+    done += count;
+  }
+
+  return true;
+}
+
+void platform::readMemory(HANDLE handle, const std::vector<Read>& reads, std::vector<bool>* success) {
+  if (snapshot::isSnapshot(handle)) {
+    success->resize(reads.size());
+
+    for (size_t i = 0; i < reads.size(); i++) {
+      (*success)[i] = snapshot::readMemory(handle, reads[i].address, reads[i].buffer, reads[i].size);
+    }
+
+    return;
+  }
+
+  success->assign(reads.size(), false);
+
+  // kept per thread so batches read over and over don't allocate
+  thread_local std::vector<struct iovec> local;
+  thread_local std::vector<struct iovec> remote;
+
+  for (size_t first = 0; first < reads.size();) {
+    size_t count = reads.size() - first < IOV_MAX ? reads.size() - first : IOV_MAX;
+
+    local.resize(count);
+    remote.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+      local[i] = { reads[first + i].buffer, reads[first + i].size };
+      remote[i] = { (void*)reads[first + i].address, reads[first + i].size };
+    }
+
+    ssize_t read = process_vm_readv(toPid(handle), local.data(), count, remote.data(), count, 0);
+
+    if (read == -1 && (errno == ENOSYS || errno == EPERM)) {
+      for (size_t i = first; i < reads.size(); i++) {
+        (*success)[i] = readMemory(handle, reads[i].address, reads[i].buffer, reads[i].size);
+      }
+
+      return;
+    }
+
+    // the process is gone, none of the ranges can be read
+    if (read == -1 && errno == ESRCH) {
+      return;
+    }
+
+    // the call stops at the first range it can't read in full, every range
+    // before it is done, the rest is retried after skipping the failing one
+    size_t left = read == -1 ? 0 : (size_t)read;
+    size_t index = first;
+
+    while (index < first + count && left >= reads[index].size) {
+      (*success)[index] = true;
+      left -= reads[index].size;
+      index++;
+    }
+
+    first = index == first + count ? index : index + 1;
+  }
+}
+
+bool platform::writeMemory(HANDLE handle, uintptr_t address, const void* buffer, size_t size) {
+  // snapshots are read-only
+  if (snapshot::isSnapshot(handle)) {
+    return false;
+  }
+
+  struct iovec local = { (void*)buffer, size };
+  struct iovec remote = { (void*)address, size };
+
+  ssize_t written = process_vm_writev(toPid(handle), &local, 1, &remote, 1, 0);
+
+  if (written == (ssize_t)size) {
+    return true;
+  }
+
+  // process_vm_writev refuses read-only pages, /proc/<pid>/mem writes through
+  // them like WriteProcessMemory does, which is what patching code relies on
+  if (written != -1) {
+    return false;
+  }
+
+  int file = memoryFile(toPid(handle));
+
+  for (size_t done = 0; done < size;) {
+    ssize_t count = pwrite(file, (const char*)buffer + done, size - done, (off_t)(address + done));
+
+    if (count <= 0) {
+      return false;
+    }
+
+    done += count;
+  }
+
+  return true;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> platform::getRegions(HANDLE handle, std::vector<std::string>* names) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::getRegions(handle, names);
+  }
+
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+  std::vector<Mapping> mappings;
+
+  if (!readMaps(toPid(handle), &mappings)) {
+    return regions;
+  }
+
+  // every mapping of a file shares the base of its first mapping, like the sections of a module
+  std::unordered_map<std::string, uintptr_t> allocationBases;
+
+  for (auto& mapping : mappings) {
+    MEMORY_BASIC_INFORMATION region;
+    bool file = !mapping.path.empty() && mapping.path[0] == '/';
+    uintptr_t allocationBase = mapping.begin;
+
+    if (file) {
+      allocationBase = allocationBases.emplace(mapping.path, mapping.begin).first->second;
+    }
+
+    region.BaseAddress = (PVOID)mapping.begin;
+    region.AllocationBase = (PVOID)allocationBase;
+    region.RegionSize = mapping.end - mapping.begin;
+    region.State = MEM_COMMIT;
+    region.Protect = toProtection(mapping.perms);
+    region.AllocationProtect = region.Protect;
+    region.Type = !file ? MEM_PRIVATE : mapping.perms[3] == 's' ? MEM_MAPPED : MEM_IMAGE;
+
+    regions.push_back(region);
+
+    if (names != nullptr) {
+      names->push_back(file ? mapping.path : std::string());
+    }
+  }
+
+  return regions;
+}
+
+bool platform::queryRegion(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::queryRegion(handle, address, region);
+  }
+
+  std::vector<MEMORY_BASIC_INFORMATION> regions = getRegions(handle);
+  uintptr_t previousEnd = 0;
+
+  for (auto& current : regions) {
+    uintptr_t begin = (uintptr_t)current.BaseAddress;
+
+    if (address < begin) {
+      // the gap between two mappings, reported as free memory like VirtualQueryEx does
+      *region = { (PVOID)previousEnd, NULL, 0, begin - previousEnd, MEM_FREE, PAGE_NOACCESS, 0 };
+      return true;
+    }
+
+    if (address < begin + current.RegionSize) {
+      *region = current;
+      return true;
+    }
+
+    previousEnd = begin + current.RegionSize;
+  }
+
+  return false;
+}
+
+bool platform::getRegionsVersion(HANDLE handle, uint64_t* version) {
+  // snapshots never change
+  if (snapshot::isSnapshot(handle)) {
+    *version = 0;
+    return true;
+  }
+
+  // the modification time of /proc/<pid>/maps never changes, the size of the address
+  // space changes with every mapping made or removed, and the start time with the process
+  Stat stat;
+
+  if (!readStat("/proc/" + std::to_string(toPid(handle)) + "/stat", &stat)) {
+    return false;
+  }
+
+  *version = (uint64_t)stat.virtualSize * 31 + stat.startTime;
+  return true;
+}
+
+namespace {
+  // longest a suspend waits for every thread to stop, in milliseconds
+  const int SUSPEND_TIMEOUT = 100;
+
+  // Whether no thread of a process runs anymore, stopped by a signal, by a tracer or exiting
+  bool isStopped(pid_t pid) {
+    std::string path = "/proc/" + std::to_string(pid) + "/task";
+    DIR* directory = opendir(path.c_str());
+
+    if (directory == nullptr) {
+      return false;
+    }
+
+    bool stopped = true;
+
+    while (struct dirent* entry = readdir(directory)) {
+      Stat stat;
+
+      // a thread gone since the listing doesn't run either
+      if (stopped && isNumber(entry->d_name) && readStat(path + "/" + entry->d_name + "/stat", &stat)) {
+        stopped = stat.state == 'T' || stat.state == 't' || stat.state == 'Z' || stat.state == 'X';
+      }
+    }
+
+    closedir(directory);
+    return stopped;
+  }
+}
+
+bool platform::suspendProcess(HANDLE handle, bool* resume) {
+  pid_t pid = toPid(handle);
+  *resume = false;
+
+  if (snapshot::isSnapshot(handle)) {
+    return true;
+  }
+
+  // stopped by someone else, it's theirs to continue
+  if (isStopped(pid)) {
+    return true;
+  }
+
+  if (kill(pid, SIGSTOP) != 0) {
+    return false;
+  }
+
+  *resume = true;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SUSPEND_TIMEOUT);
+
+  while (!isStopped(pid)) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+
+    timespec wait = { 0, 1000000 };
+    nanosleep(&wait, nullptr);
+  }
+
+  return true;
+}
+
+void platform::resumeProcess(HANDLE handle) {
+  kill(toPid(handle), SIGCONT);
+}
+
+bool platform::resetDirtyPages(HANDLE handle) {
+  return !snapshot::isSnapshot(handle) && supportsSoftDirty() && clearSoftDirty(toPid(handle));
+}
+
+bool platform::getDirtyPages(HANDLE handle, uintptr_t address, size_t pages, std::vector<bool>* dirty) {
+  if (snapshot::isSnapshot(handle) || !supportsSoftDirty()) {
+    return false;
+  }
+
+  std::string path = "/proc/" + std::to_string(toPid(handle)) + "/pagemap";
+  int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (file == -1) {
+    return false;
+  }
+
+  // pagemap has an entry per system page, which can be larger than 4 KiB
+  const size_t SOFT_DIRTY_PAGE = 0x1000;
+  size_t systemPage = (size_t)sysconf(_SC_PAGESIZE);
+  uintptr_t first = address / systemPage;
+  uintptr_t last = (address + pages * SOFT_DIRTY_PAGE - 1) / systemPage;
+
+  std::vector<uint64_t> entries(last - first + 1);
+  size_t size = entries.size() * sizeof(uint64_t);
+  bool success = true;
+
+  for (size_t done = 0; done < size;) {
+    ssize_t count = pread(file, (char*)entries.data() + done, size - done, (off_t)(first * sizeof(uint64_t) + done));
+
+    if (count <= 0) {
+      success = false;
+      break;
+    }
+
+    done += count;
+  }
+
+  close(file);
+
+  if (!success) {
+    return false;
+  }
+
+  dirty->resize(pages);
+
+  for (size_t i = 0; i < pages; i++) {
+    (*dirty)[i] = isSoftDirty(entries[(address + i * SOFT_DIRTY_PAGE) / systemPage - first]);
+  }
+
+  return true;
+}
+
+std::vector<PROCESSENTRY32> platform::getProcesses(const char** errorMessage) {
+  std::vector<PROCESSENTRY32> processes;
+  DIR* directory = opendir("/proc");
+
+  if (directory == nullptr) {
+    *errorMessage = "unable to read the list of processes from /proc";
+    return processes;
+  }
+
+  while (struct dirent* entry = readdir(directory)) {
+    PROCESSENTRY32 process;
+
+    // the process may have exited since the directory was listed
+    if (isNumber(entry->d_name) && readProcess(entry->d_name, &process)) {
+      processes.push_back(process);
+    }
+  }
+
+  closedir(directory);
+  return processes;
+}
+
+bool platform::getProcess(DWORD processId, PROCESSENTRY32* process) {
+  return readProcess(std::to_string(processId).c_str(), process);
+}
+
+bool platform::getProcessChanges(std::vector<DWORD>* processIds, std::vector<DWORD>* exited, bool* overflow) {
+  std::lock_guard<std::mutex> lock(connectorMutex);
+
+  if (connector == -1) {
+    connector = openConnector();
+  }
+
+  if (connector < 0) {
+    return false;
+  }
+
+  alignas(nlmsghdr) char buffer[8192];
+
+  while (true) {
+    ssize_t received = recv(connector, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+    if (received < 0) {
+      if (errno == ENOBUFS) {
+        // the socket's buffer filled up, events were dropped
+        *overflow = true;
+        continue;
+      }
+
+      if (errno == EINTR) {
+        continue;
+      }
+
+      break;
+    }
+
+    int length = (int) received;
+
+    for (nlmsghdr* header = (nlmsghdr*) buffer; NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+      cn_msg* message = (cn_msg*) NLMSG_DATA(header);
+
+      if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC || message->len < sizeof(proc_event)) {
+        continue;
+      }
+
+      proc_event* event = (proc_event*) message->data;
+
+      // threads start and exit too, only thread group leaders are processes
+      switch (event->what) {
+        case proc_event::PROC_EVENT_FORK:
+          if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid) {
+            processIds->push_back((DWORD) event->event_data.fork.child_tgid);
+          }
+          break;
+        case proc_event::PROC_EVENT_EXEC:
+          processIds->push_back((DWORD) event->event_data.exec.process_tgid);
+          break;
+        case proc_event::PROC_EVENT_COMM:
+          processIds->push_back((DWORD) event->event_data.comm.process_tgid);
+          break;
+        case proc_event::PROC_EVENT_EXIT:
+          // the process is still in /proc until it's reaped, earlier changes of it don't matter
+          if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+            DWORD processId = (DWORD) event->event_data.exit.process_tgid;
+            processIds->erase(std::remove(processIds->begin(), processIds->end(), processId), processIds->end());
+            exited->push_back(processId);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  return true;
+}
+
+std::vector<MODULEENTRY32> platform::getModules(DWORD processId, const char** errorMessage) {
+  std::vector<MODULEENTRY32> modules;
+  std::vector<Mapping> mappings;
+
+  if (!readMaps((pid_t)processId, &mappings)) {
+    *errorMessage = "unable to read the memory maps of the process";
+    return modules;
+  }
+
+  // a module is every mapping of an executable file (the program and its shared libraries),
+  // spanning from its lowest to its highest mapping, in the order they appear in memory
+  struct Span {
+    uintptr_t begin;
+    uintptr_t end;
+    bool executable;
+  };
+
+  std::vector<std::string> order;
+  std::unordered_map<std::string, Span> spans;
+
+  for (auto& mapping : mappings) {
+    if (mapping.path.empty() || mapping.path[0] != '/') {
+      continue;
+    }
+
+    auto found = spans.find(mapping.path);
+
+    if (found == spans.end()) {
+      order.push_back(mapping.path);
+      spans[mapping.path] = { mapping.begin, mapping.end, mapping.perms[2] == 'x' };
+      continue;
+    }
+
+    Span& span = found->second;
+    span.begin = mapping.begin < span.begin ? mapping.begin : span.begin;
+    span.end = mapping.end > span.end ? mapping.end : span.end;
+    span.executable = span.executable || mapping.perms[2] == 'x';
+  }
+
+  for (auto& path : order) {
+    Span& span = spans[path];
+
+    if (!span.executable) {
+      continue;
+    }
+
+    MODULEENTRY32 module = {};
+    module.dwSize = sizeof(module);
+    module.th32ProcessID = processId;
+    module.GlblcntUsage = 1;
+    module.ProccntUsage = 1;
+    module.modBaseAddr = (BYTE*)span.begin;
+    module.modBaseSize = (DWORD)(span.end - span.begin);
+    module.hModule = (HMODULE)span.begin;
+    strncpy(module.szModule, baseName(path), sizeof(module.szModule) - 1);
+    strncpy(module.szExePath, path.c_str(), sizeof(module.szExePath) - 1);
+
+    modules.push_back(module);
+  }
+
+  return modules;
+}
+
+std::vector<THREADENTRY32> platform::getThreads(DWORD processId, const char** errorMessage) {
+  std::vector<THREADENTRY32> threads;
+  std::vector<DWORD> processIds;
+
+  // like the Toolhelp snapshot, 0 lists the threads of every process
+  if (processId != 0) {
+    processIds.push_back(processId);
+  } else {
+    DIR* directory = opendir("/proc");
+
+    if (directory == nullptr) {
+      *errorMessage = "unable to read the list of processes from /proc";
+      return threads;
+    }
+
+    while (struct dirent* entry = readdir(directory)) {
+      if (isNumber(entry->d_name)) {
+        processIds.push_back((DWORD)atoi(entry->d_name));
+      }
+    }
+
+    closedir(directory);
+  }
+
+  for (DWORD owner : processIds) {
+    std::string path = "/proc/" + std::to_string(owner) + "/task";
+    DIR* directory = opendir(path.c_str());
+
+    if (directory == nullptr) {
+      if (processId != 0) {
+        *errorMessage = "unable to read the threads of the process";
+      }
+
+      continue;
+    }
+
+    while (struct dirent* entry = readdir(directory)) {
+      if (!isNumber(entry->d_name)) {
+        continue;
+      }
+
+      Stat stat;
+      THREADENTRY32 thread = {};
+      thread.dwSize = sizeof(thread);
+      thread.th32ThreadID = (DWORD)atoi(entry->d_name);
+      thread.th32OwnerProcessID = owner;
+
+      if (readStat(path + "/" + entry->d_name + "/stat", &stat)) {
+        thread.tpBasePri = stat.priority;
+      }
+
+      threads.push_back(thread);
+    }
+
+    closedir(directory);
+  }
+
+  return threads;
+}
+
+namespace {
+  // threads traced, with the process each one belongs to, only touched by the tracing thread
+  std::unordered_map<pid_t, pid_t> tracees;
+  // where the next wait starts looking, so a busy thread can't hide the others
+  size_t nextTracee = 0;
+
+  // Hardware breakpoint set in a process, opened again for every thread it starts
+  struct Breakpoint {
+    pid_t processId;
+    int hardwareRegister;
+    perf_event_attr attr;
+  };
+
+  // A breakpoint in one thread, a perf event writing every hit to a ring buffer
+  struct Sampler {
+    pid_t threadId;
+    pid_t processId;
+    int hardwareRegister;
+    int fd;
+    perf_event_mmap_page* ring;
+  };
+
+  // pages of every ring buffer after its header page, a power of two
+  const size_t RING_PAGES = 4;
+  // longest a detach waits for a thread to stop, in milliseconds
+  const int DETACH_TIMEOUT = 100;
+
+  std::vector<Breakpoint> breakpoints;
+  std::vector<Sampler> samplers;
+  size_t nextSampler = 0;
+
+  bool openSampler(pid_t threadId, const Breakpoint& breakpoint) {
+    int fd = (int)syscall(__NR_perf_event_open, &breakpoint.attr, threadId, -1, -1, PERF_FLAG_FD_CLOEXEC);
+
+    if (fd == -1) {
+      return false;
+    }
+
+    void* ring = mmap(nullptr, (RING_PAGES + 1) * getpagesize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (ring == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+
+    samplers.push_back({ threadId, breakpoint.processId, breakpoint.hardwareRegister, fd, (perf_event_mmap_page*)ring });
+    return true;
+  }
+
+  template <typename Predicate>
+  bool closeSamplers(Predicate matches) {
+    auto end = std::partition(samplers.begin(), samplers.end(), [&](const Sampler& sampler) { return !matches(sampler); });
+    bool closed = end != samplers.end();
+
+    for (auto sampler = end; sampler != samplers.end(); sampler++) {
+      munmap(sampler->ring, (RING_PAGES + 1) * getpagesize());
+      close(sampler->fd);
+    }
+
+    samplers.erase(end, samplers.end());
+    return closed;
+  }
+
+  // Copies bytes out of a ring buffer, wrapping around its end
+  void readRing(const Sampler& sampler, uint64_t position, void* buffer, size_t size) {
+    size_t length = RING_PAGES * getpagesize();
+    const unsigned char* data = (const unsigned char*)sampler.ring + getpagesize();
+    size_t offset = (size_t)(position & (length - 1));
+    size_t first = std::min(size, length - offset);
+
+    memcpy(buffer, data + offset, first);
+    memcpy((unsigned char*)buffer + first, data, size - first);
+  }
+
+  // Takes the next hit out of a ring buffer, skipping the other records
+  bool takeSample(const Sampler& sampler, platform::DebugStop* stop) {
+    uint64_t head = __atomic_load_n(&sampler.ring->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = sampler.ring->data_tail;
+
+    while (tail != head) {
+      perf_event_header header;
+      // PERF_SAMPLE_IP | PERF_SAMPLE_TID
+      struct { uint64_t ip; uint32_t pid; uint32_t tid; } sample;
+
+      readRing(sampler, tail, &header, sizeof(header));
+      bool found = header.type == PERF_RECORD_SAMPLE && header.size >= sizeof(header) + sizeof(sample);
+
+      if (found) {
+        readRing(sampler, tail + sizeof(header), &sample, sizeof(sample));
+      }
+
+      tail += header.size;
+      __atomic_store_n(&sampler.ring->data_tail, tail, __ATOMIC_RELEASE);
+
+      if (found) {
+        *stop = {};
+        stop->processId = (DWORD)sampler.processId;
+        stop->threadId = (DWORD)sample.tid;
+        stop->code = SIGTRAP;
+        stop->flags = TRAP_HWBKPT;
+        stop->address = (uintptr_t)sample.ip;
+        stop->hardwareRegister = sampler.hardwareRegister;
+        stop->sampled = true;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Debug register whose breakpoint stopped a thread, from the status register, which is
+  // cleared since its bits are sticky. -1 for a SIGTRAP that isn't a hardware breakpoint.
+  int takeHardwareRegister(pid_t threadId) {
+#if defined(__x86_64__) || defined(__i386__)
+    size_t offset = offsetof(struct user, u_debugreg) + 6 * sizeof(long);
+
+    errno = 0;
+    long dr6 = ptrace(PTRACE_PEEKUSER, threadId, (void*)offset, nullptr);
+
+    if (errno != 0) {
+      return -1;
+    }
+
+    for (int i = 0; i < 4; i++) {
+      if (dr6 & (1L << i)) {
+        ptrace(PTRACE_POKEUSER, threadId, (void*)offset, nullptr);
+        return i;
+      }
+    }
+#endif
+
+    return -1;
+  }
+
+  // Forgets a thread gone, true when it was the last one traced of its process
+  bool removeTracee(pid_t threadId, pid_t processId) {
+    tracees.erase(threadId);
+    closeSamplers([&](const Sampler& sampler) { return sampler.threadId == threadId; });
+
+    bool last = std::none_of(tracees.begin(), tracees.end(), [&](const std::pair<const pid_t, pid_t>& tracee) {
+      return tracee.second == processId;
+    });
+
+    if (last) {
+      breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(), [&](const Breakpoint& breakpoint) {
+        return breakpoint.processId == processId;
+      }), breakpoints.end());
+    }
+
+    return last;
+  }
+
+  // Adds the thread a traced one just started, it is traced from its start
+  void addClone(pid_t threadId, pid_t processId) {
+    unsigned long child;
+
+    if (ptrace(PTRACE_GETEVENTMSG, threadId, nullptr, &child) != 0) {
+      return;
+    }
+
+    tracees[(pid_t)child] = processId;
+
+    // the thread is stopped until its first event is seen, its breakpoints are in place
+    // before it runs anything
+    for (auto& breakpoint : breakpoints) {
+      if (breakpoint.processId == processId) {
+        openSampler((pid_t)child, breakpoint);
+      }
+    }
+  }
+}
+
+bool platform::debugAttach(DWORD processId, bool killOnExit) {
+  long options = PTRACE_O_TRACECLONE | (killOnExit ? PTRACE_O_EXITKILL : 0);
+  bool attached = false;
+
+  // threads started by a thread already traced are traced along with it,
+  // the ones started by a thread not traced yet are found listing again
+  for (bool found = true; found;) {
+    const char* errorMessage = "";
+    found = false;
+
+    for (auto& thread : getThreads(processId, &errorMessage)) {
+      pid_t threadId = (pid_t)thread.th32ThreadID;
+
+      if (tracees.count(threadId) != 0) {
+        continue;
+      }
+
+      if (ptrace(PTRACE_SEIZE, threadId, nullptr, (void*)options) == 0) {
+        tracees[threadId] = (pid_t)processId;
+        attached = found = true;
+      }
+    }
+  }
+
+  return attached;
+}
+
+bool platform::debugDetach(DWORD processId) {
+  bool detached = false;
+
+  closeSamplers([&](const Sampler& sampler) { return sampler.processId == (pid_t)processId; });
+  breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(), [&](const Breakpoint& breakpoint) {
+    return breakpoint.processId == (pid_t)processId;
+  }), breakpoints.end());
+
+  for (;;) {
+    auto thread = std::find_if(tracees.begin(), tracees.end(), [&](const std::pair<const pid_t, pid_t>& tracee) {
+      return tracee.second == (pid_t)processId;
+    });
+
+    if (thread == tracees.end()) {
+      return detached;
+    }
+
+    pid_t threadId = thread->first;
+    tracees.erase(thread);
+
+    // a thread has to be stopped to be detached from, the signal it was stopped
+    // for is still delivered unless it was one of our breakpoints
+    int signal = 0;
+    int status;
+
+    if (ptrace(PTRACE_INTERRUPT, threadId, nullptr, nullptr) != 0) {
+      continue;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DETACH_TIMEOUT);
+
+    for (;;) {
+      pid_t waited = waitpid(threadId, &status, __WALL | WNOHANG);
+
+      if (waited == 0 && std::chrono::steady_clock::now() < deadline) {
+        timespec wait = { 0, 1000000 };
+        nanosleep(&wait, nullptr);
+        continue;
+      }
+
+      // a zombie group leader never stops while other threads live, a thread that
+      // doesn't stop in time or is gone is left as it is
+      if (waited != threadId || !WIFSTOPPED(status)) {
+        break;
+      }
+
+      int event = status >> 16;
+
+      if (event == PTRACE_EVENT_CLONE) {
+        addClone(threadId, (pid_t)processId);
+        ptrace(PTRACE_CONT, threadId, nullptr, nullptr);
+        continue;
+      }
+
+      if (event == 0 && WSTOPSIG(status) != SIGTRAP) {
+        signal = WSTOPSIG(status);
+      }
+
+      detached = ptrace(PTRACE_DETACH, threadId, nullptr, (void*)(long)signal) == 0 || detached;
+      break;
+    }
+  }
+}
+
+bool platform::debugWait(DWORD timeout, DebugStop* stop) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  thread_local std::vector<std::pair<pid_t, pid_t>> threads;
+  thread_local std::vector<pollfd> rings;
+
+  // waitpid(-1) would reap children the rest of the process waits for (libuv's among them),
+  // so only the threads traced are waited for, one at a time
+  for (;;) {
+    for (size_t i = 0; i < samplers.size(); i++) {
+      if (takeSample(samplers[(nextSampler + i) % samplers.size()], stop)) {
+        nextSampler = (nextSampler + i + 1) % samplers.size();
+        return true;
+      }
+    }
+
+    siginfo_t waiting = {};
+
+    // nothing of any child is waiting most of the time, which one peek tells without going
+    // through every thread traced
+    bool idle = waitid(P_ALL, 0, &waiting, WEXITED | WSTOPPED | WNOHANG | WNOWAIT | __WALL) == 0 && waiting.si_pid == 0;
+
+    threads.clear();
+
+    if (!idle) {
+      threads.assign(tracees.begin(), tracees.end());
+    }
+
+    for (size_t i = 0; i < threads.size(); i++) {
+      pid_t threadId = threads[(nextTracee + i) % threads.size()].first;
+      pid_t processId = threads[(nextTracee + i) % threads.size()].second;
+      int status;
+
+      pid_t waited = waitpid(threadId, &status, __WALL | WNOHANG);
+      bool gone = waited == -1 && errno == ECHILD;
+
+      if (!gone && waited != threadId) {
+        continue;
+      }
+
+      if (gone || WIFEXITED(status) || WIFSIGNALED(status)) {
+        // the process exited with its last thread
+        if (removeTracee(threadId, processId)) {
+          *stop = {};
+          stop->processId = (DWORD)processId;
+          stop->hardwareRegister = -1;
+          stop->exited = true;
+          return true;
+        }
+
+        continue;
+      }
+
+      int signal = WSTOPSIG(status);
+      int event = status >> 16;
+
+      if (event == PTRACE_EVENT_CLONE) {
+        addClone(threadId, processId);
+        ptrace(PTRACE_CONT, threadId, nullptr, nullptr);
+        continue;
+      }
+
+      // a group-stop keeps the process stopped the way it was told to be, other events
+      // (a thread starting, an interruption) let the thread go on
+      if (event == PTRACE_EVENT_STOP && (signal == SIGSTOP || signal == SIGTSTP || signal == SIGTTIN || signal == SIGTTOU)) {
+        ptrace(PTRACE_LISTEN, threadId, nullptr, nullptr);
+        continue;
+      }
+
+      if (event != 0) {
+        ptrace(PTRACE_CONT, threadId, nullptr, nullptr);
+        continue;
+      }
+
+      siginfo_t info = {};
+      ptrace(PTRACE_GETSIGINFO, threadId, nullptr, &info);
+
+      stop->processId = (DWORD)processId;
+      stop->threadId = (DWORD)threadId;
+      stop->code = (DWORD)signal;
+      stop->flags = (DWORD)info.si_code;
+      stop->address = (uintptr_t)info.si_addr;
+      stop->hardwareRegister = signal == SIGTRAP ? takeHardwareRegister(threadId) : -1;
+      stop->initial = false;
+      stop->exited = false;
+      stop->sampled = false;
+
+      nextTracee = (nextTracee + i + 1) % threads.size();
+      return true;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    if (now >= deadline) {
+      return false;
+    }
+
+    // a thread stopping is noticed within a millisecond, a breakpoint hit right away
+    auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+    timespec wait = { 0, (long)std::min<long long>(left, 1000) * 1000 };
+
+    rings.clear();
+
+    for (auto& sampler : samplers) {
+      rings.push_back({ sampler.fd, POLLIN, 0 });
+    }
+
+    if (ppoll(rings.data(), rings.size(), &wait, nullptr) <= 0) {
+      continue;
+    }
+
+    // the thread of a breakpoint exited, its hits were all taken above
+    for (auto& ring : rings) {
+      if (ring.revents & POLLHUP) {
+        closeSamplers([&](const Sampler& sampler) { return sampler.fd == ring.fd; });
+      }
+    }
+  }
+}
+
+bool platform::debugContinue(const DebugStop& stop, bool handled) {
+  return ptrace(PTRACE_CONT, (pid_t)stop.threadId, nullptr, (void*)(long)(handled ? 0 : stop.code)) == 0;
+}
+
+bool platform::setHardwareBreakpoint(DWORD processId, uintptr_t address, int hardwareRegister, int trigger, int size) {
+  perf_event_attr attr = {};
+  attr.type = PERF_TYPE_BREAKPOINT;
+  attr.size = sizeof(attr);
+  attr.bp_addr = address;
+  attr.sample_period = 1;
+  attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+  attr.wakeup_events = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  if (trigger == 0) {
+    attr.bp_type = HW_BREAKPOINT_X;
+    attr.bp_len = sizeof(long);
+  } else if ((trigger == 1 || trigger == 3) && (size == 1 || size == 2 || size == 4 || size == 8)) {
+    attr.bp_type = trigger == 1 ? HW_BREAKPOINT_W : HW_BREAKPOINT_RW;
+    attr.bp_len = size;
+  } else {
+    return false;
+  }
+
+  removeHardwareBreakpoint(processId, hardwareRegister);
+
+  Breakpoint breakpoint = { (pid_t)processId, hardwareRegister, attr };
+  bool set = false;
+
+  for (auto& tracee : tracees) {
+    if (tracee.second == (pid_t)processId) {
+      set = openSampler(tracee.first, breakpoint) || set;
+    }
+  }
+
+  if (set) {
+    breakpoints.push_back(breakpoint);
+  }
+
+  return set;
+}
+
+bool platform::removeHardwareBreakpoint(DWORD processId, int hardwareRegister) {
+  breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(), [&](const Breakpoint& breakpoint) {
+    return breakpoint.processId == (pid_t)processId && breakpoint.hardwareRegister == hardwareRegister;
+  }), breakpoints.end());
+
+  return closeSamplers([&](const Sampler& sampler) {
+    return sampler.processId == (pid_t)processId && sampler.hardwareRegister == hardwareRegister;
+  });
+}
@@ -0,0 +1,427 @@
+#include <windows.h>
+#include <TlHelp32.h>
+#include <psapi.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "platform.h"
+#include "debugger.h"
+#include "snapshot.h"
+
+#pragma comment(lib, "psapi.lib")
+
+HANDLE platform::openProcess(DWORD processId) {
+  return OpenProcess(PROCESS_ALL_ACCESS, FALSE, processId);
+}
+
+bool platform::closeProcess(HANDLE handle) {
+  if (snapshot::close(handle)) {
+    return true;
+  }
+
+  return CloseHandle(handle) != 0;
+}
+
+DWORD platform::getProcessId(HANDLE handle) {
+  if (snapshot::isSnapshot(handle)) {
+    return (DWORD)(uintptr_t)handle;
+  }
+
+  return GetProcessId(handle);
+}
+
+bool platform::readMemory(HANDLE handle, uintptr_t address, void* buffer, size_t size) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::readMemory(handle, address, buffer, size);
+  }
+
+  return ReadProcessMemory(handle, (LPCVOID)address, buffer, size, NULL) != 0;
+}
+
+void platform::readMemory(HANDLE handle, const std::vector<Read>& reads, std::vector<bool>* success) {
+  if (snapshot::isSnapshot(handle)) {
+    success->resize(reads.size());
+
+    for (size_t i = 0; i < reads.size(); i++) {
+      (*success)[i] = snapshot::readMemory(handle, reads[i].address, reads[i].buffer, reads[i].size);
+    }
+
+    return;
+  }
+
+  // ranges closer than this are read together, reading the gap costs less than another call
+  const size_t MERGE_GAP = 512;
+
+  success->assign(reads.size(), false);
+
+  // kept per thread so batches read over and over don't allocate
+  thread_local std::vector<size_t> order;
+  thread_local std::vector<unsigned char> span;
+
+  order.resize(reads.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return reads[a].address < reads[b].address; });
+
+  for (size_t i = 0; i < order.size();) {
+    uintptr_t begin = reads[order[i]].address;
+    uintptr_t end = begin + reads[order[i]].size;
+    size_t next = i + 1;
+
+    while (next < order.size() && reads[order[next]].address <= end + MERGE_GAP) {
+      end = std::max(end, reads[order[next]].address + reads[order[next]].size);
+      next++;
+    }
+
+    span.resize(end - begin);
+    bool spanRead = next - i > 1 && readMemory(handle, begin, span.data(), span.size());
+
+    for (size_t j = i; j < next; j++) {
+      const Read& read = reads[order[j]];
+
+      if (spanRead) {
+        memcpy(read.buffer, span.data() + (read.address - begin), read.size);
+        (*success)[order[j]] = true;
+      } else {
+        // a lone range, or part of the span isn't readable: read the ranges one by one
+        (*success)[order[j]] = readMemory(handle, read.address, read.buffer, read.size);
+      }
+    }
+
+    i = next;
+  }
+}
+
+bool platform::writeMemory(HANDLE handle, uintptr_t address, const void* buffer, size_t size) {
+  // snapshots are read-only
+  if (snapshot::isSnapshot(handle)) {
+    return false;
+  }
+
+  return WriteProcessMemory(handle, (LPVOID)address, buffer, size, NULL) != 0;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> platform::getRegions(HANDLE handle, std::vector<std::string>* names) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::getRegions(handle, names);
+  }
+
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+
+  MEMORY_BASIC_INFORMATION region;
+  DWORD64 address;
+
+  // the regions of a module share its allocation base, its name is only looked up once
+  std::unordered_map<PVOID, std::string> moduleNames;
+
+  for (address = 0; VirtualQueryEx(handle, (LPVOID)address, &region, sizeof(region)) == sizeof(region); address += region.RegionSize) {
+    regions.push_back(region);
+
+    if (names != nullptr) {
+      if (region.State == MEM_FREE) {
+        names->push_back(std::string());
+        continue;
+      }
+
+      auto found = moduleNames.find(region.AllocationBase);
+
+      if (found == moduleNames.end()) {
+        char moduleName[MAX_PATH];
+        DWORD size = GetModuleFileNameExA(handle, (HINSTANCE)region.AllocationBase, moduleName, MAX_PATH);
+
+        found = moduleNames.emplace(region.AllocationBase, size != 0 ? std::string(moduleName, size) : std::string()).first;
+      }
+
+      names->push_back(found->second);
+    }
+  }
+
+  return regions;
+}
+
+bool platform::queryRegion(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region) {
+  if (snapshot::isSnapshot(handle)) {
+    return snapshot::queryRegion(handle, address, region);
+  }
+
+  return VirtualQueryEx(handle, (LPVOID)address, region, sizeof(*region)) == sizeof(*region);
+}
+
+bool platform::getRegionsVersion(HANDLE handle, uint64_t* version) {
+  // snapshots never change
+  if (snapshot::isSnapshot(handle)) {
+    *version = 0;
+    return true;
+  }
+
+  // the commit charge changes with every allocation committed or released,
+  // the working set would change with every page faulted in
+  PROCESS_MEMORY_COUNTERS_EX counters;
+
+  if (!GetProcessMemoryInfo(handle, (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters))) {
+    return false;
+  }
+
+  *version = counters.PrivateUsage;
+  return true;
+}
+
+// Windows only tracks writes to memory allocated with MEM_WRITE_WATCH by the process itself
+bool platform::resetDirtyPages(HANDLE handle) {
+  return false;
+}
+
+bool platform::getDirtyPages(HANDLE handle, uintptr_t address, size_t pages, std::vector<bool>* dirty) {
+  return false;
+}
+
+// Only needed around reading and clearing dirty pages, which Windows can't track
+bool platform::suspendProcess(HANDLE handle, bool* resume) {
+  *resume = false;
+  return false;
+}
+
+void platform::resumeProcess(HANDLE handle) {
+}
+
+std::vector<PROCESSENTRY32> platform::getProcesses(const char** errorMessage) {
+  // Take a snapshot of all processes.
+  HANDLE hProcessSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, NULL);
+  PROCESSENTRY32 pEntry;
+
+  if (hProcessSnapshot == INVALID_HANDLE_VALUE) {
+    *errorMessage = "method failed to take snapshot of the process";
+  }
+
+  // Before use, set the structure size.
+  pEntry.dwSize = sizeof(pEntry);
+
+  // Exit if unable to find the first process.
+  if (!Process32First(hProcessSnapshot, &pEntry)) {
+    CloseHandle(hProcessSnapshot);
+    *errorMessage = "method failed to retrieve the first process";
+  }
+
+  std::vector<PROCESSENTRY32> processes;
+
+  // Loop through processes.
+  do {
+    // Add the process to the vector
+    processes.push_back(pEntry);
+  } while (Process32Next(hProcessSnapshot, &pEntry));
+
+  CloseHandle(hProcessSnapshot);
+  return processes;
+}
+
+bool platform::getProcess(DWORD processId, PROCESSENTRY32* process) {
+  const char* errorMessage = "";
+  std::vector<PROCESSENTRY32> processes = getProcesses(&errorMessage);
+
+  for (auto& entry : processes) {
+    if (entry.th32ProcessID == processId) {
+      *process = entry;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool platform::getProcessChanges(std::vector<DWORD>* processIds, std::vector<DWORD>* exited, bool* overflow) {
+  return false;
+}
+
+std::vector<MODULEENTRY32> platform::getModules(DWORD processId, const char** errorMessage) {
+  // Take a snapshot of all modules inside a given process.
+  HANDLE hModuleSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, processId);
+  MODULEENTRY32 mEntry;
+
+  if (hModuleSnapshot == INVALID_HANDLE_VALUE) {
+    *errorMessage = "method failed to take snapshot of the modules";
+  }
+
+  // Before use, set the structure size.
+  mEntry.dwSize = sizeof(mEntry);
+
+  // Exit if unable to find the first module.
+  if (!Module32First(hModuleSnapshot, &mEntry)) {
+    CloseHandle(hModuleSnapshot);
+    *errorMessage = "method failed to retrieve the first module";
+  }
+
+  std::vector<MODULEENTRY32> modules;
+
+  // Loop through modules.
+  do {
+    // Add the module to the vector
+    modules.push_back(mEntry);
+  } while (Module32Next(hModuleSnapshot, &mEntry));
+
+  CloseHandle(hModuleSnapshot);
+
+  return modules;
+}
+
+std::vector<THREADENTRY32> platform::getThreads(DWORD processId, const char** errorMessage) {
+  HANDLE hThreadSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, processId);
+  THREADENTRY32 mEntry;
+
+  if (hThreadSnapshot == INVALID_HANDLE_VALUE) {
+    *errorMessage = "method failed to take snapshot of the threads";
+  }
+
+  mEntry.dwSize = sizeof(mEntry);
+
+  if(!Thread32First(hThreadSnapshot, &mEntry)) {
+    CloseHandle(hThreadSnapshot);
+    *errorMessage = "method failed to retrieve the first thread";
+  }
+
+  std::vector<THREADENTRY32> threads;
+
+  do {
+    threads.push_back(mEntry);
+  } while (Thread32Next(hThreadSnapshot, &mEntry));
+
+  CloseHandle(hThreadSnapshot);
+
+  return threads;
+}
+
+namespace {
+  // processes attached to whose loader breakpoint hasn't been seen yet, only touched by the debugging thread
+  std::unordered_set<DWORD> attaching;
+}
+
+bool platform::debugAttach(DWORD processId, bool killOnExit) {
+  if (DebugActiveProcess(processId) == 0) {
+    return false;
+  }
+
+  DebugSetProcessKillOnExit(killOnExit);
+  attaching.insert(processId);
+  return true;
+}
+
+bool platform::debugDetach(DWORD processId) {
+  attaching.erase(processId);
+  return DebugActiveProcessStop(processId) != 0;
+}
+
+bool platform::debugWait(DWORD timeout, DebugStop* stop) {
+  DEBUG_EVENT event = {};
+
+  if (WaitForDebugEvent(&event, timeout) == 0) {
+    return false;
+  }
+
+  if (event.dwDebugEventCode == CREATE_PROCESS_DEBUG_EVENT) {
+    CloseHandle(event.u.CreateProcessInfo.hFile);
+  }
+
+  if (event.dwDebugEventCode == LOAD_DLL_DEBUG_EVENT) {
+    CloseHandle(event.u.LoadDll.hFile);
+  }
+
+  if (event.dwDebugEventCode != EXCEPTION_DEBUG_EVENT) {
+    ContinueDebugEvent(event.dwProcessId, event.dwThreadId, DBG_CONTINUE);
+  }
+
+  if (event.dwDebugEventCode == EXIT_PROCESS_DEBUG_EVENT) {
+    attaching.erase(event.dwProcessId);
+
+    *stop = {};
+    stop->processId = event.dwProcessId;
+    stop->hardwareRegister = -1;
+    stop->exited = true;
+    return true;
+  }
+
+  if (event.dwDebugEventCode != EXCEPTION_DEBUG_EVENT) {
+    return false;
+  }
+
+  const EXCEPTION_RECORD& record = event.u.Exception.ExceptionRecord;
+
+  stop->processId = event.dwProcessId;
+  stop->threadId = event.dwThreadId;
+  stop->code = record.ExceptionCode;
+  stop->flags = record.ExceptionFlags;
+  stop->address = (uintptr_t) record.ExceptionAddress;
+  stop->hardwareRegister = -1;
+  stop->exited = false;
+  stop->sampled = false;
+
+  // STATUS_WX86_BREAKPOINT is the loader breakpoint of a 32-bit process
+  stop->initial = (record.ExceptionCode == EXCEPTION_BREAKPOINT || record.ExceptionCode == 0x4000001F) && attaching.erase(event.dwProcessId) != 0;
+
+  if (record.ExceptionCode != EXCEPTION_SINGLE_STEP) {
+    return true;
+  }
+
+  HANDLE thread = OpenThread(THREAD_GET_CONTEXT | THREAD_SET_CONTEXT, false, event.dwThreadId);
+
+  if (thread == 0) {
+    return true;
+  }
+
+  CONTEXT context = {};
+  context.ContextFlags = CONTEXT_DEBUG_REGISTERS;
+
+  if (GetThreadContext(thread, &context)) {
+    DebugRegister6 dr6;
+    dr6.Value = context.Dr6;
+
+    stop->hardwareRegister = dr6.DR0 ? 0 : dr6.DR1 ? 1 : dr6.DR2 ? 2 : dr6.DR3 ? 3 : -1;
+
+    // the status bits are sticky, left set the next hit of another register would look like this one
+    context.Dr6 = 0;
+    SetThreadContext(thread, &context);
+  }
+
+  CloseHandle(thread);
+  return true;
+}
+
+bool platform::debugContinue(const DebugStop& stop, bool handled) {
+  // an execute breakpoint faults before its instruction runs, continued as is the thread would
+  // hit it again right away. The resume flag lets the instruction run once without faulting.
+  if (handled && stop.code == EXCEPTION_SINGLE_STEP && stop.hardwareRegister != -1) {
+    HANDLE thread = OpenThread(THREAD_GET_CONTEXT | THREAD_SET_CONTEXT, false, stop.threadId);
+
+    if (thread != 0) {
+      CONTEXT context = {};
+      context.ContextFlags = CONTEXT_DEBUG_REGISTERS | CONTEXT_CONTROL;
+
+      if (GetThreadContext(thread, &context)) {
+        DebugRegister7 dr7;
+        dr7.Value = context.Dr7;
+
+        int trigger = stop.hardwareRegister == 0 ? dr7.RW0 : stop.hardwareRegister == 1 ? dr7.RW1 : stop.hardwareRegister == 2 ? dr7.RW2 : dr7.RW3;
+
+        if (trigger == 0) {
+          context.EFlags |= 0x10000;
+          SetThreadContext(thread, &context);
+        }
+      }
+
+      CloseHandle(thread);
+    }
+  }
+
+  return ContinueDebugEvent(stop.processId, stop.threadId, handled ? DBG_CONTINUE : DBG_EXCEPTION_NOT_HANDLED) != 0;
+}
+
+bool platform::setHardwareBreakpoint(DWORD processId, uintptr_t address, int hardwareRegister, int trigger, int size) {
+  // DR7 encodes the length as 0 for 1 byte, 1 for 2, 3 for 4 and 2 for 8, an execute
+  // breakpoint (trigger 0) has to have a length of 0 or it never fires
+  int length = trigger == 0 ? 0 : size == 8 ? 2 : size == 4 ? 3 : size == 2 ? 1 : 0;
+  return debugger::setHardwareBreakpoint(processId, address, (Register) hardwareRegister, trigger, length);
+}
+
+bool platform::removeHardwareBreakpoint(DWORD processId, int hardwareRegister) {
+  return debugger::setHardwareBreakpoint(processId, 0, (Register) hardwareRegister, 0, 0);
+}
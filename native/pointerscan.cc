@@ -0,0 +1,1159 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pointerscan.h"
+#include "platform.h"
+#include "module.h"
+#include "regionmap.h"
+#include "threadpool.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  const size_t BLOCK_SIZE = 0x100000;
+  const size_t PAGE = 0x1000;
+  // addresses of a level a task walks back from
+  const size_t ADDRESSES_PER_TASK = 0x400;
+  const size_t MAX_DEPTH = 16;
+  // chains followed together when filtering, every level of a batch is a single read
+  const size_t CHAINS_PER_BATCH = 0x10000;
+
+  const char MAGIC[8] = { 'M', 'P', 'P', 'T', 'R', 'S', '\r', '\n' };
+  const uint32_t VERSION = 1;
+
+  const char MAP_MAGIC[8] = { 'M', 'P', 'P', 'M', 'A', 'P', '\r', '\n' };
+  const uint32_t MAP_VERSION = 1;
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointerSize;
+    uint32_t maxDepth;
+    // bytes of every chain record
+    uint32_t stride;
+    uint64_t moduleCount;
+    uint64_t stringsSize;
+    uint64_t chainCount;
+    // address the chains lead to in the process scanned
+    uint64_t target;
+  };
+
+  struct FileModule {
+    // offset of the module's name in the string table
+    uint32_t name;
+    uint32_t length;
+  };
+
+  // Followed by `maxDepth + 1` offsets, the unused ones set to 0
+  struct FileChain {
+    uint32_t module;
+    uint32_t count;
+  };
+
+  struct MapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointerSize;
+    uint64_t moduleCount;
+    uint64_t stringsSize;
+    uint64_t pointerCount;
+  };
+
+  struct MapModule {
+    uint64_t baseAddress;
+    uint64_t size;
+    uint32_t name;
+    uint32_t length;
+  };
+
+  // A file mapped read-only, unmapped along with its last reference
+  struct MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() {
+      if (data == nullptr) {
+        return;
+      }
+
+#ifdef _WIN32
+      UnmapViewOfFile(data);
+#else
+      munmap((void*) data, size);
+#endif
+    }
+  };
+
+  // A mapped chain file, its header and module table checked
+  struct ChainFile {
+    std::shared_ptr<const MappedFile> file;
+    FileHeader header;
+    std::vector<std::string> modules;
+    const unsigned char* records;
+
+    const unsigned char* getRecord(uint64_t index) const {
+      return records + index * header.stride;
+    }
+
+    // false for a record that is corrupt
+    bool get(uint64_t index, FileChain* chain, const int32_t** offsets) const {
+      const unsigned char* record = getRecord(index);
+
+      memcpy(chain, record, sizeof(*chain));
+      *offsets = (const int32_t*) (record + sizeof(*chain));
+
+      return chain->module < modules.size() && chain->count >= 2 && chain->count <= header.maxDepth + 1;
+    }
+  };
+
+  struct Range {
+    uintptr_t begin;
+    uintptr_t end;
+  };
+
+  // Part of a writable region read by a single task
+  struct Block {
+    uintptr_t address;
+    size_t size;
+    // bytes read, `size` plus room for a pointer starting at its end
+    size_t length;
+  };
+
+  // A pointer leading to an address of the previous level
+  struct Edge {
+    uint64_t address;
+    uint32_t target;
+    uint32_t offset;
+  };
+
+  // Addresses of a level, ascending, along with the edges leading from each of them to
+  // addresses of the previous level: the edges of address i are [first[i], first[i + 1])
+  struct Level {
+    std::vector<uint64_t> addresses;
+    std::vector<int32_t> modules;
+    std::vector<size_t> first;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> offsets;
+
+    size_t getSize() const {
+      return addresses.size() * (sizeof(uint64_t) + sizeof(int32_t) + sizeof(size_t)) + targets.size() * 2 * sizeof(uint32_t);
+    }
+  };
+
+  bool isReadable(const MEMORY_BASIC_INFORMATION& region) {
+    return region.State == MEM_COMMIT && !(region.Protect & PAGE_GUARD)
+      && (region.Protect & (PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+  }
+
+  bool isWritable(const MEMORY_BASIC_INFORMATION& region) {
+    return region.State == MEM_COMMIT && !(region.Protect & PAGE_GUARD)
+      && (region.Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+  }
+
+  bool contains(const std::vector<Range>& ranges, uint64_t address) {
+    auto next = std::upper_bound(ranges.begin(), ranges.end(), address, [](uint64_t address, const Range& range) {
+      return address < range.begin;
+    });
+
+    return next != ranges.begin() && address < (next - 1)->end;
+  }
+
+  // Module an address is stored in, -1 for none
+  int32_t findModule(const std::vector<MODULEENTRY32>& modules, uint64_t address) {
+    auto next = std::upper_bound(modules.begin(), modules.end(), address, [](uint64_t address, const MODULEENTRY32& module) {
+      return address < (uintptr_t) module.modBaseAddr;
+    });
+
+    if (next == modules.begin()) {
+      return -1;
+    }
+
+    const MODULEENTRY32& module = *(next - 1);
+    return address < (uintptr_t) module.modBaseAddr + module.modBaseSize ? (int32_t) (next - 1 - modules.begin()) : -1;
+  }
+
+  // Reads a block, pages that can't be read are left as zeroes, which never point anywhere readable
+  void readBlock(HANDLE handle, const Block& block, unsigned char* buffer) {
+    if (platform::readMemory(handle, block.address, buffer, block.length)) {
+      return;
+    }
+
+    for (size_t offset = 0; offset < block.length; offset += PAGE) {
+      size_t length = block.length - offset < PAGE ? block.length - offset : PAGE;
+
+      if (!platform::readMemory(handle, block.address + offset, buffer + offset, length)) {
+        memset(buffer + offset, 0, length);
+      }
+    }
+  }
+
+  // Sorts the parts produced by every task on the shared pool, then merges them two at a time
+  template <class T, class Less>
+  void sortParts(std::vector<std::vector<T>>& parts, std::vector<T>* sorted, Less less) {
+    threadpool& pool = threadpool::shared();
+
+    pool.run(parts.size(), [&](size_t i) {
+      std::sort(parts[i].begin(), parts[i].end(), less);
+    });
+
+    while (parts.size() > 1) {
+      std::vector<std::vector<T>> merged((parts.size() + 1) / 2);
+
+      pool.run(merged.size(), [&](size_t i) {
+        if (2 * i + 1 == parts.size()) {
+          merged[i].swap(parts[2 * i]);
+          return;
+        }
+
+        std::vector<T>& left = parts[2 * i];
+        std::vector<T>& right = parts[2 * i + 1];
+
+        merged[i].resize(left.size() + right.size());
+        std::merge(left.begin(), left.end(), right.begin(), right.end(), merged[i].begin(), less);
+
+        std::vector<T>().swap(left);
+        std::vector<T>().swap(right);
+      });
+
+      parts.swap(merged);
+    }
+
+    sorted->clear();
+
+    if (!parts.empty()) {
+      sorted->swap(parts[0]);
+    }
+  }
+
+  // Maps a whole file of at least `minimum` bytes read-only
+  std::shared_ptr<const MappedFile> mapFile(const char* path, size_t minimum) {
+    std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE) {
+      return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= (LONGLONG) minimum) {
+      mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+
+    CloseHandle(file);
+
+    if (mapping == NULL) {
+      return nullptr;
+    }
+
+    // the view keeps the mapping alive once its handle is closed
+    mapped->data = (const unsigned char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    mapped->size = (size_t) fileSize.QuadPart;
+    CloseHandle(mapping);
+#else
+    int file = ::open(path, O_RDONLY);
+
+    if (file == -1) {
+      return nullptr;
+    }
+
+    struct stat info;
+    void* data = MAP_FAILED;
+
+    if (fstat(file, &info) == 0 && info.st_size >= (off_t) minimum && info.st_size > 0) {
+      data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    ::close(file);
+
+    mapped->data = data == MAP_FAILED ? nullptr : (const unsigned char*) data;
+    mapped->size = (size_t) info.st_size;
+#endif
+
+    if (mapped->data == nullptr) {
+      return nullptr;
+    }
+
+    return mapped;
+  }
+
+  // Whether two paths name the same existing file, however they are spelled. Writing a chain
+  // file over one that is mapped would truncate it under the reader.
+  bool isSameFile(const char* path, const char* other) {
+#ifdef _WIN32
+    BY_HANDLE_FILE_INFORMATION information[2];
+    const char* paths[2] = { path, other };
+
+    for (int i = 0; i < 2; i++) {
+      HANDLE file = CreateFileA(paths[i], 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+      if (file == INVALID_HANDLE_VALUE) {
+        return false;
+      }
+
+      bool found = GetFileInformationByHandle(file, &information[i]);
+      CloseHandle(file);
+
+      if (!found) {
+        return false;
+      }
+    }
+
+    return information[0].dwVolumeSerialNumber == information[1].dwVolumeSerialNumber
+      && information[0].nFileIndexHigh == information[1].nFileIndexHigh
+      && information[0].nFileIndexLow == information[1].nFileIndexLow;
+#else
+    struct stat first;
+    struct stat second;
+
+    return stat(path, &first) == 0 && stat(other, &second) == 0 && first.st_dev == second.st_dev && first.st_ino == second.st_ino;
+#endif
+  }
+
+  bool openChains(const char* path, ChainFile* chains, const char** errorMessage) {
+    chains->file = mapFile(path, sizeof(FileHeader));
+
+    if (chains->file == nullptr) {
+      *errorMessage = "unable to open the pointer scan file";
+      return false;
+    }
+
+    const unsigned char* data = chains->file->data;
+    uint64_t size = chains->file->size;
+    FileHeader& header = chains->header;
+
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.maxDepth == 0 || header.maxDepth > MAX_DEPTH
+      || header.stride != sizeof(FileChain) + (header.maxDepth + 1) * sizeof(int32_t)) {
+      *errorMessage = "not a pointer scan file";
+      return false;
+    }
+
+    // every count is checked against the size on its own first so the total can't overflow
+    bool valid = header.moduleCount <= size / sizeof(FileModule) && header.stringsSize <= size && header.chainCount <= size / header.stride
+      && sizeof(header) + header.moduleCount * sizeof(FileModule) + header.stringsSize + header.chainCount * header.stride <= size;
+
+    const FileModule* table = (const FileModule*) (data + sizeof(header));
+    const char* strings = (const char*) (table + (valid ? header.moduleCount : 0));
+
+    for (uint64_t i = 0; valid && i < header.moduleCount; i++) {
+      valid = (uint64_t) table[i].name + table[i].length <= header.stringsSize;
+
+      if (valid) {
+        chains->modules.push_back(std::string(strings + table[i].name, table[i].length));
+      }
+    }
+
+    if (!valid) {
+      *errorMessage = "the pointer scan file is truncated or corrupt";
+      return false;
+    }
+
+    chains->records = (const unsigned char*) strings + header.stringsSize;
+    return true;
+  }
+
+  // Creates a chain file and writes everything but the chains. `header` only needs the pointer
+  // size, the depth and the target, the rest is filled in.
+  FILE* createChains(const char* path, FileHeader* header, const std::vector<std::string>& modules, bool* written) {
+    FILE* file = fopen(path, "wb");
+
+    if (file == nullptr) {
+      return nullptr;
+    }
+
+    memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->stride = (uint32_t) (sizeof(FileChain) + (header->maxDepth + 1) * sizeof(int32_t));
+    header->moduleCount = modules.size();
+    header->chainCount = 0;
+
+    std::vector<FileModule> table;
+    std::string strings;
+
+    for (auto& module : modules) {
+      table.push_back({ (uint32_t) strings.size(), (uint32_t) module.size() });
+      strings.append(module);
+    }
+
+    // chain records start 8 byte aligned
+    strings.resize((strings.size() + 7) & ~(size_t) 7);
+    header->stringsSize = strings.size();
+
+    *written = fwrite(header, sizeof(*header), 1, file) == 1
+      && (table.empty() || fwrite(table.data(), sizeof(FileModule), table.size(), file) == table.size())
+      && fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+
+    return file;
+  }
+
+  // Writes the header again with the number of chains written, and closes the file
+  bool finishChains(FILE* file, FileHeader* header, uint64_t chains, bool written) {
+    header->chainCount = chains;
+    written = written && fseek(file, 0, SEEK_SET) == 0 && fwrite(header, sizeof(*header), 1, file) == 1;
+    return fclose(file) == 0 && written;
+  }
+
+  // Walks back from the addresses of `previous` that aren't in a module
+  bool walkBack(const pointerscan::Map& map, const Level& previous, size_t maxOffset, size_t budget, Level* level, const std::atomic<bool>* cancelled) {
+    std::vector<uint32_t> sources;
+
+    for (size_t i = 0; i < previous.addresses.size(); i++) {
+      if (previous.modules[i] < 0) {
+        sources.push_back((uint32_t) i);
+      }
+    }
+
+    size_t tasks = (sources.size() + ADDRESSES_PER_TASK - 1) / ADDRESSES_PER_TASK;
+    std::vector<std::vector<Edge>> parts(tasks);
+    std::atomic<size_t> edges(0);
+    std::atomic<bool> exceeded(false);
+
+    threadpool::shared().run(tasks, [&](size_t task) {
+      std::vector<Edge>& part = parts[task];
+      size_t end = std::min(sources.size(), (task + 1) * ADDRESSES_PER_TASK);
+
+      for (size_t i = task * ADDRESSES_PER_TASK; i < end; i++) {
+        if (exceeded.load(std::memory_order_relaxed) || (cancelled != nullptr && cancelled->load())) {
+          return;
+        }
+
+        uint64_t address = previous.addresses[sources[i]];
+        uint64_t lowest = address > maxOffset ? address - maxOffset : 0;
+
+        const pointerscan::Pointer* pointers = map.pointers;
+        const pointerscan::Pointer* last = map.pointers + map.pointerCount;
+
+        auto pointer = std::lower_bound(pointers, last, lowest, [](const pointerscan::Pointer& pointer, uint64_t value) {
+          return pointer.value < value;
+        });
+
+        size_t found = part.size();
+
+        for (; pointer != last && pointer->value <= address; ++pointer) {
+          part.push_back({ pointer->address, sources[i], (uint32_t) (address - pointer->value) });
+        }
+
+        if ((edges += part.size() - found) * sizeof(Edge) > budget) {
+          exceeded = true;
+        }
+      }
+    });
+
+    if (exceeded || (cancelled != nullptr && cancelled->load())) {
+      return false;
+    }
+
+    std::vector<Edge> sorted;
+    sortParts(parts, &sorted, [](const Edge& left, const Edge& right) {
+      return left.address != right.address ? left.address < right.address : left.target < right.target;
+    });
+
+    level->targets.reserve(sorted.size());
+    level->offsets.reserve(sorted.size());
+
+    for (size_t i = 0; i < sorted.size(); i++) {
+      if (i == 0 || sorted[i].address != sorted[i - 1].address) {
+        level->addresses.push_back(sorted[i].address);
+        level->modules.push_back(findModule(map.modules, sorted[i].address));
+        level->first.push_back(i);
+      }
+
+      level->targets.push_back(sorted[i].target);
+      level->offsets.push_back(sorted[i].offset);
+    }
+
+    level->first.push_back(sorted.size());
+    return level->getSize() <= budget;
+  }
+
+  // Writes the chains starting at addresses stored in a module, following their edges
+  // down to the target depth first
+  struct Writer {
+    FILE* file;
+    const std::vector<Level>& levels;
+    const std::vector<MODULEENTRY32>& modules;
+    size_t maxResults;
+    size_t stride;
+    // offsets of the chain being followed, from its start
+    std::vector<int32_t> offsets;
+    std::vector<unsigned char> record;
+    FileChain chain;
+    uint64_t chains;
+    bool written;
+
+    bool isFull() const {
+      return !written || (maxResults != 0 && chains >= maxResults);
+    }
+
+    void start(size_t depth, size_t index) {
+      const Level& level = levels[depth];
+      const MODULEENTRY32& module = modules[level.modules[index]];
+      uint64_t offset = level.addresses[index] - (uintptr_t) module.modBaseAddr;
+
+      if (offset > (uint64_t) std::numeric_limits<int32_t>::max()) {
+        return;
+      }
+
+      chain.module = (uint32_t) level.modules[index];
+      offsets.assign(1, (int32_t) offset);
+      walk(depth, index);
+    }
+
+    void walk(size_t depth, size_t index) {
+      if (depth == 0) {
+        write();
+        return;
+      }
+
+      const Level& level = levels[depth];
+
+      for (size_t edge = level.first[index]; edge < level.first[index + 1] && !isFull(); edge++) {
+        offsets.push_back((int32_t) level.offsets[edge]);
+        walk(depth - 1, level.targets[edge]);
+        offsets.pop_back();
+      }
+    }
+
+    void write() {
+      chain.count = (uint32_t) offsets.size();
+
+      record.assign(stride, 0);
+      memcpy(record.data(), &chain, sizeof(chain));
+      memcpy(record.data() + sizeof(chain), offsets.data(), offsets.size() * sizeof(int32_t));
+
+      written = fwrite(record.data(), 1, stride, file) == stride;
+      chains++;
+    }
+  };
+}
+
+bool pointerscan::validate(const Options& options, const char** errorMessage) {
+  if (options.pointerSize != 4 && options.pointerSize != 8) {
+    *errorMessage = "pointer size must be 4 or 8";
+    return false;
+  }
+
+  if (options.alignment == 0 || options.alignment > PAGE || (options.alignment & (options.alignment - 1)) != 0) {
+    *errorMessage = "alignment must be a power of two";
+    return false;
+  }
+
+  if (options.maxDepth == 0 || options.maxDepth > MAX_DEPTH) {
+    *errorMessage = "maximum depth must be between 1 and 16";
+    return false;
+  }
+
+  if (options.maxOffset > (size_t) std::numeric_limits<int32_t>::max()) {
+    *errorMessage = "maximum offset must fit in 31 bits";
+    return false;
+  }
+
+  return true;
+}
+
+bool pointerscan::buildMap(HANDLE handle, const Options& options, Map* map, const char** errorMessage, const std::atomic<bool>* cancelled) {
+  if (!validate(options, errorMessage)) {
+    return false;
+  }
+
+  const char* moduleError = "";
+  map->pointerSize = options.pointerSize;
+  map->pointers = nullptr;
+  map->pointerCount = 0;
+  map->storage.clear();
+  map->file.reset();
+  map->path.clear();
+  map->modules = module::getModules(platform::getProcessId(handle), &moduleError);
+
+  if (strcmp(moduleError, "")) {
+    *errorMessage = moduleError;
+    return false;
+  }
+
+  std::sort(map->modules.begin(), map->modules.end(), [](const MODULEENTRY32& left, const MODULEENTRY32& right) {
+    return (uintptr_t) left.modBaseAddr < (uintptr_t) right.modBaseAddr;
+  });
+
+  // pointers are kept when they point into a readable region
+  std::vector<Range> readable;
+  std::vector<Block> blocks;
+
+  for (auto& region : regionmap::getRegions(handle)) {
+    uintptr_t base = (uintptr_t) region.BaseAddress;
+
+    if (isReadable(region)) {
+      if (!readable.empty() && readable.back().end == base) {
+        readable.back().end += region.RegionSize;
+      } else {
+        readable.push_back({ base, base + region.RegionSize });
+      }
+    }
+
+    if (!isWritable(region)) {
+      continue;
+    }
+
+    for (size_t offset = 0; offset < region.RegionSize; offset += BLOCK_SIZE) {
+      size_t size = region.RegionSize - offset < BLOCK_SIZE ? region.RegionSize - offset : BLOCK_SIZE;
+      size_t remaining = region.RegionSize - offset - size;
+      size_t overlap = options.pointerSize - 1 < remaining ? options.pointerSize - 1 : remaining;
+
+      blocks.push_back({ base + offset, size, size + overlap });
+    }
+  }
+
+  if (readable.empty()) {
+    return true;
+  }
+
+  uint64_t lowest = readable.front().begin;
+  uint64_t highest = readable.back().end;
+
+  std::vector<std::vector<Pointer>> parts(blocks.size());
+  std::atomic<size_t> pointers(0);
+  std::atomic<bool> exceeded(false);
+
+  threadpool::shared().run(blocks.size(), [&](size_t i) {
+    if (exceeded.load(std::memory_order_relaxed) || (cancelled != nullptr && cancelled->load())) {
+      return;
+    }
+
+    thread_local std::vector<unsigned char> buffer;
+    const Block& block = blocks[i];
+    std::vector<Pointer>& part = parts[i];
+
+    buffer.resize(block.length);
+    readBlock(handle, block, buffer.data());
+
+    size_t offset = (options.alignment - block.address % options.alignment) % options.alignment;
+
+    for (; offset < block.size && offset + options.pointerSize <= block.length; offset += options.alignment) {
+      uint64_t value;
+
+      if (options.pointerSize == 8) {
+        memcpy(&value, buffer.data() + offset, sizeof(uint64_t));
+      } else {
+        uint32_t narrow;
+        memcpy(&narrow, buffer.data() + offset, sizeof(uint32_t));
+        value = narrow;
+      }
+
+      if (value < lowest || value >= highest || !contains(readable, value)) {
+        continue;
+      }
+
+      part.push_back({ value, block.address + offset });
+    }
+
+    if ((pointers += part.size()) * sizeof(Pointer) > options.maxMemory) {
+      exceeded = true;
+    }
+  });
+
+  if (cancelled != nullptr && cancelled->load()) {
+    *errorMessage = "the scan was cancelled";
+    return false;
+  }
+
+  if (exceeded) {
+    *errorMessage = "the pointer map takes more memory than allowed";
+    return false;
+  }
+
+  sortParts(parts, &map->storage, [](const Pointer& left, const Pointer& right) {
+    return left.value != right.value ? left.value < right.value : left.address < right.address;
+  });
+
+  map->pointers = map->storage.data();
+  map->pointerCount = map->storage.size();
+
+  return true;
+}
+
+bool pointerscan::scan(const Map& map, uintptr_t target, const Options& options, const char* path, Stats* stats, const char** errorMessage, const std::atomic<bool>* cancelled) {
+  if (!validate(options, errorMessage)) {
+    return false;
+  }
+
+  if (!map.path.empty() && isSameFile(map.path.c_str(), path)) {
+    *errorMessage = "the output can't be the file the pointer map was opened from";
+    return false;
+  }
+
+  // the pages of an opened map are the file's, they aren't counted
+  size_t mapSize = map.storage.size() * sizeof(Pointer);
+  size_t budget = options.maxMemory > mapSize ? options.maxMemory - mapSize : 0;
+
+  *stats = { map.pointerCount, 0, false };
+
+  // level 0 is the target, level n holds the pointers n dereferences away from it
+  std::vector<Level> levels(1);
+  levels[0].addresses.push_back(target);
+  levels[0].modules.push_back(-1);
+  levels[0].first = { 0, 0 };
+
+  size_t used = 0;
+
+  for (size_t depth = 1; depth <= options.maxDepth; depth++) {
+    Level level;
+
+    if (!walkBack(map, levels.back(), options.maxOffset, budget - used, &level, cancelled)) {
+      if (cancelled != nullptr && cancelled->load()) {
+        *errorMessage = "the scan was cancelled";
+        return false;
+      }
+
+      // chains are still written for the levels walked so far
+      stats->truncated = true;
+      break;
+    }
+
+    used += level.getSize();
+    levels.push_back(std::move(level));
+
+    if (std::find(levels.back().modules.begin(), levels.back().modules.end(), -1) == levels.back().modules.end()) {
+      break;
+    }
+  }
+
+  std::vector<std::string> names;
+
+  for (auto& module : map.modules) {
+    names.push_back(module.szModule);
+  }
+
+  FileHeader header = {};
+  header.pointerSize = (uint32_t) map.pointerSize;
+  header.maxDepth = (uint32_t) options.maxDepth;
+  header.target = target;
+
+  bool written;
+  FILE* file = createChains(path, &header, names, &written);
+
+  if (file == nullptr) {
+    *errorMessage = "unable to create the pointer scan file";
+    return false;
+  }
+
+  Writer writer = { file, levels, map.modules, options.maxResults, header.stride, {}, {}, {}, 0, written };
+
+  for (size_t depth = 1; depth < levels.size() && !writer.isFull(); depth++) {
+    const Level& level = levels[depth];
+
+    for (size_t i = 0; i < level.addresses.size() && !writer.isFull(); i++) {
+      if (level.modules[i] >= 0) {
+        writer.start(depth, i);
+      }
+    }
+  }
+
+  if (writer.written && options.maxResults != 0 && writer.chains >= options.maxResults) {
+    stats->truncated = true;
+  }
+
+  if (!finishChains(file, &header, writer.chains, writer.written)) {
+    *errorMessage = "unable to write the pointer scan file";
+    return false;
+  }
+
+  stats->chains = writer.chains;
+  return true;
+}
+
+bool pointerscan::saveMap(const Map& map, const char* path, const char** errorMessage) {
+  if (!map.path.empty() && isSameFile(map.path.c_str(), path)) {
+    *errorMessage = "the pointer map can't be saved over the file it was opened from";
+    return false;
+  }
+
+  FILE* file = fopen(path, "wb");
+
+  if (file == nullptr) {
+    *errorMessage = "unable to create the pointer map file";
+    return false;
+  }
+
+  MapHeader header = {};
+  memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+  header.version = MAP_VERSION;
+  header.pointerSize = (uint32_t) map.pointerSize;
+  header.moduleCount = map.modules.size();
+  header.pointerCount = map.pointerCount;
+
+  std::vector<MapModule> modules;
+  std::string strings;
+
+  for (auto& module : map.modules) {
+    modules.push_back({ (uint64_t) (uintptr_t) module.modBaseAddr, module.modBaseSize, (uint32_t) strings.size(), (uint32_t) strlen(module.szModule) });
+    strings.append(module.szModule);
+  }
+
+  // pointers start 8 byte aligned
+  strings.resize((strings.size() + 7) & ~(size_t) 7);
+  header.stringsSize = strings.size();
+
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1
+    && (modules.empty() || fwrite(modules.data(), sizeof(MapModule), modules.size(), file) == modules.size())
+    && fwrite(strings.data(), 1, strings.size(), file) == strings.size()
+    && (map.pointerCount == 0 || fwrite(map.pointers, sizeof(Pointer), map.pointerCount, file) == map.pointerCount);
+
+  written = fclose(file) == 0 && written;
+
+  if (!written) {
+    *errorMessage = "unable to write the pointer map file";
+    return false;
+  }
+
+  return true;
+}
+
+bool pointerscan::openMap(const char* path, Map* map, const char** errorMessage) {
+  std::shared_ptr<const MappedFile> file = mapFile(path, sizeof(MapHeader));
+
+  if (file == nullptr) {
+    *errorMessage = "unable to open the pointer map file";
+    return false;
+  }
+
+  MapHeader header;
+  memcpy(&header, file->data, sizeof(header));
+
+  if (memcmp(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0 || header.version != MAP_VERSION || (header.pointerSize != 4 && header.pointerSize != 8)) {
+    *errorMessage = "not a pointer map file";
+    return false;
+  }
+
+  uint64_t size = file->size;
+  bool valid = header.moduleCount <= size / sizeof(MapModule) && header.stringsSize <= size && header.pointerCount <= size / sizeof(Pointer)
+    && sizeof(header) + header.moduleCount * sizeof(MapModule) + header.stringsSize + header.pointerCount * sizeof(Pointer) == size;
+
+  const MapModule* table = (const MapModule*) (file->data + sizeof(header));
+  const char* strings = (const char*) (table + (valid ? header.moduleCount : 0));
+  std::vector<MODULEENTRY32> modules;
+
+  for (uint64_t i = 0; valid && i < header.moduleCount; i++) {
+    valid = (uint64_t) table[i].name + table[i].length <= header.stringsSize && table[i].length < sizeof(MODULEENTRY32::szModule);
+
+    if (valid) {
+      MODULEENTRY32 module = {};
+      module.dwSize = sizeof(module);
+      module.modBaseAddr = (BYTE*) (uintptr_t) table[i].baseAddress;
+      module.modBaseSize = (DWORD) table[i].size;
+      memcpy(module.szModule, strings + table[i].name, table[i].length);
+      modules.push_back(module);
+    }
+  }
+
+  if (!valid) {
+    *errorMessage = "the pointer map file is truncated or corrupt";
+    return false;
+  }
+
+  map->pointerSize = header.pointerSize;
+  map->pointers = (const Pointer*) (strings + header.stringsSize);
+  map->pointerCount = (size_t) header.pointerCount;
+  map->storage.clear();
+  map->file = file;
+  map->path = path;
+  map->modules.swap(modules);
+  return true;
+}
+
+bool pointerscan::readChains(const char* path, size_t maxResults, std::vector<std::string>* modules, std::vector<Chain>* chains, const char** errorMessage) {
+  ChainFile file;
+
+  if (!openChains(path, &file, errorMessage)) {
+    return false;
+  }
+
+  *modules = file.modules;
+
+  size_t count = maxResults != 0 && maxResults < file.header.chainCount ? maxResults : (size_t) file.header.chainCount;
+  chains->reserve(count);
+
+  for (size_t i = 0; i < count; i++) {
+    FileChain chain;
+    const int32_t* offsets;
+
+    if (!file.get(i, &chain, &offsets)) {
+      *errorMessage = "the pointer scan file is truncated or corrupt";
+      return false;
+    }
+
+    chains->push_back({ chain.module, std::vector<int64_t>(offsets, offsets + chain.count) });
+  }
+
+  return true;
+}
+
+bool pointerscan::filter(HANDLE handle, const char* path, uintptr_t target, const char* output, FilterStats* stats, const char** errorMessage, const std::atomic<bool>* cancelled) {
+  ChainFile chains;
+
+  if (isSameFile(path, output)) {
+    *errorMessage = "the output can't be the pointer scan file being filtered";
+    return false;
+  }
+
+  if (!openChains(path, &chains, errorMessage)) {
+    return false;
+  }
+
+  const char* moduleError = "";
+  std::vector<MODULEENTRY32> loaded = module::getModules(platform::getProcessId(handle), &moduleError);
+
+  if (strcmp(moduleError, "")) {
+    *errorMessage = moduleError;
+    return false;
+  }
+
+  // base address of every module of the file in the process, 0 for the ones it hasn't loaded
+  std::unordered_map<std::string, uint64_t> byName;
+  std::vector<uint64_t> bases;
+
+  for (auto& module : loaded) {
+    byName.emplace(module.szModule, (uintptr_t) module.modBaseAddr);
+  }
+
+  for (auto& name : chains.modules) {
+    auto found = byName.find(name);
+    bases.push_back(found != byName.end() ? found->second : 0);
+  }
+
+  FileHeader header = chains.header;
+  header.target = target;
+
+  bool written;
+  FILE* file = createChains(output, &header, chains.modules, &written);
+
+  if (file == nullptr) {
+    *errorMessage = "unable to create the pointer scan file";
+    return false;
+  }
+
+  size_t pointerSize = chains.header.pointerSize;
+  bool corrupt = false;
+  bool stopped = false;
+
+  *stats = { chains.header.chainCount, 0 };
+
+  // address every chain of the batch reached, and the chains still followed
+  std::vector<uint64_t> addresses;
+  std::vector<uint64_t> values;
+  std::vector<uint32_t> alive;
+  std::vector<uint32_t> followed;
+  std::vector<bool> kept;
+  std::vector<platform::Read> reads;
+  std::vector<bool> success;
+
+  for (uint64_t first = 0; first < chains.header.chainCount && written && !corrupt && !stopped; first += CHAINS_PER_BATCH) {
+    size_t count = (size_t) std::min<uint64_t>(CHAINS_PER_BATCH, chains.header.chainCount - first);
+
+    addresses.assign(count, 0);
+    values.resize(count);
+    kept.assign(count, false);
+    alive.clear();
+
+    for (size_t i = 0; i < count && !corrupt; i++) {
+      FileChain chain;
+      const int32_t* offsets;
+
+      corrupt = !chains.get(first + i, &chain, &offsets);
+
+      if (!corrupt && bases[chain.module] != 0) {
+        addresses[i] = bases[chain.module] + offsets[0];
+        alive.push_back((uint32_t) i);
+      }
+    }
+
+    // at depth n the chains of n offsets have reached their end, the others read a pointer
+    for (size_t depth = 1; !alive.empty() && !corrupt; depth++) {
+      if (cancelled != nullptr && cancelled->load()) {
+        stopped = true;
+        break;
+      }
+
+      followed.clear();
+      reads.clear();
+
+      for (uint32_t i : alive) {
+        FileChain chain;
+        const int32_t* offsets;
+        chains.get(first + i, &chain, &offsets);
+
+        if (chain.count == depth) {
+          kept[i] = addresses[i] == target;
+          continue;
+        }
+
+        values[i] = 0;
+        reads.push_back({ (uintptr_t) addresses[i], &values[i], pointerSize });
+        followed.push_back(i);
+      }
+
+      platform::readMemory(handle, reads, &success);
+      alive.clear();
+
+      for (size_t j = 0; j < followed.size(); j++) {
+        uint32_t i = followed[j];
+        FileChain chain;
+        const int32_t* offsets;
+        chains.get(first + i, &chain, &offsets);
+
+        if (!success[j]) {
+          continue;
+        }
+
+        uint64_t value = values[i];
+
+        if (pointerSize == 4) {
+          uint32_t narrow;
+          memcpy(&narrow, &values[i], sizeof(uint32_t));
+          value = narrow;
+        }
+
+        addresses[i] = value + offsets[depth];
+        alive.push_back(i);
+      }
+    }
+
+    for (size_t i = 0; i < count && written && !corrupt && !stopped; i++) {
+      if (kept[i]) {
+        written = fwrite(chains.getRecord(first + i), 1, header.stride, file) == header.stride;
+        stats->kept++;
+      }
+    }
+  }
+
+  written = finishChains(file, &header, stats->kept, written);
+
+  if (corrupt) {
+    *errorMessage = "the pointer scan file is truncated or corrupt";
+    return false;
+  }
+
+  if (stopped) {
+    *errorMessage = "the filter was cancelled";
+    return false;
+  }
+
+  if (!written) {
+    *errorMessage = "unable to write the pointer scan file";
+    return false;
+  }
+
+  return true;
+}
+
+bool pointerscan::intersect(const std::vector<std::string>& paths, const char* output, uint64_t* chains, const char** errorMessage) {
+  if (paths.empty()) {
+    *errorMessage = "requires at least one pointer scan file";
+    return false;
+  }
+
+  std::vector<ChainFile> files(paths.size());
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    if (isSameFile(paths[i].c_str(), output)) {
+      *errorMessage = "the output can't be one of the pointer scan files intersected";
+      return false;
+    }
+
+    if (!openChains(paths[i].c_str(), &files[i], errorMessage)) {
+      return false;
+    }
+  }
+
+  // the name of the module a chain starts in followed by its offsets, the same across files
+  auto getKey = [](const ChainFile& file, uint64_t index, std::string* key) {
+    FileChain chain;
+    const int32_t* offsets;
+
+    if (!file.get(index, &chain, &offsets)) {
+      return false;
+    }
+
+    key->assign(file.modules[chain.module]);
+    key->push_back('\0');
+    key->append((const char*) offsets, chain.count * sizeof(int32_t));
+    return true;
+  };
+
+  std::vector<std::vector<std::string>> others(files.size() - 1);
+  std::string key;
+
+  for (size_t i = 1; i < files.size(); i++) {
+    std::vector<std::string>& keys = others[i - 1];
+    keys.reserve((size_t) files[i].header.chainCount);
+
+    for (uint64_t j = 0; j < files[i].header.chainCount; j++) {
+      if (!getKey(files[i], j, &key)) {
+        *errorMessage = "the pointer scan file is truncated or corrupt";
+        return false;
+      }
+
+      keys.push_back(key);
+    }
+
+    std::sort(keys.begin(), keys.end());
+  }
+
+  // the chains are written in the order of the first file, shortest first
+  const ChainFile& chosen = files[0];
+  FileHeader header = chosen.header;
+
+  bool written;
+  FILE* file = createChains(output, &header, chosen.modules, &written);
+
+  if (file == nullptr) {
+    *errorMessage = "unable to create the pointer scan file";
+    return false;
+  }
+
+  bool corrupt = false;
+  *chains = 0;
+
+  for (uint64_t i = 0; i < chosen.header.chainCount && written && !corrupt; i++) {
+    corrupt = !getKey(chosen, i, &key);
+
+    bool everywhere = !corrupt;
+
+    for (size_t j = 0; j < others.size() && everywhere; j++) {
+      everywhere = std::binary_search(others[j].begin(), others[j].end(), key);
+    }
+
+    if (everywhere) {
+      written = fwrite(chosen.getRecord(i), 1, header.stride, file) == header.stride;
+      (*chains)++;
+    }
+  }
+
+  written = finishChains(file, &header, *chains, written);
+
+  if (corrupt) {
+    *errorMessage = "the pointer scan file is truncated or corrupt";
+    return false;
+  }
+
+  if (!written) {
+    *errorMessage = "unable to write the pointer scan file";
+    return false;
+  }
+
+  return true;
+}
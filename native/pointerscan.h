@@ -0,0 +1,116 @@
+#pragma once
+#ifndef POINTERSCAN_H
+#define POINTERSCAN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "platform.h"
+
+// Pointer scanner. Every aligned pointer stored in the writable regions of a process and
+// pointing into a readable region goes into a map sorted by the address pointed to. Chains
+// are found walking back from a target address a level at a time: the pointers to
+// [address - maxOffset, address] are found with a binary search, the ones stored in a
+// module start a chain and the others are walked back from at the next level.
+//
+// Chains are written to a file: a header, a table of the modules chains start in, a string
+// table with their names, then one record per chain, all of the same size. Fields are stored
+// in the byte order of the machine that wrote the file.
+//
+// A map can be saved and opened again to walk back from other targets without reading the
+// process again: a header, the module table, the string table, then the pointers as they
+// are in memory, so an opened map is used straight from the mapped file. Chains found in
+// one run of a process are checked against another run by following them in it, a batch
+// of chains at a time with one read of all their pointers per level.
+namespace pointerscan {
+  struct Options {
+    // 4 or 8, the size of the pointers stored in the target process
+    size_t pointerSize;
+    // pointers are looked for at multiples of it
+    size_t alignment;
+    // dereferences of the longest chain
+    size_t maxDepth;
+    // largest offset added to a pointer to reach the next address
+    size_t maxOffset;
+    // chains written at most, 0 for no limit
+    size_t maxResults;
+    // bytes the map, and then the levels walked back, can take
+    size_t maxMemory;
+  };
+
+  struct Pointer {
+    // address pointed to, and where the pointer is stored
+    uint64_t value;
+    uint64_t address;
+  };
+
+  struct Map {
+    size_t pointerSize = 0;
+    // ascending by value, then by address: `storage` for a map built, the file for one opened
+    const Pointer* pointers = nullptr;
+    size_t pointerCount = 0;
+    std::vector<Pointer> storage;
+    std::shared_ptr<const void> file;
+    // the file of a map opened, nothing may be written over it while the map is used
+    std::string path;
+    // modules chains can start in, ascending by base address
+    std::vector<MODULEENTRY32> modules;
+
+    Map() = default;
+    Map(Map&&) = default;
+    Map& operator=(Map&&) = default;
+    // `pointers` would still point into the map copied
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+  };
+
+  // A chain in the form `readplan` follows with the module's base address as the base:
+  // `offsets[0]` is where the first pointer is stored in the module, every other offset
+  // is added to the pointer read before it, the last one leading to the target
+  struct Chain {
+    uint32_t module;
+    std::vector<int64_t> offsets;
+  };
+
+  struct Stats {
+    uint64_t pointers;
+    uint64_t chains;
+    // levels left unwalked or chains left unwritten because of `maxMemory` or `maxResults`
+    bool truncated;
+  };
+
+  struct FilterStats {
+    // chains checked, and the ones still leading to the target
+    uint64_t chains;
+    uint64_t kept;
+  };
+
+  bool validate(const Options& options, const char** errorMessage);
+
+  bool buildMap(HANDLE handle, const Options& options, Map* map, const char** errorMessage, const std::atomic<bool>* cancelled = nullptr);
+
+  bool saveMap(const Map& map, const char* path, const char** errorMessage);
+
+  // Maps a saved map, it stays mapped while `map` or one of the maps moved from it is alive
+  bool openMap(const char* path, Map* map, const char** errorMessage);
+
+  // Walks back from `target` and writes the chains found into `path`, shortest first
+  bool scan(const Map& map, uintptr_t target, const Options& options, const char* path, Stats* stats, const char** errorMessage, const std::atomic<bool>* cancelled = nullptr);
+
+  // Reads a file of chains back, along with the names of the modules they start in.
+  // At most `maxResults` chains are read, 0 for all of them.
+  bool readChains(const char* path, size_t maxResults, std::vector<std::string>* modules, std::vector<Chain>* chains, const char** errorMessage);
+
+  // Follows the chains of `path` in a process, module bases looked up by name, and writes
+  // the ones leading to `target` into `output`
+  bool filter(HANDLE handle, const char* path, uintptr_t target, const char* output, FilterStats* stats, const char** errorMessage, const std::atomic<bool>* cancelled = nullptr);
+
+  // Writes the chains of the first file found in every other one into `output`, chains
+  // being the same when they start in modules of the same name with the same offsets
+  bool intersect(const std::vector<std::string>& paths, const char* output, uint64_t* chains, const char** errorMessage);
+}
+
+#endif
@@ -1,8 +1,9 @@
 #include <node.h>
-#include <windows.h>
-#include <TlHelp32.h>
+#include <cstring>
 #include <vector>
 #include "process.h"
+#include "platform.h"
+#include "registry.h"
 #include "memoryprocess.h"
 
 process::process() {}
@@ -16,16 +17,9 @@ process::Pair process::openProcess(const char* processName, const char** errorMe
   PROCESSENTRY32 process;
   HANDLE handle = NULL;
 
-  // A list of processes (PROCESSENTRY32)
-  std::vector<PROCESSENTRY32> processes = getProcesses(errorMessage);
-
-  for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processes.size(); i++) {
-    // Check to see if this is the process we want.
-    if (!strcmp(processes[i].szExeFile, processName)) {
-      handle = OpenProcess(PROCESS_ALL_ACCESS, FALSE, processes[i].th32ProcessID);
-      process = processes[i];
-      break;
-    }
+  // looked up in the process index rather than in a new listing
+  if (registry::findProcess(processName, &process, errorMessage)) {
+    handle = platform::openProcess(process.th32ProcessID);
   }
 
   if (handle == NULL) {
@@ -42,16 +36,8 @@ process::Pair process::openProcess(DWORD processId, const char** errorMessage) {
   PROCESSENTRY32 process;
   HANDLE handle = NULL;
 
-  // A list of processes (PROCESSENTRY32)
-  std::vector<PROCESSENTRY32> processes = getProcesses(errorMessage);
-
-  for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processes.size(); i++) {
-    // Check to see if this is the process we want.
-    if (processId == processes[i].th32ProcessID) {
-      handle = OpenProcess(PROCESS_ALL_ACCESS, FALSE, processes[i].th32ProcessID);
-      process = processes[i];
-      break;
-    }
+  if (registry::findProcess(processId, &process, errorMessage)) {
+    handle = platform::openProcess(process.th32ProcessID);
   }
 
   if (handle == NULL) {
@@ -65,31 +51,5 @@ process::Pair process::openProcess(DWORD processId, const char** errorMessage) {
 }
 
 std::vector<PROCESSENTRY32> process::getProcesses(const char** errorMessage) {
-  // Take a snapshot of all processes.
-  HANDLE hProcessSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, NULL);
-  PROCESSENTRY32 pEntry;
-
-  if (hProcessSnapshot == INVALID_HANDLE_VALUE) {
-    *errorMessage = "method failed to take snapshot of the process";
-  }
-
-  // Before use, set the structure size.
-  pEntry.dwSize = sizeof(pEntry);
-
-  // Exit if unable to find the first process.
-  if (!Process32First(hProcessSnapshot, &pEntry)) {
-    CloseHandle(hProcessSnapshot);
-    *errorMessage = "method failed to retrieve the first process";
-  }
-
-  std::vector<PROCESSENTRY32> processes;
-
-  // Loop through processes.
-  do {
-    // Add the process to the vector
-    processes.push_back(pEntry);
-  } while (Process32Next(hProcessSnapshot, &pEntry));
-
-  CloseHandle(hProcessSnapshot);
-  return processes;
+  return registry::getProcesses(errorMessage);
 }
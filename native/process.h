@@ -1,11 +1,9 @@
 #pragma once
 #ifndef PROCESS_H
 #define PROCESS_H
-#define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-#include <TlHelp32.h>
 #include <vector>
+#include "platform.h"
 
 class process {
 public:
@@ -0,0 +1,125 @@
+#include <cstring>
+#include <vector>
+#include "readplan.h"
+#include "platform.h"
+
+bool readplan::compile(const std::vector<Chain>& chains, size_t pointerSize, Plan* plan, const char** errorMessage) {
+  if (pointerSize != 4 && pointerSize != 8) {
+    *errorMessage = "pointer size must be 4 or 8";
+    return false;
+  }
+
+  plan->chains = chains;
+  plan->offsets.assign(chains.size(), 0);
+  plan->pointerSize = pointerSize;
+  plan->depth = 0;
+
+  size_t size = 0;
+
+  for (size_t i = 0; i < chains.size(); i++) {
+    if (chains[i].size == 0) {
+      *errorMessage = "values read by a plan need a fixed size";
+      return false;
+    }
+
+    // vectors are aligned to their components
+    size_t alignment = chains[i].size > sizeof(double) ? sizeof(float) : chains[i].size;
+    size = (size + alignment - 1) / alignment * alignment;
+
+    plan->offsets[i] = size;
+    size += chains[i].size;
+
+    size_t hops = chains[i].offsets.empty() ? 0 : chains[i].offsets.size() - 1;
+    plan->depth = hops > plan->depth ? hops : plan->depth;
+  }
+
+  plan->statusOffset = size;
+  plan->size = size + chains.size();
+
+  plan->addresses.reserve(chains.size());
+  plan->pointers.reserve(chains.size());
+  plan->pending.reserve(chains.size());
+  plan->reads.reserve(chains.size());
+  plan->success.reserve(chains.size());
+
+  return true;
+}
+
+size_t readplan::execute(HANDLE handle, Plan& plan, unsigned char* output) {
+  size_t count = plan.chains.size();
+  unsigned char* status = output + plan.statusOffset;
+
+  plan.addresses.resize(count);
+  plan.pointers.resize(count);
+
+  // chains still being followed
+  plan.pending.clear();
+
+  for (size_t i = 0; i < count; i++) {
+    plan.addresses[i] = plan.chains[i].base;
+    plan.pending.push_back(i);
+    status[i] = 0;
+  }
+
+  for (size_t level = 0; level < plan.depth; level++) {
+    plan.reads.clear();
+
+    for (size_t i : plan.pending) {
+      const Chain& chain = plan.chains[i];
+
+      if (level + 1 < chain.offsets.size()) {
+        plan.pointers[i] = 0;
+        plan.reads.push_back({ plan.addresses[i] + (uintptr_t) chain.offsets[level], &plan.pointers[i], plan.pointerSize });
+      }
+    }
+
+    platform::readMemory(handle, plan.reads, &plan.success);
+
+    // drop the chains that hit an unreadable or null pointer, keep the others
+    size_t read = 0;
+    size_t kept = 0;
+
+    for (size_t i : plan.pending) {
+      if (level + 1 >= plan.chains[i].offsets.size()) {
+        plan.pending[kept++] = i;
+        continue;
+      }
+
+      if (plan.success[read++] && plan.pointers[i] != 0) {
+        plan.addresses[i] = (uintptr_t) plan.pointers[i];
+        plan.pending[kept++] = i;
+      }
+    }
+
+    plan.pending.resize(kept);
+  }
+
+  plan.reads.clear();
+
+  for (size_t i : plan.pending) {
+    const Chain& chain = plan.chains[i];
+    uintptr_t address = plan.addresses[i] + (chain.offsets.empty() ? 0 : (uintptr_t) chain.offsets.back());
+
+    plan.reads.push_back({ address, output + plan.offsets[i], chain.size });
+  }
+
+  platform::readMemory(handle, plan.reads, &plan.success);
+
+  size_t read = 0;
+
+  for (size_t j = 0; j < plan.pending.size(); j++) {
+    if (plan.success[j]) {
+      status[plan.pending[j]] = 1;
+      read++;
+    }
+  }
+
+  // values of chains that failed are zeroed rather than left from the previous execution
+  for (size_t i = 0; i < count; i++) {
+    if (!status[i]) {
+      memset(output + plan.offsets[i], 0, plan.chains[i].size);
+    }
+  }
+
+  return read;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef READPLAN_H
+#define READPLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "platform.h"
+
+namespace readplan {
+  // A pointer chain: starting at `base`, every offset but the last is added
+  // and dereferenced, the last one is added before reading the value
+  struct Chain {
+    uintptr_t base;
+    std::vector<int64_t> offsets;
+    size_t size;
+  };
+
+  // Chains compiled into an output layout, executed as many times as needed.
+  // Values are packed in chain order, each aligned to its own size, followed
+  // by one status byte per chain (1 when the value could be read).
+  struct Plan {
+    std::vector<Chain> chains;
+    std::vector<size_t> offsets;
+    size_t statusOffset;
+    size_t size;
+    // 4 or 8, the size of the pointers stored in the target process
+    size_t pointerSize;
+    // number of dereferences of the longest chain
+    size_t depth;
+
+    // scratch reused between executions so polling doesn't allocate
+    std::vector<uintptr_t> addresses;
+    std::vector<uint64_t> pointers;
+    std::vector<size_t> pending;
+    std::vector<platform::Read> reads;
+    std::vector<bool> success;
+  };
+
+  bool compile(const std::vector<Chain>& chains, size_t pointerSize, Plan* plan, const char** errorMessage);
+
+  // Follows every chain a depth level at a time, the hops of a level are read
+  // in a single batch. `output` has to be at least `plan.size` bytes long.
+  // Returns the number of chains whose value was read.
+  size_t execute(HANDLE handle, Plan& plan, unsigned char* output);
+}
+
+#endif
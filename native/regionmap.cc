@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "regionmap.h"
+#include "platform.h"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  const std::chrono::milliseconds MAX_AGE(1000);
+  // reading the version costs system calls, lookups in quick succession trust the last one read
+  const std::chrono::milliseconds CHECK_INTERVAL(1);
+
+  struct Map {
+    std::vector<MEMORY_BASIC_INFORMATION> regions;
+    std::vector<std::string> names;
+    bool named;
+    uint64_t version;
+    Clock::time_point listed;
+  };
+
+  struct Entry {
+    std::shared_ptr<const Map> map;
+    Clock::time_point checked;
+  };
+
+  std::mutex mutex;
+  std::unordered_map<HANDLE, Entry> maps;
+
+  // Regions of a handle, listed again when the platform reports changes. Names are only
+  // looked up when asked for since they cost a call per module on Windows.
+  std::shared_ptr<const Map> get(HANDLE handle, bool named) {
+    Clock::time_point now = Clock::now();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto found = maps.find(handle);
+
+      if (found != maps.end() && now - found->second.checked < CHECK_INTERVAL && (found->second.map->named || !named)) {
+        return found->second.map;
+      }
+    }
+
+    uint64_t version = 0;
+    bool versioned = platform::getRegionsVersion(handle, &version);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto found = maps.find(handle);
+
+      if (found != maps.end()) {
+        const Map& map = *found->second.map;
+
+        if (versioned && map.version == version && now - map.listed < MAX_AGE && (map.named || !named)) {
+          found->second.checked = now;
+          return found->second.map;
+        }
+      }
+    }
+
+    // regions are listed without the lock held, so other handles aren't held up
+    std::shared_ptr<Map> map = std::make_shared<Map>();
+    map->regions = platform::getRegions(handle, named ? &map->names : nullptr);
+    map->named = named;
+    map->version = version;
+    map->listed = now;
+
+    // a process that can't report changes is listed every time
+    if (versioned) {
+      std::lock_guard<std::mutex> lock(mutex);
+      maps[handle] = { map, now };
+    }
+
+    return map;
+  }
+}
+
+bool regionmap::find(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region) {
+  std::shared_ptr<const Map> map = get(handle, false);
+  const std::vector<MEMORY_BASIC_INFORMATION>& regions = map->regions;
+
+  // first region starting after the address, the one before it may contain it
+  auto next = std::upper_bound(regions.begin(), regions.end(), address, [](uintptr_t address, const MEMORY_BASIC_INFORMATION& region) {
+    return address < (uintptr_t)region.BaseAddress;
+  });
+
+  uintptr_t previousEnd = 0;
+
+  if (next != regions.begin()) {
+    const MEMORY_BASIC_INFORMATION& previous = *(next - 1);
+    previousEnd = (uintptr_t)previous.BaseAddress + previous.RegionSize;
+
+    if (address < previousEnd) {
+      *region = previous;
+      return true;
+    }
+  }
+
+  if (next == regions.end()) {
+    return false;
+  }
+
+  *region = {};
+  region->BaseAddress = (PVOID)previousEnd;
+  region->RegionSize = (uintptr_t)next->BaseAddress - previousEnd;
+  region->State = MEM_FREE;
+  region->Protect = PAGE_NOACCESS;
+  return true;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> regionmap::getRegions(HANDLE handle, std::vector<std::string>* names) {
+  std::shared_ptr<const Map> map = get(handle, names != nullptr);
+
+  if (names != nullptr) {
+    *names = map->names;
+  }
+
+  return map->regions;
+}
+
+void regionmap::invalidate(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(mutex);
+  maps.erase(handle);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#ifndef REGIONMAP_H
+#define REGIONMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "platform.h"
+
+// Regions of a process kept per handle, sorted by address so the region containing an
+// address is found with a binary search. The regions are only listed again once the
+// platform reports allocations made or freed since, or once the list is a second old,
+// since protection changes aren't always reported.
+namespace regionmap {
+  // Region containing `address`. Addresses between regions are reported as free memory,
+  // like `VirtualQueryEx` does, false past the last region.
+  bool find(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region);
+
+  // `names` receives the file backing each region, empty for anonymous memory
+  std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE handle, std::vector<std::string>* names = nullptr);
+
+  // Drops the regions of a handle, after changing them or closing the handle
+  void invalidate(HANDLE handle);
+}
+
+#endif
@@ -0,0 +1,343 @@
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "registry.h"
+#include "platform.h"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Processes {
+    std::unordered_map<DWORD, PROCESSENTRY32> byId;
+    // processes sharing a name, in the order they were listed
+    std::unordered_map<std::string, std::vector<DWORD>> byName;
+    // every process, in the order they were listed and then started
+    std::vector<DWORD> order;
+    Clock::time_point listed;
+    bool complete = false;
+    bool incremental = false;
+  };
+
+  struct Modules {
+    std::vector<MODULEENTRY32> list;
+    std::unordered_map<std::string, size_t> byName;
+    Clock::time_point listed;
+  };
+
+  std::mutex mutex;
+  Processes processes;
+  std::unordered_map<DWORD, Modules> modules;
+  int64_t maxAge = 1000;
+
+  bool isFresh(Clock::time_point listed) {
+    return Clock::now() - listed < std::chrono::milliseconds(maxAge);
+  }
+
+  void remove(std::vector<DWORD>* ids, DWORD processId) {
+    for (size_t i = 0; i < ids->size(); i++) {
+      if ((*ids)[i] == processId) {
+        ids->erase(ids->begin() + i);
+        return;
+      }
+    }
+  }
+
+  void removeName(const PROCESSENTRY32& process) {
+    auto found = processes.byName.find(process.szExeFile);
+
+    if (found == processes.byName.end()) {
+      return;
+    }
+
+    remove(&found->second, process.th32ProcessID);
+
+    if (found->second.empty()) {
+      processes.byName.erase(found);
+    }
+  }
+
+  // Whether `current` is still the process `previous` was, as far as the entries tell
+  bool isSameProcess(const PROCESSENTRY32& previous, const PROCESSENTRY32& current) {
+    return previous.th32ParentProcessID == current.th32ParentProcessID && !strcmp(previous.szExeFile, current.szExeFile);
+  }
+
+  // Takes a process out of the index along with its modules
+  void drop(DWORD processId) {
+    auto found = processes.byId.find(processId);
+
+    if (found != processes.byId.end()) {
+      removeName(found->second);
+      remove(&processes.order, processId);
+      processes.byId.erase(found);
+    }
+
+    modules.erase(processId);
+  }
+
+  // Brings a single process up to date, its modules are dropped when it's gone or replaced
+  void update(DWORD processId) {
+    PROCESSENTRY32 current;
+    bool exists = platform::getProcess(processId, &current);
+    auto found = processes.byId.find(processId);
+
+    if (found != processes.byId.end()) {
+      if (exists && isSameProcess(found->second, current)) {
+        found->second = current;
+        return;
+      }
+
+      drop(processId);
+    }
+
+    if (exists) {
+      processes.byId[processId] = current;
+      processes.byName[current.szExeFile].push_back(processId);
+      processes.order.push_back(processId);
+    }
+  }
+
+  // Takes the whole listing again and compares it with the index
+  bool list(const char** errorMessage) {
+    const char* listError = "";
+    std::vector<PROCESSENTRY32> listing = platform::getProcesses(&listError);
+
+    if (strcmp(listError, "")) {
+      *errorMessage = listError;
+      return false;
+    }
+
+    std::unordered_map<DWORD, PROCESSENTRY32> byId;
+    std::unordered_map<std::string, std::vector<DWORD>> byName;
+    std::vector<DWORD> order;
+
+    byId.reserve(listing.size());
+    order.reserve(listing.size());
+
+    for (auto& process : listing) {
+      auto previous = processes.byId.find(process.th32ProcessID);
+
+      if (previous != processes.byId.end() && !isSameProcess(previous->second, process)) {
+        modules.erase(process.th32ProcessID);
+      }
+
+      byId[process.th32ProcessID] = process;
+      byName[process.szExeFile].push_back(process.th32ProcessID);
+      order.push_back(process.th32ProcessID);
+    }
+
+    for (auto& process : processes.byId) {
+      if (byId.find(process.first) == byId.end()) {
+        modules.erase(process.first);
+      }
+    }
+
+    processes.byId.swap(byId);
+    processes.byName.swap(byName);
+    processes.order.swap(order);
+    processes.listed = Clock::now();
+    processes.complete = true;
+    return true;
+  }
+
+  // Applies the changes the kernel reported, or lists the processes again when it
+  // can't report them and the index is too old. `force` lists them regardless of age.
+  bool sync(bool force, const char** errorMessage) {
+    std::vector<DWORD> changed;
+    std::vector<DWORD> exited;
+    bool overflow = false;
+
+    // subscribing happens on the first call, before the first listing, so nothing is missed
+    processes.incremental = platform::getProcessChanges(&changed, &exited, &overflow);
+
+    if (!processes.complete || overflow || (!processes.incremental && (force || !isFresh(processes.listed)))) {
+      return list(errorMessage);
+    }
+
+    // exits come first, a process id reused since then is among the changes
+    for (DWORD processId : exited) {
+      drop(processId);
+    }
+
+    for (DWORD processId : changed) {
+      update(processId);
+    }
+
+    return true;
+  }
+
+  // Modules of a process, listed again when too old or when `force` is set.
+  // `listed` tells whether they were listed by this call.
+  Modules* listModules(DWORD processId, bool force, bool* listed, const char** errorMessage) {
+    auto found = modules.find(processId);
+
+    *listed = false;
+
+    if (found != modules.end() && !force && isFresh(found->second.listed)) {
+      return &found->second;
+    }
+
+    *listed = true;
+
+    const char* listError = "";
+    std::vector<MODULEENTRY32> list = platform::getModules(processId, &listError);
+
+    if (strcmp(listError, "")) {
+      *errorMessage = listError;
+      modules.erase(processId);
+      return nullptr;
+    }
+
+    Modules& entry = modules[processId];
+    entry.list.swap(list);
+    entry.byName.clear();
+    entry.listed = Clock::now();
+
+    // the first of modules sharing a name is the one found, like a linear search would
+    for (size_t i = 0; i < entry.list.size(); i++) {
+      entry.byName.emplace(entry.list[i].szModule, i);
+    }
+
+    return &entry;
+  }
+}
+
+void registry::setMaxAge(int64_t milliseconds) {
+  std::lock_guard<std::mutex> lock(mutex);
+  maxAge = milliseconds < 0 ? 0 : milliseconds;
+}
+
+int64_t registry::getMaxAge() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return maxAge;
+}
+
+bool registry::isIncremental() {
+  std::lock_guard<std::mutex> lock(mutex);
+  const char* errorMessage = "";
+  sync(false, &errorMessage);
+  return processes.incremental;
+}
+
+bool registry::findProcess(const char* name, PROCESSENTRY32* process, const char** errorMessage) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (!sync(false, errorMessage)) {
+    return false;
+  }
+
+  auto found = processes.byName.find(name);
+
+  // a process started since the last listing isn't in the index yet
+  if (found == processes.byName.end() && !processes.incremental) {
+    if (!sync(true, errorMessage)) {
+      return false;
+    }
+
+    found = processes.byName.find(name);
+  }
+
+  if (found == processes.byName.end()) {
+    return false;
+  }
+
+  *process = processes.byId[found->second.front()];
+  return true;
+}
+
+bool registry::findProcess(DWORD processId, PROCESSENTRY32* process, const char** errorMessage) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (!sync(false, errorMessage)) {
+    return false;
+  }
+
+  auto found = processes.byId.find(processId);
+
+  if (found == processes.byId.end() && !processes.incremental) {
+    if (!sync(true, errorMessage)) {
+      return false;
+    }
+
+    found = processes.byId.find(processId);
+  }
+
+  if (found == processes.byId.end()) {
+    return false;
+  }
+
+  *process = found->second;
+  return true;
+}
+
+std::vector<PROCESSENTRY32> registry::getProcesses(const char** errorMessage) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<PROCESSENTRY32> list;
+
+  // a listing is asked for, it is only skipped when the kernel keeps the index current
+  if (!sync(true, errorMessage)) {
+    return list;
+  }
+
+  list.reserve(processes.order.size());
+
+  for (DWORD processId : processes.order) {
+    list.push_back(processes.byId[processId]);
+  }
+
+  return list;
+}
+
+bool registry::findModule(DWORD processId, const char* name, MODULEENTRY32* module, const char** errorMessage) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // changes reported for the process drop its modules before they're looked at,
+  // the modules are still listed when processes can't be
+  const char* syncError = "";
+  sync(false, &syncError);
+
+  bool listed;
+  Modules* entry = listModules(processId, false, &listed, errorMessage);
+
+  if (entry == nullptr) {
+    return false;
+  }
+
+  auto found = entry->byName.find(name);
+
+  // a module loaded since the modules were listed isn't in the index yet
+  if (found == entry->byName.end() && !listed) {
+    entry = listModules(processId, true, &listed, errorMessage);
+
+    if (entry == nullptr) {
+      return false;
+    }
+
+    found = entry->byName.find(name);
+  }
+
+  if (found == entry->byName.end()) {
+    return false;
+  }
+
+  *module = entry->list[found->second];
+  return true;
+}
+
+std::vector<MODULEENTRY32> registry::getModules(DWORD processId, const char** errorMessage) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  const char* syncError = "";
+  sync(false, &syncError);
+
+  bool listed;
+  Modules* entry = listModules(processId, false, &listed, errorMessage);
+  return entry == nullptr ? std::vector<MODULEENTRY32>() : entry->list;
+}
+
+void registry::invalidateModules(DWORD processId) {
+  std::lock_guard<std::mutex> lock(mutex);
+  modules.erase(processId);
+}
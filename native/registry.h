@@ -0,0 +1,33 @@
+#pragma once
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <cstdint>
+#include <vector>
+#include "platform.h"
+
+// Index of the running processes, by id and by name, and of the modules of the
+// processes asked about, by name. Where the kernel reports process changes (the
+// proc connector on Linux) the index is updated a process at a time as they happen,
+// elsewhere listings older than `maxAge` are taken again and compared with the index.
+// Module lists are kept for `maxAge` and taken again when a module isn't found.
+namespace registry {
+  // Milliseconds listings are trusted for, 0 to take them on every call
+  void setMaxAge(int64_t milliseconds);
+  int64_t getMaxAge();
+
+  // Whether the kernel reports process changes, so the index never has to be taken again
+  bool isIncremental();
+
+  bool findProcess(const char* name, PROCESSENTRY32* process, const char** errorMessage);
+  bool findProcess(DWORD processId, PROCESSENTRY32* process, const char** errorMessage);
+  std::vector<PROCESSENTRY32> getProcesses(const char** errorMessage);
+
+  bool findModule(DWORD processId, const char* name, MODULEENTRY32* module, const char** errorMessage);
+  std::vector<MODULEENTRY32> getModules(DWORD processId, const char** errorMessage);
+
+  // Drops the modules of a process, after loading or unloading one
+  void invalidateModules(DWORD processId);
+}
+
+#endif
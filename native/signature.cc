@@ -0,0 +1,369 @@
+#include <cstring>
+#include <vector>
+#include "signature.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIGNATURE_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC exposes every intrinsic regardless of the compilation flags,
+// GCC and Clang need to be told which functions are allowed to use AVX2
+#if defined(SIGNATURE_X86) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+  int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 0xa;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 0xa;
+    return -1;
+  }
+
+  // Horspool search, only worth it when wildcards still allow long shifts
+  const unsigned char* findHorspool(const unsigned char* begin, const unsigned char* end, const signature::Signature& signature) {
+    size_t length = signature.bytes.size();
+    const unsigned char* last = end - length;
+
+    for (const unsigned char* position = begin; position <= last; position += signature.skip[position[length - 1]]) {
+      if (signature::compare(position, signature)) {
+        return position;
+      }
+    }
+
+    return nullptr;
+  }
+
+  const unsigned char* findScalar(const unsigned char* begin, const unsigned char* end, const signature::Signature& signature) {
+    size_t length = signature.bytes.size();
+    const unsigned char* last = end - length;
+    unsigned char anchor = signature.bytes[signature.anchor];
+
+    if (signature.maxSkip >= 16) {
+      return findHorspool(begin, end, signature);
+    }
+
+    for (const unsigned char* position = begin + signature.anchor; position <= last + signature.anchor;) {
+      const void* hit = memchr(position, anchor, (last + signature.anchor) - position + 1);
+
+      if (hit == nullptr) {
+        break;
+      }
+
+      const unsigned char* candidate = static_cast<const unsigned char*>(hit) - signature.anchor;
+
+      if (signature::compare(candidate, signature)) {
+        return candidate;
+      }
+
+      position = static_cast<const unsigned char*>(hit) + 1;
+    }
+
+    return nullptr;
+  }
+
+#ifdef SIGNATURE_X86
+  // Counts trailing zeros of a non-zero candidate mask
+  inline unsigned int lowestBit(unsigned int value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+  }
+
+  const unsigned char* findSSE2(const unsigned char* begin, const unsigned char* end, const signature::Signature& signature) {
+    size_t length = signature.bytes.size();
+    const unsigned char* last = end - length;
+    const __m128i anchor = _mm_set1_epi8((char) signature.bytes[signature.anchor]);
+    const __m128i secondary = _mm_set1_epi8((char) signature.bytes[signature.secondary]);
+
+    const unsigned char* position = begin;
+
+    // Both anchors are compared for 16 candidate start positions at once,
+    // only positions where both of them match are verified in full
+    for (; position + 15 <= last; position += 16) {
+      __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position + signature.anchor));
+      __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position + signature.secondary));
+      unsigned int candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, anchor), _mm_cmpeq_epi8(second, secondary)));
+
+      while (candidates != 0) {
+        unsigned int bit = lowestBit(candidates);
+
+        if (signature::compare(position + bit, signature)) {
+          return position + bit;
+        }
+
+        candidates &= candidates - 1;
+      }
+    }
+
+    return position <= last ? findScalar(position, end, signature) : nullptr;
+  }
+
+  TARGET_AVX2
+  const unsigned char* findAVX2(const unsigned char* begin, const unsigned char* end, const signature::Signature& signature) {
+    size_t length = signature.bytes.size();
+    const unsigned char* last = end - length;
+    const __m256i anchor = _mm256_set1_epi8((char) signature.bytes[signature.anchor]);
+    const __m256i secondary = _mm256_set1_epi8((char) signature.bytes[signature.secondary]);
+
+    const unsigned char* position = begin;
+
+    for (; position + 31 <= last; position += 32) {
+      __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position + signature.anchor));
+      __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position + signature.secondary));
+      unsigned int candidates = (unsigned int) _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, anchor), _mm256_cmpeq_epi8(second, secondary)));
+
+      while (candidates != 0) {
+        unsigned int bit = lowestBit(candidates);
+
+        if (signature::compare(position + bit, signature)) {
+          return position + bit;
+        }
+
+        candidates &= candidates - 1;
+      }
+    }
+
+    return position <= last ? findSSE2(position, end, signature) : nullptr;
+  }
+
+  bool supportsAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7) {
+      return false;
+    }
+
+    // AVX2 also requires the OS to save the YMM registers (OSXSAVE + XCR0)
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+      return false;
+    }
+
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+      return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+#endif
+}
+
+int signature::frequency(unsigned char byte) {
+  switch (byte) {
+    case 0x00: return 32;
+    case 0xFF: return 31;
+    case 0xCC: return 30;
+    case 0x48: return 29;
+    case 0x8B: return 28;
+    case 0x89: return 27;
+    case 0x0F: return 26;
+    case 0x90: return 25;
+    case 0xE8: return 24;
+    case 0x24: return 23;
+    case 0x4C: return 22;
+    case 0x44: return 21;
+    case 0x83: return 20;
+    case 0x01: return 19;
+    case 0x10: return 18;
+    case 0x08: return 17;
+    case 0x20: return 16;
+    case 0x40: return 15;
+    case 0x04: return 14;
+    case 0x8D: return 13;
+    case 0xC3: return 12;
+    case 0x85: return 11;
+    case 0xC0: return 10;
+    case 0x74: return 9;
+    case 0x75: return 8;
+    case 0x41: return 7;
+    case 0x45: return 6;
+    case 0x49: return 5;
+    case 0x80: return 4;
+    case 0x02: return 3;
+    case 0x33: return 2;
+    case 0xE9: return 1;
+    default: return 0;
+  }
+}
+
+bool signature::compile(const char* pattern, Signature* signature, const char** errorMessage) {
+  signature->bytes.clear();
+  signature->mask.clear();
+
+  for (const char* c = pattern; *c; c++) {
+    if (*c == ' ') {
+      continue;
+    }
+
+    if (*c == '?') {
+      signature->bytes.push_back(0x00);
+      signature->mask.push_back(0x00);
+      continue;
+    }
+
+    int high = hexValue(c[0]);
+    int low = high == -1 ? -1 : hexValue(c[1]);
+
+    if (high == -1 || low == -1) {
+      *errorMessage = "invalid signature: expected hex byte or wildcard";
+      return false;
+    }
+
+    signature->bytes.push_back((unsigned char) (high << 4 | low));
+    signature->mask.push_back(0xFF);
+    c++;
+  }
+
+  signature->anchor = 0;
+  signature->secondary = 0;
+  signature->significant = false;
+
+  // The anchor is the least common significant byte, the secondary anchor
+  // is the least common of the remaining ones, preferring ones further away
+  // from the anchor as neighbouring bytes tend to be correlated
+  int anchorScore = 0;
+  for (size_t i = 0; i < signature->bytes.size(); i++) {
+    if (signature->mask[i] == 0x00) {
+      continue;
+    }
+
+    int score = frequency(signature->bytes[i]);
+    if (!signature->significant || score < anchorScore) {
+      signature->anchor = i;
+      anchorScore = score;
+      signature->significant = true;
+    }
+  }
+
+  signature->secondary = signature->anchor;
+  int secondaryScore = 0;
+  size_t secondaryDistance = 0;
+  bool hasSecondary = false;
+
+  for (size_t i = 0; i < signature->bytes.size(); i++) {
+    if (signature->mask[i] == 0x00 || i == signature->anchor) {
+      continue;
+    }
+
+    int score = frequency(signature->bytes[i]);
+    size_t distance = i > signature->anchor ? i - signature->anchor : signature->anchor - i;
+
+    if (!hasSecondary || score < secondaryScore || (score == secondaryScore && distance > secondaryDistance)) {
+      signature->secondary = i;
+      secondaryScore = score;
+      secondaryDistance = distance;
+      hasSecondary = true;
+    }
+  }
+
+  // bytes before the final one shorten the shift to their distance from the end,
+  // a wildcard caps every shift as it could stand in for any byte
+  size_t length = signature->bytes.size();
+  size_t maxShift = length;
+
+  for (size_t i = 0; i + 1 < length; i++) {
+    if (signature->mask[i] == 0x00) {
+      maxShift = length - 1 - i;
+    }
+  }
+
+  signature->maxSkip = maxShift;
+
+  for (size_t c = 0; c < 256; c++) {
+    signature->skip[c] = maxShift;
+  }
+
+  for (size_t i = 0; i + 1 < length; i++) {
+    if (signature->mask[i] != 0x00 && length - 1 - i < signature->skip[signature->bytes[i]]) {
+      signature->skip[signature->bytes[i]] = length - 1 - i;
+    }
+  }
+
+  return true;
+}
+
+bool signature::compare(const unsigned char* bytes, const Signature& signature) {
+  const unsigned char* value = signature.bytes.data();
+  const unsigned char* mask = signature.mask.data();
+  size_t length = signature.bytes.size();
+  size_t i = 0;
+
+#ifdef SIGNATURE_X86
+  for (; i + 16 <= length; i += 16) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+    __m128i masked = _mm_and_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i)));
+    __m128i equal = _mm_cmpeq_epi8(masked, _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i)));
+
+    if (_mm_movemask_epi8(equal) != 0xFFFF) {
+      return false;
+    }
+  }
+#endif
+
+  for (; i < length; i++) {
+    if ((bytes[i] & mask[i]) != value[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const unsigned char* signature::find(const unsigned char* begin, const unsigned char* end, const Signature& signature, Kernel kernel) {
+  size_t length = signature.bytes.size();
+
+  if (begin == nullptr || end < begin || (size_t) (end - begin) < length) {
+    return nullptr;
+  }
+
+  // a signature made only of wildcards matches anywhere
+  if (!signature.significant) {
+    return begin;
+  }
+
+  static const Kernel detected = detectKernel();
+
+  if (kernel == Kernel::Auto) {
+    kernel = detected;
+  }
+
+#ifdef SIGNATURE_X86
+  if (kernel == Kernel::AVX2 && detected == Kernel::AVX2) {
+    return findAVX2(begin, end, signature);
+  }
+
+  if (kernel == Kernel::AVX2 || kernel == Kernel::SSE2) {
+    return findSSE2(begin, end, signature);
+  }
+#endif
+
+  return findScalar(begin, end, signature);
+}
+
+signature::Kernel signature::detectKernel() {
+#ifdef SIGNATURE_X86
+  // SSE2 is part of the x86-64 baseline
+  return supportsAVX2() ? Kernel::AVX2 : Kernel::SSE2;
+#else
+  return Kernel::Scalar;
+#endif
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace signature {
+  // Scanning kernels, `Auto` picks the fastest one supported by the CPU
+  enum class Kernel {
+    Auto = 0x0,
+    Scalar = 0x1,
+    SSE2 = 0x2,
+    AVX2 = 0x3
+  };
+
+  struct Signature {
+    // byte values to match, wildcard positions hold 0x00
+    std::vector<unsigned char> bytes;
+    // 0xFF for bytes that have to match, 0x00 for wildcards
+    std::vector<unsigned char> mask;
+    // index of the rarest significant byte, used to find candidates
+    size_t anchor;
+    // index of a second significant byte used to filter candidates
+    size_t secondary;
+    // whether the signature contains at least one significant byte
+    bool significant;
+    // Horspool shift for each byte found at the end of the search window,
+    // capped by the last wildcard since a wildcard matches any byte
+    size_t skip[256];
+    // largest shift in `skip`, short shifts make Horspool slower than memchr
+    size_t maxSkip;
+  };
+
+  // Parses a signature such as "8B 0D ? ? ? ? 8B 01" into value/mask arrays
+  // and precomputes the anchors and skip table used while scanning.
+  // Every `?` is a single wildcard byte and spaces are ignored.
+  bool compile(const char* pattern, Signature* signature, const char** errorMessage);
+
+  // Returns a pointer to the first match in [begin, end), or `nullptr`
+  const unsigned char* find(const unsigned char* begin, const unsigned char* end, const Signature& signature, Kernel kernel = Kernel::Auto);
+
+  // Whether `bytes` (at least `signature.bytes.size()` long) matches the signature
+  bool compare(const unsigned char* bytes, const Signature& signature);
+
+  // Rough frequency of a byte in x86 code and data sections, higher is more common.
+  // Bytes not listed are considered rare, which makes them good anchors.
+  int frequency(unsigned char byte);
+
+  // Kernel that `Kernel::Auto` resolves to on this CPU
+  Kernel detectKernel();
+}
+
+#endif
@@ -0,0 +1,1026 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include "snapshot.h"
+#include "module.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SNAPSHOT_X64
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC exposes every intrinsic regardless of the compilation flags,
+// GCC and Clang need to be told which functions are allowed to use SSE4.2
+#if defined(SNAPSHOT_X64) && !defined(_MSC_VER)
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define TARGET_SSE42
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  const char MAGIC[8] = { 'M', 'P', 'S', 'N', 'A', 'P', '\r', '\n' };
+  const uint32_t VERSION = 1;
+  const uint64_t PAGE = 0x1000;
+
+  // bytes read from the process at once while dumping
+  const size_t CHUNK = 0x100000;
+
+  // snapshot handles start above any process id and kernel handle value, and step by 4 like handles do
+  const uintptr_t HANDLE_BASE = 0x40000000;
+
+  // set on regions some pages of which couldn't be read and were stored as zeroes
+  const uint32_t REGION_PARTIAL = 1;
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    // process the dump was taken from
+    uint32_t processId;
+    uint64_t regionCount;
+    uint64_t regionTable;
+    uint64_t moduleCount;
+    uint64_t moduleTable;
+    uint64_t strings;
+    uint64_t stringsSize;
+    // pages of a delta, 0 for a dump
+    uint64_t pageCount;
+    uint64_t pageTable;
+    // 0 for a dump, the capture a delta holds counting from 1 otherwise
+    uint64_t sequence;
+    // random value identifying a dump, stored in its deltas
+    uint64_t baseline;
+  };
+
+  // The fields of MEMORY_BASIC_INFORMATION, with the offset of the region's bytes in
+  // the file. Regions of a delta have no bytes, their pages are in the page table.
+  struct FileRegion {
+    uint64_t baseAddress;
+    uint64_t allocationBase;
+    uint64_t regionSize;
+    uint32_t allocationProtect;
+    uint32_t state;
+    uint32_t protect;
+    uint32_t type;
+    uint64_t data;
+    // offset of the backing file's name in the string table
+    uint32_t name;
+    uint32_t flags;
+  };
+
+  struct FileModule {
+    uint64_t baseAddress;
+    uint64_t size;
+    uint32_t name;
+    uint32_t path;
+  };
+
+  // A page of a delta and the offset of its bytes
+  struct FilePage {
+    uint64_t address;
+    uint64_t data;
+  };
+
+  // A mapped dump or delta
+  struct File {
+    const unsigned char* data;
+    size_t size;
+    const FileHeader* header;
+    const FileRegion* regions;
+    const FileModule* modules;
+    const char* strings;
+    const FilePage* pages;
+
+    ~File() {
+      if (data == nullptr) {
+        return;
+      }
+
+#ifdef _WIN32
+      UnmapViewOfFile(data);
+#else
+      munmap((void*) data, size);
+#endif
+    }
+  };
+
+  // Latest bytes of a page changed by the deltas
+  struct Page {
+    uintptr_t address;
+    const unsigned char* bytes;
+  };
+
+  struct Snapshot {
+    // the dump first, then its deltas in order, the last file describes the regions and modules
+    std::vector<std::unique_ptr<File>> files;
+    // ascending
+    std::vector<Page> pages;
+  };
+
+  // snapshots are shared so one being closed while another thread reads from it stays mapped
+  std::mutex snapshotsMutex;
+  std::unordered_map<uintptr_t, std::shared_ptr<Snapshot>> snapshots;
+  uintptr_t nextHandle = HANDLE_BASE;
+
+  // lets the platform layer skip the lookup entirely while no snapshot is open
+  std::atomic<size_t> opened(0);
+
+  std::shared_ptr<Snapshot> find(HANDLE handle) {
+    if (opened.load(std::memory_order_relaxed) == 0 || (uintptr_t) handle < HANDLE_BASE) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(snapshotsMutex);
+
+    auto snapshot = snapshots.find((uintptr_t) handle);
+    return snapshot == snapshots.end() ? nullptr : snapshot->second;
+  }
+
+  // Region holding `address`, nullptr when it isn't part of the file
+  const FileRegion* findRegion(const File& file, uintptr_t address) {
+    const FileRegion* begin = file.regions;
+    const FileRegion* end = begin + file.header->regionCount;
+    const FileRegion* region = std::upper_bound(begin, end, address, [](uintptr_t value, const FileRegion& current) {
+      return value < current.baseAddress;
+    });
+
+    if (region == begin || address - (region - 1)->baseAddress >= (region - 1)->regionSize) {
+      return nullptr;
+    }
+
+    return region - 1;
+  }
+
+  // Whether a range lies in regions following each other in memory, and in the file when `contiguous`
+  bool isMapped(const File& file, uintptr_t address, size_t size, bool contiguous) {
+    const FileRegion* region = findRegion(file, address);
+
+    if (region == nullptr || address + size < address) {
+      return false;
+    }
+
+    const FileRegion* last = file.regions + file.header->regionCount - 1;
+
+    for (const FileRegion* current = region; address + size > current->baseAddress + current->regionSize; current++) {
+      const FileRegion* next = current + 1;
+
+      if (current == last || next->baseAddress != current->baseAddress + current->regionSize) {
+        return false;
+      }
+
+      if (contiguous && next->data != current->data + current->regionSize) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Bytes of a range of a dump
+  const unsigned char* locate(const File& file, uintptr_t address, size_t size) {
+    if (!isMapped(file, address, size, true)) {
+      return nullptr;
+    }
+
+    const FileRegion* region = findRegion(file, address);
+    return file.data + region->data + (address - region->baseAddress);
+  }
+
+  const Page* findPage(const Snapshot& snapshot, uintptr_t address) {
+    auto page = std::lower_bound(snapshot.pages.begin(), snapshot.pages.end(), address, [](const Page& current, uintptr_t value) {
+      return current.address < value;
+    });
+
+    return page != snapshot.pages.end() && page->address == address ? &*page : nullptr;
+  }
+
+  // Bytes of a range, as long as none of its pages were changed by a delta
+  const unsigned char* locate(const Snapshot& snapshot, uintptr_t address, size_t size) {
+    const File& dump = *snapshot.files.front();
+
+    if (snapshot.files.size() == 1) {
+      return locate(dump, address, size);
+    }
+
+    if (size == 0 || !isMapped(*snapshot.files.back(), address, size, false)) {
+      return nullptr;
+    }
+
+    auto page = std::lower_bound(snapshot.pages.begin(), snapshot.pages.end(), address & ~(PAGE - 1), [](const Page& current, uintptr_t value) {
+      return current.address < value;
+    });
+
+    if (page != snapshot.pages.end() && page->address < address + size) {
+      return nullptr;
+    }
+
+    return locate(dump, address, size);
+  }
+
+  // Copies a range page by page, from the latest delta holding each page or from the dump
+  bool copyPages(const Snapshot& snapshot, uintptr_t address, void* buffer, size_t size) {
+    if (snapshot.files.size() == 1 || !isMapped(*snapshot.files.back(), address, size, false)) {
+      return false;
+    }
+
+    unsigned char* output = (unsigned char*) buffer;
+
+    for (uintptr_t current = address; current < address + size;) {
+      uintptr_t page = current & ~(PAGE - 1);
+      size_t length = page + PAGE - current < address + size - current ? (size_t) (page + PAGE - current) : (size_t) (address + size - current);
+
+      const Page* changed = findPage(snapshot, page);
+      const unsigned char* bytes = changed != nullptr ? changed->bytes + (current - page) : locate(*snapshot.files.front(), current, length);
+
+      if (bytes == nullptr) {
+        return false;
+      }
+
+      memcpy(output + (current - address), bytes, length);
+      current += length;
+    }
+
+    return true;
+  }
+
+  MEMORY_BASIC_INFORMATION toRegion(const FileRegion& region) {
+    MEMORY_BASIC_INFORMATION result;
+    memset(&result, 0, sizeof(result));
+
+    result.BaseAddress = (PVOID)(uintptr_t) region.baseAddress;
+    result.AllocationBase = (PVOID)(uintptr_t) region.allocationBase;
+    result.AllocationProtect = region.allocationProtect;
+    result.RegionSize = (SIZE_T) region.regionSize;
+    result.State = region.state;
+    result.Protect = region.protect;
+    result.Type = region.type;
+
+    return result;
+  }
+
+  bool isCaptured(const MEMORY_BASIC_INFORMATION& region, const snapshot::Filter& filter) {
+    uintptr_t begin = (uintptr_t) region.BaseAddress;
+
+    if (region.State != MEM_COMMIT || region.Protect == 0 || (region.Protect & (PAGE_NOACCESS | PAGE_GUARD)) != 0) {
+      return false;
+    }
+
+    if ((filter.protection != 0 && (region.Protect & filter.protection) == 0) || (filter.type != 0 && (region.Type & filter.type) == 0)) {
+      return false;
+    }
+
+    return begin + region.RegionSize > filter.start && (filter.end == 0 || begin < filter.end);
+  }
+
+  // Offset of `value` in the string table, strings used more than once are stored once
+  uint32_t addString(std::string* table, std::unordered_map<std::string, uint32_t>* offsets, const std::string& value) {
+    auto found = offsets->find(value);
+
+    if (found != offsets->end()) {
+      return found->second;
+    }
+
+    uint32_t offset = (uint32_t) table->size();
+    table->append(value);
+    table->push_back('\0');
+    offsets->emplace(value, offset);
+
+    return offset;
+  }
+
+  // Reads a chunk of a region, unreadable pages are zeroed and counted when the chunk can't be read at once
+  uint64_t readChunk(HANDLE handle, uintptr_t address, unsigned char* buffer, size_t size) {
+    if (platform::readMemory(handle, address, buffer, size)) {
+      return 0;
+    }
+
+    uint64_t unreadable = 0;
+
+    for (size_t offset = 0; offset < size; offset += PAGE) {
+      size_t length = size - offset < PAGE ? size - offset : PAGE;
+
+      if (!platform::readMemory(handle, address + offset, buffer + offset, length)) {
+        memset(buffer + offset, 0, length);
+        unreadable++;
+      }
+    }
+
+    return unreadable;
+  }
+
+  uint32_t crc32cScalar(const unsigned char* bytes, size_t size) {
+    static const std::vector<uint32_t> table = [] {
+      std::vector<uint32_t> entries(256);
+
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t value = i;
+
+        for (int bit = 0; bit < 8; bit++) {
+          value = value & 1 ? (value >> 1) ^ 0x82F63B78 : value >> 1;
+        }
+
+        entries[i] = value;
+      }
+
+      return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < size; i++) {
+      crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+  }
+
+#ifdef SNAPSHOT_X64
+  TARGET_SSE42
+  uint32_t crc32cSSE42(const unsigned char* bytes, size_t size) {
+    uint64_t crc = 0xFFFFFFFF;
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+      uint64_t word;
+      memcpy(&word, bytes + i, sizeof(word));
+      crc = _mm_crc32_u64(crc, word);
+    }
+
+    for (; i < size; i++) {
+      crc = _mm_crc32_u8((uint32_t) crc, bytes[i]);
+    }
+
+    return ~(uint32_t) crc;
+  }
+
+  bool supportsSSE42() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#endif
+  }
+#endif
+
+  // CRC32C of a page, with the SSE4.2 instruction when the CPU has it
+  uint32_t hashPage(const unsigned char* bytes) {
+#ifdef SNAPSHOT_X64
+    static const bool sse42 = supportsSSE42();
+
+    if (sse42) {
+      return crc32cSSE42(bytes, PAGE);
+    }
+#endif
+
+    return crc32cScalar(bytes, PAGE);
+  }
+
+  // Header and tables of a dump or delta, describing the process when it was captured
+  struct Capture {
+    FileHeader header;
+    std::vector<FileRegion> regions;
+    std::vector<FileModule> modules;
+    std::string strings;
+  };
+
+  bool collect(HANDLE handle, const snapshot::Filter& filter, Capture* capture, const char** errorMessage) {
+    std::vector<std::string> names;
+    std::vector<MEMORY_BASIC_INFORMATION> regions = platform::getRegions(handle, &names);
+
+    if (regions.empty()) {
+      *errorMessage = "unable to retrieve the memory regions of the process";
+      return false;
+    }
+
+    const char* moduleError = "";
+    std::vector<MODULEENTRY32> modules = module::getModules(platform::getProcessId(handle), &moduleError);
+    std::unordered_map<std::string, uint32_t> offsets;
+
+    // the empty string comes first, regions without a backing file point at it
+    addString(&capture->strings, &offsets, std::string());
+
+    for (size_t i = 0; i < regions.size(); i++) {
+      if (!isCaptured(regions[i], filter)) {
+        continue;
+      }
+
+      FileRegion region;
+      memset(&region, 0, sizeof(region));
+
+      region.baseAddress = (uintptr_t) regions[i].BaseAddress;
+      region.allocationBase = (uintptr_t) regions[i].AllocationBase;
+      region.regionSize = regions[i].RegionSize;
+      region.allocationProtect = regions[i].AllocationProtect;
+      region.state = regions[i].State;
+      region.protect = regions[i].Protect;
+      region.type = regions[i].Type;
+      region.name = addString(&capture->strings, &offsets, names[i]);
+
+      capture->regions.push_back(region);
+    }
+
+    for (auto& entry : modules) {
+      FileModule fileModule;
+      fileModule.baseAddress = (uintptr_t) entry.modBaseAddr;
+      fileModule.size = entry.modBaseSize;
+      fileModule.name = addString(&capture->strings, &offsets, entry.szModule);
+      fileModule.path = addString(&capture->strings, &offsets, entry.szExePath);
+
+      capture->modules.push_back(fileModule);
+    }
+
+    FileHeader& header = capture->header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+    header.version = VERSION;
+    header.processId = platform::getProcessId(handle);
+    header.regionCount = capture->regions.size();
+    header.regionTable = sizeof(FileHeader);
+    header.moduleCount = capture->modules.size();
+    header.moduleTable = header.regionTable + capture->regions.size() * sizeof(FileRegion);
+    header.strings = header.moduleTable + capture->modules.size() * sizeof(FileModule);
+    header.stringsSize = capture->strings.size();
+
+    return true;
+  }
+
+  // Offset of the first page of data, right after the tables
+  uint64_t getDataOffset(const FileHeader& header) {
+    return (header.strings + header.stringsSize + PAGE - 1) & ~(PAGE - 1);
+  }
+
+  // Writes the header, the tables and the padding up to the first page of data
+  bool writeTables(FILE* file, const Capture& capture) {
+    static const unsigned char padding[PAGE] = {};
+    size_t paddingSize = (size_t) (getDataOffset(capture.header) - capture.header.strings - capture.header.stringsSize);
+
+    return fwrite(&capture.header, sizeof(FileHeader), 1, file) == 1
+      && (capture.regions.empty() || fwrite(capture.regions.data(), sizeof(FileRegion), capture.regions.size(), file) == capture.regions.size())
+      && (capture.modules.empty() || fwrite(capture.modules.data(), sizeof(FileModule), capture.modules.size(), file) == capture.modules.size())
+      && fwrite(capture.strings.data(), 1, capture.strings.size(), file) == capture.strings.size()
+      && fwrite(padding, 1, paddingSize, file) == paddingSize;
+  }
+
+  uint64_t createBaseline() {
+    std::random_device device;
+    uint64_t random = ((uint64_t) device() << 32) | device();
+    return random ^ (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+
+  // Whether a page was part of the ranges captured last time
+  bool isTracked(const std::vector<std::pair<uintptr_t, uintptr_t>>& ranges, uintptr_t address) {
+    auto range = std::upper_bound(ranges.begin(), ranges.end(), address, [](uintptr_t value, const std::pair<uintptr_t, uintptr_t>& current) {
+      return value < current.first;
+    });
+
+    return range != ranges.begin() && address < (range - 1)->second;
+  }
+
+  std::vector<std::pair<uintptr_t, uintptr_t>> toRanges(const std::vector<FileRegion>& regions) {
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+
+    for (auto& region : regions) {
+      ranges.emplace_back((uintptr_t) region.baseAddress, (uintptr_t) (region.baseAddress + region.regionSize));
+    }
+
+    return ranges;
+  }
+
+  // Dumps every region, hashing its pages for `tracker` when it can't rely on soft-dirty bits
+  bool writeDump(HANDLE handle, const char* path, const snapshot::Filter& filter, snapshot::Stats* stats, snapshot::Tracker* tracker, const char** errorMessage, const std::atomic<bool>* cancelled) {
+    Capture capture;
+
+    if (!collect(handle, filter, &capture, errorMessage)) {
+      return false;
+    }
+
+    capture.header.baseline = createBaseline();
+
+    // region bytes start on a page boundary, one region right after the other
+    uint64_t data = getDataOffset(capture.header);
+
+    for (auto& region : capture.regions) {
+      region.data = data;
+      data += region.regionSize;
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if (file == nullptr) {
+      *errorMessage = "unable to create the snapshot file";
+      return false;
+    }
+
+    std::vector<unsigned char> buffer(CHUNK);
+    std::vector<snapshot::PageHash> hashes;
+    bool hashing = tracker != nullptr && !tracker->softDirty;
+    bool written = writeTables(file, capture);
+    bool partial = false;
+
+    *stats = { capture.regions.size(), 0, 0 };
+
+    for (size_t i = 0; written && i < capture.regions.size(); i++) {
+      FileRegion& region = capture.regions[i];
+
+      for (uint64_t offset = 0; written && offset < region.regionSize; offset += CHUNK) {
+        if (cancelled != nullptr && cancelled->load()) {
+          written = false;
+          break;
+        }
+
+        uintptr_t address = (uintptr_t) (region.baseAddress + offset);
+        size_t size = region.regionSize - offset < CHUNK ? (size_t) (region.regionSize - offset) : CHUNK;
+        uint64_t unreadable = readChunk(handle, address, buffer.data(), size);
+
+        if (unreadable != 0) {
+          region.flags |= REGION_PARTIAL;
+          stats->unreadable += unreadable;
+          partial = true;
+        }
+
+        for (size_t page = 0; hashing && page + PAGE <= size; page += PAGE) {
+          hashes.push_back({ address + page, hashPage(buffer.data() + page) });
+        }
+
+        written = fwrite(buffer.data(), 1, size, file) == size;
+      }
+
+      stats->bytes += region.regionSize;
+    }
+
+    // the region table sits right after the header, well within reach of fseek
+    if (written && partial) {
+      written = fseek(file, (long) capture.header.regionTable, SEEK_SET) == 0
+        && fwrite(capture.regions.data(), sizeof(FileRegion), capture.regions.size(), file) == capture.regions.size();
+    }
+
+    written = fclose(file) == 0 && written;
+
+    if (!written) {
+      remove(path);
+      *errorMessage = cancelled != nullptr && cancelled->load() ? "dump was cancelled" : "unable to write the snapshot file";
+      return false;
+    }
+
+    if (tracker != nullptr) {
+      tracker->baseline = capture.header.baseline;
+      tracker->ranges = toRanges(capture.regions);
+      tracker->hashes = std::move(hashes);
+    }
+
+    return true;
+  }
+
+  // Maps a whole file read-only
+  bool map(const char* path, File* mapped) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= (LONGLONG) sizeof(FileHeader)) {
+      mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+
+    CloseHandle(file);
+
+    if (mapping == NULL) {
+      return false;
+    }
+
+    // the view keeps the mapping alive once its handle is closed
+    mapped->data = (const unsigned char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    mapped->size = (size_t) fileSize.QuadPart;
+    CloseHandle(mapping);
+#else
+    int file = ::open(path, O_RDONLY);
+
+    if (file == -1) {
+      return false;
+    }
+
+    struct stat info;
+    void* data = MAP_FAILED;
+
+    if (fstat(file, &info) == 0 && info.st_size >= (off_t) sizeof(FileHeader)) {
+      data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    ::close(file);
+
+    mapped->data = data == MAP_FAILED ? nullptr : (const unsigned char*) data;
+    mapped->size = (size_t) info.st_size;
+#endif
+
+    if (mapped->data == nullptr) {
+      return false;
+    }
+
+    mapped->header = (const FileHeader*) mapped->data;
+    mapped->regions = (const FileRegion*) (mapped->data + mapped->header->regionTable);
+    mapped->modules = (const FileModule*) (mapped->data + mapped->header->moduleTable);
+    mapped->strings = (const char*) (mapped->data + mapped->header->strings);
+    mapped->pages = (const FilePage*) (mapped->data + mapped->header->pageTable);
+
+    return true;
+  }
+
+  // Checks the tables of a mapped file so lookups never reach past its end
+  bool isValid(const File& file, bool delta) {
+    const FileHeader* header = file.header;
+
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION || (header->sequence != 0) != delta) {
+      return false;
+    }
+
+    if (header->regionTable > file.size || header->regionCount > (file.size - header->regionTable) / sizeof(FileRegion)) {
+      return false;
+    }
+
+    if (header->moduleTable > file.size || header->moduleCount > (file.size - header->moduleTable) / sizeof(FileModule)) {
+      return false;
+    }
+
+    if (header->pageTable > file.size || header->pageCount > (file.size - header->pageTable) / sizeof(FilePage)) {
+      return false;
+    }
+
+    if (header->strings > file.size || header->stringsSize > file.size - header->strings || header->stringsSize == 0 || file.strings[header->stringsSize - 1] != '\0') {
+      return false;
+    }
+
+    for (uint64_t i = 0; i < header->regionCount; i++) {
+      const FileRegion& region = file.regions[i];
+
+      if (region.name >= header->stringsSize || (delta ? region.data != 0 : region.data > file.size || region.regionSize > file.size - region.data)) {
+        return false;
+      }
+
+      // lookups are binary searches
+      if (i != 0 && region.baseAddress < file.regions[i - 1].baseAddress + file.regions[i - 1].regionSize) {
+        return false;
+      }
+    }
+
+    for (uint64_t i = 0; i < header->moduleCount; i++) {
+      if (file.modules[i].name >= header->stringsSize || file.modules[i].path >= header->stringsSize) {
+        return false;
+      }
+    }
+
+    for (uint64_t i = 0; i < header->pageCount; i++) {
+      const FilePage& page = file.pages[i];
+
+      if (page.data > file.size || PAGE > file.size - page.data || (page.address & (PAGE - 1)) != 0) {
+        return false;
+      }
+
+      if (i != 0 && page.address <= file.pages[i - 1].address) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+bool snapshot::dump(HANDLE handle, const char* path, const Filter& filter, Stats* stats, const char** errorMessage, const std::atomic<bool>* cancelled) {
+  return writeDump(handle, path, filter, stats, nullptr, errorMessage, cancelled);
+}
+
+bool snapshot::track(HANDLE handle, const char* path, const Filter& filter, Tracker* tracker, Stats* stats, const char** errorMessage) {
+  tracker->handle = handle;
+  tracker->filter = filter;
+  tracker->sequence = 0;
+
+  // bits are cleared before the baseline is read, so no write made while dumping is missed
+  tracker->softDirty = platform::resetDirtyPages(handle);
+
+  return writeDump(handle, path, filter, stats, tracker, errorMessage, nullptr);
+}
+
+bool snapshot::capture(Tracker& tracker, const char* path, DeltaStats* stats, const char** errorMessage) {
+  Capture capture;
+
+  if (!collect(tracker.handle, tracker.filter, &capture, errorMessage)) {
+    return false;
+  }
+
+  capture.header.sequence = tracker.sequence + 1;
+  capture.header.baseline = tracker.baseline;
+
+  // which pages changed, by region
+  std::vector<std::vector<bool>> dirty(capture.regions.size());
+  bool softDirty = tracker.softDirty;
+
+  *stats = { 0, 0, softDirty };
+
+  if (softDirty) {
+    // a write landing between reading the bits and clearing them would be lost, so the process
+    // is stopped in between. When it can't be, every page is taken: the pages are read after
+    // the bits are cleared, so nothing written before or after is missed.
+    bool resume;
+    bool stopped = platform::suspendProcess(tracker.handle, &resume);
+
+    for (size_t i = 0; i < capture.regions.size(); i++) {
+      size_t count = (size_t) (capture.regions[i].regionSize / PAGE);
+
+      if (!stopped || !platform::getDirtyPages(tracker.handle, (uintptr_t) capture.regions[i].baseAddress, count, &dirty[i])) {
+        dirty[i].assign(count, true);
+      }
+    }
+
+    // pages written from now on show up in the next capture, or every page does
+    // once the bits can't be cleared anymore
+    bool reset = platform::resetDirtyPages(tracker.handle);
+
+    if (resume) {
+      platform::resumeProcess(tracker.handle);
+    }
+
+    if (!reset) {
+      tracker.softDirty = false;
+      tracker.ranges.clear();
+    }
+  }
+
+  FILE* file = fopen(path, "wb");
+
+  if (file == nullptr) {
+    *errorMessage = "unable to create the snapshot file";
+    return false;
+  }
+
+  std::vector<unsigned char> buffer(CHUNK);
+  std::vector<FilePage> pages;
+  std::vector<PageHash> hashes;
+  uint64_t data = getDataOffset(capture.header);
+  bool written = writeTables(file, capture);
+
+  // hashes of the last capture are walked alongside the pages, both being in ascending order
+  size_t previous = 0;
+
+  for (size_t i = 0; written && i < capture.regions.size(); i++) {
+    const FileRegion& region = capture.regions[i];
+
+    for (uint64_t offset = 0; written && offset < region.regionSize; offset += CHUNK) {
+      uintptr_t address = (uintptr_t) (region.baseAddress + offset);
+      size_t size = region.regionSize - offset < CHUNK ? (size_t) (region.regionSize - offset) : CHUNK;
+      size_t count = size / PAGE;
+      size_t first = (size_t) (offset / PAGE);
+
+      bool read = !softDirty;
+
+      for (size_t page = 0; softDirty && page < count; page++) {
+        read = read || dirty[i][first + page] || !isTracked(tracker.ranges, address + page * PAGE);
+      }
+
+      stats->pagesScanned += count;
+
+      if (read) {
+        readChunk(tracker.handle, address, buffer.data(), size);
+      }
+
+      for (size_t page = 0; read && written && page < count; page++) {
+        uintptr_t current = address + page * PAGE;
+        const unsigned char* bytes = buffer.data() + page * PAGE;
+        bool changed;
+
+        if (softDirty) {
+          changed = dirty[i][first + page] || !isTracked(tracker.ranges, current);
+        } else {
+          uint32_t hash = hashPage(bytes);
+
+          while (previous < tracker.hashes.size() && tracker.hashes[previous].address < current) {
+            previous++;
+          }
+
+          changed = previous == tracker.hashes.size() || tracker.hashes[previous].address != current || tracker.hashes[previous].hash != hash;
+          hashes.push_back({ current, hash });
+        }
+
+        if (changed) {
+          pages.push_back({ current, data });
+          data += PAGE;
+          written = fwrite(bytes, 1, PAGE, file) == PAGE;
+        }
+      }
+    }
+  }
+
+  stats->pagesCopied = pages.size();
+
+  // the page table comes after the pages, whose number is only known once they are written
+  capture.header.pageCount = pages.size();
+  capture.header.pageTable = data;
+
+  written = written
+    && (pages.empty() || fwrite(pages.data(), sizeof(FilePage), pages.size(), file) == pages.size())
+    && fseek(file, 0, SEEK_SET) == 0
+    && fwrite(&capture.header, sizeof(FileHeader), 1, file) == 1;
+
+  written = fclose(file) == 0 && written;
+
+  if (!written) {
+    remove(path);
+    *errorMessage = "unable to write the snapshot file";
+
+    // soft-dirty bits were cleared already, everything has to be copied next time
+    tracker.ranges.clear();
+    tracker.hashes.clear();
+    return false;
+  }
+
+  tracker.sequence++;
+  tracker.ranges = toRanges(capture.regions);
+
+  if (!softDirty) {
+    tracker.hashes = std::move(hashes);
+  }
+
+  return true;
+}
+
+HANDLE snapshot::open(const char* path, const std::vector<std::string>& deltas, const char** errorMessage) {
+  std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+
+  for (size_t i = 0; i <= deltas.size(); i++) {
+    std::unique_ptr<File> file(new File());
+    file->data = nullptr;
+
+    if (!map(i == 0 ? path : deltas[i - 1].c_str(), file.get())) {
+      *errorMessage = "unable to open the snapshot file";
+      return NULL;
+    }
+
+    if (!isValid(*file, i != 0)) {
+      *errorMessage = "file isn't a snapshot or is corrupted";
+      return NULL;
+    }
+
+    if (i != 0 && (file->header->baseline != snapshot->files.front()->header->baseline || file->header->sequence != i)) {
+      *errorMessage = "deltas have to be given in the order they were captured, after the dump they were captured from";
+      return NULL;
+    }
+
+    snapshot->files.push_back(std::move(file));
+  }
+
+  // the latest copy of each page wins
+  std::unordered_map<uintptr_t, const unsigned char*> changed;
+
+  for (size_t i = 1; i < snapshot->files.size(); i++) {
+    const File& file = *snapshot->files[i];
+
+    for (uint64_t j = 0; j < file.header->pageCount; j++) {
+      changed[(uintptr_t) file.pages[j].address] = file.data + file.pages[j].data;
+    }
+  }
+
+  for (auto& page : changed) {
+    snapshot->pages.push_back({ page.first, page.second });
+  }
+
+  std::sort(snapshot->pages.begin(), snapshot->pages.end(), [](const Page& a, const Page& b) {
+    return a.address < b.address;
+  });
+
+  std::lock_guard<std::mutex> lock(snapshotsMutex);
+
+  uintptr_t handle = nextHandle;
+  nextHandle += 4;
+
+  snapshots[handle] = snapshot;
+  opened++;
+
+  return (HANDLE) handle;
+}
+
+bool snapshot::close(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(snapshotsMutex);
+
+  if (snapshots.erase((uintptr_t) handle) == 0) {
+    return false;
+  }
+
+  opened--;
+  return true;
+}
+
+bool snapshot::isSnapshot(HANDLE handle) {
+  return find(handle) != nullptr;
+}
+
+bool snapshot::readMemory(HANDLE handle, uintptr_t address, void* buffer, size_t size) {
+  std::shared_ptr<Snapshot> snapshot = find(handle);
+
+  if (!snapshot) {
+    return false;
+  }
+
+  const unsigned char* bytes = locate(*snapshot, address, size);
+
+  if (bytes == nullptr) {
+    return copyPages(*snapshot, address, buffer, size);
+  }
+
+  memcpy(buffer, bytes, size);
+  return true;
+}
+
+std::vector<MEMORY_BASIC_INFORMATION> snapshot::getRegions(HANDLE handle, std::vector<std::string>* names) {
+  std::vector<MEMORY_BASIC_INFORMATION> regions;
+  std::shared_ptr<Snapshot> snapshot = find(handle);
+
+  if (!snapshot) {
+    return regions;
+  }
+
+  const File& file = *snapshot->files.back();
+
+  for (uint64_t i = 0; i < file.header->regionCount; i++) {
+    regions.push_back(toRegion(file.regions[i]));
+
+    if (names != nullptr) {
+      names->push_back(file.strings + file.regions[i].name);
+    }
+  }
+
+  return regions;
+}
+
+bool snapshot::queryRegion(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region) {
+  std::shared_ptr<Snapshot> snapshot = find(handle);
+  const FileRegion* found = snapshot ? findRegion(*snapshot->files.back(), address) : nullptr;
+
+  if (found == nullptr) {
+    return false;
+  }
+
+  *region = toRegion(*found);
+  return true;
+}
+
+bool snapshot::getModules(DWORD processId, std::vector<MODULEENTRY32>* modules) {
+  std::shared_ptr<Snapshot> snapshot = find((HANDLE)(uintptr_t) processId);
+
+  if (!snapshot) {
+    return false;
+  }
+
+  const File& file = *snapshot->files.back();
+  modules->clear();
+
+  for (uint64_t i = 0; i < file.header->moduleCount; i++) {
+    const FileModule& fileModule = file.modules[i];
+
+    MODULEENTRY32 entry;
+    memset(&entry, 0, sizeof(entry));
+
+    entry.dwSize = sizeof(entry);
+    entry.th32ProcessID = processId;
+    entry.modBaseAddr = (BYTE*)(uintptr_t) fileModule.baseAddress;
+    entry.modBaseSize = (DWORD) fileModule.size;
+    entry.hModule = (HMODULE)(uintptr_t) fileModule.baseAddress;
+    strncpy(entry.szModule, file.strings + fileModule.name, sizeof(entry.szModule) - 1);
+    strncpy(entry.szExePath, file.strings + fileModule.path, sizeof(entry.szExePath) - 1);
+
+    modules->push_back(entry);
+  }
+
+  return true;
+}
+
+const unsigned char* snapshot::view(HANDLE handle, uintptr_t address, size_t size, std::shared_ptr<const void>* mapping) {
+  std::shared_ptr<Snapshot> snapshot = find(handle);
+  const unsigned char* bytes = snapshot ? locate(*snapshot, address, size) : nullptr;
+
+  if (bytes != nullptr) {
+    *mapping = snapshot;
+  }
+
+  return bytes;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "platform.h"
+
+// Process dumps written to disk and opened again as read-only pseudo processes.
+//
+// A dump is a header, a table of the regions captured, a table of the modules
+// loaded, a string table with their names, then the bytes of every region
+// starting on a page boundary. Fields are stored in the byte order of the machine
+// that wrote the dump. Opened dumps are memory mapped and handed out as handles
+// the platform layer serves reads, region queries and module lists from, so
+// everything built on top of it works on a dump like it does on a live process.
+//
+// A dump can be the baseline of deltas, which only hold the pages written since
+// the previous capture. A delta has the same tables as a dump, describing the
+// process when it was captured, followed by the pages and a table of their addresses.
+namespace snapshot {
+  struct Filter {
+    // regions kept have one of these protection bits, 0 for any readable region
+    DWORD protection;
+    // regions kept have one of these types (MEM_IMAGE, MEM_MAPPED, MEM_PRIVATE), 0 for any
+    DWORD type;
+    // regions kept overlap [start, end), an `end` of 0 for no limit
+    uintptr_t start;
+    uintptr_t end;
+  };
+
+  struct Stats {
+    size_t regions;
+    uint64_t bytes;
+    // pages that couldn't be read and were stored as zeroes
+    uint64_t unreadable;
+  };
+
+  struct DeltaStats {
+    // pages checked for changes, and pages written to the delta
+    uint64_t pagesScanned;
+    uint64_t pagesCopied;
+    // whether the kernel told which pages changed, pages were hashed otherwise
+    bool softDirty;
+  };
+
+  // A 4 KiB page and its CRC32C, as of the last capture
+  struct PageHash {
+    uintptr_t address;
+    uint32_t hash;
+  };
+
+  // Changes of a process followed since its baseline dump
+  struct Tracker {
+    HANDLE handle;
+    Filter filter;
+    // identifies the baseline, stored in each delta
+    uint64_t baseline;
+    uint64_t sequence;
+    bool softDirty;
+    // ranges captured last time, ascending, pages outside of them are always copied
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    // hashes of the pages captured last time, ascending, when soft-dirty bits aren't available
+    std::vector<PageHash> hashes;
+  };
+
+  // Streams every committed readable region passing `filter` into `path`
+  bool dump(HANDLE handle, const char* path, const Filter& filter, Stats* stats, const char** errorMessage, const std::atomic<bool>* cancelled = nullptr);
+
+  // Dumps the baseline into `path` and starts following the pages written from then on
+  bool track(HANDLE handle, const char* path, const Filter& filter, Tracker* tracker, Stats* stats, const char** errorMessage);
+
+  // Writes the pages changed since the last capture into a delta at `path`
+  bool capture(Tracker& tracker, const char* path, DeltaStats* stats, const char** errorMessage);
+
+  // Maps a dump along with deltas of it, applied in order. The handle returned is closed by `close`.
+  HANDLE open(const char* path, const std::vector<std::string>& deltas, const char** errorMessage);
+  bool close(HANDLE handle);
+
+  bool isSnapshot(HANDLE handle);
+
+  // Same contract as their `platform` counterparts, for handles returned by `open`.
+  // The process id of a snapshot is the value of its handle.
+  bool readMemory(HANDLE handle, uintptr_t address, void* buffer, size_t size);
+  std::vector<MEMORY_BASIC_INFORMATION> getRegions(HANDLE handle, std::vector<std::string>* names);
+  bool queryRegion(HANDLE handle, uintptr_t address, MEMORY_BASIC_INFORMATION* region);
+  bool getModules(DWORD processId, std::vector<MODULEENTRY32>* modules);
+
+  // Bytes of [address, address + size) straight from the mapping, nullptr unless
+  // `handle` is a snapshot holding the whole range. `mapping` keeps the file
+  // mapped while the bytes are in use, even if the snapshot gets closed.
+  const unsigned char* view(HANDLE handle, uintptr_t address, size_t size, std::shared_ptr<const void>* mapping);
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <thread>
+#include "threadpool.h"
+
+threadpool::threadpool() : threads(0), job(nullptr), generation(0), pending(0), stopping(false) {}
+
+threadpool::~threadpool() {
+  stop();
+}
+
+threadpool& threadpool::shared() {
+  // never destroyed, joining workers while the addon is being unloaded can deadlock
+  static threadpool* pool = new threadpool();
+  return *pool;
+}
+
+void threadpool::setThreads(unsigned int count) {
+  // the next `run` starts the workers again when their number doesn't match
+  threads = count;
+}
+
+unsigned int threadpool::getThreads() {
+  unsigned int count = threads;
+  return count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : count;
+}
+
+void threadpool::run(size_t count, const std::function<void(size_t)>& task) {
+  std::lock_guard<std::mutex> lock(runMutex);
+
+  unsigned int total = getThreads();
+
+  // workers left from before the count went down to 1
+  if (total == 1 && !workers.empty()) {
+    stop();
+  }
+
+  // nothing to gain from waking workers up
+  if (total == 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+
+    return;
+  }
+
+  if (workers.size() != total - 1) {
+    stop();
+    start(total);
+  }
+
+  {
+    std::lock_guard<std::mutex> state(mutex);
+    job = &task;
+    pending = count;
+  }
+
+  // hand out contiguous blocks so every worker starts on its own part of the
+  // address space, queue 0 belongs to the calling thread and gets the lowest indices
+  for (size_t queue = 0; queue < queues.size(); queue++) {
+    size_t begin = count * queue / queues.size();
+    size_t end = count * (queue + 1) / queues.size();
+
+    std::lock_guard<std::mutex> guard(queues[queue]->mutex);
+    for (size_t i = begin; i < end; i++) {
+      queues[queue]->tasks.push_back(i);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> state(mutex);
+    generation++;
+  }
+  wake.notify_all();
+
+  work(0);
+
+  std::unique_lock<std::mutex> state(mutex);
+  done.wait(state, [this] { return pending == 0; });
+  job = nullptr;
+}
+
+void threadpool::start(unsigned int count) {
+  stopping = false;
+
+  queues.clear();
+  for (unsigned int i = 0; i < count; i++) {
+    queues.push_back(std::unique_ptr<Queue>(new Queue()));
+  }
+
+  for (unsigned int i = 1; i < count; i++) {
+    workers.push_back(std::thread([this, i] {
+      size_t seen = 0;
+
+      while (true) {
+        {
+          std::unique_lock<std::mutex> state(mutex);
+          wake.wait(state, [this, seen] { return stopping || generation != seen; });
+
+          if (stopping) {
+            return;
+          }
+
+          seen = generation;
+        }
+
+        work(i);
+      }
+    }));
+  }
+}
+
+void threadpool::stop() {
+  {
+    std::lock_guard<std::mutex> state(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  workers.clear();
+}
+
+void threadpool::work(size_t queue) {
+  size_t index;
+
+  while (next(queue, &index)) {
+    const std::function<void(size_t)>* task;
+    {
+      std::lock_guard<std::mutex> state(mutex);
+      task = job;
+    }
+
+    (*task)(index);
+
+    std::lock_guard<std::mutex> state(mutex);
+    if (--pending == 0) {
+      done.notify_all();
+    }
+  }
+}
+
+bool threadpool::next(size_t queue, size_t* index) {
+  {
+    std::lock_guard<std::mutex> guard(queues[queue]->mutex);
+
+    if (!queues[queue]->tasks.empty()) {
+      *index = queues[queue]->tasks.front();
+      queues[queue]->tasks.pop_front();
+      return true;
+    }
+  }
+
+  // steal the highest pending index of another queue, leaving it the work
+  // closest to what it is currently scanning
+  for (size_t i = 1; i < queues.size(); i++) {
+    Queue& victim = *queues[(queue + i) % queues.size()];
+    std::lock_guard<std::mutex> guard(victim.mutex);
+
+    if (!victim.tasks.empty()) {
+      *index = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+
+  return false;
+}
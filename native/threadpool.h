@@ -0,0 +1,64 @@
+#pragma once
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool used to spread scans over every core.
+// Each worker owns a queue of task indices it takes from the front of,
+// and steals from the back of other queues once its own runs dry.
+class threadpool {
+public:
+  threadpool();
+  ~threadpool();
+
+  // Shared pool used by the scanners
+  static threadpool& shared();
+
+  // Number of threads taking part in `run`, including the calling thread.
+  // 0 resets it to the number of hardware threads. A change applies from the next `run`.
+  void setThreads(unsigned int count);
+  unsigned int getThreads();
+
+  // Calls `task(index)` for every index in [0, count) and returns once all of them are done.
+  // Lower indices are handed out first, so a task can bail out early once a lower index has
+  // produced the result it is looking for.
+  void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  void start(unsigned int count);
+  void stop();
+  void work(size_t queue);
+  bool next(size_t queue, size_t* index);
+
+  // read without `runMutex`, so the count can be looked at or changed while a scan runs
+  std::atomic<unsigned int> threads;
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Queue>> queues;
+
+  // serialises `run` calls coming from different threads
+  std::mutex runMutex;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(size_t)>* job;
+  size_t generation;
+  size_t pending;
+  bool stopping;
+};
+
+#endif
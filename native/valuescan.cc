@@ -0,0 +1,400 @@
+#include <cstring>
+#include <vector>
+#include "valuescan.h"
+#include "platform.h"
+#include "threadpool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VALUESCAN_X86
+#include <emmintrin.h>
+#endif
+
+using valuescan::Block;
+using valuescan::Condition;
+using valuescan::Scan;
+
+namespace {
+  // regions are split into blocks of this size so they can be scanned in parallel
+  const size_t BLOCK_SIZE = 0x100000;
+
+  bool isWritable(const MEMORY_BASIC_INFORMATION& region) {
+    return region.State == MEM_COMMIT && !(region.Protect & PAGE_GUARD)
+      && (region.Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+  }
+
+  size_t countBits(uint64_t bits) {
+    size_t count = 0;
+
+    for (; bits != 0; bits &= bits - 1) {
+      count++;
+    }
+
+    return count;
+  }
+
+  template <class T>
+  T load(const unsigned char* bytes) {
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+  }
+
+  // Changed/unchanged compare the bytes, so a float that stays NaN is unchanged
+  template <class T>
+  bool passes(valuescan::Compare compare, const unsigned char* current, const unsigned char* previous, const Condition& condition) {
+    switch (compare) {
+      case valuescan::C_EXACT:
+        return load<T>(current) == load<T>(condition.value);
+      case valuescan::C_RANGE:
+        return load<T>(current) >= load<T>(condition.value) && load<T>(current) <= load<T>(condition.maximum);
+      case valuescan::C_UNKNOWN:
+        return true;
+      case valuescan::C_CHANGED:
+        return memcmp(current, previous, sizeof(T)) != 0;
+      case valuescan::C_UNCHANGED:
+        return memcmp(current, previous, sizeof(T)) == 0;
+      case valuescan::C_INCREASED:
+        return load<T>(current) > load<T>(previous);
+      case valuescan::C_DECREASED:
+        return load<T>(current) < load<T>(previous);
+    }
+
+    return false;
+  }
+
+#ifdef VALUESCAN_X86
+  // Evaluates 64 consecutive 4 byte values at once, one bit per value
+  uint64_t filter32(valuescan::Type type, valuescan::Compare compare, const unsigned char* current, const unsigned char* previous, const Condition& condition) {
+    const __m128i ones = _mm_set1_epi32(-1);
+    // unsigned values are compared as signed ones once their sign bit is flipped
+    const __m128i bias = _mm_set1_epi32(type == valuescan::T_UINT32 ? (int) 0x80000000 : 0);
+    const __m128i value = _mm_xor_si128(_mm_set1_epi32(load<int32_t>(condition.value)), bias);
+    const __m128i maximum = _mm_xor_si128(_mm_set1_epi32(load<int32_t>(condition.maximum)), bias);
+    const __m128 valueFloat = _mm_set1_ps(load<float>(condition.value));
+    const __m128 maximumFloat = _mm_set1_ps(load<float>(condition.maximum));
+
+    uint64_t mask = 0;
+
+    for (int i = 0; i < 16; i++) {
+      __m128i now = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i * 16));
+      __m128i before = previous != nullptr ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i * 16)) : _mm_setzero_si128();
+      __m128i keep = ones;
+
+      if (compare == valuescan::C_CHANGED) {
+        keep = _mm_andnot_si128(_mm_cmpeq_epi32(now, before), ones);
+      } else if (compare == valuescan::C_UNCHANGED) {
+        keep = _mm_cmpeq_epi32(now, before);
+      } else if (type == valuescan::T_FLOAT) {
+        __m128 nowFloat = _mm_castsi128_ps(now);
+        __m128 beforeFloat = _mm_castsi128_ps(before);
+
+        switch (compare) {
+          case valuescan::C_EXACT: keep = _mm_castps_si128(_mm_cmpeq_ps(nowFloat, valueFloat)); break;
+          case valuescan::C_RANGE: keep = _mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(nowFloat, valueFloat), _mm_cmple_ps(nowFloat, maximumFloat))); break;
+          case valuescan::C_INCREASED: keep = _mm_castps_si128(_mm_cmpgt_ps(nowFloat, beforeFloat)); break;
+          case valuescan::C_DECREASED: keep = _mm_castps_si128(_mm_cmplt_ps(nowFloat, beforeFloat)); break;
+          default: break;
+        }
+      } else {
+        now = _mm_xor_si128(now, bias);
+        before = _mm_xor_si128(before, bias);
+
+        switch (compare) {
+          case valuescan::C_EXACT: keep = _mm_cmpeq_epi32(now, value); break;
+          case valuescan::C_RANGE: keep = _mm_andnot_si128(_mm_or_si128(_mm_cmpgt_epi32(value, now), _mm_cmpgt_epi32(now, maximum)), ones); break;
+          case valuescan::C_INCREASED: keep = _mm_cmpgt_epi32(now, before); break;
+          case valuescan::C_DECREASED: keep = _mm_cmplt_epi32(now, before); break;
+          default: break;
+        }
+      }
+
+      mask |= (uint64_t) _mm_movemask_ps(_mm_castsi128_ps(keep)) << (i * 4);
+    }
+
+    return mask;
+  }
+#endif
+
+  // Clears the bits of the dense candidates failing the condition, `previous` is null for a first scan
+  template <class T>
+  size_t filterDense(const Scan& scan, Block& block, const unsigned char* current, const unsigned char* previous, const Condition& condition) {
+    size_t count = 0;
+
+    for (size_t word = 0; word < block.bitmap.size(); word++) {
+      uint64_t bits = block.bitmap[word];
+
+      if (bits == 0) {
+        continue;
+      }
+
+      size_t offset = word * 64 * scan.alignment;
+
+#ifdef VALUESCAN_X86
+      // every value of the word is a candidate and they are packed back to back
+      if (bits == ~0ULL && sizeof(T) == 4 && scan.alignment == 4) {
+        bits = filter32(scan.type, condition.compare, current + offset, previous != nullptr ? previous + offset : nullptr, condition);
+        block.bitmap[word] = bits;
+        count += countBits(bits);
+        continue;
+      }
+#endif
+
+      uint64_t kept = 0;
+
+      for (size_t bit = 0; bit < 64; bit++) {
+        // skip a byte of the word at a time while it holds no candidate
+        if ((bit & 7) == 0 && ((bits >> bit) & 0xFF) == 0) {
+          bit += 7;
+          continue;
+        }
+
+        if ((bits >> bit) & 1) {
+          size_t position = offset + bit * scan.alignment;
+
+          if (passes<T>(condition.compare, current + position, previous != nullptr ? previous + position : nullptr, condition)) {
+            kept |= 1ULL << bit;
+          }
+        }
+      }
+
+      block.bitmap[word] = kept;
+      count += countBits(kept);
+    }
+
+    return count;
+  }
+
+  // Switches a block to offsets once they take less memory than its bitmap and snapshot
+  void compact(const Scan& scan, Block& block) {
+    if (!block.dense || block.count * (sizeof(uint32_t) + scan.valueSize) >= block.bitmap.size() * sizeof(uint64_t) + block.snapshot.size()) {
+      return;
+    }
+
+    block.offsets.reserve(block.count);
+    block.values.reserve(block.count * scan.valueSize);
+
+    for (size_t word = 0; word < block.bitmap.size(); word++) {
+      for (uint64_t bits = block.bitmap[word]; bits != 0; bits &= bits - 1) {
+        size_t bit = countBits((bits & (0 - bits)) - 1);
+        uint32_t offset = (uint32_t) ((word * 64 + bit) * scan.alignment);
+
+        block.offsets.push_back(offset);
+        block.values.insert(block.values.end(), block.snapshot.begin() + offset, block.snapshot.begin() + offset + scan.valueSize);
+      }
+    }
+
+    std::vector<uint64_t>().swap(block.bitmap);
+    std::vector<unsigned char>().swap(block.snapshot);
+    block.dense = false;
+  }
+
+  void drop(Block& block) {
+    std::vector<uint64_t>().swap(block.bitmap);
+    std::vector<unsigned char>().swap(block.snapshot);
+    std::vector<uint32_t>().swap(block.offsets);
+    std::vector<unsigned char>().swap(block.values);
+    block.count = 0;
+  }
+
+  template <class T>
+  void scanDense(const Scan& scan, Block& block, const Condition& condition, bool first) {
+    std::vector<unsigned char> current(block.length);
+
+    if (!platform::readMemory(scan.handle, block.address, current.data(), current.size())) {
+      drop(block);
+      return;
+    }
+
+    if (first) {
+      // every slot a whole value fits in starts out as a candidate
+      size_t fitting = block.length < scan.valueSize ? 0 : (block.length - scan.valueSize) / scan.alignment + 1;
+      size_t starting = (block.size + scan.alignment - 1) / scan.alignment;
+      size_t slots = fitting < starting ? fitting : starting;
+
+      block.bitmap.assign((slots + 63) / 64, ~0ULL);
+
+      if (slots % 64 != 0) {
+        block.bitmap.back() = (1ULL << (slots % 64)) - 1;
+      }
+    }
+
+    block.count = filterDense<T>(scan, block, current.data(), first ? nullptr : block.snapshot.data(), condition);
+    block.snapshot.swap(current);
+
+    compact(scan, block);
+  }
+
+  template <class T>
+  void scanSparse(const Scan& scan, Block& block, const Condition& condition) {
+    std::vector<unsigned char> current(block.count * scan.valueSize);
+    std::vector<platform::Read> reads(block.count);
+    std::vector<bool> success;
+
+    for (size_t i = 0; i < block.count; i++) {
+      reads[i] = { block.address + block.offsets[i], current.data() + i * scan.valueSize, scan.valueSize };
+    }
+
+    platform::readMemory(scan.handle, reads, &success);
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < block.count; i++) {
+      const unsigned char* now = current.data() + i * scan.valueSize;
+
+      if (success[i] && passes<T>(condition.compare, now, block.values.data() + i * scan.valueSize, condition)) {
+        block.offsets[kept] = block.offsets[i];
+        memcpy(block.values.data() + kept * scan.valueSize, now, scan.valueSize);
+        kept++;
+      }
+    }
+
+    block.count = kept;
+    block.offsets.resize(kept);
+    block.values.resize(kept * scan.valueSize);
+  }
+
+  template <class T>
+  void scanBlock(const Scan& scan, Block& block, const Condition& condition, bool first) {
+    if (first || block.dense) {
+      scanDense<T>(scan, block, condition, first);
+    } else {
+      scanSparse<T>(scan, block, condition);
+    }
+  }
+
+  void scanBlock(const Scan& scan, Block& block, const Condition& condition, bool first) {
+    switch (scan.type) {
+      case valuescan::T_INT8: return scanBlock<int8_t>(scan, block, condition, first);
+      case valuescan::T_UINT8: return scanBlock<uint8_t>(scan, block, condition, first);
+      case valuescan::T_INT16: return scanBlock<int16_t>(scan, block, condition, first);
+      case valuescan::T_UINT16: return scanBlock<uint16_t>(scan, block, condition, first);
+      case valuescan::T_INT32: return scanBlock<int32_t>(scan, block, condition, first);
+      case valuescan::T_UINT32: return scanBlock<uint32_t>(scan, block, condition, first);
+      case valuescan::T_INT64: return scanBlock<int64_t>(scan, block, condition, first);
+      case valuescan::T_UINT64: return scanBlock<uint64_t>(scan, block, condition, first);
+      case valuescan::T_FLOAT: return scanBlock<float>(scan, block, condition, first);
+      case valuescan::T_DOUBLE: return scanBlock<double>(scan, block, condition, first);
+    }
+  }
+
+  // Scans every block in parallel, blocks left without candidates are dropped
+  void run(Scan& scan, const Condition& condition, bool first) {
+    threadpool::shared().run(scan.blocks.size(), [&](size_t index) {
+      scanBlock(scan, scan.blocks[index], condition, first);
+    });
+
+    size_t kept = 0;
+    scan.count = 0;
+
+    for (size_t i = 0; i < scan.blocks.size(); i++) {
+      if (scan.blocks[i].count != 0) {
+        scan.count += scan.blocks[i].count;
+        std::swap(scan.blocks[kept++], scan.blocks[i]);
+      }
+    }
+
+    scan.blocks.resize(kept);
+  }
+}
+
+size_t valuescan::getSize(Type type) {
+  switch (type) {
+    case T_INT8: case T_UINT8: return 1;
+    case T_INT16: case T_UINT16: return 2;
+    case T_INT32: case T_UINT32: case T_FLOAT: return 4;
+    case T_INT64: case T_UINT64: case T_DOUBLE: return 8;
+  }
+
+  return 0;
+}
+
+void valuescan::encode(Type type, double value, unsigned char* output) {
+  memset(output, 0, 8);
+
+  switch (type) {
+    case T_INT8: { int8_t data = (int8_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_UINT8: { uint8_t data = (uint8_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_INT16: { int16_t data = (int16_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_UINT16: { uint16_t data = (uint16_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_INT32: { int32_t data = (int32_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_UINT32: { uint32_t data = (uint32_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_INT64: { int64_t data = (int64_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_UINT64: { uint64_t data = (uint64_t) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_FLOAT: { float data = (float) value; memcpy(output, &data, sizeof(data)); break; }
+    case T_DOUBLE: memcpy(output, &value, sizeof(value)); break;
+  }
+}
+
+bool valuescan::first(HANDLE handle, Type type, size_t alignment, const Condition& condition, Scan* scan, const char** errorMessage) {
+  if (condition.compare != C_EXACT && condition.compare != C_RANGE && condition.compare != C_UNKNOWN) {
+    *errorMessage = "a first scan can only look for an exact value, a range or an unknown value";
+    return false;
+  }
+
+  scan->handle = handle;
+  scan->type = type;
+  scan->valueSize = getSize(type);
+  scan->alignment = alignment == 0 ? scan->valueSize : alignment;
+  scan->count = 0;
+  scan->blocks.clear();
+
+  for (auto& region : platform::getRegions(handle)) {
+    if (!isWritable(region)) {
+      continue;
+    }
+
+    uintptr_t base = (uintptr_t) region.BaseAddress;
+
+    for (size_t offset = 0; offset < region.RegionSize; offset += BLOCK_SIZE) {
+      size_t size = region.RegionSize - offset < BLOCK_SIZE ? region.RegionSize - offset : BLOCK_SIZE;
+      size_t remaining = region.RegionSize - offset - size;
+      size_t overlap = scan->valueSize - 1 < remaining ? scan->valueSize - 1 : remaining;
+
+      Block block;
+      block.address = base + offset;
+      block.size = size;
+      block.length = size + overlap;
+      block.count = 0;
+      block.dense = true;
+
+      scan->blocks.push_back(std::move(block));
+    }
+  }
+
+  run(*scan, condition, true);
+  return true;
+}
+
+bool valuescan::next(Scan& scan, const Condition& condition, const char** errorMessage) {
+  if (condition.compare == C_UNKNOWN) {
+    *errorMessage = "an unknown value can only be looked for by a first scan";
+    return false;
+  }
+
+  run(scan, condition, false);
+  return true;
+}
+
+void valuescan::results(const Scan& scan, size_t maxResults, std::vector<uint64_t>* addresses) {
+  size_t limit = maxResults == 0 || maxResults > scan.count ? scan.count : maxResults;
+  addresses->reserve(limit);
+
+  for (auto& block : scan.blocks) {
+    if (block.dense) {
+      for (size_t word = 0; word < block.bitmap.size() && addresses->size() < limit; word++) {
+        for (uint64_t bits = block.bitmap[word]; bits != 0 && addresses->size() < limit; bits &= bits - 1) {
+          size_t bit = countBits((bits & (0 - bits)) - 1);
+          addresses->push_back(block.address + (word * 64 + bit) * scan.alignment);
+        }
+      }
+    } else {
+      for (size_t i = 0; i < block.offsets.size() && addresses->size() < limit; i++) {
+        addresses->push_back(block.address + block.offsets[i]);
+      }
+    }
+
+    if (addresses->size() >= limit) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef VALUESCAN_H
+#define VALUESCAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "platform.h"
+
+// First/next value scanner. A first scan snapshots every writable region and keeps
+// the addresses whose value passes a condition, next scans read the candidates again
+// and keep the ones passing a new condition, which can compare against the last scan.
+namespace valuescan {
+  enum Type {
+    T_INT8,
+    T_UINT8,
+    T_INT16,
+    T_UINT16,
+    T_INT32,
+    T_UINT32,
+    T_INT64,
+    T_UINT64,
+    T_FLOAT,
+    T_DOUBLE
+  };
+
+  enum Compare {
+    // equal to `value`
+    C_EXACT,
+    // between `value` and `maximum`, both included
+    C_RANGE,
+    // every value, only valid for a first scan
+    C_UNKNOWN,
+    // compared with the value read by the previous scan, only valid for next scans
+    C_CHANGED,
+    C_UNCHANGED,
+    C_INCREASED,
+    C_DECREASED
+  };
+
+  struct Condition {
+    Compare compare;
+    // values stored as the scanned type
+    unsigned char value[8];
+    unsigned char maximum[8];
+  };
+
+  // Part of a region, scanned by a single task. Candidates are kept as a bitmap
+  // with one bit per aligned slot while they are dense, along with a snapshot of the
+  // block, and as offsets with their values once that takes less memory.
+  struct Block {
+    uintptr_t address;
+    // bytes values can start in
+    size_t size;
+    // bytes read, `size` plus room for the last value
+    size_t length;
+    size_t count;
+    bool dense;
+
+    std::vector<uint64_t> bitmap;
+    std::vector<unsigned char> snapshot;
+
+    std::vector<uint32_t> offsets;
+    std::vector<unsigned char> values;
+  };
+
+  struct Scan {
+    HANDLE handle;
+    Type type;
+    size_t valueSize;
+    size_t alignment;
+    size_t count;
+    std::vector<Block> blocks;
+  };
+
+  size_t getSize(Type type);
+
+  // Stores `value` as `type` into `output`, which has to hold 8 bytes
+  void encode(Type type, double value, unsigned char* output);
+
+  // `alignment` of 0 aligns values to their own size
+  bool first(HANDLE handle, Type type, size_t alignment, const Condition& condition, Scan* scan, const char** errorMessage);
+  bool next(Scan& scan, const Condition& condition, const char** errorMessage);
+
+  // Addresses of the candidates in ascending order, at most `maxResults` of them (0 for all)
+  void results(const Scan& scan, size_t maxResults, std::vector<uint64_t>* addresses);
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "watcher.h"
+
+namespace {
+  // bytes of the values compared at once before looking at the entries inside
+  const size_t BLOCK_SIZE = 64;
+  // values closer than this are read as one range, reading the gap costs less than another range
+  const size_t MERGE_GAP = 256;
+}
+
+watcher::Watcher::Watcher(HANDLE handle, const std::vector<Entry>& entries, uint32_t interval, std::function<void()> notify)
+  : handle(handle), entries(entries), interval(interval), notify(notify), stopping(false), notified(false) {
+  size_t size = 0;
+
+  for (auto& entry : entries) {
+    offsets.push_back(size);
+    size += entry.size;
+  }
+
+  current.assign(size, 0);
+  previous.assign(size, 0);
+  pending.assign(size, 0);
+  readable.assign(entries.size(), true);
+  pendingReadable.assign(entries.size(), true);
+  marked.assign(entries.size(), false);
+
+  order.resize(entries.size());
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    order[i] = (uint32_t) i;
+  }
+
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return entries[a].address < entries[b].address; });
+
+  size_t spanSize = 0;
+
+  for (size_t i = 0; i < order.size(); i++) {
+    const Entry& entry = entries[order[i]];
+
+    if (!spans.empty() && entry.address <= spans.back().address + spans.back().size + MERGE_GAP) {
+      platform::Read& span = spans.back();
+      span.size = std::max(span.size, entry.address + entry.size - span.address);
+      continue;
+    }
+
+    if (!spans.empty()) {
+      spanSize += spans.back().size;
+    }
+
+    spans.push_back({ entry.address, nullptr, entry.size });
+    spanFirst.push_back(i);
+  }
+
+  if (!spans.empty()) {
+    spanSize += spans.back().size;
+  }
+
+  spanFirst.push_back(order.size());
+  spanBuffer.resize(spanSize);
+
+  for (size_t i = 0, offset = 0; i < spans.size(); offset += spans[i].size, i++) {
+    spans[i].buffer = spanBuffer.data() + offset;
+  }
+
+  // an entry spanning two blocks is the first one of the second
+  for (size_t block = 0, i = 0; block * BLOCK_SIZE < size; block++) {
+    while (offsets[i] + entries[i].size <= block * BLOCK_SIZE) {
+      i++;
+    }
+
+    blockFirst.push_back((uint32_t) i);
+  }
+
+  thread = std::thread(&Watcher::run, this);
+}
+
+watcher::Watcher::~Watcher() {
+  stop();
+}
+
+void watcher::Watcher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  wake.notify_all();
+
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+bool watcher::Watcher::take(Changes* changes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  notified = false;
+
+  changes->indices.clear();
+  changes->values.clear();
+  changes->readable.clear();
+
+  if (changed.empty()) {
+    return false;
+  }
+
+  std::sort(changed.begin(), changed.end());
+
+  for (uint32_t i : changed) {
+    changes->indices.push_back(i);
+    changes->values.insert(changes->values.end(), pending.begin() + offsets[i], pending.begin() + offsets[i] + entries[i].size);
+    changes->readable.push_back(pendingReadable[i]);
+    marked[i] = false;
+  }
+
+  changed.clear();
+  return true;
+}
+
+void watcher::Watcher::run() {
+  auto next = std::chrono::steady_clock::now();
+
+  for (bool first = true;; first = false) {
+    poll(first);
+
+    // a tick taking longer than the interval delays the next one instead of piling them up
+    auto now = std::chrono::steady_clock::now();
+    next = std::max(next + std::chrono::milliseconds(interval), now);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (wake.wait_until(lock, next, [this]() { return stopping; })) {
+      return;
+    }
+  }
+}
+
+void watcher::Watcher::poll(bool first) {
+  platform::readMemory(handle, spans, &spanRead);
+  success.assign(entries.size(), true);
+  retries.clear();
+  retried.clear();
+
+  for (size_t i = 0; i < spans.size(); i++) {
+    for (size_t j = spanFirst[i]; j < spanFirst[i + 1]; j++) {
+      uint32_t index = order[j];
+      unsigned char* value = current.data() + offsets[index];
+
+      if (spanRead[i]) {
+        memcpy(value, (const unsigned char*) spans[i].buffer + (entries[index].address - spans[i].address), entries[index].size);
+      } else {
+        retries.push_back({ entries[index].address, value, entries[index].size });
+        retried.push_back(index);
+      }
+    }
+  }
+
+  // part of a range isn't readable, its values may be
+  if (!retries.empty()) {
+    platform::readMemory(handle, retries, &retryRead);
+
+    for (size_t i = 0; i < retried.size(); i++) {
+      success[retried[i]] = retryRead[i];
+    }
+  }
+
+  found.clear();
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (!success[i]) {
+      memset(current.data() + offsets[i], 0, entries[i].size);
+    }
+
+    // values that couldn't be read or can be again are changes whatever their bytes
+    if (success[i] != readable[i]) {
+      readable[i] = success[i];
+      found.push_back((uint32_t) i);
+    }
+  }
+
+  size_t size = current.size();
+  // entries before it were looked at with an earlier block
+  size_t checked = 0;
+
+  for (size_t block = 0; block < blockFirst.size(); block++) {
+    size_t begin = block * BLOCK_SIZE;
+    size_t length = std::min(BLOCK_SIZE, size - begin);
+
+    if (memcmp(current.data() + begin, previous.data() + begin, length) == 0) {
+      continue;
+    }
+
+    size_t i = std::max((size_t) blockFirst[block], checked);
+
+    for (; i < entries.size() && offsets[i] < begin + length; i++) {
+      if (memcmp(current.data() + offsets[i], previous.data() + offsets[i], entries[i].size) != 0) {
+        found.push_back((uint32_t) i);
+      }
+    }
+
+    checked = i;
+  }
+
+  previous.swap(current);
+
+  // the first tick only sets the values changes are found against
+  if (first || found.empty()) {
+    return;
+  }
+
+  bool waking;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (uint32_t i : found) {
+      memcpy(pending.data() + offsets[i], previous.data() + offsets[i], entries[i].size);
+      pendingReadable[i] = readable[i];
+
+      if (!marked[i]) {
+        marked[i] = true;
+        changed.push_back(i);
+      }
+    }
+
+    waking = !notified;
+    notified = true;
+  }
+
+  if (waking) {
+    notify();
+  }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "platform.h"
+
+// Value watcher. A thread of its own reads every watched value in one batch per tick, values
+// close to each other read as a single range, into a buffer laid out like the previous one,
+// and compares the two a block at a time with memcmp (vectorized by the C library) before
+// looking at the values of a block that changed. Changes pile up until the consumer takes them, the latest value of every entry
+// kept once, so a consumer slower than the interval gets one batch instead of a backlog.
+namespace watcher {
+  struct Entry {
+    uintptr_t address;
+    // bytes of the value, at most 16
+    size_t size;
+  };
+
+  // Entries changed since the changes were last taken, ascending, with their latest values
+  // one after the other, `size` bytes each
+  struct Changes {
+    std::vector<uint32_t> indices;
+    std::vector<unsigned char> values;
+    // false for the entries that couldn't be read, their values are zeroes
+    std::vector<bool> readable;
+  };
+
+  class Watcher {
+  public:
+    // Starts polling. `notify` is called from the polling thread when changes are waiting to
+    // be taken and none were waiting before.
+    Watcher(HANDLE handle, const std::vector<Entry>& entries, uint32_t interval, std::function<void()> notify);
+    ~Watcher();
+
+    // Stops polling and waits for the thread, `notify` is never called afterwards
+    void stop();
+
+    // Takes the changes waiting, false when there are none
+    bool take(Changes* changes);
+
+  private:
+    void run();
+    void poll(bool first);
+
+    HANDLE handle;
+    std::vector<Entry> entries;
+    // where every entry's value is in the buffers, and the first entry of every block
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> blockFirst;
+    uint32_t interval;
+    std::function<void()> notify;
+
+    // ranges covering the values, read into `spanBuffer`, and the entries inside each of
+    // them: entries `order[spanFirst[i]]` to `order[spanFirst[i + 1] - 1]`
+    std::vector<platform::Read> spans;
+    std::vector<unsigned char> spanBuffer;
+    std::vector<uint32_t> order;
+    std::vector<size_t> spanFirst;
+    std::vector<bool> spanRead;
+    // the values of ranges that couldn't be read, read again one by one
+    std::vector<platform::Read> retries;
+    std::vector<uint32_t> retried;
+    std::vector<bool> retryRead;
+
+    // read this tick and the last one
+    std::vector<bool> success;
+    std::vector<unsigned char> current;
+    std::vector<unsigned char> previous;
+    std::vector<bool> readable;
+    std::vector<uint32_t> found;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    // latest values of the entries in `changed`, not taken yet
+    std::vector<unsigned char> pending;
+    std::vector<bool> pendingReadable;
+    std::vector<uint32_t> changed;
+    std::vector<bool> marked;
+    bool notified;
+
+    std::thread thread;
+  };
+}
+
+#endif
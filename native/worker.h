@@ -0,0 +1,85 @@
+#pragma once
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <napi.h>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Set from JavaScript (through an AbortSignal) to stop a worker early
+typedef std::shared_ptr<std::atomic<bool>> Cancellation;
+
+// Called at the end of an `execute` whose work stops early once cancelled, so a result cut
+// short rejects the promise instead of resolving it
+inline void reportAborted(const Cancellation& cancellation, const char** errorMessage) {
+  if (cancellation && cancellation->load()) {
+    *errorMessage = "aborted";
+  }
+}
+
+// Runs blocking work on the libuv thread pool and settles a promise with the result.
+// `execute` runs on a worker thread and reports failures through `errorMessage`,
+// `resolve` runs back on the JavaScript thread and builds the value the promise resolves to.
+// A worker cancelled before it starts is rejected as aborted without running `execute`, once
+// it runs only `execute` can tell it stopped early (see `reportAborted`).
+class PromiseWorker : public Napi::AsyncWorker {
+public:
+  PromiseWorker(Napi::Env env, Cancellation cancellation, std::function<void(const char** errorMessage)> execute, std::function<Napi::Value(Napi::Env)> resolve)
+    : Napi::AsyncWorker(env),
+      deferred(Napi::Promise::Deferred::New(env)),
+      cancellation(cancellation),
+      execute(execute),
+      resolve(resolve) {}
+
+  // Keeps a JavaScript value used by `execute` (a compiled pattern, a target buffer) alive until the worker is done
+  void keep(Napi::Value value) {
+    kept.push_back(Napi::Persistent(value));
+  }
+
+  // Queues the worker, the returned promise is settled once it is done
+  Napi::Promise start() {
+    Napi::Promise promise = deferred.Promise();
+    Queue();
+    return promise;
+  }
+
+  void Execute() override {
+    const char* errorMessage = "";
+
+    if (isCancelled()) {
+      SetError("aborted");
+      return;
+    }
+
+    execute(&errorMessage);
+
+    if (strcmp(errorMessage, "")) {
+      SetError(errorMessage);
+    }
+  }
+
+  void OnOK() override {
+    deferred.Resolve(resolve(Env()));
+  }
+
+  void OnError(const Napi::Error& error) override {
+    deferred.Reject(error.Value());
+  }
+
+private:
+  bool isCancelled() {
+    return cancellation && cancellation->load();
+  }
+
+  Napi::Promise::Deferred deferred;
+  Cancellation cancellation;
+  std::function<void(const char**)> execute;
+  std::function<Napi::Value(Napi::Env)> resolve;
+  std::vector<Napi::Reference<Napi::Value>> kept;
+};
+
+#endif
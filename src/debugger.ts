@@ -56,43 +56,89 @@ class Registers {
   }
 }
 
+// What the pump does with a register's stops, see `DebugPolicies`
+const HANDLED = 0x0;
+
 class Debugger extends EventEmitter {
   constructor(memoryprocess) {
     super();
     this.memoryprocess = memoryprocess;
     this.registers = new Registers();
     this.attached = false;
-    this.intervals = [];
+    this.pump = null;
+    this.processes = new Set();
+    this.policies = new Map();
+  }
+
+  // The pump's native thread waits for debug events and continues them, JavaScript only
+  // hears about them. It is only running while a process is attached to, so it doesn't
+  // keep the event loop alive otherwise.
+  getPump() {
+    if (!this.pump) {
+      this.pump = this.memoryprocess.createDebugPump(events => this.dispatch(events));
+
+      this.policies.forEach((policy, register) => {
+        this.memoryprocess.setDebugPolicy(this.pump, register, policy);
+      });
+    }
+
+    return this.pump;
+  }
+
+  close() {
+    if (this.pump) {
+      this.memoryprocess.closeDebugPump(this.pump);
+      this.pump = null;
+    }
+
+    this.attached = false;
   }
 
   attach(processId, killOnDetach = false) {
-    const success = this.memoryprocess.attachDebugger(processId, killOnDetach);
+    const success = this.memoryprocess.debugPumpAttach(this.getPump(), processId, killOnDetach);
 
     if (success) {
       this.attached = true;
+      this.processes.add(processId);
+    } else if (this.processes.size === 0) {
+      this.close();
     }
 
     return success;
   }
 
   detach(processId) {
-    this.intervals.map(({ id }) => clearInterval(id));
-    return this.memoryprocess.detachDebugger(processId);
+    if (!this.pump) {
+      return false;
+    }
+
+    const success = this.memoryprocess.debugPumpDetach(this.pump, processId);
+    this.processes.delete(processId);
+
+    if (this.processes.size === 0) {
+      this.close();
+    }
+
+    return success;
   }
 
   removeHardwareBreakpoint(processId, register) {
-    const success = this.memoryprocess.removeHardwareBreakpoint(processId, register);
+    if (!this.pump) {
+      return false;
+    }
+
+    const success = this.memoryprocess.debugPumpRemoveBreakpoint(this.pump, processId, register);
 
     if (success) {
       this.registers.unbusy(register);
-    }
 
-    // Find the register's corresponding interval and delete it
-    this.intervals.forEach(({ register: r, id }) => {
-      if (r === register) {
-        clearInterval(id);
+      // The next breakpoint set in this register starts from the default policy
+      this.policies.delete(register);
+
+      if (this.pump) {
+        this.memoryprocess.setDebugPolicy(this.pump, register, HANDLED);
       }
-    });
+    }
 
     return success;
   }
@@ -113,39 +159,55 @@ class Debugger extends EventEmitter {
     // Obtain an available register
     const register = this.registers.getRegister();
     const success = this.memoryprocess
-      .setHardwareBreakpoint(processId, address, register, trigger, size);
+      .debugPumpSetBreakpoint(this.getPump(), processId, address, register, trigger, size);
 
     // If the breakpoint was set, mark this register as busy
     if (success) {
       this.registers.busy(register);
-      this.monitor(register);
     }
 
     return register;
   }
 
+  // Kept for code written when a register's hits were polled for, `timeout` being how long
+  // each poll waited. The pump delivers them as they come, so there is nothing to start.
   monitor(register, timeout = 100) {
-    const id = setInterval(() => {
-      const debugEvent = this.memoryprocess.awaitDebugEvent(register, timeout);
+  }
 
-      if (debugEvent) {
-        this.memoryprocess.handleDebugEvent(debugEvent.processId, debugEvent.threadId);
+  // Sets what is done with a register's hits: continued as handled (the default), passed on
+  // to the process, or held until `continue` is called for the thread that hit it.
+  // -1 stands for the exceptions that aren't hardware breakpoints, passed on by default.
+  setPolicy(register, policy = HANDLED) {
+    if (this.pump) {
+      this.memoryprocess.setDebugPolicy(this.pump, register, policy);
+    }
 
-        // Global event for all registers
-        this.emit('debugEvent', {
-          register,
-          event: debugEvent,
-        });
+    this.policies.set(register, policy);
+  }
 
-        // Event per register
+  continue(processId, threadId, handled = true) {
+    if (!this.pump) {
+      return false;
+    }
+
+    return this.memoryprocess.continueDebugEvent(this.pump, processId, threadId, handled);
+  }
+
+  dispatch(events) {
+    for (const debugEvent of events) {
+      const register = debugEvent.hardwareRegister;
+
+      // Global event for all registers
+      this.emit('debugEvent', {
+        register,
+        event: debugEvent,
+      });
+
+      // Event per register
+      if (register !== -1) {
         this.emit(register, debugEvent);
       }
-    }, 100);
-
-    this.intervals.push({
-      register,
-      id,
-    });
+    }
   }
 }
 
@@ -1,12 +1,12 @@
 // @ts-ignore
 const memoryprocess = require('./native.node');
 import { existsSync, type PathLike } from 'fs';
-import { MemoryAllocationFlags, type Protection, MemoryAccessFlags, MemoryPageFlags, type Process, type Module, type DataType, type MemoryData } from "./types"
+import { MemoryAllocationFlags, type Protection, MemoryAccessFlags, MemoryPageFlags, type Process, type Module, type DataType, type DataTypeId, type MemoryData, type CompiledPattern, type PatternRequest, type BatchRead, type BatchResult, type ReadChain, type ReadPlan, type StructField, type StructOptions, type StructValue, type StructColumns, type ColumnRead, type PageCacheOptions, type PageCacheStats, type StringOptions, type ScanDataType, type ScanCondition, type ValueScan, type SnapshotFilter, type DumpStats, type TrackedDump, type DeltaStats, type PointerScanOptions, type PointerScanStats, type PointerChain, type PointerFilterStats, type WatchedValue, type Watch, type DebugEvent, type DebugPump, type DebugPolicy, type BreakpointTriggerType } from "./types"
 import Debugger from './debugger';
 import { STRUCTRON_TYPE_STRING } from './utils';
 
 /* TODO:
- * - remove callbacks from all functions and implement promise support using Napi
+ * - remove callbacks from the remaining functions in favour of the *Async variants
  * - validate argument types in JS space instead of C++
  * - refactor read/write memory functions to use buffers instead?
  * - add support for more data types
@@ -82,17 +82,36 @@ function getModules(processId: number, callback?: ((modules: Module[], errorMess
   return memoryprocess.getModules(processId, callback);
 }
 
+/**
+ * Sets how long process and module listings are trusted for. Processes and modules are
+ * looked up in an index; on Linux, when the kernel reports process starts and exits,
+ * the process index is kept current without listing processes again.
+ *
+ * @param milliseconds - How old a listing can be before it is taken again (1000 by default), 0 to take it on every call.
+ * @returns The maximum age that will be used.
+ */
+function setProcessIndexMaxAge(milliseconds: number): number {
+  return memoryprocess.setProcessIndexMaxAge(milliseconds);
+}
+
+/**
+ * Ids of the data types, by name. They come from the native module so they always match it.
+ */
+const DataTypes: Readonly<Record<Exclude<DataType, `${string}_be`>, DataTypeId>> = memoryprocess.DataTypes;
+
 /**
  * Reads a value from a process's memory.
  * 
  * @param handle - The handle of the process to read from.
  * @param address - The address to read from.
- * @param dataType - The data type to read.
+ * @param dataType - The data type to read, a name or an id from `DataTypes`.
  * @param callback - Optional callback function to handle the result asynchronously.
  * @returns The read value or undefined if the operation failed.
  */
-function readMemory<T extends DataType>(handle: number, address: number, dataType: T, callback?: (value: MemoryData<T>, errorMessage: string) => void): MemoryData<T> | undefined {
-  if (dataType.endsWith('_be')) {
+function readMemory<T extends DataType>(handle: number, address: number, dataType: T, callback?: (value: MemoryData<T>, errorMessage: string) => void): MemoryData<T> | undefined;
+function readMemory(handle: number, address: number, dataType: DataTypeId, callback?: (value: any, errorMessage: string) => void): any;
+function readMemory(handle: number, address: number, dataType: DataType | DataTypeId, callback?: (value: any, errorMessage: string) => void): any {
+  if (typeof dataType === 'string' && dataType.endsWith('_be')) {
     return readMemoryBE(handle, address, dataType, callback);
   }
 
@@ -183,19 +202,257 @@ function readBuffer(handle: number, address: number, size: number, callback?: (b
   return memoryprocess.readBuffer(handle, address, size, callback);
 }
 
+/**
+ * Reads a NUL terminated string from a process's memory.
+ *
+ * The string is read in chunks growing from 64 bytes to 64 KiB, stopping at page boundaries,
+ * and searched for its terminator as it comes in, so short strings cost a single small read.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The address of the string.
+ * @param options - Maximum length and encoding of the string.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns The string, cut at `maxLength` characters.
+ */
+function readString(handle: number, address: number | bigint, options?: StringOptions, callback?: (errorMessage: string, value: string) => void): string {
+  if (!callback) {
+    return memoryprocess.readString(handle, address, options);
+  }
+
+  return memoryprocess.readString(handle, address, options, callback);
+}
+
+/**
+ * Reads a process's memory straight into an existing buffer, without allocating.
+ * Reusing the same target keeps repeated snapshots of a region allocation free.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The memory address to read from.
+ * @param target - Buffer, ArrayBuffer, typed array or DataView to read into.
+ * @param offset - Byte offset into `target` to start writing at.
+ * @param length - The number of bytes to read, defaults to the rest of `target`.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns Whether the whole range could be read.
+ */
+function readBufferInto(handle: number, address: number | bigint, target: ArrayBuffer | ArrayBufferView, offset = 0, length?: number, callback?: (errorMessage: string, success: boolean) => void): boolean {
+  if (length === undefined) {
+    length = target.byteLength - offset;
+  }
+
+  if (!callback) {
+    return memoryprocess.readBufferInto(handle, address, target, offset, length);
+  }
+
+  return memoryprocess.readBufferInto(handle, address, target, offset, length, callback);
+}
+
+/**
+ * Reads many values from a process's memory at once, with as few system calls as possible.
+ *
+ * Values are packed into the returned buffer in request order, each aligned to its own size
+ * (vectors to 4 bytes), at `offsets`. Values that couldn't be read are left zeroed, the
+ * status byte of each request at `statusOffset + index` is 1 when its value was read.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param requests - Address and data type of every value to read.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns A buffer holding every value and its status.
+ */
+function readMemoryBatch(handle: number, requests: BatchRead[], callback?: (errorMessage: string, buffer: BatchResult) => void): BatchResult {
+  if (!callback) {
+    return memoryprocess.readMemoryBatch(handle, requests);
+  }
+
+  return memoryprocess.readMemoryBatch(handle, requests, callback);
+}
+
+/**
+ * Polls values on a native thread and calls back with the ones that changed. Every tick
+ * reads all the values in one batch and compares them with the previous ones, the event
+ * loop is only entered when something changed. Changes made while the callback hasn't run
+ * yet are merged, the latest value of every one kept, so a busy event loop gets a single
+ * call instead of a backlog.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param values - Address and data type of every value to watch.
+ * @param intervalMs - Milliseconds between two reads of the values.
+ * @param onChange - Called with the indices (into `values`, ascending) of the values that
+ * changed and their new values, null for the ones that can no longer be read.
+ * @returns The watch, polling until passed to `unwatch`.
+ */
+function watch(handle: number, values: WatchedValue[], intervalMs: number, onChange: (indices: Uint32Array, values: (MemoryData<Exclude<BatchRead['type'], DataTypeId>> | null)[]) => void): Watch {
+  return memoryprocess.watch(handle, values, intervalMs, onChange);
+}
+
+/**
+ * Stops a watch started by `watch`, its callback is never called again.
+ *
+ * @param watch - The watch to stop.
+ */
+function unwatch(watch: Watch): void {
+  memoryprocess.unwatch(watch);
+}
+
+/**
+ * Compiles pointer chains into a plan that can be executed over and over.
+ *
+ * @param chains - Pointer chains to follow, each ending with the data type to read.
+ * @param pointerSize - Size of the pointers in the target process, 4 or 8 (defaults to the addon's).
+ * @returns The compiled plan and the layout of the buffer it writes to.
+ */
+function compileReadPlan(chains: ReadChain[], pointerSize?: 4 | 8): ReadPlan {
+  if (pointerSize === undefined) {
+    return memoryprocess.compileReadPlan(chains);
+  }
+
+  return memoryprocess.compileReadPlan(chains, pointerSize);
+}
+
+/**
+ * Follows every chain of a read plan in native code and writes the values into `target`.
+ * Hops at the same depth are read in a single batch and nothing is allocated,
+ * so the same target can be reused by a polling loop.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param plan - Plan returned by `compileReadPlan`.
+ * @param target - Buffer of at least `plan.byteLength` bytes.
+ * @returns The number of chains whose value could be read.
+ */
+function executeReadPlan(handle: number, plan: ReadPlan, target: ArrayBuffer | ArrayBufferView): number {
+  return memoryprocess.executeReadPlan(handle, plan.compiled, target);
+}
+
+/**
+ * Reads an array of structs at once and scatters the fields asked for into columns, one
+ * typed array per field. Nothing is allocated, so the same columns can be refilled every frame.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The address of the first struct.
+ * @param count - The number of structs.
+ * @param stride - Bytes between the start of two structs.
+ * @param columns - Offset, data type and target of every field to read.
+ * @returns The number of structs that could be read.
+ */
+function readColumns(handle: number, address: number | bigint, count: number, stride: number, columns: ColumnRead[]): number {
+  return memoryprocess.readColumns(handle, address, count, stride, columns);
+}
+
+/**
+ * Registers a struct layout, so structs can be read and decoded in native code.
+ * Layouts can refer to layouts registered before them, for nested structs and
+ * pointers to structs.
+ *
+ * @param fields - Name, offset and type of every field.
+ * @param options - Size of the struct and of the pointers it holds.
+ * @returns The id of the layout.
+ */
+function registerStruct(fields: StructField[], options?: StructOptions): number {
+  if (!options) {
+    return memoryprocess.registerStruct(fields);
+  }
+
+  return memoryprocess.registerStruct(fields, options);
+}
+
+/**
+ * Reads a struct in one read and decodes every field in native code, following
+ * pointers to other registered structs.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The address of the struct.
+ * @param layout - Layout returned by `registerStruct`.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns The struct as an object.
+ */
+function readStruct(handle: number, address: number | bigint, layout: number, callback?: (errorMessage: string, value: StructValue) => void): StructValue {
+  if (!callback) {
+    return memoryprocess.readStruct(handle, address, layout);
+  }
+
+  return memoryprocess.readStruct(handle, address, layout, callback);
+}
+
+/**
+ * Reads `count` structs, `stride` bytes apart, and decodes them in native code. Closely packed
+ * structs are read at once, the pointed structs of a field are read in a single batch.
+ * Throws when the pointed structs of a field would span more than 1 GiB.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The address of the first struct.
+ * @param count - The number of structs.
+ * @param stride - Bytes between the start of two structs, 0 for the size of the layout.
+ * @param layout - Layout returned by `registerStruct`.
+ * @param options - `columnar: true` returns an object of columns instead of an array of objects.
+ * @returns The structs, `null` for those that couldn't be read, or their columns.
+ */
+function readStructArray(handle: number, address: number | bigint, count: number, stride: number, layout: number, options: { columnar: true }): StructColumns;
+function readStructArray(handle: number, address: number | bigint, count: number, stride: number, layout: number, options?: { columnar?: false }): (StructValue | null)[];
+function readStructArray(handle: number, address: number | bigint, count: number, stride: number, layout: number, options?: { columnar?: boolean }): (StructValue | null)[] | StructColumns {
+  return memoryprocess.readStructArray(handle, address, count, stride, layout, options);
+}
+
+/**
+ * Caches the memory read from a process by 4 KiB page, so values and scans read again and again
+ * don't go back to the kernel. Read-only and executable pages stay cached until evicted, writable
+ * pages only when `options.ttl` is set. Writes made through this library drop the pages they touch.
+ *
+ * @param handle - The handle of the process to cache.
+ * @param options - Byte budget of the cache and lifetime of writable pages.
+ */
+function enablePageCache(handle: number, options?: PageCacheOptions): void {
+  if (!options) {
+    return memoryprocess.enablePageCache(handle);
+  }
+
+  return memoryprocess.enablePageCache(handle, options);
+}
+
+/**
+ * Stops caching a process's memory and frees the cached pages.
+ *
+ * @param handle - The handle of the process.
+ */
+function disablePageCache(handle: number): void {
+  return memoryprocess.disablePageCache(handle);
+}
+
+/**
+ * Drops every cached writable page, read-only and executable pages are kept.
+ *
+ * @param handle - The handle of the process.
+ */
+function clearPageCache(handle: number): void {
+  return memoryprocess.clearPageCache(handle);
+}
+
+/**
+ * Retrieves the hit/miss counters of a process's page cache.
+ *
+ * @param handle - The handle of the process.
+ * @returns The counters, or null when the cache isn't enabled.
+ */
+function getPageCacheStats(handle: number): PageCacheStats | null {
+  return memoryprocess.getPageCacheStats(handle);
+}
+
 /**
  * Writes a value to a process's memory.
  * 
  * @param handle - The handle of the process to write to.
  * @param address - The address to write to.
  * @param value - The value to write.
- * @param dataType - The data type to write.
+ * @param dataType - The data type to write, a name or an id from `DataTypes`.
  * @param callback - Optional callback function to handle the result asynchronously.
  * @returns Whether the operation was successful.
  */
-function writeMemory(handle: number, address: number, value: string, dataType: 'str'|'string'): boolean;
-function writeMemory<T extends Exclude<DataType,'str'|'string'>>(handle: number, address: number, value: MemoryData<T>, dataType: T): boolean;
-function writeMemory(handle: number, address: number, value: any, dataType: DataType): boolean {
+function writeMemory(handle: number, address: number, value: string, dataType: 'str'|'string'|'wstr'|'wstring'): boolean;
+function writeMemory<T extends Exclude<DataType,'str'|'string'|'wstr'|'wstring'>>(handle: number, address: number, value: MemoryData<T>, dataType: T): boolean;
+function writeMemory(handle: number, address: number, value: any, dataType: DataTypeId): boolean;
+function writeMemory(handle: number, address: number, value: any, dataType: DataType | DataTypeId): boolean {
+  if (typeof dataType === 'number') {
+    return memoryprocess.writeMemory(handle, address, value, dataType);
+  }
+
   let dataValue: MemoryData<DataType> = value;
   if (dataType === 'str' || dataType === 'string') {
     // ensure TS knows this branch yields a string for T = 'str'|'string'
@@ -302,13 +559,24 @@ function writeBuffer(handle: number, address: number, buffer: Buffer<ArrayBuffer
   return memoryprocess.writeBuffer(handle, address, buffer);
 }
 
+/**
+ * Parses a signature once so it can be reused across pattern scans.
+ *
+ * @param signature - The signature to compile, e.g. `"8B 0D ? ? ? ? 8B 01"`.
+ * @returns A native handle that can be passed to `findPattern` in place of the signature string.
+ */
+function compilePattern(signature: string): CompiledPattern {
+  return memoryprocess.compilePattern(signature);
+}
+
 // TODO: Implement pattern scanning functionality with various overloads to match the C++ implementation
 function findPattern(...args: any[]): any {
   const pattern           = ['number', 'string', 'number', 'number'].toString();
   const patternByModule   = ['number', 'string', 'string', 'number', 'number'].toString();
   const patternByAddress  = ['number', 'number', 'string', 'number', 'number'].toString();
 
-  const types = args.map(arg => typeof arg);
+  // compiled patterns are native handles and can be used wherever a signature string is expected
+  const types = args.map(arg => (typeof arg === 'object' && arg !== null) ? 'string' : typeof arg);
 
   if (types.slice(0, 4).toString() === pattern) {
     if (types.length === 4 || (types.length === 5 && types[4] === 'function')) {
@@ -334,6 +602,257 @@ function findPattern(...args: any[]): any {
   throw new Error('invalid arguments!');
 }
 
+/**
+ * Searches for many signatures at once, walking each module and region only once.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param signatures - Signatures to search for, optionally with their own flags and pattern offset.
+ * @param all - Whether to return every match instead of the first one.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns One address per signature (0 when not found), or an array of addresses per signature when `all` is set.
+ */
+function findPatterns(handle: number, signatures: PatternRequest[], all?: false, callback?: (errorMessage: string, addresses: number[]) => void): number[];
+function findPatterns(handle: number, signatures: PatternRequest[], all: true, callback?: (errorMessage: string, addresses: number[][]) => void): number[][];
+function findPatterns(handle: number, signatures: PatternRequest[], all = false, callback?: (errorMessage: string, addresses: any) => void): number[] | number[][] {
+  if (!callback) {
+    return memoryprocess.findPatterns(handle, signatures, all);
+  }
+
+  return memoryprocess.findPatterns(handle, signatures, all, callback);
+}
+
+/**
+ * Finds every match of a signature across all modules and regions.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param signature - The signature to search for, as a string or a handle from `compilePattern`.
+ * @param flags - Flags for the pattern search.
+ * @param patternOffset - Offset added to every match.
+ * @param maxResults - Stops after this many matches, 0 for no limit.
+ * @param callback - Optional callback receiving the matches in batches as the scan goes. Returning `false` stops the scan.
+ * @returns Every matching address in the order found, module by module and then the regions outside modules,
+ *   or the number of matches handed to the callback.
+ */
+function findAllPatterns(handle: number, signature: string | CompiledPattern, flags: number, patternOffset: number, maxResults?: number): BigUint64Array;
+function findAllPatterns(handle: number, signature: string | CompiledPattern, flags: number, patternOffset: number, maxResults: number, callback: (errorMessage: string, addresses: BigUint64Array) => boolean | void): number;
+function findAllPatterns(handle: number, signature: string | CompiledPattern, flags: number, patternOffset: number, maxResults = 0, callback?: (errorMessage: string, addresses: BigUint64Array) => boolean | void): BigUint64Array | number {
+  if (!callback) {
+    return memoryprocess.findAllPatterns(handle, signature, flags, patternOffset, maxResults);
+  }
+
+  return memoryprocess.findAllPatterns(handle, signature, flags, patternOffset, maxResults, callback);
+}
+
+/**
+ * Sets how many threads pattern scans are spread over, including the calling thread.
+ *
+ * @param count - Number of threads, 0 to use one per hardware thread (the default).
+ * @returns The number of threads that will be used.
+ */
+function setScanThreads(count: number): number {
+  return memoryprocess.setScanThreads(count);
+}
+
+/**
+ * Scans every writable region of a process for values passing a condition. Pass
+ * `{ compare: 'unknown' }` to keep every value and narrow them down with `nextScan`.
+ *
+ * @param handle - The handle of the process to scan.
+ * @param dataType - The data type of the values.
+ * @param condition - The condition values have to pass.
+ * @param alignment - Alignment of the scanned addresses, defaults to the size of the data type.
+ * @returns The scan, holding the candidates found.
+ */
+function firstScan(handle: number, dataType: ScanDataType, condition: ScanCondition, alignment?: number): ValueScan {
+  if (alignment === undefined) {
+    return memoryprocess.firstScan(handle, dataType, condition);
+  }
+
+  return memoryprocess.firstScan(handle, dataType, condition, alignment);
+}
+
+/**
+ * Reads the candidates of a scan again and keeps the ones passing a new condition.
+ *
+ * @param scan - The scan returned by `firstScan`.
+ * @param condition - The condition values have to pass, which can compare with the previous scan.
+ * @returns The number of candidates left.
+ */
+function nextScan(scan: ValueScan, condition: ScanCondition): number {
+  return memoryprocess.nextScan(scan, condition);
+}
+
+/**
+ * Retrieves the number of candidates of a scan.
+ *
+ * @param scan - The scan returned by `firstScan`.
+ * @returns The number of candidates.
+ */
+function getScanCount(scan: ValueScan): number {
+  return memoryprocess.getScanCount(scan);
+}
+
+/**
+ * Retrieves the addresses of the candidates of a scan, in ascending order.
+ *
+ * @param scan - The scan returned by `firstScan`.
+ * @param maxResults - Maximum number of addresses returned, 0 for all of them (the default).
+ * @returns The addresses.
+ */
+function getScanResults(scan: ValueScan, maxResults = 0): BigUint64Array {
+  return memoryprocess.getScanResults(scan, maxResults);
+}
+
+/**
+ * Finds pointer chains leading to an address, for addresses that move between runs. Every
+ * pointer in the writable memory of the process is mapped by the address it points to, then
+ * walked back from the address a level at a time up to `maxDepth` dereferences. Chains
+ * starting at a pointer stored in a module are written to `path`, shortest first, and can be
+ * read back with `readPointerChains`.
+ *
+ * @param handle - The handle of the process to scan.
+ * @param address - The address the chains lead to.
+ * @param path - The file to write the chains to.
+ * @param options - Optional limits of the scan.
+ * @returns How many pointers were mapped and chains written.
+ */
+function scanPointers(handle: number, address: number | bigint, path: string, options?: PointerScanOptions): PointerScanStats {
+  return memoryprocess.scanPointers(handle, address, path, options);
+}
+
+/**
+ * Reads the chains written by a pointer scan.
+ *
+ * @param path - The file written by `scanPointers`.
+ * @param maxResults - Maximum number of chains read, 0 for all of them (the default).
+ * @returns The chains, with the name of the module each one starts in.
+ */
+function readPointerChains(path: string, maxResults = 0): PointerChain[] {
+  return memoryprocess.readPointerChains(path, maxResults);
+}
+
+/**
+ * Maps every pointer in the writable memory of a process, like `scanPointers` does, and
+ * saves the map so it can be walked back from with `scanPointerMap` without the process.
+ *
+ * @param handle - The handle of the process to map.
+ * @param path - The file to save the map to.
+ * @param options - Optional pointer size, alignment and `maxMemory` of the map.
+ * @returns How many pointers were mapped.
+ */
+function savePointerMap(handle: number, path: string, options?: PointerScanOptions): number {
+  return memoryprocess.savePointerMap(handle, path, options);
+}
+
+/**
+ * Finds pointer chains leading to an address in a map saved by `savePointerMap`. The map
+ * is used straight from the file, any number of addresses can be scanned for from one map.
+ *
+ * @param mapPath - The file written by `savePointerMap`.
+ * @param address - The address the chains lead to.
+ * @param path - The file to write the chains to, other than `mapPath`.
+ * @param options - Optional limits of the scan, the pointer size is the map's.
+ * @returns How many pointers were mapped and chains written.
+ */
+function scanPointerMap(mapPath: string, address: number | bigint, path: string, options?: PointerScanOptions): PointerScanStats {
+  return memoryprocess.scanPointerMap(mapPath, address, path, options);
+}
+
+/**
+ * Follows the chains of a pointer scan in a process, usually a later run of the one scanned,
+ * and writes the ones still leading to the address to another file. Module base addresses
+ * are looked up by name, and all the chains are followed together, one level at a time.
+ *
+ * @param handle - The handle of the process to follow the chains in.
+ * @param path - The file written by a pointer scan.
+ * @param address - The address the chains must lead to in this process.
+ * @param output - The file to write the chains kept to, other than `path`.
+ * @returns How many chains were followed and kept.
+ */
+function filterPointerChains(handle: number, path: string, address: number | bigint, output: string): PointerFilterStats {
+  return memoryprocess.filterPointerChains(handle, path, address, output);
+}
+
+/**
+ * Writes the chains of the first pointer scan found in every other one to a file, chains
+ * being the same when they start in a module of the same name with the same offsets.
+ *
+ * @param paths - Files written by pointer scans, of different runs of a process.
+ * @param output - The file to write the chains found in all of them to, none of `paths`.
+ * @returns How many chains were written.
+ */
+function intersectPointerChains(paths: string[], output: string): number {
+  return memoryprocess.intersectPointerChains(paths, output);
+}
+
+/**
+ * Streams a process's memory into a file: its regions, its modules, then the bytes of
+ * every region. The dump can be opened again with `openSnapshot`.
+ *
+ * @param handle - The handle of the process to dump.
+ * @param path - The file to write.
+ * @param filter - Optional filter of the regions written.
+ * @param callback - Optional callback function to handle the result asynchronously.
+ * @returns What was written.
+ */
+function dumpProcess(handle: number, path: string, filter?: SnapshotFilter): DumpStats;
+function dumpProcess(handle: number, path: string, filter: SnapshotFilter | undefined, callback: (errorMessage: string, stats: DumpStats | null) => void): null;
+function dumpProcess(handle: number, path: string, filter?: SnapshotFilter, callback?: (errorMessage: string, stats: DumpStats | null) => void): DumpStats | null {
+  if (!callback) {
+    return memoryprocess.dumpProcess(handle, path, filter);
+  }
+
+  return memoryprocess.dumpProcess(handle, path, filter, callback);
+}
+
+/**
+ * Opens a dump written by `dumpProcess` or `trackProcess`. The handle returned works with the
+ * functions reading memory, listing regions and modules or scanning for patterns as if it were
+ * the process, reading straight from the memory mapped files. Writes fail.
+ *
+ * @param path - The dump to open.
+ * @param deltas - Deltas written by `captureDelta`, in the order they were captured.
+ * @returns The handle of the snapshot, closed with `closeHandle`.
+ */
+function openSnapshot(path: string, deltas?: string[]): number {
+  if (!deltas) {
+    return memoryprocess.openSnapshot(path);
+  }
+
+  return memoryprocess.openSnapshot(path, deltas);
+}
+
+/**
+ * Dumps a process like `dumpProcess` and starts following the pages it writes, so
+ * `captureDelta` only has to copy what changed. Linux soft-dirty bits tell which pages
+ * were written when the kernel supports them, every page is hashed (CRC32C) otherwise.
+ * The process is stopped briefly while the bits are read and cleared, and every page is
+ * copied by a capture that can't stop it.
+ *
+ * @param handle - The handle of the process to dump.
+ * @param path - The file the baseline is written to.
+ * @param filter - Optional filter of the regions written.
+ * @returns What was written, and the tracker to capture deltas with.
+ */
+function trackProcess(handle: number, path: string, filter?: SnapshotFilter): TrackedDump {
+  if (!filter) {
+    return memoryprocess.trackProcess(handle, path);
+  }
+
+  return memoryprocess.trackProcess(handle, path, filter);
+}
+
+/**
+ * Writes the pages changed since the baseline or the previous delta into a delta file.
+ *
+ * @param tracker - The tracker returned by `trackProcess`.
+ * @param path - The file the delta is written to.
+ * @returns How many pages were checked and how many were copied.
+ */
+function captureDelta(tracker: TrackedDump['tracker'], path: string): DeltaStats {
+  return memoryprocess.captureDelta(tracker, path);
+}
+
 /**
  * Calls a function in a process's memory.
  * 
@@ -459,6 +978,104 @@ function virtualQueryEx(handle: number, address: number, callback: ((region: any
   return memoryprocess.virtualQueryEx(handle, address, callback);
 }
 
+/**
+ * Starts a thread that attaches to processes, waits for their debug events and continues them
+ * by the policy of the debug register that raised them, without going through JavaScript.
+ * `onEvents` gets every stop the thread went through since it last ran.
+ *
+ * @param onEvents - Called on the JavaScript thread with the stops waiting.
+ * @returns The pump, running until passed to `closeDebugPump`.
+ */
+function createDebugPump(onEvents: (events: DebugEvent[]) => void): DebugPump {
+  return memoryprocess.createDebugPump(onEvents);
+}
+
+/**
+ * Attaches a debug pump to a process.
+ *
+ * @param pump - The debug pump.
+ * @param processId - The process to debug.
+ * @param killOnExit - Whether the process is killed when the pump goes away.
+ * @returns Whether the pump attached.
+ */
+function debugPumpAttach(pump: DebugPump, processId: number, killOnExit = false): boolean {
+  return memoryprocess.debugPumpAttach(pump, processId, killOnExit);
+}
+
+/**
+ * Detaches a debug pump from a process, continuing whatever it holds of it.
+ *
+ * @param pump - The debug pump.
+ * @param processId - The process to stop debugging.
+ * @returns Whether the pump detached.
+ */
+function debugPumpDetach(pump: DebugPump, processId: number): boolean {
+  return memoryprocess.debugPumpDetach(pump, processId);
+}
+
+/**
+ * Sets a hardware breakpoint in every thread of a process a debug pump is attached to. On Linux
+ * it is a perf event per thread, opened for every thread the process starts too, and hits are
+ * reported without stopping the thread.
+ *
+ * @param pump - The debug pump.
+ * @param processId - The process to set the breakpoint in.
+ * @param address - The address to break on.
+ * @param register - Debug register 0 to 3.
+ * @param trigger - One of `BreakpointTriggerTypes`.
+ * @param size - Bytes watched: 1, 2, 4 or 8, ignored when breaking on execution.
+ * @returns Whether the breakpoint was set.
+ */
+function debugPumpSetBreakpoint(pump: DebugPump, processId: number, address: number | bigint, register: number, trigger: BreakpointTriggerType, size: number): boolean {
+  return memoryprocess.debugPumpSetBreakpoint(pump, processId, address, register, trigger, size);
+}
+
+/**
+ * Removes a hardware breakpoint set with `debugPumpSetBreakpoint`.
+ *
+ * @param pump - The debug pump.
+ * @param processId - The process the breakpoint is in.
+ * @param register - Debug register 0 to 3.
+ * @returns Whether the breakpoint was removed.
+ */
+function debugPumpRemoveBreakpoint(pump: DebugPump, processId: number, register: number): boolean {
+  return memoryprocess.debugPumpRemoveBreakpoint(pump, processId, register);
+}
+
+/**
+ * Sets what a debug pump does with the stops of a debug register. Registers are continued
+ * as handled by default, any other exception is passed on.
+ *
+ * @param pump - The debug pump.
+ * @param register - Debug register 0 to 3, or -1 for exceptions that aren't hardware breakpoints.
+ * @param policy - One of `DebugPolicies`.
+ */
+function setDebugPolicy(pump: DebugPump, register: number, policy: DebugPolicy): void {
+  memoryprocess.setDebugPolicy(pump, register, policy);
+}
+
+/**
+ * Continues a thread a debug pump holds under the `HOLD` policy.
+ *
+ * @param pump - The debug pump.
+ * @param processId - The process of the thread.
+ * @param threadId - The thread to continue.
+ * @param handled - Whether the exception was handled, false passes it on to the process.
+ * @returns Whether the thread was held.
+ */
+function continueDebugEvent(pump: DebugPump, processId: number, threadId: number, handled = true): boolean {
+  return memoryprocess.continueDebugEvent(pump, processId, threadId, handled);
+}
+
+/**
+ * Stops a debug pump, continuing what it holds and detaching from every process.
+ *
+ * @param pump - The debug pump.
+ */
+function closeDebugPump(pump: DebugPump): void {
+  memoryprocess.closeDebugPump(pump);
+}
+
 /**
  * Injects a DLL into a process.
 
@@ -513,17 +1130,264 @@ function openFileMapping(fileName: string) {
   return memoryprocess.openFileMapping(fileName);
 }
 
+/**
+ * Runs a native *Async function, cancelling its worker when `signal` is aborted.
+ * The returned promise rejects with the signal's reason when the work was stopped by the
+ * abort, work that ran to completion anyway resolves with its result.
+ */
+async function withSignal<T>(signal: AbortSignal | undefined, run: (token?: unknown) => Promise<T>): Promise<T> {
+  if (!signal) {
+    return run();
+  }
+
+  signal.throwIfAborted();
+
+  const token = memoryprocess.createCancellation();
+  const abort = () => memoryprocess.cancel(token);
+  signal.addEventListener('abort', abort, { once: true });
+
+  try {
+    return await run(token);
+  } catch (error) {
+    throw signal.aborted ? signal.reason : error;
+  } finally {
+    signal.removeEventListener('abort', abort);
+  }
+}
+
+/**
+ * Searches for a signature on a worker thread, modules first, then every memory region.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param signature - The signature to search for, as a string or a handle from `compilePattern`.
+ * @param flags - Flags for the pattern search.
+ * @param patternOffset - Offset added to the match.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to the matching address, or 0 if nothing matched.
+ */
+function findPatternAsync(handle: number, signature: string | CompiledPattern, flags: number, patternOffset: number, signal?: AbortSignal): Promise<number> {
+  return withSignal(signal, token => memoryprocess.findPatternAsync(handle, signature, flags, patternOffset, token));
+}
+
+/**
+ * Searches for a signature inside a single module on a worker thread.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param moduleName - The name of the module to search in.
+ * @param signature - The signature to search for, as a string or a handle from `compilePattern`.
+ * @param flags - Flags for the pattern search.
+ * @param patternOffset - Offset added to the match.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to the matching address, or 0 if nothing matched.
+ */
+function findPatternByModuleAsync(handle: number, moduleName: string, signature: string | CompiledPattern, flags: number, patternOffset: number, signal?: AbortSignal): Promise<number> {
+  return withSignal(signal, token => memoryprocess.findPatternByModuleAsync(handle, moduleName, signature, flags, patternOffset, token));
+}
+
+/**
+ * Searches for a signature inside the module or region containing `baseAddress` on a worker thread.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param baseAddress - Address inside the module or region to search.
+ * @param signature - The signature to search for, as a string or a handle from `compilePattern`.
+ * @param flags - Flags for the pattern search.
+ * @param patternOffset - Offset added to the match.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to the matching address, or 0 if nothing matched.
+ */
+function findPatternByAddressAsync(handle: number, baseAddress: number | bigint, signature: string | CompiledPattern, flags: number, patternOffset: number, signal?: AbortSignal): Promise<number> {
+  return withSignal(signal, token => memoryprocess.findPatternByAddressAsync(handle, baseAddress, signature, flags, patternOffset, token));
+}
+
+/**
+ * Searches for many signatures at once on a worker thread, see `findPatterns`.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param signatures - Signatures to search for, optionally with their own flags and pattern offset.
+ * @param all - Whether to return every match instead of the first one.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to one address per signature, or an array of addresses per signature when `all` is set.
+ */
+function findPatternsAsync(handle: number, signatures: PatternRequest[], all?: false, signal?: AbortSignal): Promise<number[]>;
+function findPatternsAsync(handle: number, signatures: PatternRequest[], all: true, signal?: AbortSignal): Promise<number[][]>;
+function findPatternsAsync(handle: number, signatures: PatternRequest[], all = false, signal?: AbortSignal): Promise<number[] | number[][]> {
+  return withSignal(signal, token => memoryprocess.findPatternsAsync(handle, signatures, all, token));
+}
+
+/**
+ * Finds every match of a signature across all modules and regions on a worker thread.
+ *
+ * @param handle - The handle of the process to search in.
+ * @param signature - The signature to search for, as a string or a handle from `compilePattern`.
+ * @param flags - Flags for the pattern search.
+ * @param patternOffset - Offset added to every match.
+ * @param maxResults - Stops after this many matches, 0 for no limit.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to every matching address in the order found, module by module and then
+ *   the regions outside modules.
+ */
+function findAllPatternsAsync(handle: number, signature: string | CompiledPattern, flags: number, patternOffset: number, maxResults = 0, signal?: AbortSignal): Promise<BigUint64Array> {
+  return withSignal(signal, token => memoryprocess.findAllPatternsAsync(handle, signature, flags, patternOffset, maxResults, token));
+}
+
+/**
+ * Retrieves the memory regions of a process on a worker thread.
+ *
+ * @param handle - The handle of the process.
+ * @param signal - Optional signal aborting the call before it starts.
+ * @returns A promise resolving to the regions, see `getRegions`.
+ */
+function getRegionsAsync(handle: number, signal?: AbortSignal): Promise<any[]> {
+  return withSignal(signal, token => memoryprocess.getRegionsAsync(handle, token));
+}
+
+/**
+ * Reads a buffer from a process's memory on a worker thread, a megabyte at a time.
+ * Parts that can't be read are left zeroed.
+ *
+ * @param handle - The handle of the process to read from.
+ * @param address - The memory address to read from.
+ * @param size - The number of bytes to read.
+ * @param signal - Optional signal aborting the read.
+ * @returns A promise resolving to the buffer.
+ */
+function readBufferAsync(handle: number, address: number | bigint, size: number, signal?: AbortSignal): Promise<Buffer> {
+  return withSignal(signal, token => memoryprocess.readBufferAsync(handle, address, size, token));
+}
+
+/**
+ * Streams a process's memory into a file on a worker thread, see `dumpProcess`.
+ * An aborted dump removes the file.
+ *
+ * @param handle - The handle of the process to dump.
+ * @param path - The file to write.
+ * @param filter - Optional filter of the regions written.
+ * @param signal - Optional signal aborting the dump.
+ * @returns A promise resolving to what was written.
+ */
+function dumpProcessAsync(handle: number, path: string, filter?: SnapshotFilter, signal?: AbortSignal): Promise<DumpStats> {
+  return withSignal(signal, token => memoryprocess.dumpProcessAsync(handle, path, filter, token));
+}
+
+/**
+ * Finds pointer chains leading to an address on worker threads, see `scanPointers`.
+ *
+ * @param handle - The handle of the process to scan.
+ * @param address - The address the chains lead to.
+ * @param path - The file to write the chains to.
+ * @param options - Optional limits of the scan.
+ * @param signal - Optional signal aborting the scan.
+ * @returns A promise resolving to how many pointers were mapped and chains written.
+ */
+function scanPointersAsync(handle: number, address: number | bigint, path: string, options?: PointerScanOptions, signal?: AbortSignal): Promise<PointerScanStats> {
+  return withSignal(signal, token => memoryprocess.scanPointersAsync(handle, address, path, options, token));
+}
+
+/**
+ * Maps and saves every pointer of a process on worker threads, see `savePointerMap`.
+ *
+ * @param handle - The handle of the process to map.
+ * @param path - The file to save the map to.
+ * @param options - Optional pointer size, alignment and `maxMemory` of the map.
+ * @param signal - Optional signal aborting the mapping.
+ * @returns A promise resolving to how many pointers were mapped.
+ */
+function savePointerMapAsync(handle: number, path: string, options?: PointerScanOptions, signal?: AbortSignal): Promise<number> {
+  return withSignal(signal, token => memoryprocess.savePointerMapAsync(handle, path, options, token));
+}
+
+/**
+ * Follows the chains of a pointer scan in a process on a worker thread, see `filterPointerChains`.
+ *
+ * @param handle - The handle of the process to follow the chains in.
+ * @param path - The file written by a pointer scan.
+ * @param address - The address the chains must lead to in this process.
+ * @param output - The file to write the chains kept to, other than `path`.
+ * @param signal - Optional signal aborting the filter.
+ * @returns A promise resolving to how many chains were followed and kept.
+ */
+function filterPointerChainsAsync(handle: number, path: string, address: number | bigint, output: string, signal?: AbortSignal): Promise<PointerFilterStats> {
+  return withSignal(signal, token => memoryprocess.filterPointerChainsAsync(handle, path, address, output, token));
+}
+
+/**
+ * Calls a function in a process's memory on a worker thread.
+ * Aborting only helps before the call starts, a running remote thread isn't stopped.
+ *
+ * @param handle - The handle of the process to call the function in.
+ * @param args - The arguments to pass to the function.
+ * @param returnType - The return type of the function.
+ * @param address - The address of the function to call.
+ * @param signal - Optional signal aborting the call before it starts.
+ * @returns A promise resolving to the return value and exit code of the function.
+ */
+function callFunctionAsync(handle: number, args: any[], returnType: number, address: number | bigint, signal?: AbortSignal): Promise<{ returnValue: any; exitCode: number; }> {
+  return withSignal(signal, token => memoryprocess.callFunctionAsync(handle, args, returnType, address, token));
+}
+
+/**
+ * Injects a DLL into a process on a worker thread.
+ * Aborting only helps before the injection starts.
+ *
+ * @param handle - The handle of the process to inject the DLL into.
+ * @param dllPath - The path to the DLL to inject.
+ * @param signal - Optional signal aborting the injection before it starts.
+ * @returns A promise resolving to whether the DLL was loaded.
+ */
+function injectDllAsync(handle: number, dllPath: PathLike, signal?: AbortSignal): Promise<boolean> {
+  if (!dllPath.toString().endsWith('.dll')) {
+    return Promise.reject(new Error("Given path is invalid: file is not of type 'dll'."));
+  }
+
+  return withSignal(signal, token => memoryprocess.injectDllAsync(handle, dllPath.toString(), token));
+}
+
 const library = {
   openProcess,
   closeHandle,
   getProcesses,
   findModule,
   getModules,
+  setProcessIndexMaxAge,
+  DataTypes,
   readMemory,
+  readString,
   readBuffer,
+  readBufferInto,
+  readMemoryBatch,
+  watch,
+  unwatch,
+  compileReadPlan,
+  executeReadPlan,
+  registerStruct,
+  readStruct,
+  readStructArray,
+  readColumns,
+  enablePageCache,
+  disablePageCache,
+  clearPageCache,
+  getPageCacheStats,
   writeMemory,
   writeBuffer,
+  compilePattern,
   findPattern,
+  findPatterns,
+  findAllPatterns,
+  setScanThreads,
+  firstScan,
+  nextScan,
+  getScanCount,
+  getScanResults,
+  scanPointers,
+  readPointerChains,
+  savePointerMap,
+  scanPointerMap,
+  filterPointerChains,
+  intersectPointerChains,
+  dumpProcess,
+  openSnapshot,
+  trackProcess,
+  captureDelta,
   callFunction,
   virtualAllocEx,
   virtualProtectEx,
@@ -533,6 +1397,27 @@ const library = {
   unloadDll,
   openFileMapping,
   mapViewOfFile,
+  findPatternAsync,
+  findPatternByModuleAsync,
+  findPatternByAddressAsync,
+  findPatternsAsync,
+  findAllPatternsAsync,
+  getRegionsAsync,
+  readBufferAsync,
+  dumpProcessAsync,
+  scanPointersAsync,
+  savePointerMapAsync,
+  filterPointerChainsAsync,
+  callFunctionAsync,
+  injectDllAsync,
+  createDebugPump,
+  debugPumpAttach,
+  debugPumpDetach,
+  debugPumpSetBreakpoint,
+  debugPumpRemoveBreakpoint,
+  setDebugPolicy,
+  continueDebugEvent,
+  closeDebugPump,
   attachDebugger: memoryprocess.attachDebugger,
   detachDebugger: memoryprocess.detachDebugger,
   awaitDebugEvent: memoryprocess.awaitDebugEvent,
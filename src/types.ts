@@ -16,6 +16,29 @@ export const SignatureTypes = {
   SUBTRACT: 0x2,
 } as const;
 
+/**
+ * Signature parsed by `compilePattern`, opaque to JavaScript
+ */
+export type CompiledPattern = { readonly __brand: 'CompiledPattern' };
+
+/**
+ * Signature searched for by `findPatterns`, either on its own or with per-signature options
+ */
+export type PatternRequest = string | CompiledPattern | {
+  /**
+   * Signature string or compiled pattern
+   */
+  pattern: string | CompiledPattern;
+  /**
+   * Combination of `SignatureTypes` flags
+   */
+  flags?: number;
+  /**
+   * Offset added to the matching address
+   */
+  patternOffset?: number;
+};
+
 // Memory access flags
 export const MemoryAccessFlags = {
   PAGE_NOACCESS: 0x01,
@@ -68,11 +91,22 @@ export const BreakpointTriggerTypes = {
   TRIGGER_WRITE: 0x1,
 } as const;
 
+// What a debug pump does with the stops of a debug register
+export const DebugPolicies = {
+  // Continued as handled, the process doesn't see the exception
+  HANDLED: 0x0,
+  // Passed on to the process
+  UNHANDLED: 0x1,
+  // Left stopped until `continueDebugEvent`
+  HOLD: 0x2,
+} as const;
+
 
 export type Protection = typeof MemoryAccessFlags[keyof typeof MemoryAccessFlags];
 export type PageProtection = typeof MemoryPageFlags[keyof typeof MemoryPageFlags];
 export type AllocationType = typeof MemoryAllocationFlags[keyof typeof MemoryAllocationFlags];
 export type BreakpointTriggerType = typeof BreakpointTriggerTypes[keyof typeof BreakpointTriggerTypes];
+export type DebugPolicy = typeof DebugPolicies[keyof typeof DebugPolicies];
 
 /**
  * Represents a process with its associated information and handle
@@ -159,17 +193,399 @@ export type DataType =
   'double'  | 'double_be'|
   'bool'    | 'boolean'  |
   'ptr'     | 'pointer'  | 'uptr'    | 'upointer' |
-  'str'     | 'string'   |
+  'str'     | 'string'   | 'wstr'    | 'wstring'  |
   'vec3'    | 'vector3'  |
   'vec4'    | 'vector4';
 
+/**
+ * Numeric id of a data type, taken from `DataTypes`. Passing ids instead of names
+ * skips looking the type up on every call.
+ */
+export type DataTypeId = number & { readonly __brand: 'DataTypeId' };
+
+/**
+ * Field read by `readMemoryBatch`, only fixed size little-endian types can be batched
+ */
+export type BatchRead = {
+  /**
+   * Address of the value
+   */
+  address: number | bigint;
+  /**
+   * Data type of the value, as a name or an id from `DataTypes`
+   */
+  type: Exclude<DataType, 'str' | 'string' | 'wstr' | 'wstring' | `${string}_be`> | DataTypeId;
+};
+
+/**
+ * Buffer returned by `readMemoryBatch`: the values, then a status byte per request
+ */
+export type BatchResult = Buffer & {
+  /**
+   * Offset of the value of each request in the buffer
+   */
+  readonly offsets: Uint32Array;
+  /**
+   * Offset of the status bytes, one per request, 1 when its value could be read
+   */
+  readonly statusOffset: number;
+};
+
+/**
+ * Value polled by `watch`, any fixed size little-endian type
+ */
+export type WatchedValue = {
+  /**
+   * Address of the value
+   */
+  address: number | bigint;
+  /**
+   * Data type of the value, as a name or an id from `DataTypes`
+   */
+  type: BatchRead['type'];
+};
+
+/**
+ * Values polled by `watch`, until passed to `unwatch`
+ */
+export type Watch = { readonly __brand: 'Watch' };
+
+/**
+ * Thread of a debugged process stopped by an exception, a signal on Linux
+ */
+export type DebugEvent = {
+  processId: number;
+  threadId: number;
+  /**
+   * Exception code, the signal number on Linux
+   */
+  exceptionCode: number;
+  /**
+   * Exception flags, the signal's si_code on Linux
+   */
+  exceptionFlags: number;
+  exceptionAddress: number;
+  /**
+   * Debug register whose breakpoint was hit, -1 for any other exception
+   */
+  hardwareRegister: number;
+};
+
+/**
+ * Native thread debugging processes, until passed to `closeDebugPump`
+ */
+export type DebugPump = { readonly __brand: 'DebugPump' };
+
+/**
+ * Pointer chain read by a read plan. Every offset but the last is added and
+ * dereferenced, the last one is added before reading the value.
+ */
+export type ReadChain = {
+  /**
+   * Address the chain starts at, usually a module base address
+   */
+  base: number | bigint;
+  /**
+   * Offsets applied at every hop
+   */
+  offsets?: number[];
+  /**
+   * Data type of the value at the end of the chain, as a name or an id from `DataTypes`
+   */
+  type: BatchRead['type'];
+};
+
+/**
+ * Read plan compiled by `compileReadPlan`
+ */
+export type ReadPlan = {
+  /**
+   * Compiled chains, opaque to JavaScript
+   */
+  readonly compiled: { readonly __brand: 'ReadPlan' };
+  /**
+   * Minimum size of the buffer the plan is executed into
+   */
+  readonly byteLength: number;
+  /**
+   * Offset of the value of each chain in the buffer
+   */
+  readonly offsets: readonly number[];
+  /**
+   * Offset of the status bytes, one per chain, 1 when its value could be read
+   */
+  readonly statusOffset: number;
+};
+
+/**
+ * Field of a struct layout registered with `registerStruct`
+ */
+export type StructField = {
+  /**
+   * Property the field is decoded into
+   */
+  name: string;
+  /**
+   * Offset of the field in the struct
+   */
+  offset: number;
+  /**
+   * Fixed size data type, `'string'` for a NUL terminated string stored in the struct,
+   * or `'struct'` for a struct stored in the struct
+   */
+  type: Exclude<DataType, 'wstr' | 'wstring' | `${string}_be`> | 'struct';
+  /**
+   * Bytes of a `'string'` field
+   */
+  length?: number;
+  /**
+   * Layout of a `'struct'` field, or of the struct a pointer field points to,
+   * which is then decoded in its place (`null` for null or unreadable pointers)
+   */
+  layout?: number;
+};
+
+/**
+ * Options of `registerStruct`
+ */
+export type StructOptions = {
+  /**
+   * Bytes of the struct, defaults to the end of its last field
+   */
+  size?: number;
+  /**
+   * Size of the pointers stored in the target process, 4 or 8 (default: size of the pointers of this build)
+   */
+  pointerSize?: 4 | 8;
+};
+
+/**
+ * Field scattered into its own column by `readColumns`
+ */
+export type ColumnRead = {
+  /**
+   * Offset of the field in every struct
+   */
+  offset: number;
+  /**
+   * Data type of the field, as a name or an id from `DataTypes`. Only fixed size little-endian
+   * types can be read into columns.
+   */
+  type: BatchRead['type'];
+  /**
+   * Receives the field of every struct back to back, e.g. a `Float32Array` of `3 * count`
+   * values for a `'vec3'`. Fields of structs that couldn't be read are zeroed.
+   */
+  target: ArrayBuffer | ArrayBufferView;
+};
+
+/**
+ * Struct decoded by `readStruct` and `readStructArray`
+ */
+export type StructValue = { [field: string]: any };
+
+/**
+ * Structs decoded by `readStructArray` with `columnar: true`, one column per field. Numbers,
+ * booleans and pointers are typed arrays, vectors are `Float32Array`s of 3 or 4 values per
+ * struct, strings are arrays, nested and pointed structs are objects of columns. Values of
+ * structs that couldn't be read are zero.
+ */
+export type StructColumns = { [field: string]: ArrayLike<number | bigint> | (string | null)[] | StructColumns };
+
 /**
    * Maps a DataType to its corresponding JS return type
    */
 export type MemoryData<T extends DataType> =
 /** 64-bit integers (LE/BE) as BigInt */
 T extends 'int64' | 'uint64' | 'int64_be' | 'uint64_be' ? bigint :
-T extends 'string' | 'str' ? string :
+T extends 'string' | 'str' | 'wstring' | 'wstr' ? string :
 T extends 'vector3' | 'vec3' ? { x: number; y: number; z: number } :
 T extends 'vector4' | 'vec4' ? { x: number; y: number; z: number; w: number } :
-number;
\ No newline at end of file
+number;
+/**
+ * Options of the page cache enabled by `enablePageCache`
+ */
+export type PageCacheOptions = {
+  /**
+   * Bytes of pages kept at most, least recently used pages are evicted first (default 64 MiB)
+   */
+  budget?: number;
+  /**
+   * Milliseconds writable pages stay cached, 0 to keep them until `clearPageCache`.
+   * Writable pages aren't cached when left out, read-only and executable pages always are.
+   */
+  ttl?: number;
+};
+
+/**
+ * Options of `readString`
+ */
+export type StringOptions = {
+  /**
+   * Characters read at most, longer strings are cut (default 1048576)
+   */
+  maxLength?: number;
+  /**
+   * `'utf8'` for single byte and UTF-8 strings, `'utf16'` for UTF-16LE (wide) strings (default `'utf8'`)
+   */
+  encoding?: 'utf8' | 'utf16';
+};
+
+/**
+ * Counters of a page cache, see `getPageCacheStats`
+ */
+export type PageCacheStats = {
+  hits: number;
+  misses: number;
+  evictions: number;
+  pages: number;
+  bytes: number;
+};
+
+/**
+ * Data types `firstScan` can look for
+ */
+export type ScanDataType =
+  'int8' | 'byte' | 'char' | 'uint8' | 'ubyte' | 'uchar' | 'bool' | 'boolean' |
+  'int16' | 'short' | 'uint16' | 'ushort' | 'word' |
+  'int32' | 'int' | 'long' | 'uint32' | 'uint' | 'ulong' | 'dword' |
+  'int64' | 'uint64' | 'ptr' | 'pointer' | 'uptr' | 'upointer' |
+  'float' | 'double';
+
+/**
+ * Condition a value has to pass to stay a candidate of a value scan.
+ * `unknown` is only valid for a first scan, the comparisons with the previous
+ * value (`changed`, `unchanged`, `increased`, `decreased`) only for next scans.
+ */
+export type ScanCondition =
+  { compare: 'exact'; value: number | bigint } |
+  { compare: 'range'; min: number | bigint; max: number | bigint } |
+  { compare: 'unknown' | 'changed' | 'unchanged' | 'increased' | 'decreased' };
+
+/**
+ * Candidates of a value scan started by `firstScan`
+ */
+export type ValueScan = { readonly __brand: 'ValueScan' };
+
+/**
+ * Regions written by `dumpProcess`, every committed readable region when left out
+ */
+export type SnapshotFilter = {
+  /**
+   * Keeps regions with one of these `MemoryAccessFlags`
+   */
+  protection?: number;
+  /**
+   * Keeps regions of one of these types (`MEM_IMAGE`, `MEM_MAPPED`, `MEM_PRIVATE`)
+   */
+  type?: number;
+  /**
+   * Keeps regions overlapping [start, end)
+   */
+  start?: number | bigint;
+  end?: number | bigint;
+};
+
+/**
+ * What `dumpProcess` wrote
+ */
+export type DumpStats = {
+  regions: number;
+  bytes: number;
+  /**
+   * Pages that couldn't be read, stored as zeroes
+   */
+  unreadablePages: number;
+};
+
+/**
+ * Baseline written by `trackProcess`, along with the tracker `captureDelta` takes
+ */
+export type TrackedDump = DumpStats & {
+  readonly tracker: { readonly __brand: 'DumpTracker' };
+  /**
+   * Whether the kernel reports written pages (Linux soft-dirty bits), pages are hashed otherwise
+   */
+  softDirty: boolean;
+};
+
+/**
+ * What `captureDelta` wrote
+ */
+export type DeltaStats = {
+  /**
+   * Number of the delta, starting at 1
+   */
+  sequence: number;
+  pagesScanned: number;
+  pagesCopied: number;
+  softDirty: boolean;
+};
+
+/**
+ * Limits of a pointer scan, every field being optional
+ */
+export type PointerScanOptions = {
+  /**
+   * Size of the pointers of the process, 8 by default on 64-bit builds
+   */
+  pointerSize?: 4 | 8;
+  /**
+   * Pointers are looked for at multiples of it, their own size by default
+   */
+  alignment?: number;
+  /**
+   * Dereferences of the longest chain, 5 by default
+   */
+  maxDepth?: number;
+  /**
+   * Largest offset added to a pointer, 0x1000 by default
+   */
+  maxOffset?: number;
+  /**
+   * Chains written at most, 1000000 by default, 0 for no limit
+   */
+  maxResults?: number;
+  /**
+   * Bytes the pointer map and the levels walked back can take, 1 GiB by default
+   */
+  maxMemory?: number;
+};
+
+/**
+ * What `scanPointers` wrote
+ */
+export type PointerScanStats = {
+  /**
+   * Pointers found in the writable memory of the process
+   */
+  pointers: number;
+  chains: number;
+  /**
+   * Whether levels were left unwalked or chains unwritten because of `maxMemory` or `maxResults`
+   */
+  truncated: boolean;
+};
+
+/**
+ * A chain read back from a pointer scan. `offsets[0]` is where the first pointer is stored
+ * in the module, so `{ base: module base address, offsets, type }` is a `ReadChain`.
+ */
+export type PointerChain = {
+  module: string;
+  offsets: number[];
+};
+
+/**
+ * What `filterPointerChains` kept
+ */
+export type PointerFilterStats = {
+  /**
+   * Chains followed in the process
+   */
+  chains: number;
+  /**
+   * Chains still leading to the address, written to the output file
+   */
+  kept: number;
+};